@@ -27,7 +27,6 @@ namespace Asset
         framework_(framework), 
         memory_cache_size_(DEFAULT_MEMORY_CACHE_SIZE),
         update_time_(0.0),
-        md5_engine_(new QCryptographicHash(QCryptographicHash::Md5)),
         disk_changes_after_last_check_(false),
         disk_cache_max_size_(0)
     {
@@ -52,7 +51,6 @@ namespace Asset
 
     AssetCache::~AssetCache()
     {
-        SAFE_DELETE(md5_engine_);
     }
 
     void AssetCache::InitDiskCaching()
@@ -95,9 +93,7 @@ namespace Asset
                 removed_files++;
                 removed_bytes += file_size;
 
-                std::set<std::string>::iterator find_result = disk_cache_contents_.find(native_absolute_path.toStdString());
-                if (find_result != disk_cache_contents_.end())
-                    disk_cache_contents_.erase(find_result);
+                RemoveDiskCacheFile(native_absolute_path.toStdString());
             }
 
             // Notify user
@@ -149,9 +145,7 @@ namespace Asset
                 removed_bytes += file_size;
                 current_size -= file_size;
 
-                std::set<std::string>::iterator find_result = disk_cache_contents_.find(native_absolute_path.toStdString());
-                if (find_result != disk_cache_contents_.end())
-                    disk_cache_contents_.erase(find_result);
+                RemoveDiskCacheFile(native_absolute_path.toStdString());
 
                 if (current_size < aimed_size)
                     break;
@@ -172,7 +166,7 @@ namespace Asset
             {
                 if (boost::filesystem::is_regular_file(i->status()))
                 {
-                    disk_cache_contents_.insert(i->path().native_directory_string());
+                    AddDiskCacheFile(i->path().native_directory_string());
                 }
                 ++i;
             }
@@ -217,18 +211,13 @@ namespace Asset
         while ((total_size > memory_cache_size_) && (deletes < CACHE_MAX_DELETES) && (oldest_assets.size()))
         {
             RexAsset* asset = *oldest_assets.begin();
-            AssetMap::iterator i = assets_.begin();
-            while (i != assets_.end())
+            AssetMap::iterator i = assets_.find(Foundation::AssetKey(asset->GetId()));
+            if (i != assets_.end() && i->second.get() == asset)
             {
-                if (i->second.get() == asset)
-                {
-                    total_size -= asset->GetSize();
-                    AssetModule::LogDebug("Removed cached asset " + asset->GetId() + " age " + ToString<Real>(asset->GetAge()));
-                    assets_.erase(i);
-                    oldest_assets.erase(oldest_assets.begin());
-                    break;
-                }
-                ++i;
+                total_size -= asset->GetSize();
+                MODULE_LOG_DEBUG(AssetModule, "Removed cached asset " + asset->GetId() + " age " + ToString<Real>(asset->GetAge()));
+                assets_.erase(i);
+                oldest_assets.erase(oldest_assets.begin());
             }
             
             ++deletes;
@@ -247,34 +236,31 @@ namespace Asset
     {
         if (check_memory)
         {
-            AssetMap::iterator i = assets_.begin();
-            while (i != assets_.end())
+            AssetMap::iterator i = assets_.find(Foundation::AssetKey(asset_id));
+            if ((i != assets_.end()) && (asset_type.empty() || (i->second->GetType() == asset_type)))
             {
-                Foundation::AssetPtr asset = i->second;
-                if ((asset->GetId() == asset_id) && (asset_type.empty() || (asset->GetType() == asset_type)))
-                {
-                    RexAsset* asset = dynamic_cast<RexAsset*>(i->second.get());
-                    if (asset)
-                        asset->ResetAge();
-                    return i->second;
-                }
-                ++i;
+                RexAsset* asset = dynamic_cast<RexAsset*>(i->second.get());
+                if (asset)
+                    asset->ResetAge();
+                return i->second;
             }
         }
         
-        std::string asset_hash = GetHash(asset_id);
-        
         if (check_disk)
         {
-            std::set<std::string>::iterator i = disk_cache_contents_.begin();
-            while (i != disk_cache_contents_.end())
+            DiskCacheMap::iterator files = disk_cache_contents_.find(GetDiskKey(asset_id));
+            if (files == disk_cache_contents_.end())
+                return Foundation::AssetPtr();
+
+            StringVector::iterator i = files->second.begin();
+            while (i != files->second.end())
             {
-                if ((i->find(asset_hash) != std::string::npos) && (asset_type.empty() || i->find(asset_type) != std::string::npos))
+                if (asset_type.empty() || i->find(asset_type) != std::string::npos)
                     break;
                 ++i;
             }
             
-            if (i != disk_cache_contents_.end())
+            if (i != files->second.end())
             {
                 boost::filesystem::path file_path(*i);
                 std::ifstream filestr(file_path.native_directory_string().c_str(), std::ios::in | std::ios::binary);
@@ -288,27 +274,28 @@ namespace Asset
                     StringVector assetNameType = SplitString(*i, '.');
                     if (assetNameType.size() < 2)
                     {
-                        AssetModule::LogDebug("Malformed assetcache filename " + *i);
+                        MODULE_LOG_DEBUG(AssetModule, "Malformed assetcache filename " + *i);
                         filestr.close();
-                        disk_cache_contents_.erase(i);
+                        files->second.erase(i);
                         return Foundation::AssetPtr();
                     }
                     
                     std::string type = assetNameType[assetNameType.size() - 1];
 
                     RexAsset* new_asset = new RexAsset(asset_id, type);
-                    assets_[asset_id] = Foundation::AssetPtr(new_asset);
+                    Foundation::AssetPtr asset(new_asset);
+                    assets_[Foundation::AssetKey(asset_id)] = asset;
                 
                     RexAsset::AssetDataVector& data = new_asset->GetDataInternal();
                     data.resize(length);
                     filestr.read((char *)&data[0], length);
                     filestr.close();
-                    return assets_[asset_id];
+                    return asset;
                 }
                 else
                 {
                     // File got deleted by someone else while program was running, or something, do not re-check
-                    disk_cache_contents_.erase(i);
+                    files->second.erase(i);
                 }
             }
         }
@@ -320,14 +307,14 @@ namespace Asset
     void AssetCache::StoreAsset(Foundation::AssetPtr asset)
     {
         const std::string& asset_id = asset->GetId();
-        AssetModule::LogDebug("Storing complete asset " + asset_id);
+        MODULE_LOG_DEBUG(AssetModule, "Storing complete asset " + asset_id);
 
         // Store to memory cache
-        assets_[asset_id] = asset;
+        assets_[Foundation::AssetKey(asset_id)] = asset;
 
         // Store to disk cache
         const std::string& type = asset->GetType();
-        boost::filesystem::path file_path(cache_path_ + "/" + GetHash(asset_id) + "." + type);
+        boost::filesystem::path file_path(cache_path_ + "/" + GetDiskKey(asset_id).ToHexString() + "." + type);
         std::ofstream filestr(file_path.native_directory_string().c_str(), std::ios::out | std::ios::binary);
         if (filestr.good())
         {
@@ -337,7 +324,7 @@ namespace Asset
             filestr.write((const char *)&data[0], size);
             filestr.close();
 
-            disk_cache_contents_.insert(file_path.native_directory_string());
+            AddDiskCacheFile(file_path.native_directory_string());
         }
         else
         {
@@ -351,41 +338,71 @@ namespace Asset
 
         // Delete from disk cache
         const std::string& type = asset->GetType();
-        boost::filesystem::path file_path(cache_path_ + "/" + GetHash(asset_id)  + "." + type);
+        boost::filesystem::path file_path(cache_path_ + "/" + GetDiskKey(asset_id).ToHexString() + "." + type);
         if (boost::filesystem::exists(file_path))
         {
             if (boost::filesystem::remove(file_path))
             {
-                AssetModule::LogDebug("Removed asset " + asset_id + " from cache");
+                MODULE_LOG_DEBUG(AssetModule, "Removed asset " + asset_id + " from cache");
 
-                std::set<std::string>::iterator find_result = disk_cache_contents_.find(file_path.native_directory_string());
-                if (find_result != disk_cache_contents_.end())
-                    disk_cache_contents_.erase(find_result);
+                RemoveDiskCacheFile(file_path.native_directory_string());
 
-                assets_.erase(asset_id);
+                assets_.erase(Foundation::AssetKey(asset_id));
                 disk_changes_after_last_check_ = true;
 
                 return true;
             }
             else
             {
-                AssetModule::LogDebug("Could not removed asset " + asset_id + " from cache");
+                MODULE_LOG_DEBUG(AssetModule, "Could not removed asset " + asset_id + " from cache");
                 return false;
             }
         }
         else
         {
-            AssetModule::LogDebug("File " + file_path.string() + " does not exist, could not delete from cache.");
+            MODULE_LOG_DEBUG(AssetModule, "File " + file_path.string() + " does not exist, could not delete from cache.");
             return true;
         }
     }
 
-    std::string AssetCache::GetHash(const std::string &asset_id)
+    Foundation::AssetKey AssetCache::GetDiskKey(const std::string &asset_id)
+    {
+        QByteArray digest = QCryptographicHash::hash(QByteArray::fromRawData(asset_id.c_str(), asset_id.size()),
+            QCryptographicHash::Md5);
+        return Foundation::AssetKey::FromBytes((const u8*)digest.constData());
+    }
+
+    //! Returns the disk key part of a cache file path, the hex digest before the type extension
+    static std::string GetDiskKeyString(const std::string& path)
     {
-        QCryptographicHash md5_engine_(QCryptographicHash::Md5);
-        md5_engine_.addData(asset_id.c_str(), asset_id.size());
-        QString md5_hash(md5_engine_.result().toHex());
-        md5_engine_.reset();
-        return md5_hash.toStdString();
+        std::string filename = boost::filesystem::path(path).filename();
+        return filename.substr(0, filename.find('.'));
+    }
+
+    void AssetCache::AddDiskCacheFile(const std::string& path)
+    {
+        std::string key_string = GetDiskKeyString(path);
+        // Files not named by a digest can never be looked up
+        if (key_string.length() != Foundation::AssetKey::cSizeBytes * 2 || !Foundation::AssetKey::IsUuid(key_string))
+            return;
+
+        StringVector& files = disk_cache_contents_[Foundation::AssetKey(key_string)];
+        if (std::find(files.begin(), files.end(), path) == files.end())
+            files.push_back(path);
+    }
+
+    void AssetCache::RemoveDiskCacheFile(const std::string& path)
+    {
+        std::string key_string = GetDiskKeyString(path);
+        if (key_string.length() != Foundation::AssetKey::cSizeBytes * 2 || !Foundation::AssetKey::IsUuid(key_string))
+            return;
+
+        DiskCacheMap::iterator i = disk_cache_contents_.find(Foundation::AssetKey(key_string));
+        if (i == disk_cache_contents_.end())
+            return;
+
+        i->second.erase(std::remove(i->second.begin(), i->second.end(), path), i->second.end());
+        if (i->second.empty())
+            disk_cache_contents_.erase(i);
     }
 }
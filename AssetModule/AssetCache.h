@@ -3,14 +3,15 @@
 #ifndef incl_Asset_AssetCache_h
 #define incl_Asset_AssetCache_h
 
-class QCryptographicHash;
-
 #include "Foundation.h"
 #include "AssetInterface.h"
+#include "AssetKey.h"
 
 #include <QObject>
 #include <QDir>
 
+#include <boost/unordered_map.hpp>
+
 namespace Asset
 {
     //! Stores assets to memory and/or disk based cache. Created and used by AssetManager.
@@ -20,7 +21,7 @@ namespace Asset
     Q_OBJECT
 
     public:
-        typedef std::map<std::string, Foundation::AssetPtr> AssetMap;
+        typedef boost::unordered_map<Foundation::AssetKey, Foundation::AssetPtr> AssetMap;
 
         //! Constructor
         /*! \param framework Framework
@@ -68,9 +69,14 @@ namespace Asset
          */
         void CheckDiskCache(const std::string& path);
 
-        //! Calculates hash from given asset id
-        //! Used for file name generation
-        std::string GetHash(const std::string &asset_id);
+        //! Returns the MD5 digest of an asset id, which names its files in the disk cache
+        static Foundation::AssetKey GetDiskKey(const std::string &asset_id);
+
+        //! Adds a file to the known disk cache contents
+        void AddDiskCacheFile(const std::string& path);
+
+        //! Removes a file from the known disk cache contents
+        void RemoveDiskCacheFile(const std::string& path);
 
         //! Asset memory cache
         AssetMap assets_;
@@ -84,16 +90,13 @@ namespace Asset
         //! Update time accumulator
         f64 update_time_;
 
-        //! Assets known to be in disk cache
-        //! Values are hash values from asset id's
-        std::set<std::string> disk_cache_contents_;
+        //! Paths of the files known to be in disk cache, one per asset type, by the MD5 digest of the asset id
+        typedef boost::unordered_map<Foundation::AssetKey, StringVector> DiskCacheMap;
+        DiskCacheMap disk_cache_contents_;
 
         //! Framework
         Foundation::Framework* framework_;
 
-        //! MD5 Engine
-        QCryptographicHash *md5_engine_;
-
         QDir cache_dir_;
         int disk_cache_max_size_;
         bool disk_changes_after_last_check_;
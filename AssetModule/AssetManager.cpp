@@ -13,7 +13,10 @@ using namespace RexTypes;
 namespace Asset
 {
     AssetManager::AssetManager(Foundation::Framework* framework) : 
-        framework_(framework)
+        framework_(framework),
+        memory_hits_(0),
+        disk_hits_(0),
+        misses_(0)
     {
         Foundation::EventManagerPtr event_manager = framework_->GetEventManager();
         
@@ -198,21 +201,48 @@ namespace Asset
         // First check memory cache
         Foundation::AssetPtr asset = cache_->GetAsset(asset_id, true, false, asset_type);
         if (asset)
+        {
+            ++memory_hits_;
             return asset;
+        }
 
         // If transfer in progress in any of the providers, do not check disk cache again
         AssetProviderVector::iterator i = providers_.begin();
         while (i != providers_.end())
         {
             if ((*i)->InProgress(asset_id))
+            {
+                ++misses_;
                 return Foundation::AssetPtr();
+            }
             ++i;
         } 
             
         // Last check disk cache
         asset = cache_->GetAsset(asset_id, false, true, asset_type);
+        if (asset)
+            ++disk_hits_;
+        else
+            ++misses_;
         return asset;
     }
+
+    void AssetManager::CollectMetrics(Foundation::MetricValues& values)
+    {
+        values.push_back(std::make_pair("memory_hits", (f64)memory_hits_));
+        values.push_back(std::make_pair("disk_hits", (f64)disk_hits_));
+        values.push_back(std::make_pair("misses", (f64)misses_));
+
+        uint lookups = memory_hits_ + disk_hits_ + misses_;
+        values.push_back(std::make_pair("hit_rate", lookups ? (f64)(memory_hits_ + disk_hits_) / lookups : 0.0));
+
+        uint memory_size = 0;
+        const AssetCache::AssetMap& assets = cache_->GetAssets();
+        for(AssetCache::AssetMap::const_iterator i = assets.begin(); i != assets.end(); ++i)
+            memory_size += i->second->GetSize();
+        values.push_back(std::make_pair("memory_assets", (f64)assets.size()));
+        values.push_back(std::make_pair("memory_bytes", (f64)memory_size));
+    }
     
     Foundation::AssetCacheInfoMap AssetManager::GetAssetCacheInfo()
     {
@@ -238,7 +268,7 @@ namespace Asset
             return false;
 
         const AssetCache::AssetMap& assets = cache_->GetAssets();
-        AssetCache::AssetMap::const_iterator found_item = assets.find(asset_id);
+        AssetCache::AssetMap::const_iterator found_item = assets.find(Foundation::AssetKey(asset_id));
         if (found_item != assets.end())
             return cache_->DeleteAsset(found_item->second);
         return false;
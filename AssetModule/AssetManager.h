@@ -7,6 +7,7 @@
 #include "AssetServiceInterface.h"
 #include "AssetProviderInterface.h"
 #include "RexUUID.h"
+#include "MetricsExporter.h"
 
 namespace Foundation
 {
@@ -106,6 +107,11 @@ namespace Asset
             \param frametime Seconds since last frame
          */
         void Update(f64 frametime);
+
+        //! Adds the cache lookup totals and the memory cache size to a metrics sample
+        /*! \param values values of the sample
+         */
+        void CollectMetrics(Foundation::MetricValues& values);
         
     private:
         //! Gets new request tag
@@ -130,6 +136,15 @@ namespace Asset
         //! Asset providers
         typedef std::vector<Foundation::AssetProviderPtr> AssetProviderVector;
         AssetProviderVector providers_;
+
+        //! Cache lookups found in memory
+        uint memory_hits_;
+
+        //! Cache lookups found on disk
+        uint disk_hits_;
+
+        //! Cache lookups not found
+        uint misses_;
     };
 }
 
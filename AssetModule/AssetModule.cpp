@@ -15,11 +15,13 @@
 
 #include "Interfaces/ProtocolModuleInterface.h"
 
+#include <boost/bind.hpp>
+
 namespace Asset
 {
     std::string AssetModule::type_name_static_ = "Asset";
 
-    AssetModule::AssetModule() : ModuleInterface(type_name_static_), inboundcategory_id_(0)
+    AssetModule::AssetModule() : ModuleInterface(type_name_static_), inboundcategory_id_(0), metrics_source_(0)
     {
     }
 
@@ -37,6 +39,7 @@ namespace Asset
     {
         manager_ = AssetManagerPtr(new AssetManager(framework_));
         framework_->GetServiceManager()->RegisterService(Foundation::Service::ST_Asset, manager_);
+        metrics_source_ = framework_->GetMetricsExporter()->RegisterSource("assetcache", boost::bind(&AssetManager::CollectMetrics, manager_.get(), _1));
 
         // Add XMLRPC asset provider before http asset provider, so it will take requests it recognizes though both use http
         xmlrpc_asset_provider_ = Foundation::AssetProviderPtr(new XMLRPCAssetProvider(framework_));
@@ -93,6 +96,8 @@ namespace Asset
         manager_->UnregisterAssetProvider(xmlrpc_asset_provider_);
         manager_->UnregisterAssetProvider(http_asset_provider_);
 
+        framework_->GetMetricsExporter()->UnregisterSource(metrics_source_);
+        metrics_source_ = 0;
         framework_->GetServiceManager()->UnregisterService(manager_);
         manager_.reset();
     }
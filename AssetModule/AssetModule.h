@@ -9,6 +9,7 @@
 #include "ConsoleCommandServiceInterface.h"
 #include "AssetProviderInterface.h"
 #include "AssetModuleApi.h"
+#include "MetricsExporter.h"
 
 namespace Foundation
 {
@@ -75,6 +76,9 @@ namespace Asset
         //! asset manager
         AssetManagerPtr manager_;
 
+        //! id of the asset cache metrics source
+        Foundation::metric_source_id_t metrics_source_;
+
         //! category id for incoming messages
         event_category_id_t inboundcategory_id_;
 
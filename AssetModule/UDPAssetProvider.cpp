@@ -86,15 +86,9 @@ namespace Asset
 
         if ((transfer) && (transfer->GetReceivedContinuous() >= received))
         {
-            // Make new temporary asset for the incomplete data
-            RexAsset* new_asset = new RexAsset(transfer->GetAssetId(), GetTypeNameFromAssetType(transfer->GetAssetType()));
-            Foundation::AssetPtr asset_ptr(new_asset);
-            
-            RexAsset::AssetDataVector& data = new_asset->GetDataInternal();
-            data.resize(transfer->GetReceivedContinuous());
-            transfer->AssembleData(&data[0]);
-
-            return asset_ptr;
+            // Make new temporary asset that refers to the continuous data of the transfer buffer, without copying it
+            return Foundation::AssetPtr(new UDPIncompleteAsset(transfer->GetAssetId(), GetTypeNameFromAssetType(transfer->GetAssetType()),
+                transfer->GetBuffer(), transfer->GetReceivedContinuous()));
         }
 
         return Foundation::AssetPtr();
@@ -278,8 +272,7 @@ namespace Asset
         const RexUUID& asset_id, const RequestTagVector& tags)
     {
         // If request already exists, just append the new tag(s)
-        std::string asset_id_str = asset_id.ToString();
-        UDPAssetTransfer* transfer = GetTransfer(asset_id_str);
+        UDPAssetTransfer* transfer = GetTransfer(asset_id);
         if (transfer)
         {
             transfer->InsertTags(tags);
@@ -294,7 +287,7 @@ namespace Asset
         new_transfer.InsertTags(tags);
         texture_transfers_[asset_id] = new_transfer;
 
-        AssetModule::LogDebug("Requesting texture " + asset_id.ToString());
+        MODULE_LOG_DEBUG(AssetModule, "Requesting texture " + asset_id.ToString());
 
         ProtocolUtilities::NetOutMessage *m = net->StartMessageBuilding(RexNetMsgRequestImage);
         assert(m);
@@ -316,8 +309,7 @@ namespace Asset
         const RexUUID& asset_id, uint asset_type, const RequestTagVector& tags)
     {
         // If request already exists, just append the new tag(s)
-        std::string asset_id_str = asset_id.ToString();
-        UDPAssetTransfer* transfer = GetTransfer(asset_id_str);
+        UDPAssetTransfer* transfer = GetTransfer(asset_id);
         if (transfer)
         {
             transfer->InsertTags(tags);
@@ -327,13 +319,14 @@ namespace Asset
         RexUUID transfer_id;
         transfer_id.Random();
 
+        std::string asset_id_str = asset_id.ToString();
         UDPAssetTransfer new_transfer;
         new_transfer.SetAssetId(asset_id_str);
         new_transfer.SetAssetType(asset_type);
         new_transfer.InsertTags(tags);
         asset_transfers_[transfer_id] = new_transfer;
 
-        AssetModule::LogDebug("Requesting asset " + asset_id_str);
+        MODULE_LOG_DEBUG(AssetModule, "Requesting asset " + asset_id_str);
 
         ProtocolUtilities::NetOutMessage *m = net->StartMessageBuilding(RexNetMsgTransferRequest);
         assert(m);
@@ -406,7 +399,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = texture_transfers_.find(asset_id);
         if (i == texture_transfers_.end())
         {
-            AssetModule::LogDebug("Data received for nonexisting texture transfer " + asset_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Data received for nonexisting texture transfer " + asset_id.ToString());
             return;
         }
 
@@ -438,7 +431,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = texture_transfers_.find(asset_id);
         if (i == texture_transfers_.end())
         {
-            AssetModule::LogDebug("Data received for nonexisting texture transfer " + asset_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Data received for nonexisting texture transfer " + asset_id.ToString());
             return;
         }
 
@@ -466,7 +459,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = texture_transfers_.find(asset_id);
         if (i == texture_transfers_.end())
         {
-            AssetModule::LogDebug("Cancel received for nonexisting texture transfer " + asset_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Cancel received for nonexisting texture transfer " + asset_id.ToString());
             return;
         }
 
@@ -475,7 +468,7 @@ namespace Asset
         // Send transfer canceled event
         SendAssetCanceled(transfer);
 
-        AssetModule::LogDebug("Transfer of texture " + asset_id.ToString() + " canceled");
+        MODULE_LOG_DEBUG(AssetModule, "Transfer of texture " + asset_id.ToString() + " canceled");
         texture_transfers_.erase(i);
     }
 
@@ -485,7 +478,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = asset_transfers_.find(transfer_id);
         if (i == asset_transfers_.end())
         {
-            AssetModule::LogDebug("Data received for nonexisting asset transfer " + transfer_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Data received for nonexisting asset transfer " + transfer_id.ToString());
             return;
         }
 
@@ -498,7 +491,7 @@ namespace Asset
 
         if ((status != RexTS_Ok) && (status != RexTS_Done))
         {
-            AssetModule::LogDebug("Transfer for asset " + transfer.GetAssetId() + " canceled with code " + ToString<s32>(status));
+            MODULE_LOG_DEBUG(AssetModule, "Transfer for asset " + transfer.GetAssetId() + " canceled with code " + ToString<s32>(status));
             asset_transfers_.erase(i);
             return;
         }
@@ -520,7 +513,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = asset_transfers_.find(transfer_id);
         if (i == asset_transfers_.end())
         {
-            AssetModule::LogDebug("Data received for nonexisting asset transfer " + transfer_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Data received for nonexisting asset transfer " + transfer_id.ToString());
             return;
         }
 
@@ -532,7 +525,7 @@ namespace Asset
 
         if ((status != RexTS_Ok) && (status != RexTS_Done))
         {
-            AssetModule::LogDebug("Transfer for asset " + transfer.GetAssetId() + " canceled with code " + ToString<s32>(status));
+            MODULE_LOG_DEBUG(AssetModule, "Transfer for asset " + transfer.GetAssetId() + " canceled with code " + ToString<s32>(status));
 
             // Send transfer canceled event
             SendAssetCanceled(transfer);
@@ -561,7 +554,7 @@ namespace Asset
         UDPAssetTransferMap::iterator i = asset_transfers_.find(transfer_id);
         if (i == asset_transfers_.end())
         {
-            AssetModule::LogDebug("Cancel received for nonexisting asset transfer " + transfer_id.ToString());
+            MODULE_LOG_DEBUG(AssetModule, "Cancel received for nonexisting asset transfer " + transfer_id.ToString());
             return;
         }
         
@@ -570,7 +563,7 @@ namespace Asset
         // Send transfer canceled event
         SendAssetCanceled(transfer);
 
-        AssetModule::LogDebug("Transfer for asset " + transfer.GetAssetId() + " canceled");
+        MODULE_LOG_DEBUG(AssetModule, "Transfer for asset " + transfer.GetAssetId() + " canceled");
         asset_transfers_.erase(i);
     }
 
@@ -591,16 +584,25 @@ namespace Asset
 
     UDPAssetTransfer* UDPAssetProvider::GetTransfer(const std::string& asset_id)
     {
-        RexUUID asset_uuid(asset_id);
+        // Only UUID ids can be UDP transfers
+        if (!Foundation::AssetKey::IsUuid(asset_id))
+            return 0;
+
+        return GetTransfer(RexUUID(asset_id));
+    }
 
-        UDPAssetTransferMap::iterator i = texture_transfers_.find(asset_uuid);
+    UDPAssetTransfer* UDPAssetProvider::GetTransfer(const RexUUID& asset_id)
+    {
+        UDPAssetTransferMap::iterator i = texture_transfers_.find(asset_id);
         if (i != texture_transfers_.end())
             return &i->second;
 
+        // Other assets are mapped by transfer id, compare the 16-byte keys
+        Foundation::AssetKey asset_key = Foundation::AssetKey::FromBytes(asset_id.data);
         UDPAssetTransferMap::iterator j = asset_transfers_.begin();
         while (j != asset_transfers_.end())
         {
-            if (j->second.GetAssetId() == asset_id)
+            if (j->second.GetAssetKey() == asset_key)
                 return &j->second;
             ++j;
         }
@@ -620,8 +622,7 @@ namespace Asset
 
             Foundation::AssetPtr new_asset = Foundation::AssetPtr(new RexAsset(asset_id, GetTypeNameFromAssetType(transfer.GetAssetType())));
             RexAsset::AssetDataVector& data = checked_static_cast<RexAsset*>(new_asset.get())->GetDataInternal();
-            data.resize(transfer.GetReceived());
-            transfer.AssembleData(&data[0]);
+            transfer.TakeData(data);
 
             asset_service->StoreAsset(new_asset);
 
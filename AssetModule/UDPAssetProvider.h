@@ -152,6 +152,12 @@ namespace Asset
          */
         UDPAssetTransfer* GetTransfer(const std::string& asset_id);
 
+        //! Gets asset transfer if it's in progress
+        /*! \param asset_id Asset UUID
+            \return Pointer to transfer, or 0 if no transfer
+         */
+        UDPAssetTransfer* GetTransfer(const RexUUID& asset_id);
+
         //! Requests a texture from network
         /*! \param net Connected network interface
             \param asset_id Asset UUID
@@ -7,6 +7,11 @@ namespace Asset
     UDPAssetTransfer::UDPAssetTransfer() :
         size_(0),
         received_(0),
+        received_continuous_(0),
+        next_packet_(0),
+        first_packet_size_(0),
+        packet_size_(0),
+        data_(new std::vector<u8>()),
         time_(0.0)
     {
     }
@@ -23,26 +28,10 @@ namespace Asset
         return received_ >= size_;
     }
     
-    uint UDPAssetTransfer::GetReceivedContinuous() const
+    void UDPAssetTransfer::SetSize(uint size)
     {
-        uint size = 0;
-        
-        DataPacketMap::const_iterator i = data_packets_.begin();
-        
-        uint expected_index = 0;
-      
-        while (i != data_packets_.end())
-        {
-            if (i->first != expected_index)
-                break;
-            
-            size += i->second.size();
-            
-            ++expected_index;
-            ++i;
-        }
-        
-        return size;
+        size_ = size;
+        EnsureCapacity(size);
     }
     
     void UDPAssetTransfer::ReceiveData(uint packet_index, const u8* data, uint size)
@@ -55,34 +44,158 @@ namespace Asset
             return;
         }
         
-        if (!data_packets_[packet_index].size())
+        if (IsReceived(packet_index))
         {
-            data_packets_[packet_index].resize(size);
-            memcpy(&data_packets_[packet_index][0], data, size);
-            received_ += size;
+            AssetModule::LogDebug("Already received asset data packet index " + ToString<uint>(packet_index));
+            return;
         }
-        else
+
+        received_ += size;
+
+        // Common case: packet continues the data received so far
+        if (packet_index == next_packet_)
         {
-            AssetModule::LogDebug("Already received asset data packet index " + ToString<uint>(packet_index));
+            LearnPacketSize(packet_index, size);
+            WritePacket(packet_index, received_continuous_, data, size);
+            received_continuous_ += size;
+            ++next_packet_;
+            AdvanceContinuous();
+            return;
         }
+
+        // Out of order packet: write directly to its offset if it is known, else hold until the predecessors arrive
+        uint offset;
+        if ((GetPacketOffset(packet_index, offset)) && ((size == packet_size_) || ((size_) && (offset + size == size_))))
+            WritePacket(packet_index, offset, data, size);
+        else
+            pending_packets_[packet_index].assign(data, data + size);
     }
     
-    void UDPAssetTransfer::AssembleData(u8* buffer) const
+    void UDPAssetTransfer::TakeData(std::vector<u8>& dest)
     {
-        DataPacketMap::const_iterator i = data_packets_.begin();
-        
-        uint expected_index = 0;
+        if (data_.unique())
+        {
+            dest.swap(*data_);
+            dest.resize(received_continuous_);
+        }
+        else
+        {
+            const std::vector<u8>& data = *data_;
+            dest.assign(data.begin(), data.begin() + received_continuous_);
+        }
       
-        while (i != data_packets_.end())
+        data_.reset(new std::vector<u8>());
+        written_packets_.clear();
+        pending_packets_.clear();
+        received_ = 0;
+        received_continuous_ = 0;
+        next_packet_ = 0;
+    }
+
+    bool UDPAssetTransfer::IsReceived(uint packet_index) const
+    {
+        if ((packet_index < written_packets_.size()) && (written_packets_[packet_index]))
+            return true;
+
+        return pending_packets_.find(packet_index) != pending_packets_.end();
+    }
+
+    bool UDPAssetTransfer::GetPacketOffset(uint packet_index, uint& offset) const
+    {
+        if (packet_index == 0)
         {
-            if (i->first != expected_index)
+            offset = 0;
+            return true;
+        }
+
+        if ((!first_packet_size_) || (!packet_size_))
+            return false;
+
+        offset = first_packet_size_ + (packet_index - 1) * packet_size_;
+        return true;
+    }
+
+    void UDPAssetTransfer::LearnPacketSize(uint packet_index, uint size)
+    {
+        if (packet_index == 0)
+        {
+            first_packet_size_ = size;
+            return;
+        }
+
+        if (packet_size_)
+            return;
+
+        // All packets after the first are the same size, except the last. Learn the size once we know this is not the last
+        bool last = (!size_) || (received_continuous_ + size >= size_);
+        if ((last) && (!pending_packets_.empty()) && (pending_packets_.rbegin()->first > packet_index))
+            last = false;
+        if (!last)
+            packet_size_ = size;
+    }
+
+    uint UDPAssetTransfer::GetWrittenPacketSize(uint packet_index, uint offset) const
+    {
+        if (packet_index == 0)
+            return first_packet_size_;
+
+        // Only the last packet may be shorter
+        if ((size_) && (offset + packet_size_ > size_))
+            return size_ - offset;
+
+        return packet_size_;
+    }
+
+    void UDPAssetTransfer::WritePacket(uint packet_index, uint offset, const u8* data, uint size)
+    {
+        EnsureCapacity(offset + size);
+        memcpy(&(*data_)[offset], data, size);
+
+        if (packet_index >= written_packets_.size())
+            written_packets_.resize(packet_index + 1, false);
+        written_packets_[packet_index] = true;
+    }
+
+    void UDPAssetTransfer::EnsureCapacity(uint size)
+    {
+        std::vector<u8>& data = *data_;
+        if (data.size() >= size)
+            return;
+
+        if (data_.unique())
+        {
+            data.resize(size);
+            return;
+        }
+
+        // Incomplete assets still refer to the old buffer, so do not reallocate it under them
+        UDPAssetBufferPtr new_data(new std::vector<u8>(size));
+        if (!data.empty())
+            memcpy(&(*new_data)[0], &data[0], data.size());
+        data_ = new_data;
+    }
+
+    void UDPAssetTransfer::AdvanceContinuous()
+    {
+        for (;;)
+        {
+            if ((next_packet_ < written_packets_.size()) && (written_packets_[next_packet_]))
+            {
+                received_continuous_ += GetWrittenPacketSize(next_packet_, received_continuous_);
+                ++next_packet_;
+                continue;
+            }
+
+            DataPacketMap::iterator i = pending_packets_.find(next_packet_);
+            if (i == pending_packets_.end())
                 break;
             
-            memcpy(buffer, &i->second[0], i->second.size());
-            buffer += i->second.size();
-            
-            ++expected_index;
-            ++i;
+            const std::vector<u8>& packet = i->second;
+            LearnPacketSize(next_packet_, packet.size());
+            WritePacket(next_packet_, received_continuous_, &packet[0], packet.size());
+            received_continuous_ += packet.size();
+            ++next_packet_;
+            pending_packets_.erase(i);
         }
     }
 }
\ No newline at end of file
@@ -4,9 +4,21 @@
 #define incl_Asset_UDPAssetTransfer_h
 
 #include "CoreTypes.h"
+#include "AssetInterface.h"
+#include "AssetKey.h"
+#include "RexAssetMetadata.h"
+
 namespace Asset
 {
+    //! Shared data buffer of an UDP asset transfer
+    typedef boost::shared_ptr<std::vector<u8> > UDPAssetBufferPtr;
+
     //! Stores data related to an UDP asset transfer that is in progress. Not necessary to clients of the AssetModule.
+    /*! Asset data is written directly into one buffer, which is preallocated to the final size as soon as the size is known.
+        Packets are placed to their offset as they arrive; which packets have been received is tracked with a bitmap.
+        Only packets whose offset cannot be determined yet (out-of-order packets before the packet size has been seen)
+        are held separately until their predecessors arrive.
+     */
     class UDPAssetTransfer
     {
     public:
@@ -23,17 +35,22 @@ namespace Asset
          */
         void ReceiveData(uint packet_index, const u8* data, uint size);
         
-        //! Assembles continuous asset data to a buffer
-        /*! Call GetReceivedContinuous() (or GetReceived() if you know the transfer is complete)
-            first to know how big the buffer must be
-            \param buffer Pointer to buffer that will receive data
+        //! Returns the shared data buffer
+        /*! Bytes of the continuous part never change once received, so the buffer can be handed to other threads
+            for reading that part while the transfer is still in progress.
          */
-        void AssembleData(u8* buffer) const;
-        
+        UDPAssetBufferPtr GetBuffer() const { return data_; }
+
+        //! Moves the received data into a vector, leaving the transfer empty
+        /*! Copies only if the buffer is still shared with an incomplete asset.
+            \param dest Vector that will receive the data. Resized to the continuous received size
+         */
+        void TakeData(std::vector<u8>& dest);
+
         //! Sets asset ID
         /*! \param asset_id Asset id
          */
-        void SetAssetId(const std::string& asset_id) { asset_id_ = asset_id; }
+        void SetAssetId(const std::string& asset_id) { asset_id_ = asset_id; asset_key_ = Foundation::AssetKey(asset_id); }
         
         //! Sets asset type
         /*! \param asset_type Asset type
@@ -41,10 +58,10 @@ namespace Asset
         void SetAssetType(uint asset_type) { asset_type_ = asset_type; }
         
         //! Sets asset size
-        /*! Called when asset transfer header received
+        /*! Called when asset transfer header received. Preallocates the data buffer.
             \param size Asset size in bytes
          */
-        void SetSize(uint size) { size_ = size; }
+        void SetSize(uint size);
         
         //! Adds elapsed time
         /*! \param delta_time Amount of time to add
@@ -68,6 +85,9 @@ namespace Asset
                           
         //! Returns asset ID
         const std::string& GetAssetId() const { return asset_id_; }
+
+        //! Returns key of asset ID
+        const Foundation::AssetKey& GetAssetKey() const { return asset_key_; }
         
         //! Returns asset type
         uint GetAssetType() const { return asset_type_; }
@@ -79,7 +99,7 @@ namespace Asset
         uint GetReceived() const { return received_; }
         
         //! Returns total size of continuous data from the asset beginning received so far
-        uint GetReceivedContinuous() const;
+        uint GetReceivedContinuous() const { return received_continuous_; }
         
         //! Returns elapsed time since last packet
         f64 GetTime() const { return time_; }
@@ -89,9 +109,35 @@ namespace Asset
         
     private:
         typedef std::map<uint, std::vector<u8> > DataPacketMap;
+
+        //! Returns whether packet has been received (written to buffer or held as pending)
+        bool IsReceived(uint packet_index) const;
+
+        //! Returns byte offset of a packet, if it can be determined
+        bool GetPacketOffset(uint packet_index, uint& offset) const;
+
+        //! Records packet sizes from a packet that continues the data received so far
+        void LearnPacketSize(uint packet_index, uint size);
+
+        //! Returns size of an already written packet
+        uint GetWrittenPacketSize(uint packet_index, uint offset) const;
+
+        //! Writes packet data to the buffer and marks the packet received
+        void WritePacket(uint packet_index, uint offset, const u8* data, uint size);
+
+        //! Makes sure the buffer is at least the given size
+        /*! If the buffer is shared with an incomplete asset, a new buffer is allocated instead of resizing in place
+         */
+        void EnsureCapacity(uint size);
+
+        //! Advances the continuous data counter over received packets, and writes held packets that became continuous
+        void AdvanceContinuous();
         
         //! Asset ID
         std::string asset_id_;
+
+        //! Key of asset ID, for finding the transfer
+        Foundation::AssetKey asset_key_;
         
         //! Asset type
         uint asset_type_;
@@ -102,8 +148,26 @@ namespace Asset
         //! Received bytes
         uint received_;
         
-        //! Map of data packets
-        DataPacketMap data_packets_;
+        //! Received continuous bytes from the asset beginning
+        uint received_continuous_;
+
+        //! Index of first packet not yet part of the continuous data
+        uint next_packet_;
+
+        //! Size of the first packet, 0 if not known yet
+        uint first_packet_size_;
+
+        //! Size of the following packets (except the last), 0 if not known yet
+        uint packet_size_;
+
+        //! Asset data buffer
+        UDPAssetBufferPtr data_;
+
+        //! Bitmap of packets written to the buffer
+        std::vector<bool> written_packets_;
+
+        //! Packets whose offset was not yet known on arrival
+        DataPacketMap pending_packets_;
         
         //! Elapsed time since last packet
         f64 time_;
@@ -111,6 +175,59 @@ namespace Asset
         //! List of request tags associated with this transfer
         RequestTagVector tags_;
     };
+
+    //! Incomplete asset that refers to the continuous data of an UDP asset transfer in progress, without copying it
+    class UDPIncompleteAsset : public Foundation::AssetInterface
+    {
+    public:
+        //! Constructor
+        /*! \param asset_id Asset id
+            \param asset_type Asset type
+            \param data Transfer data buffer
+            \param size Size of continuous data in the buffer
+         */
+        UDPIncompleteAsset(const std::string& asset_id, const std::string& asset_type, UDPAssetBufferPtr data, uint size) :
+            asset_id_(asset_id),
+            asset_type_(asset_type),
+            data_(data),
+            size_(size)
+        {
+        }
+
+        //! Destructor
+        virtual ~UDPIncompleteAsset() {}
+
+        //! returns asset ID
+        virtual const std::string& GetId() const { return asset_id_; }
+
+        //! returns asset type
+        virtual const std::string& GetType() const { return asset_type_; }
+
+        //! returns asset data size
+        virtual uint GetSize() const { return size_; }
+
+        //! returns asset data
+        virtual const u8* GetData() const { return size_ ? &(*data_)[0] : 0; }
+
+        //! returns asset metadata
+        virtual Foundation::AssetMetadataInterface* GetMetadata() const { return (Foundation::AssetMetadataInterface*)&metadata_; }
+
+    private:
+        //! asset id
+        std::string asset_id_;
+
+        //! asset type
+        std::string asset_type_;
+
+        //! shared transfer buffer
+        UDPAssetBufferPtr data_;
+
+        //! size of continuous data
+        uint size_;
+
+        //! asset metadata
+        RexAssetMetadata metadata_;
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_CoreAtomic_h
+#define incl_CoreAtomic_h
+
+#if defined(_WINDOWS)
+#include <windows.h>
+#endif
+
+//! Minimal atomic pointer and counter operations for lock-free queues
+/*! All operations act as full memory barriers, which is more than what lock-free single consumer queues need,
+    but keeps the implementation for each compiler trivial.
+ */
+namespace Core
+{
+    //! Atomically sets a pointer and returns the previous value
+    template <class T> inline T *AtomicExchangePointer(T * volatile *target, T *value)
+    {
+#if defined(_WINDOWS)
+        return static_cast<T *>(InterlockedExchangePointer((PVOID volatile *)target, value));
+#else
+        __sync_synchronize();
+        return __sync_lock_test_and_set(target, value);
+#endif
+    }
+
+    //! Reads a pointer written by another thread. Data written before the pointer was stored is visible after the read
+    template <class T> inline T *AtomicLoadPointer(T * volatile const *source)
+    {
+#if defined(_WINDOWS)
+        T *value = *source;
+        MemoryBarrier();
+        return value;
+#else
+        T *value = *source;
+        __sync_synchronize();
+        return value;
+#endif
+    }
+
+    //! Writes a pointer to be read by another thread. Data written before is visible to a thread that reads the pointer
+    template <class T> inline void AtomicStorePointer(T * volatile *target, T *value)
+    {
+#if defined(_WINDOWS)
+        MemoryBarrier();
+        *target = value;
+#else
+        __sync_synchronize();
+        *target = value;
+#endif
+    }
+
+    //! Atomically adds to a counter and returns the new value
+    inline long AtomicAdd(long volatile *target, long value)
+    {
+#if defined(_WINDOWS)
+        return InterlockedExchangeAdd(target, value) + value;
+#else
+        return __sync_add_and_fetch(target, value);
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_CoreSimd_h
+#define incl_CoreSimd_h
+
+//! SSE code paths of the float math types, on all x86 and x64 builds. Define CORE_NO_SIMD to use the scalar code.
+#if !defined(CORE_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CORE_SIMD_SSE
+#endif
+
+#ifdef CORE_SIMD_SSE
+
+#include <xmmintrin.h>
+
+//! Returns the shuffle of a and b with elements a[x], a[y], b[z], b[w]
+#define CORE_SIMD_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+//! Returns the swizzle of v with elements v[x], v[y], v[z], v[w]
+#define CORE_SIMD_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+
+//! Sets out to the product of two row-major 4x4 matrices, in the element order of CMatrix4::setbyproduct_nocheck
+/*! out may be the same as a or b.
+ */
+inline void SimdMatrixProduct(float *out, const float *a, const float *b)
+{
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+
+    __m128 rows[4];
+    for(int i = 0; i < 4; ++i)
+    {
+        // Row i of the result is the combination of the rows of a, weighted by row i of b
+        const __m128 b_row = _mm_loadu_ps(b + i * 4);
+        rows[i] = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(CORE_SIMD_SWIZZLE(b_row, 0, 0, 0, 0), a0), _mm_mul_ps(CORE_SIMD_SWIZZLE(b_row, 1, 1, 1, 1), a1)),
+            _mm_add_ps(_mm_mul_ps(CORE_SIMD_SWIZZLE(b_row, 2, 2, 2, 2), a2), _mm_mul_ps(CORE_SIMD_SWIZZLE(b_row, 3, 3, 3, 3), a3)));
+    }
+
+    for(int i = 0; i < 4; ++i)
+        _mm_storeu_ps(out + i * 4, rows[i]);
+}
+
+//! Returns the product of two 2x2 row-major matrices, stored in one register
+inline __m128 SimdMatrix2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, CORE_SIMD_SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(CORE_SIMD_SWIZZLE(a, 1, 0, 3, 2), CORE_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+//! Returns adj(a) * b of two 2x2 row-major matrices
+inline __m128 SimdMatrix2AdjMul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(CORE_SIMD_SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(CORE_SIMD_SWIZZLE(a, 1, 1, 2, 2), CORE_SIMD_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+//! Returns a * adj(b) of two 2x2 row-major matrices
+inline __m128 SimdMatrix2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, CORE_SIMD_SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(CORE_SIMD_SWIZZLE(a, 1, 0, 3, 2), CORE_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+//! Inverts a row-major 4x4 matrix by its 2x2 blocks
+/*! \param out inverse, may be the same as m
+    \param m matrix
+    \param tolerance max. absolute determinant of a matrix that has no inverse
+    \return false and leaves out unchanged if the matrix has no inverse
+ */
+inline bool SimdMatrixInverse(float *out, const float *m, float tolerance)
+{
+    const __m128 r0 = _mm_loadu_ps(m);
+    const __m128 r1 = _mm_loadu_ps(m + 4);
+    const __m128 r2 = _mm_loadu_ps(m + 8);
+    const __m128 r3 = _mm_loadu_ps(m + 12);
+
+    // The 2x2 blocks  | A B |
+    //                 | C D |
+    const __m128 A = _mm_movelh_ps(r0, r1);
+    const __m128 B = _mm_movehl_ps(r1, r0);
+    const __m128 C = _mm_movelh_ps(r2, r3);
+    const __m128 D = _mm_movehl_ps(r3, r2);
+
+    // Determinants of the blocks, |A| |B| |C| |D|
+    const __m128 det_sub = _mm_sub_ps(
+        _mm_mul_ps(CORE_SIMD_SHUFFLE(r0, r2, 0, 2, 0, 2), CORE_SIMD_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(CORE_SIMD_SHUFFLE(r0, r2, 1, 3, 1, 3), CORE_SIMD_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    const __m128 det_a = CORE_SIMD_SWIZZLE(det_sub, 0, 0, 0, 0);
+    const __m128 det_b = CORE_SIMD_SWIZZLE(det_sub, 1, 1, 1, 1);
+    const __m128 det_c = CORE_SIMD_SWIZZLE(det_sub, 2, 2, 2, 2);
+    const __m128 det_d = CORE_SIMD_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    const __m128 d_c = SimdMatrix2AdjMul(D, C);
+    const __m128 a_b = SimdMatrix2AdjMul(A, B);
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 trace = _mm_mul_ps(a_b, CORE_SIMD_SWIZZLE(d_c, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+    trace = _mm_add_ss(trace, CORE_SIMD_SWIZZLE(trace, 1, 1, 1, 1));
+    float det;
+    _mm_store_ss(&det, _mm_sub_ss(_mm_add_ss(_mm_mul_ss(det_a, det_d), _mm_mul_ss(det_b, det_c)), trace));
+    if (det <= tolerance && det >= -tolerance)
+        return false;
+
+    // Adjugates of the blocks of the inverse
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, A), SimdMatrix2Mul(B, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, D), SimdMatrix2Mul(C, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, C), SimdMatrix2MulAdj(D, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, B), SimdMatrix2MulAdj(A, d_c));
+
+    const __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), _mm_set1_ps(det));
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    // Apply the adjugates and store the blocks as rows
+    _mm_storeu_ps(out, CORE_SIMD_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 4, CORE_SIMD_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(out + 8, CORE_SIMD_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 12, CORE_SIMD_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+}
+
+//! Returns the product of quaternions stored as x, y, z, w, in the element order of Quaternion::operator*
+inline __m128 SimdQuaternionProduct(__m128 a, __m128 b)
+{
+    const __m128 sign_w = _mm_setr_ps(0.0f, 0.0f, 0.0f, -0.0f);
+    __m128 result = _mm_mul_ps(CORE_SIMD_SWIZZLE(b, 3, 3, 3, 3), a);
+    result = _mm_add_ps(result, _mm_xor_ps(sign_w,
+        _mm_mul_ps(CORE_SIMD_SWIZZLE(b, 0, 1, 2, 0), CORE_SIMD_SWIZZLE(a, 3, 3, 3, 0))));
+    result = _mm_add_ps(result, _mm_xor_ps(sign_w,
+        _mm_mul_ps(CORE_SIMD_SWIZZLE(b, 1, 2, 0, 1), CORE_SIMD_SWIZZLE(a, 2, 0, 1, 1))));
+    return _mm_sub_ps(result, _mm_mul_ps(CORE_SIMD_SWIZZLE(b, 2, 0, 1, 2), CORE_SIMD_SWIZZLE(a, 1, 2, 0, 2)));
+}
+
+#endif
+
+#endif
@@ -0,0 +1,343 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "CoreStableHeaders.h"
+#include "MathBatch.h"
+#include "CoreSimd.h"
+
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+
+#ifdef CORE_SIMD_SSE
+//! Loads 4 vectors, stored as x y z x y z..., into one register per coordinate
+static inline void LoadVectors4(const Vector3df *in, __m128 &xs, __m128 &ys, __m128 &zs)
+{
+    const float *data = &in->x;
+    const __m128 p0 = _mm_loadu_ps(data);     // x0 y0 z0 x1
+    const __m128 p1 = _mm_loadu_ps(data + 4); // y1 z1 x2 y2
+    const __m128 p2 = _mm_loadu_ps(data + 8); // z2 x3 y3 z3
+
+    xs = CORE_SIMD_SHUFFLE(p0, CORE_SIMD_SHUFFLE(p1, p2, 2, 2, 1, 1), 0, 3, 0, 2);
+    ys = CORE_SIMD_SHUFFLE(CORE_SIMD_SHUFFLE(p0, p1, 1, 1, 0, 0), CORE_SIMD_SHUFFLE(p1, p2, 3, 3, 2, 2), 0, 2, 0, 2);
+    zs = CORE_SIMD_SHUFFLE(CORE_SIMD_SHUFFLE(p0, p1, 2, 2, 1, 1), p2, 0, 2, 0, 3);
+}
+
+//! Stores 4 vectors from one register per coordinate, as x y z x y z...
+static inline void StoreVectors4(Vector3df *out, __m128 xs, __m128 ys, __m128 zs)
+{
+    float *data = &out->x;
+    _mm_storeu_ps(data, CORE_SIMD_SHUFFLE(CORE_SIMD_SHUFFLE(xs, ys, 0, 0, 0, 0), CORE_SIMD_SHUFFLE(zs, xs, 0, 0, 1, 1), 0, 2, 0, 2));
+    _mm_storeu_ps(data + 4, CORE_SIMD_SHUFFLE(CORE_SIMD_SHUFFLE(ys, zs, 1, 1, 1, 1), CORE_SIMD_SHUFFLE(xs, ys, 2, 2, 2, 2), 0, 2, 0, 2));
+    _mm_storeu_ps(data + 8, CORE_SIMD_SHUFFLE(CORE_SIMD_SHUFFLE(zs, xs, 2, 2, 3, 3), CORE_SIMD_SHUFFLE(ys, zs, 3, 3, 3, 3), 0, 2, 0, 2));
+}
+#endif
+
+void TransformPositions(const Matrix4 &matrix, const Vector3df *in, Vector3df *out, uint count)
+{
+    uint i = 0;
+#ifdef CORE_SIMD_SSE
+    const f32 *m = matrix.pointer();
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    const __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 xs, ys, zs;
+        LoadVectors4(in + i, xs, ys, zs);
+        StoreVectors4(out + i,
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m0), _mm_mul_ps(ys, m4)), _mm_mul_ps(zs, m8)), m12),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m1), _mm_mul_ps(ys, m5)), _mm_mul_ps(zs, m9)), m13),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m2), _mm_mul_ps(ys, m6)), _mm_mul_ps(zs, m10)), m14));
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        Vector3df v = in[i];
+        matrix.transformVect(out[i], v);
+    }
+}
+
+void RotateVectors(const Quaternion &rotation, const Vector3df *in, Vector3df *out, uint count)
+{
+    uint i = 0;
+#ifdef CORE_SIMD_SSE
+    const __m128 qx = _mm_set1_ps(rotation.x), qy = _mm_set1_ps(rotation.y), qz = _mm_set1_ps(rotation.z);
+    const __m128 w2 = _mm_set1_ps(2.0f * rotation.w);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 xs, ys, zs;
+        LoadVectors4(in + i, xs, ys, zs);
+
+        // uv = q x v, uuv = q x uv, result = v + 2w uv + 2 uuv
+        const __m128 uvx = _mm_sub_ps(_mm_mul_ps(qy, zs), _mm_mul_ps(qz, ys));
+        const __m128 uvy = _mm_sub_ps(_mm_mul_ps(qz, xs), _mm_mul_ps(qx, zs));
+        const __m128 uvz = _mm_sub_ps(_mm_mul_ps(qx, ys), _mm_mul_ps(qy, xs));
+        const __m128 uuvx = _mm_sub_ps(_mm_mul_ps(qy, uvz), _mm_mul_ps(qz, uvy));
+        const __m128 uuvy = _mm_sub_ps(_mm_mul_ps(qz, uvx), _mm_mul_ps(qx, uvz));
+        const __m128 uuvz = _mm_sub_ps(_mm_mul_ps(qx, uvy), _mm_mul_ps(qy, uvx));
+
+        StoreVectors4(out + i,
+            _mm_add_ps(_mm_add_ps(xs, _mm_mul_ps(uvx, w2)), _mm_mul_ps(uuvx, two)),
+            _mm_add_ps(_mm_add_ps(ys, _mm_mul_ps(uvy, w2)), _mm_mul_ps(uuvy, two)),
+            _mm_add_ps(_mm_add_ps(zs, _mm_mul_ps(uvz, w2)), _mm_mul_ps(uuvz, two)));
+    }
+#endif
+    for(; i < count; ++i)
+        out[i] = rotation * in[i];
+}
+
+void MultiplyQuaternions(const Quaternion &rotation, const Quaternion *in, Quaternion *out, uint count)
+{
+#ifdef CORE_SIMD_SSE
+    const __m128 q = _mm_loadu_ps(&rotation.x);
+    for(uint i = 0; i < count; ++i)
+        _mm_storeu_ps(&out[i].x, SimdQuaternionProduct(q, _mm_loadu_ps(&in[i].x)));
+#else
+    for(uint i = 0; i < count; ++i)
+        out[i] = rotation * in[i];
+#endif
+}
+
+void NormalizeVectors(Vector3df *vectors, uint count)
+{
+    uint i = 0;
+#ifdef CORE_SIMD_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 tolerance = _mm_set1_ps(ROUNDING_ERROR_32);
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 xs, ys, zs;
+        LoadVectors4(vectors + i, xs, ys, zs);
+
+        // Same as Vector3df::normalize: no change if the squared length is about zero, else scale by 1/sqrt
+        const __m128 length_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, xs), _mm_mul_ps(ys, ys)), _mm_mul_ps(zs, zs));
+        const __m128 nonzero = _mm_cmpgt_ps(length_sq, tolerance);
+        const __m128 scale = _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(one, _mm_sqrt_ps(length_sq))), _mm_andnot_ps(nonzero, one));
+
+        StoreVectors4(vectors + i, _mm_mul_ps(xs, scale), _mm_mul_ps(ys, scale), _mm_mul_ps(zs, scale));
+    }
+#endif
+    for(; i < count; ++i)
+        vectors[i].normalize();
+}
+
+//! Scalar reference of the matrix product, the same as the generic CMatrix4::setbyproduct_nocheck
+static void ScalarMatrixProduct(f32 *out, const f32 *a, const f32 *b)
+{
+    for(int row = 0; row < 4; ++row)
+        for(int col = 0; col < 4; ++col)
+            out[row * 4 + col] = a[col] * b[row * 4] + a[4 + col] * b[row * 4 + 1] + a[8 + col] * b[row * 4 + 2] + a[12 + col] * b[row * 4 + 3];
+}
+
+//! Scalar reference of the matrix inverse, by Cramer's rule as the generic CMatrix4::getInverse
+static bool ScalarMatrixInverse(f32 *out, const f32 *m)
+{
+    const f32 s0 = m[0] * m[5] - m[1] * m[4];
+    const f32 s1 = m[0] * m[6] - m[2] * m[4];
+    const f32 s2 = m[0] * m[7] - m[3] * m[4];
+    const f32 s3 = m[1] * m[6] - m[2] * m[5];
+    const f32 s4 = m[1] * m[7] - m[3] * m[5];
+    const f32 s5 = m[2] * m[7] - m[3] * m[6];
+    const f32 c5 = m[10] * m[15] - m[11] * m[14];
+    const f32 c4 = m[9] * m[15] - m[11] * m[13];
+    const f32 c3 = m[9] * m[14] - m[10] * m[13];
+    const f32 c2 = m[8] * m[15] - m[11] * m[12];
+    const f32 c1 = m[8] * m[14] - m[10] * m[12];
+    const f32 c0 = m[8] * m[13] - m[9] * m[12];
+
+    f32 d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (iszero(d))
+        return false;
+    d = reciprocal(d);
+
+    out[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * d;
+    out[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d;
+    out[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * d;
+    out[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d;
+    out[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d;
+    out[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * d;
+    out[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d;
+    out[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * d;
+    out[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * d;
+    out[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d;
+    out[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * d;
+    out[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d;
+    out[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d;
+    out[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * d;
+    out[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d;
+    out[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * d;
+    return true;
+}
+
+//! Scalar reference of the quaternion product, the same as the generic Quaternion::operator *
+static Quaternion ScalarQuaternionProduct(const Quaternion &a, const Quaternion &b)
+{
+    return Quaternion(
+        (b.w * a.x) + (b.x * a.w) + (b.y * a.z) - (b.z * a.y),
+        (b.w * a.y) + (b.y * a.w) + (b.z * a.x) - (b.x * a.z),
+        (b.w * a.z) + (b.z * a.w) + (b.x * a.y) - (b.y * a.x),
+        (b.w * a.w) - (b.x * a.x) - (b.y * a.y) - (b.z * a.z));
+}
+
+static f32 RandomFloat(f32 min, f32 max)
+{
+    return min + (max - min) * (f32)rand() / (f32)RAND_MAX;
+}
+
+static Quaternion RandomRotation()
+{
+    Quaternion q(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+    q.normalize();
+    return q;
+}
+
+static f32 MaxDifference(const f32 *a, const f32 *b, uint count)
+{
+    f32 max_difference = 0.0f;
+    for(uint i = 0; i < count; ++i)
+        max_difference = std::max(max_difference, fabsf(a[i] - b[i]));
+    return max_difference;
+}
+
+static f32 MaxDifference(const std::vector<Matrix4> &a, const std::vector<Matrix4> &b)
+{
+    f32 max_difference = 0.0f;
+    for(uint i = 0; i < a.size(); ++i)
+        max_difference = std::max(max_difference, MaxDifference(a[i].pointer(), b[i].pointer(), 16));
+    return max_difference;
+}
+
+//! Appends one line of the benchmark report
+static void ReportLine(std::ostringstream &report, const char *name, double scalar_time, double time, uint count, f32 max_difference)
+{
+    report << name << ": scalar " << scalar_time * 1000000000.0 / count << " ns, in use " << time * 1000000000.0 / count
+        << " ns each, speedup " << (time > 0.0 ? scalar_time / time : 0.0) << ", max. difference " << max_difference << std::endl;
+}
+
+std::string BenchmarkMath(uint count)
+{
+    count = std::max(count, 1u);
+    srand(1);
+
+    // Transforms like those of scene nodes: rotation, scale and translation
+    std::vector<Matrix4> matrices(count);
+    std::vector<Quaternion> rotations(count);
+    std::vector<Vector3df> positions(count);
+    for(uint i = 0; i < count; ++i)
+    {
+        rotations[i] = RandomRotation();
+        positions[i] = Vector3df(RandomFloat(-256.0f, 256.0f), RandomFloat(-256.0f, 256.0f), RandomFloat(0.0f, 100.0f));
+        Matrix4 scale;
+        scale.setScale(Vector3df(RandomFloat(0.5f, 2.0f), RandomFloat(0.5f, 2.0f), RandomFloat(0.5f, 2.0f)));
+        matrices[i] = scale * rotations[i].getMatrix();
+        matrices[i].setTranslation(positions[i]);
+    }
+
+    std::ostringstream report;
+#ifdef CORE_SIMD_SSE
+    report << "Math in use: SSE, " << count << " elements" << std::endl;
+#else
+    report << "Math in use: scalar, " << count << " elements" << std::endl;
+#endif
+
+    // Matrix product, chaining each matrix to the next as parent and child transforms
+    {
+        std::vector<Matrix4> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            ScalarMatrixProduct(scalar_result[i].pointer(), matrices[i].pointer(), matrices[(i + 1) % count].pointer());
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        for(uint i = 0; i < count; ++i)
+            result[i].setbyproduct_nocheck(matrices[i], matrices[(i + 1) % count]);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Matrix product", scalar_time, time, count, MaxDifference(scalar_result, result));
+    }
+
+    // Matrix inverse
+    {
+        std::vector<Matrix4> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            ScalarMatrixInverse(scalar_result[i].pointer(), matrices[i].pointer());
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        for(uint i = 0; i < count; ++i)
+            matrices[i].getInverse(result[i]);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Matrix inverse", scalar_time, time, count, MaxDifference(scalar_result, result));
+    }
+
+    // Quaternion product
+    {
+        std::vector<Quaternion> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            scalar_result[i] = ScalarQuaternionProduct(rotations[i], rotations[(i + 1) % count]);
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        for(uint i = 0; i < count; ++i)
+            result[i] = rotations[i] * rotations[(i + 1) % count];
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Quaternion product", scalar_time, time, count, MaxDifference(&scalar_result[0].x, &result[0].x, count * 4));
+    }
+
+    // Batch operations against the single-element operators
+    const Matrix4 &matrix = matrices[0];
+    const Quaternion &rotation = rotations[0];
+    {
+        std::vector<Vector3df> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            matrix.transformVect(scalar_result[i], positions[i]);
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        TransformPositions(matrix, &positions[0], &result[0], count);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Batch transform positions", scalar_time, time, count, MaxDifference(&scalar_result[0].x, &result[0].x, count * 3));
+    }
+    {
+        std::vector<Vector3df> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            scalar_result[i] = rotation * positions[i];
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        RotateVectors(rotation, &positions[0], &result[0], count);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Batch rotate vectors", scalar_time, time, count, MaxDifference(&scalar_result[0].x, &result[0].x, count * 3));
+    }
+    {
+        std::vector<Quaternion> scalar_result(count), result(count);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            scalar_result[i] = ScalarQuaternionProduct(rotation, rotations[i]);
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        MultiplyQuaternions(rotation, &rotations[0], &result[0], count);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Batch multiply quaternions", scalar_time, time, count, MaxDifference(&scalar_result[0].x, &result[0].x, count * 4));
+    }
+    {
+        std::vector<Vector3df> scalar_result(positions), result(positions);
+        Poco::Timestamp scalar_start;
+        for(uint i = 0; i < count; ++i)
+            scalar_result[i].normalize();
+        double scalar_time = scalar_start.elapsed() / 1000000.0;
+        Poco::Timestamp start;
+        NormalizeVectors(&result[0], count);
+        double time = start.elapsed() / 1000000.0;
+        ReportLine(report, "Batch normalize vectors", scalar_time, time, count, MaxDifference(&scalar_result[0].x, &result[0].x, count * 3));
+    }
+
+    return report.str();
+}
@@ -0,0 +1,54 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Core_MathBatch_h
+#define incl_Core_MathBatch_h
+
+#include "CoreTypes.h"
+#include "Vector3D.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+
+#include <string>
+
+//! Batch math over arrays of positions and orientations. Uses SSE when CORE_SIMD_SSE is defined, see CoreSimd.h.
+/*! The results equal those of the single-element operators, e.g. matrix.transformVect(), up to float rounding.
+    The in and out arrays may be the same array, but may not otherwise overlap.
+ */
+
+//! Transforms positions by a matrix, as Matrix4::transformVect
+/*! \param matrix transformation
+    \param in positions
+    \param out transformed positions
+    \param count number of positions
+ */
+void TransformPositions(const Matrix4 &matrix, const Vector3df *in, Vector3df *out, uint count);
+
+//! Rotates vectors by a quaternion, as Quaternion::operator *(const Vector3df&)
+/*! \param rotation rotation, normalized
+    \param in vectors
+    \param out rotated vectors
+    \param count number of vectors
+ */
+void RotateVectors(const Quaternion &rotation, const Vector3df *in, Vector3df *out, uint count);
+
+//! Multiplies orientations by a quaternion, out[i] = rotation * in[i]
+/*! \param rotation rotation
+    \param in orientations
+    \param out rotated orientations
+    \param count number of orientations
+ */
+void MultiplyQuaternions(const Quaternion &rotation, const Quaternion *in, Quaternion *out, uint count);
+
+//! Normalizes vectors in place, as Vector3df::normalize. Vectors of about zero length are left as they are.
+/*! \param vectors vectors
+    \param count number of vectors
+ */
+void NormalizeVectors(Vector3df *vectors, uint count);
+
+//! Times the math used per transform, both the scalar code and the code in use, and checks that they agree
+/*! \param count number of elements of each operation
+    \return report of the timings and the largest differences
+ */
+std::string BenchmarkMath(uint count);
+
+#endif
@@ -17,6 +17,7 @@
 #define incl_Core_CMatrix4_h
 
 #include "CoreMath.h"
+#include "CoreSimd.h"
 #include "Vector3D.h"
 
 //! 4x4 matrix. Mostly used as transformation matrix for 3d calculations.
@@ -1725,6 +1726,47 @@ inline CMatrix4<T> operator*(const T scalar, const CMatrix4<T>& mat)
 }
 
 
+#ifdef CORE_SIMD_SSE
+// SSE versions of the f32 matrix product and inverse
+
+template <>
+inline CMatrix4<f32>& CMatrix4<f32>::setbyproduct_nocheck(const CMatrix4<f32>& other_a,const CMatrix4<f32>& other_b )
+{
+	SimdMatrixProduct(M, other_a.M, other_b.M);
+	definitelyIdentityMatrix=false;
+	return *this;
+}
+
+template <>
+inline CMatrix4<f32> CMatrix4<f32>::operator*(const CMatrix4<f32>& m2) const
+{
+	if ( this->isIdentity() )
+		return m2;
+	if ( m2.isIdentity() )
+		return *this;
+
+	CMatrix4<f32> m3 ( EM4CONST_NOTHING );
+	m3.setbyproduct_nocheck(*this, m2);
+	return m3;
+}
+
+template <>
+inline bool CMatrix4<f32>::getInverse(CMatrix4<f32>& out) const
+{
+	if ( this->isIdentity() )
+	{
+		out=*this;
+		return true;
+	}
+
+	if (!SimdMatrixInverse(out.M, M, ROUNDING_ERROR_32))
+		return false;
+	out.definitelyIdentityMatrix = definitelyIdentityMatrix;
+	return true;
+}
+#endif
+
+
 //! Typedef for f32 matrix
 typedef CMatrix4<f32> Matrix4;
 //! global const identity matrix
@@ -17,6 +17,7 @@
 #define incl_Core_Quaternion_h
 
 #include "CoreMath.h"
+#include "CoreSimd.h"
 #include "Vector3D.h"
 #include "Matrix4.h"
 
@@ -265,10 +266,14 @@ inline Quaternion Quaternion::operator*(const Quaternion& other) const
 {
 	Quaternion tmp;
 
+#ifdef CORE_SIMD_SSE
+	_mm_storeu_ps(&tmp.x, SimdQuaternionProduct(_mm_loadu_ps(&x), _mm_loadu_ps(&other.x)));
+#else
 	tmp.w = (other.w * w) - (other.x * x) - (other.y * y) - (other.z * z);
 	tmp.x = (other.w * x) + (other.x * w) + (other.y * z) - (other.z * y);
 	tmp.y = (other.w * y) + (other.y * w) + (other.z * x) - (other.x * z);
 	tmp.z = (other.w * z) + (other.z * w) + (other.x * y) - (other.y * x);
+#endif
 
 	return tmp;
 }
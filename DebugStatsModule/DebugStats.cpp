@@ -33,6 +33,7 @@
 #include "OgreTextureResource.h"
 
 #include "EC_OpenSimPresence.h"
+#include "CommunicationsService.h"
 
 #include <utility>
 
@@ -100,6 +101,10 @@ void DebugStatsModule::PostInitialize()
         "Dumps all currently existing J2K decoded textures as PNG files into the viewer working directory.",
         Console::Bind(this, &DebugStatsModule::DumpTextures)));
 
+    RegisterConsoleCommand(Console::CreateCommand("voicestats",
+        "Prints in-world voice playback statistics: buffer lengths, late, dropped and concealed audio frames.",
+        Console::Bind(this, &DebugStatsModule::ShowVoiceStatistics)));
+
     frameworkEventCategory_ = framework_->GetEventManager()->QueryEventCategory("Framework");
 
     AddProfilerWidgetToUi();
@@ -481,6 +486,23 @@ Console::CommandResult DebugStatsModule::DumpTextures(const StringVector &params
     return Console::ResultSuccess();
 }
 
+Console::CommandResult DebugStatsModule::ShowVoiceStatistics(const StringVector &params)
+{
+    boost::shared_ptr<Communications::ServiceInterface> comm = framework_->GetServiceManager()->GetService<Communications::ServiceInterface>(Foundation::Service::ST_Communications).lock();
+    if (!comm)
+        return Console::ResultFailure("Communications service not available.");
+
+    Communications::InWorldVoice::SessionInterface* session = comm->InWorldVoiceSession();
+    if (!session)
+        return Console::ResultFailure("No in-world voice session.");
+
+    QList<QString> lines = session->Statistics();
+    foreach(QString line, lines)
+        LogInfo(line.toStdString());
+
+    return Console::ResultSuccess();
+}
+
 }
 
 extern "C" void POCO_LIBRARY_API SetProfiler(Foundation::Profiler *profiler);
@@ -86,6 +86,9 @@ namespace DebugStats
         
         /// Dumps J2K decoded textures to PNG images in the viewer working directory.
         Console::CommandResult DumpTextures(const StringVector &params);
+
+        /// Prints in-world voice session statistics, e.g. late and dropped audio frames.
+        Console::CommandResult ShowVoiceStatistics(const StringVector &params);
         
         /// A history of estimated frame times.
         std::vector<std::pair<uint64_t, double> > frameTimes;
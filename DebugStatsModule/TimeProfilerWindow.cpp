@@ -19,6 +19,7 @@
 #include "EC_OgreMesh.h"
 #include "EC_OgreCustomObject.h"
 #include "EC_Terrain.h"
+#include "Renderer.h"
 //#include "RealXtend/RexProtocolMsgIDs.h"
 //#include "GenericMessageUtils.h"
 
@@ -1545,6 +1546,12 @@ void TimeProfilerWindow::RefreshSceneComplexityProfilingData()
     text << "# of total triangles rendered last frame: " << triangles << std::endl;
     text << "# of avg. triangles per batch: " << triangles / (batches ? batches : 1) << std::endl;
     text << "Avg. FPS: " << avgfps << std::endl;
+    boost::shared_ptr<OgreRenderer::Renderer> ogre_renderer = boost::dynamic_pointer_cast<OgreRenderer::Renderer>(renderer);
+    if (ogre_renderer)
+    {
+        text << "# of UI pixels repainted & uploaded last frame: " << ogre_renderer->GetUiPixelsUpdated()
+             << " in " << ogre_renderer->GetUiRectsUpdated() << " rects" << std::endl;
+    }
     text << std::endl;
     
     uint entities = 0;
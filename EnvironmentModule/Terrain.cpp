@@ -23,6 +23,7 @@
 #include "RexTypes.h"
 #include "NetworkMessages/NetInMessage.h"
 #include "Entity.h"
+#include "FrameScheduler.h"
 
 #include <OgreManualObject.h>
 #include <OgreSceneManager.h>
@@ -33,6 +34,8 @@
 #include <OgreMesh.h>
 #include <OgreEntity.h>
 
+#include <boost/bind.hpp>
+
 namespace
 {
     void DebugDumpOgreTextureInfo(const char *texName)
@@ -60,12 +63,14 @@ namespace
 namespace Environment
 {
     Terrain::Terrain(EnvironmentModule *owner)
-    :owner_(owner)
+    :owner_(owner),
+    terrain_geometry_job_(0)
     {
     }
 
     Terrain::~Terrain()
     {
+        owner_->GetFramework()->GetFrameScheduler()->Cancel(terrain_geometry_job_);
     }
 
     /// Sets the texture of the material used to render terrain.
@@ -354,12 +359,26 @@ namespace Environment
         */
     }
 
-    void Terrain::RegenerateDirtyTerrainPatches()
+    void Terrain::QueueDirtyTerrainPatches()
+    {
+        Foundation::FrameSchedulerPtr scheduler = owner_->GetFramework()->GetFrameScheduler();
+        if (!scheduler->IsScheduled(terrain_geometry_job_))
+        {
+            terrain_geometry_job_ = scheduler->Schedule("Terrain_RegeneratePatches",
+                boost::bind(&Terrain::RegenerateDirtyTerrainPatches, this, _1));
+        }
+    }
+
+    bool Terrain::RegenerateDirtyTerrainPatches(const Foundation::FrameBudget &budget)
     {
         PROFILE(RegenerateOgreTerrainGeom);
+        // The terrain entity may have been removed while the job was scheduled
         Scene::EntityPtr terrain = GetTerrainEntity().lock();
+        if (!terrain)
+            return false;
         EC_Terrain *terrainComponent = terrain->GetComponent<EC_Terrain>().get();
-        assert(terrainComponent);
+        if (!terrainComponent)
+            return false;
 
         for(int y = 0; y < EC_Terrain::cNumPatchesPerEdge; ++y)
             for(int x = 0; x < EC_Terrain::cNumPatchesPerEdge; ++x)
@@ -390,9 +409,17 @@ namespace Environment
                     }
                 }
 
-                if (neighborsLoaded)
-                    GenerateTerrainGeometryForOnePatch(*terrain, *terrainComponent, scenePatch);
+                if (!neighborsLoaded)
+                    continue;
+
+                // Always regenerate at least one patch per slice. Patches left dirty because of missing
+                // neighbors are queued again when the neighbors arrive
+                GenerateTerrainGeometryForOnePatch(*terrain, *terrainComponent, scenePatch);
+                if (budget.IsExceeded())
+                    return true;
             }
+
+        return false;
     }
 
     void Terrain::RequestTerrainTextures()
@@ -457,7 +484,8 @@ namespace Environment
 
             // Now that we have updated all the height map data for each patch, see if
             // we have enough of the patches loaded in to regenerate the GPU-side resources as well.
-            RegenerateDirtyTerrainPatches();
+            // Regenerated on a frame job, so that a burst of patches is spread over several frames.
+            QueueDirtyTerrainPatches();
             break;
         }
         case TPLayerWater:
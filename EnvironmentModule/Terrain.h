@@ -11,6 +11,7 @@
 #include "EC_Terrain.h"
 #include "EnvironmentModuleApi.h"
 #include "RexTypes.h"
+#include "FrameScheduler.h"
 
 #include <QObject>
 
@@ -103,7 +104,11 @@ namespace Environment
 
     private:
         void CreateOrUpdateTerrainPatchHeightData(const DecodedTerrainPatch &patch, int patchSize);
-        void RegenerateDirtyTerrainPatches();
+        /// Schedules the frame job that regenerates the geometry of dirty patches, if not already scheduled.
+        void QueueDirtyTerrainPatches();
+        /// Frame job that regenerates the geometry of dirty patches whose neighbors are loaded.
+        /// @return True if patches were left for the next slice.
+        bool RegenerateDirtyTerrainPatches(const Foundation::FrameBudget &budget);
         void CreateOgreTerrainPatchNode(Ogre::SceneNode *&node, int patchX, int patchY);
         void GenerateTerrainGeometryForOnePatch(Scene::Entity &entity, EC_Terrain &terrain, EC_Terrain::Patch &patch);
         void GenerateTerrainGeometry(EC_Terrain &terrain);
@@ -114,6 +119,9 @@ namespace Environment
         /// Environment module's pointer.
         EnvironmentModule *owner_;
 
+        /// Frame job that regenerates dirty patches, 0 if none.
+        Foundation::frame_job_id_t terrain_geometry_job_;
+
         /// Request tags for new terrain textures.
         request_tag_t terrain_texture_requests_[num_terrain_textures];
 
@@ -0,0 +1,195 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "AsyncLogChannel.h"
+#include "CoreAtomic.h"
+#include "CoreStringUtils.h"
+
+#include <boost/bind.hpp>
+
+namespace Foundation
+{
+    //! How often the writer thread writes queued messages, in milliseconds
+    static const int WRITE_INTERVAL = 50;
+
+    //! How often the repeat count of a repeating message is reported, in microseconds
+    static const Poco::Timestamp::TimeDiff REPEAT_INTERVAL = 5000000;
+
+    AsyncLogChannel::AsyncLogChannel(Poco::Channel *channel) :
+        channel_(channel),
+        drain_count_(0),
+        flush_waiters_(0),
+        running_(false),
+        stop_(false),
+        has_last_(false),
+        repeats_(0)
+    {
+        channel_->duplicate();
+        head_ = tail_ = new Node();
+    }
+
+    AsyncLogChannel::~AsyncLogChannel()
+    {
+        close();
+
+        // Messages pushed by threads that saw the writer still running
+        {
+            MutexLock lock(write_mutex_);
+            Drain();
+            WriteRepeats();
+        }
+
+        delete tail_;
+        channel_->release();
+    }
+
+    void AsyncLogChannel::log(const Poco::Message &msg)
+    {
+        if (!running_)
+        {
+            MutexLock lock(write_mutex_);
+            Write(msg);
+            return;
+        }
+
+        Push(msg);
+        if (msg.getPriority() <= Poco::Message::PRIO_ERROR)
+            Flush();
+    }
+
+    void AsyncLogChannel::open()
+    {
+        if (running_)
+            return;
+
+        stop_ = false;
+        running_ = true;
+        thread_ = Thread(boost::bind(&AsyncLogChannel::Run, this));
+    }
+
+    void AsyncLogChannel::close()
+    {
+        if (!running_)
+            return;
+
+        {
+            MutexLock lock(mutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        thread_.join();
+
+        {
+            MutexLock lock(mutex_);
+            running_ = false;
+        }
+        drained_.notify_all();
+
+        MutexLock lock(write_mutex_);
+        Drain();
+        WriteRepeats();
+    }
+
+    void AsyncLogChannel::Flush()
+    {
+        if (!running_ || boost::this_thread::get_id() == thread_.get_id())
+            return;
+
+        ScopedLock lock(mutex_);
+        // A pass already in progress may have missed the caller's messages, so wait for the one after it
+        unsigned target = drain_count_ + 2;
+        ++flush_waiters_;
+        wakeup_.notify_one();
+        while(running_ && (int)(target - drain_count_) > 0)
+            drained_.wait(lock);
+        --flush_waiters_;
+    }
+
+    void AsyncLogChannel::Run()
+    {
+        for(;;)
+        {
+            bool stop;
+            {
+                ScopedLock lock(mutex_);
+                if (!stop_ && !flush_waiters_)
+                    wakeup_.timed_wait(lock, boost::posix_time::milliseconds(WRITE_INTERVAL));
+                stop = stop_;
+            }
+
+            {
+                MutexLock lock(write_mutex_);
+                try
+                {
+                    Drain();
+                    if (repeats_ && repeat_time_.isElapsed(REPEAT_INTERVAL))
+                        WriteRepeats();
+                }
+                catch(...)
+                {
+                    // There is nowhere to report a failing log channel. Keep the thread alive for the next messages.
+                }
+            }
+
+            {
+                MutexLock lock(mutex_);
+                ++drain_count_;
+            }
+            drained_.notify_all();
+
+            if (stop)
+                break;
+        }
+    }
+
+    void AsyncLogChannel::Push(const Poco::Message &msg)
+    {
+        Node *node = new Node(msg);
+        Node *prev = Core::AtomicExchangePointer(&head_, node);
+        Core::AtomicStorePointer(&prev->next_, node);
+    }
+
+    void AsyncLogChannel::Drain()
+    {
+        for(;;)
+        {
+            Node *next = Core::AtomicLoadPointer(&tail_->next_);
+            if (!next)
+                break;
+
+            delete tail_;
+            tail_ = next;
+            Write(next->message_);
+            next->message_ = Poco::Message();
+        }
+    }
+
+    void AsyncLogChannel::Write(const Poco::Message &msg)
+    {
+        if (has_last_ && msg.getPriority() == last_.getPriority() && msg.getText() == last_.getText() &&
+            msg.getSource() == last_.getSource())
+        {
+            if (!repeats_++)
+                repeat_time_.update();
+            else if (repeat_time_.isElapsed(REPEAT_INTERVAL))
+                WriteRepeats();
+            return;
+        }
+
+        WriteRepeats();
+        channel_->log(msg);
+        last_ = msg;
+        has_last_ = true;
+    }
+
+    void AsyncLogChannel::WriteRepeats()
+    {
+        if (!repeats_)
+            return;
+
+        Poco::Message msg(last_.getSource(), "Last message repeated " + ToString<unsigned>(repeats_) + " times",
+            last_.getPriority());
+        repeats_ = 0;
+        channel_->log(msg);
+    }
+}
@@ -0,0 +1,127 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Foundation_AsyncLogChannel_h
+#define incl_Foundation_AsyncLogChannel_h
+
+#include "CoreThread.h"
+
+#include <Poco/Channel.h>
+#include <Poco/Message.h>
+#include <Poco/Timestamp.h>
+
+namespace Foundation
+{
+    //! Log channel that writes messages to another channel from a background thread.
+    /*! Logging threads only push the message to a lock-free queue, formatting and file writes are done
+        by the writer thread. Messages of priority error or worse are written before log() returns, so they
+        are not lost if the application crashes right after.
+
+        Repeats of the same message are collapsed: the first one is written, the rest are counted and reported
+        with a single "Last message repeated n times" message.
+
+        Until open() is called, and after close(), messages are written synchronously from the calling thread.
+     */
+    class AsyncLogChannel : public Poco::Channel
+    {
+    public:
+        //! Constructor
+        /*! \param channel Channel to write messages to. A reference to it is held until destruction.
+         */
+        explicit AsyncLogChannel(Poco::Channel *channel);
+
+        //! Queues a message for writing. Thread safe.
+        virtual void log(const Poco::Message &msg);
+
+        //! Starts the writer thread
+        virtual void open();
+
+        //! Writes all queued messages and stops the writer thread
+        virtual void close();
+
+        //! Waits until messages queued before the call have been written. Thread safe.
+        void Flush();
+
+    protected:
+        //! Destructor. Channels are reference counted, use release()
+        virtual ~AsyncLogChannel();
+
+    private:
+        AsyncLogChannel(const AsyncLogChannel &);
+        AsyncLogChannel &operator =(const AsyncLogChannel &);
+
+        //! Queued message
+        struct Node
+        {
+            Node() : next_(0) {}
+            explicit Node(const Poco::Message &message) : message_(message), next_(0) {}
+
+            Poco::Message message_;
+            Node * volatile next_;
+        };
+
+        //! Writer thread main loop
+        void Run();
+
+        //! Adds a message to the queue. Thread safe.
+        void Push(const Poco::Message &msg);
+
+        //! Writes all queued messages. Only one thread may call this at a time.
+        void Drain();
+
+        //! Writes a message, collapsing repeats
+        void Write(const Poco::Message &msg);
+
+        //! Writes the repeat count of the last message, if it has been repeated
+        void WriteRepeats();
+
+        //! Target channel
+        Poco::Channel *channel_;
+
+        //! Newest queued node, producers swap themselves in here
+        Node * volatile head_;
+
+        //! Oldest node, already written. Accessed by the consumer only
+        Node *tail_;
+
+        //! Writer thread
+        Thread thread_;
+
+        //! Protects the state below
+        Mutex mutex_;
+
+        //! Wakes up the writer thread
+        Condition wakeup_;
+
+        //! Signaled after each pass of the writer thread
+        Condition drained_;
+
+        //! Number of completed writer thread passes
+        unsigned drain_count_;
+
+        //! Number of threads waiting in Flush()
+        unsigned flush_waiters_;
+
+        //! Is the writer thread running
+        volatile bool running_;
+
+        //! Should the writer thread stop
+        bool stop_;
+
+        //! Serializes synchronous writes when the writer thread isn't running
+        Mutex write_mutex_;
+
+        //! Last written message, for detecting repeats
+        Poco::Message last_;
+
+        //! Has a message been written yet
+        bool has_last_;
+
+        //! Number of unreported repeats of the last message
+        unsigned repeats_;
+
+        //! Time of the first unreported repeat
+        Poco::Timestamp repeat_time_;
+    };
+}
+
+#endif
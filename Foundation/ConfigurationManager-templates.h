@@ -14,6 +14,7 @@ namespace Foundation
     template <typename T > T ConfigurationManager::DeclareSetting(const std::string& group, const std::string& key, 
                                                                   const T& defaultValue) const
      {    
+        RecursiveMutexLock lock(values_mutex_);
         if (HasKey(group, key))
             return GetSetting<T>(group,key);
         else
@@ -24,15 +25,46 @@ namespace Foundation
 
     template <typename T> void ConfigurationManager::SetSetting(const std::string& group, const std::string& key, const T& value)
     {
+        RecursiveMutexLock lock(values_mutex_);
+        std::string str = boost::lexical_cast<std::string>(value);
         std::map<string_pair_t, std::string>::iterator iter = values_.find(std::make_pair(group, key));
         if (iter != values_.end())
-            iter->second = boost::lexical_cast<std::string>(value);
+            iter->second = str;
         else
-            values_[std::make_pair(group, key)] = boost::lexical_cast<std::string>(value);
+            values_[std::make_pair(group, key)] = str;
+
+        NotifySettingChanged(group, key, str);
+    }
+
+    template <typename T> Setting<T> ConfigurationManager::DeclareSettingHandle(const std::string& group, const std::string& key, 
+                                                                                const T& defaultValue)
+    {
+        RecursiveMutexLock lock(values_mutex_);
+        T value = DeclareSetting(group, key, defaultValue);
+
+        // Share the cached value with earlier handles of the same type.
+        std::vector<boost::shared_ptr<SettingValueBase> > &handles = setting_values_[std::make_pair(group, key)];
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            boost::shared_ptr<SettingValue<T> > typed = boost::dynamic_pointer_cast<SettingValue<T> >(handles[i]);
+            if (typed)
+                return Setting<T>(this, group, key, typed);
+        }
+
+        boost::shared_ptr<SettingValue<T> > typed(new SettingValue<T>(value));
+        handles.push_back(typed);
+        return Setting<T>(this, group, key, typed);
+    }
+
+    template <typename T> void Setting<T>::Set(const T &value)
+    {
+        manager_->SetSetting(group_, key_, value);
+        manager_->SaveAsync();
     }
 
     template <> inline std::string ConfigurationManager::GetSetting<std::string>(const std::string& group, const std::string& key) const
     {
+        RecursiveMutexLock lock(values_mutex_);
         std::string value = "";
         std::map<string_pair_t, std::string>::iterator iter = values_.find(std::make_pair(group, key));
         if (iter != values_.end())
@@ -45,6 +77,7 @@ namespace Foundation
 
     template <typename T> inline T ConfigurationManager::GetSetting(const std::string& group, const std::string& key) const
     {
+        RecursiveMutexLock lock(values_mutex_);
         T value;
         std::map<string_pair_t, std::string>::iterator iter = values_.find(std::make_pair(group, key));
         if (iter != values_.end())
@@ -4,18 +4,25 @@
 #include "ConfigurationManager.h"
 #include "CoreException.h"
 
+#include <boost/bind.hpp>
+
 
 namespace Foundation
 {
     const char* ConfigurationManager::DEFAULT_CONFIG_PATH = "./data/configuration/";
 
     ConfigurationManager::ConfigurationManager(Framework* framework, const std::string& path) : path_(boost::filesystem::path(path)), 
-        framework_(framework)
+        framework_(framework),
+        save_pending_(false),
+        saving_(false)
     {
     }
 
     ConfigurationManager::~ConfigurationManager()
     {
+        if (save_thread_)
+            save_thread_->join();
+
         Export();
         
         // Does not own.
@@ -29,6 +36,7 @@ namespace Foundation
     
     void ConfigurationManager::Load(const std::string& path)
     {
+        RecursiveMutexLock lock(values_mutex_);
         namespace fs = boost::filesystem;
 
         fs::path filePath;
@@ -209,6 +217,13 @@ namespace Foundation
 
     void ConfigurationManager::Export(const std::string& path, const std::string& group)
     {
+        // Write a copy of the values, so that settings can be used while the files are being written.
+        MutexLock export_lock(export_mutex_);
+        ValueMap values;
+        {
+            RecursiveMutexLock lock(values_mutex_);
+            values = values_;
+        }
                     
         namespace fs = boost::filesystem; 
         fs::path filePath;
@@ -230,9 +245,6 @@ namespace Foundation
         {
             // Export all values from memory map. 
 
-            // Create temporary map which contains all data.
-
-            std::map<string_pair_t, std::string> tmp_values = values_;
 
             // Get all xml files which are located in given path (does there exist earlier configurations)
             
@@ -276,8 +288,8 @@ namespace Foundation
 
                 // Go through all runtime map values and set all values which match to group into file.
                 
-                std::map<string_pair_t, std::string>::iterator val_iter = values_.begin();
-                while(val_iter != values_.end())
+                std::map<string_pair_t, std::string>::iterator val_iter = values.begin();
+                while(val_iter != values.end())
                 {
                     std::map<string_pair_t, std::string>::iterator next = val_iter;
                     ++next;
@@ -291,7 +303,7 @@ namespace Foundation
                         std::string value = val_iter->second;
                         pConfiguration->setString(key, value);
                         // Remove old value. 
-                        values_.erase(val_iter);
+                        values.erase(val_iter);
                     }
                     val_iter = next;
                 }
@@ -307,11 +319,11 @@ namespace Foundation
           
              // Write values which were not saved earlier.
 
-            if ( values_.size() != 0)
+            if ( values.size() != 0)
             {
-                std::map<string_pair_t, std::string>::iterator val_iter = values_.begin();
+                std::map<string_pair_t, std::string>::iterator val_iter = values.begin();
                 
-                while (val_iter != values_.end() )
+                while (val_iter != values.end() )
                 {
                     //std::map<string_pair_t, std::string>::iterator next_upper = val_iter;
                    
@@ -348,8 +360,8 @@ namespace Foundation
                     
                     // Go through all values which are still left and find all keys which belongs to given group. 
 
-                    std::map<string_pair_t, std::string>::iterator val_key = values_.begin();
-                    while(val_key != values_.end())
+                    std::map<string_pair_t, std::string>::iterator val_key = values.begin();
+                    while(val_key != values.end())
                     {
                         std::map<string_pair_t, std::string>::iterator next = val_key;
                         ++next;
@@ -362,7 +374,7 @@ namespace Foundation
                             std::string value = val_key->second;
                             pConfiguration->setString(key, value);
                             // Remove old value. 
-                            values_.erase(val_key);
+                            values.erase(val_key);
                         }
                         val_key = next;
                     }
@@ -374,10 +386,10 @@ namespace Foundation
                     
                     // HACK
 
-                    if (values_.size() == 0)
-                        val_iter = values_.end();
+                    if (values.size() == 0)
+                        val_iter = values.end();
                     else
-                        val_iter = values_.begin();
+                        val_iter = values.begin();
                     // END HACK
 
                    
@@ -385,8 +397,6 @@ namespace Foundation
 
             }
             
-            // Return values so that ConfigurationManager state is same as before.
-            values_ = tmp_values;
 
          }
          else if (group != "" && fs::is_directory(filePath))
@@ -395,9 +405,6 @@ namespace Foundation
             
             // Search first that is there all ready file which match encoding. 
             
-            // Create temporary map which contains all data.
-
-            std::map<string_pair_t, std::string> tmp_values = values_;
 
             // Get all xml files which are located in given path (does there exist earlier configurations)
             
@@ -447,8 +454,8 @@ namespace Foundation
 
                 // Go through all runtime map values and set all values which match to group into file.
                 
-                std::map<string_pair_t, std::string>::iterator val_iter = values_.begin();
-                while(val_iter != values_.end())
+                std::map<string_pair_t, std::string>::iterator val_iter = values.begin();
+                while(val_iter != values.end())
                 {
                     std::map<string_pair_t, std::string>::iterator next = val_iter;
                     ++next;
@@ -462,7 +469,7 @@ namespace Foundation
                         std::string value = val_iter->second;
                         pConfiguration->setString(key, value);
                         // Remove old value. 
-                        values_.erase(val_iter);
+                        values.erase(val_iter);
                     }
                     val_iter = next;
                 }
@@ -482,9 +489,9 @@ namespace Foundation
             {
                 // There is not old configuration file.
                 
-                std::map<string_pair_t, std::string>::iterator val_iter = values_.begin();
+                std::map<string_pair_t, std::string>::iterator val_iter = values.begin();
                 
-                if(val_iter != values_.end() )
+                if(val_iter != values.end() )
                 {
                  
 
@@ -516,15 +523,14 @@ namespace Foundation
                     } catch ( std::exception& /*ex*/)
                     {
                         ///todo What to do if loading failed. 
-                        values_ = tmp_values;
                         return;
                     }
 
                     
                     // Go through all values which are still left and find all keys which belongs to given group. 
 
-                    std::map<string_pair_t, std::string>::iterator val_key = values_.begin();
-                    while(val_key != values_.end())
+                    std::map<string_pair_t, std::string>::iterator val_key = values.begin();
+                    while(val_key != values.end())
                     {
                         std::map<string_pair_t, std::string>::iterator next = val_key;
                         ++next;
@@ -537,7 +543,7 @@ namespace Foundation
                             std::string value = val_key->second;
                             pConfiguration->setString(key, value);
                             // Remove old value. 
-                            values_.erase(val_key);
+                            values.erase(val_key);
                         }
                         val_key = next;
                     }
@@ -551,20 +557,16 @@ namespace Foundation
 
             }
 
-            values_ = tmp_values;
 
          }
          else if (group != "")
          {
             // Export data when given path is a file and group is diffrent then empty string.
             
-            // Create temporary map which contains all data.
-
-            std::map<string_pair_t, std::string> tmp_values = values_;
          
-            std::map<string_pair_t, std::string>::iterator val_iter = values_.begin();
+            std::map<string_pair_t, std::string>::iterator val_iter = values.begin();
             
-            if(val_iter != values_.end() )
+            if(val_iter != values.end() )
             { 
 
                 std::string search_group = group;
@@ -580,15 +582,14 @@ namespace Foundation
                 } catch ( std::exception& /*ex*/)
                 {
                     ///todo What to do if loading failed. 
-                    values_ = tmp_values;
                     return;
                 }
 
                 
                 // Go through all values which are still left and find all keys which belongs to given group. 
 
-                std::map<string_pair_t, std::string>::iterator val_key = values_.begin();
-                while(val_key != values_.end())
+                std::map<string_pair_t, std::string>::iterator val_key = values.begin();
+                while(val_key != values.end())
                 {
                     std::map<string_pair_t, std::string>::iterator next = val_key;
                     ++next;
@@ -601,7 +602,7 @@ namespace Foundation
                         std::string value = val_key->second;
                         pConfiguration->setString(key, value);
                         // Remove old value. 
-                        values_.erase(val_key);
+                        values.erase(val_key);
                     }
                     val_key = next;
                 }
@@ -613,13 +614,13 @@ namespace Foundation
                                 
             }
 
-            values_ = tmp_values;
          }
     }
 
     
    bool ConfigurationManager::HasKey(const std::string& group, const std::string& key) const
    {
+        RecursiveMutexLock lock(values_mutex_);
         std::map<string_pair_t, std::string>::iterator iter = values_.find(std::make_pair(group, key));
         if ( iter != values_.end() )    
             return true;
@@ -630,9 +631,52 @@ namespace Foundation
 
    void ConfigurationManager::Remove(const std::string& group, const std::string key)
    {
+        RecursiveMutexLock lock(values_mutex_);
         std::map<string_pair_t, std::string>::iterator iter = values_.find(std::make_pair(group, key));
         if ( iter != values_.end() )    
             values_.erase(iter);
        
    }
+
+   void ConfigurationManager::NotifySettingChanged(const std::string& group, const std::string& key, const std::string& value)
+   {
+        SettingValueMap::iterator iter = setting_values_.find(std::make_pair(group, key));
+        if (iter == setting_values_.end())
+            return;
+
+        for (size_t i = 0; i < iter->second.size(); ++i)
+            iter->second[i]->Update(value);
+   }
+
+   void ConfigurationManager::SaveAsync()
+   {
+        RecursiveMutexLock lock(values_mutex_);
+        save_pending_ = true;
+        if (saving_)
+            return;
+
+        // The previous save thread has finished, it clears saving_ just before it exits.
+        if (save_thread_)
+            save_thread_->join();
+        saving_ = true;
+        save_thread_.reset(new Thread(boost::bind(&ConfigurationManager::SaveThread, this)));
+   }
+
+   void ConfigurationManager::SaveThread()
+   {
+        for (;;)
+        {
+            {
+                RecursiveMutexLock lock(values_mutex_);
+                if (!save_pending_)
+                {
+                    saving_ = false;
+                    return;
+                }
+                save_pending_ = false;
+            }
+
+            Export();
+        }
+   }
 }
@@ -6,6 +6,8 @@
 //#include "StableHeaders.h"
 #include "boost/filesystem.hpp" 
 #include "Poco/Util/XMLConfiguration.h"
+#include "CoreThread.h"
+#include "ConfigurationSetting.h"
 
 namespace Foundation
 {
@@ -200,6 +202,28 @@ namespace Foundation
 
         bool HasKey(const std::string& group, const std::string& key) const; 
 
+        /**
+         * Declares a setting like @p DeclareSetting, and returns a typed handle to it. The handle caches the value,
+         * and is updated whenever the setting is changed with @p SetSetting or @p Load. Use handles for settings 
+         * which are read often.
+         * @code
+         *  Foundation::Setting<float> sensitivity = config_manager_.DeclareSettingHandle("Camera", "zoom_sensitivity", 0.015f);
+         *  // In per-frame code.
+         *  distance += wheel * sensitivity.Get();
+         * @endcode
+         * @param group is the name of Group. 
+         * @param key is the name of Key.
+         * @param defaultValue is value set if the setting doesn't exist.
+         * @throw In very special cases can throw boost::bad_lexical_cast. 
+         */
+        template <typename T> Setting<T> DeclareSettingHandle(const std::string& group, const std::string& key, const T& defaultValue);
+
+        /**
+         * Exports all settings in a background thread, without blocking the caller. If an export is already running,
+         * another one is made after it.
+         */
+        void SaveAsync();
+
     private:
             
     
@@ -214,6 +238,12 @@ namespace Foundation
 
         void AddValues(Poco::Util::XMLConfiguration* pConfiguration, const std::string& group);
 
+        //! Updates the setting handles of a changed setting. Called with values_mutex_ locked.
+        void NotifySettingChanged(const std::string& group, const std::string& key, const std::string& value);
+
+        //! Background thread function of SaveAsync.
+        void SaveThread();
+
         // Default configuration file path
         static const char* DEFAULT_CONFIG_PATH;
         
@@ -223,6 +253,22 @@ namespace Foundation
          // map of all values, for exporting
         mutable ValueMap values_;
 
+        // protects values_, settings may be declared by modules initialized in a worker thread
+        mutable RecursiveMutex values_mutex_;
+
+        typedef std::map<string_pair_t, std::vector<boost::shared_ptr<SettingValueBase> > > SettingValueMap;
+
+        // cached values of setting handles, protected by values_mutex_
+        SettingValueMap setting_values_;
+
+        // serializes writing configuration files
+        Mutex export_mutex_;
+
+        // background save thread, and its state protected by values_mutex_
+        boost::shared_ptr<Thread> save_thread_;
+        bool save_pending_;
+        bool saving_;
+
         boost::filesystem::path path_;
         Framework *framework_;
         std::string file_name_encoding_;
@@ -0,0 +1,92 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Foundation_ConfigurationSetting_h
+#define incl_Foundation_ConfigurationSetting_h
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace Foundation
+{
+    class ConfigurationManager;
+
+    //! Cached value of a setting, shared by all Setting handles of the same group, key and type
+    class SettingValueBase
+    {
+    public:
+        virtual ~SettingValueBase() {}
+
+        //! Parses a new text value of the setting. Keeps the old value if the text can't be converted
+        virtual void Update(const std::string &value) = 0;
+    };
+
+    //! Typed cached value of a setting
+    template <typename T> class SettingValue : public SettingValueBase
+    {
+    public:
+        explicit SettingValue(const T &value) : value_(value) {}
+
+        virtual void Update(const std::string &value)
+        {
+            try
+            {
+                value_ = boost::lexical_cast<T>(value);
+            }
+            catch (boost::bad_lexical_cast &)
+            {
+            }
+        }
+
+        T value_;
+    };
+
+    //! Typed handle to a setting of ConfigurationManager
+    /*! Obtain the handle once with ConfigurationManager::DeclareSettingHandle. Reading the value is then a plain load of
+        the cached value, instead of a locked map lookup and text conversion on every GetSetting call. The cached value
+        is updated whenever the setting changes through ConfigurationManager::SetSetting or Load.
+
+        \code
+        Foundation::Setting<bool> show_bubbles = config.DeclareSettingHandle("InWorldChatModule", "ShowChatBubbles", true);
+        ...
+        if (show_bubbles.Get())
+            ...
+        \endcode
+
+        \note The value is updated in the thread that changes the setting. Non-POD values, e.g. strings, should be read
+              only in that thread.
+     */
+    template <typename T> class Setting
+    {
+    public:
+        //! Constructs a null handle, which must not be read
+        Setting() : manager_(0) {}
+
+        //! Constructor, used by ConfigurationManager
+        Setting(ConfigurationManager *manager, const std::string &group, const std::string &key,
+            const boost::shared_ptr<SettingValue<T> > &value) :
+            manager_(manager), group_(group), key_(key), value_(value)
+        {
+        }
+
+        //! Returns the current value
+        const T &Get() const { return value_->value_; }
+
+        //! Changes the setting, and writes the configuration files in a background thread
+        void Set(const T &value);
+
+        //! Returns true if the handle is null
+        bool IsNull() const { return !value_; }
+
+        const std::string &GetGroup() const { return group_; }
+        const std::string &GetKey() const { return key_; }
+
+    private:
+        ConfigurationManager *manager_;
+        std::string group_;
+        std::string key_;
+        boost::shared_ptr<SettingValue<T> > value_;
+    };
+}
+
+#endif
@@ -39,6 +39,7 @@ namespace Foundation
     
     event_category_id_t EventManager::RegisterEventCategory(const std::string& name)
     {
+        MutexLock lock(registry_mutex_);
         if (event_category_map_.find(name) == event_category_map_.end())
         {
             event_category_map_[name] = next_category_id_;
@@ -55,6 +56,19 @@ namespace Foundation
     
     event_category_id_t EventManager::QueryEventCategory(const std::string& name, bool create)
     {
+        {
+            MutexLock lock(registry_mutex_);
+            EventCategoryMap::const_iterator i = event_category_map_.find(name);
+            if (i != event_category_map_.end())
+                return i->second;
+        }
+
+        // If loading of the module providing this category has been deferred until first use, load it now
+        ModuleManagerPtr module_manager = framework_->GetModuleManager();
+        if (module_manager)
+            module_manager->LoadDeferredModulesForEventCategory(name);
+
+        MutexLock lock(registry_mutex_);
         EventCategoryMap::const_iterator i = event_category_map_.find(name);
         if (i != event_category_map_.end())
             return i->second;
@@ -72,6 +86,7 @@ namespace Foundation
     
     const std::string& EventManager::QueryEventCategoryName(event_category_id_t category_id) const
     {
+        MutexLock lock(registry_mutex_);
         EventCategoryMap::const_iterator i = event_category_map_.begin();
         static std::string empty;
         
@@ -94,6 +109,7 @@ namespace Foundation
             return;
         }
         
+        MutexLock lock(registry_mutex_);
         if (event_map_[category_id].find(event_id) != event_map_[category_id].end())
             Foundation::RootLogWarning("Overwriting already registered event with " + name);
         else
@@ -192,6 +208,19 @@ namespace Foundation
             return false;
         }
         
+        // Modules initialized in a worker thread get events only after they have been initialized and the main thread
+        // has picked up the registration.
+        if (QThread::currentThreadId() != main_thread_id_)
+        {
+            EventSubscriber pending_subscriber;
+            pending_subscriber.module_ = module;
+            pending_subscriber.module_name_ = module_rawptr->Name();
+            pending_subscriber.priority_ = priority;
+            MutexLock lock(pending_subscribers_mutex_);
+            pending_subscribers_.push_back(pending_subscriber);
+            return true;
+        }
+        
         for (unsigned i = 0; i < subscribers_.size(); ++i)
         {
             // If module found, just readjust the priority
@@ -212,6 +241,18 @@ namespace Foundation
         return true;
     }
     
+    void EventManager::RegisterPendingEventSubscribers()
+    {
+        EventSubscriberVector pending_subscribers;
+        {
+            MutexLock lock(pending_subscribers_mutex_);
+            pending_subscribers.swap(pending_subscribers_);
+        }
+        
+        for (unsigned i = 0; i < pending_subscribers.size(); ++i)
+            RegisterEventSubscriber(pending_subscribers[i].module_, pending_subscribers[i].priority_);
+    }
+    
     bool EventManager::UnregisterEventSubscriber(ModuleInterface* module)
     {
         if (!module)
@@ -245,6 +286,7 @@ namespace Foundation
 
     request_tag_t EventManager::GetNextRequestTag()
     {
+        MutexLock lock(registry_mutex_);
         if (next_request_tag_ == 0) 
             ++next_request_tag_; // Never use 0
         return next_request_tag_++;
@@ -120,12 +120,17 @@ namespace Foundation
 
         //! Registers a module to the event subscriber list
         /*! Do not call while responding to an event! Note that it is ok to resubscribe your module to change priority.
+            If called from a thread other than the main thread, the module is subscribed only when the main thread
+            calls RegisterPendingEventSubscribers().
             \param module Module to register
             \param priority Priority. Higher priority = gets called first
             \return true if successfully subscribed
          */
         bool RegisterEventSubscriber(ModuleWeakPtr module, int priority);
 
+        //! Subscribes the modules that were registered from other threads. Called by the framework in the main thread.
+        void RegisterPendingEventSubscribers();
+
         //! Unregisters a module from the subscriber tree
         /*! Do not call while responding to an event!
             \param module Module to unregister
@@ -191,6 +196,15 @@ namespace Foundation
         //! Event subscribers
         EventSubscriberVector subscribers_;
         
+        //! Event subscribers registered from other threads, waiting to be added by the main thread
+        EventSubscriberVector pending_subscribers_;
+        
+        //! Mutex for pending event subscribers
+        Mutex pending_subscribers_mutex_;
+        
+        //! Mutex for event categories, events and request tags
+        mutable Mutex registry_mutex_;
+        
         //! Delayed events
         typedef std::vector<DelayedEvent> DelayedEventVector;
         DelayedEventVector new_delayed_events_;
@@ -35,6 +35,8 @@ namespace Foundation
     class ConfigurationManager;
     class ComponentInterface;
     class ThreadTaskManager;
+    class FrameScheduler;
+    class MetricsExporter;
     class Profiler;
     class Framework;
 
@@ -47,6 +49,8 @@ namespace Foundation
     typedef boost::shared_ptr<Platform> PlatformPtr;
     typedef boost::shared_ptr<Application> ApplicationPtr;
     typedef boost::shared_ptr<ThreadTaskManager> ThreadTaskManagerPtr;
+    typedef boost::shared_ptr<FrameScheduler> FrameSchedulerPtr;
+    typedef boost::shared_ptr<MetricsExporter> MetricsExporterPtr;
 
     typedef boost::shared_ptr<ComponentInterface> ComponentInterfacePtr;
     typedef boost::shared_ptr<ComponentInterface> ComponentPtr;
@@ -8,37 +8,57 @@
 
 namespace Foundation
 {
+    //! Returns the foundation logger. Looked up once, Poco::Logger::get() locks a global mutex.
+    static Poco::Logger &RootLogger()
+    {
+        static Poco::Logger *logger = 0;
+        if (!logger)
+        {
+            Poco::Logger &l = Poco::Logger::get("Foundation");
+            l.duplicate();
+            logger = &l;
+        }
+        return *logger;
+    }
+
     //! Use root logging only in foundation classes.
     void RootLogFatal(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").fatal("Fatal: " + msg);
+        if (RootLogger().fatal())
+            RootLogger().fatal("Fatal: " + msg);
     }
     void RootLogCritical(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").critical("Critical: " + msg);
+        if (RootLogger().critical())
+            RootLogger().critical("Critical: " + msg);
     }
     void RootLogError(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").error("Error: " + msg);
+        if (RootLogger().error())
+            RootLogger().error("Error: " + msg);
     }
     void RootLogWarning(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").warning("Warning: " + msg);
+        if (RootLogger().warning())
+            RootLogger().warning("Warning: " + msg);
     }
     void RootLogNotice(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").notice("Notice: " + msg);
+        if (RootLogger().notice())
+            RootLogger().notice("Notice: " + msg);
     }
     void RootLogInfo(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").information(msg);
+        RootLogger().information(msg);
     }
     void RootLogTrace(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").trace("Trace: " + msg);
+        if (RootLogger().trace())
+            RootLogger().trace("Trace: " + msg);
     }
     void RootLogDebug(const std::string &msg)
     {
-        Poco::Logger::get("Foundation").debug("Debug: " + msg);
+        if (RootLogger().debug())
+            RootLogger().debug("Debug: " + msg);
     }
 }
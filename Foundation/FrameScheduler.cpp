@@ -0,0 +1,132 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "FrameScheduler.h"
+#include "Profiler.h"
+
+namespace Foundation
+{
+    FrameScheduler::FrameScheduler(f64 budget) :
+        budget_(budget),
+        last_frame_time_(0.0),
+        next_id_(1),
+        running_id_(0),
+        running_canceled_(false)
+    {
+    }
+
+    FrameScheduler::~FrameScheduler()
+    {
+    }
+
+    frame_job_id_t FrameScheduler::Schedule(const std::string& name, FrameJob job, Priority priority)
+    {
+        if ((priority < 0) || (priority >= NumPriorities))
+            priority = PriorityNormal;
+
+        Job new_job;
+        new_job.id_ = next_id_++;
+        if (!next_id_)
+            next_id_ = 1;
+        new_job.name_ = name;
+        new_job.function_ = job;
+        jobs_[priority].push_back(new_job);
+        return new_job.id_;
+    }
+
+    bool FrameScheduler::Cancel(frame_job_id_t id)
+    {
+        if (!id)
+            return false;
+
+        if (id == running_id_)
+        {
+            running_canceled_ = true;
+            return true;
+        }
+
+        for(int i = 0; i < NumPriorities; ++i)
+        {
+            for(JobList::iterator j = jobs_[i].begin(); j != jobs_[i].end(); ++j)
+            {
+                if (j->id_ == id)
+                {
+                    jobs_[i].erase(j);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool FrameScheduler::IsScheduled(frame_job_id_t id) const
+    {
+        if (!id)
+            return false;
+        if (id == running_id_)
+            return !running_canceled_;
+
+        for(int i = 0; i < NumPriorities; ++i)
+            for(JobList::const_iterator j = jobs_[i].begin(); j != jobs_[i].end(); ++j)
+                if (j->id_ == id)
+                    return true;
+
+        return false;
+    }
+
+    void FrameScheduler::RunJobs()
+    {
+        Core::tick_t start = Core::GetCurrentClockTime();
+        FrameBudget budget(start + (Core::tick_t)(budget_ * Core::GetCurrentClockFreq()));
+        bool first = true;
+
+        for(int i = 0; i < NumPriorities; ++i)
+        {
+            // Give each job that was scheduled before this round one slice. Jobs scheduled by the slices wait for the next frame
+            JobList& jobs = jobs_[i];
+            size_t num_jobs = jobs.size();
+            for(size_t j = 0; (j < num_jobs) && (!jobs.empty()); ++j)
+            {
+                if ((!first) && (budget.IsExceeded()))
+                    break;
+                first = false;
+
+                // Take the job out while it runs, so that it may schedule & cancel jobs freely
+                Job job = jobs.front();
+                jobs.pop_front();
+                running_id_ = job.id_;
+                running_canceled_ = false;
+
+                bool more = false;
+                {
+                    PROFILE(FrameScheduler_RunJob);
+                    more = job.function_(budget);
+                }
+
+                if ((more) && (!running_canceled_))
+                    jobs.push_back(job);
+                running_id_ = 0;
+            }
+        }
+
+        last_frame_time_ = (f64)(Core::GetCurrentClockTime() - start) / (f64)Core::GetCurrentClockFreq();
+    }
+
+    uint FrameScheduler::GetNumJobs() const
+    {
+        uint num_jobs = 0;
+        for(int i = 0; i < NumPriorities; ++i)
+            num_jobs += jobs_[i].size();
+        return num_jobs;
+    }
+
+    StringVector FrameScheduler::GetJobNames() const
+    {
+        StringVector names;
+        for(int i = 0; i < NumPriorities; ++i)
+            for(JobList::const_iterator j = jobs_[i].begin(); j != jobs_[i].end(); ++j)
+                names.push_back(j->name_);
+        return names;
+    }
+}
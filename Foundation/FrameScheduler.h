@@ -0,0 +1,155 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Foundation_FrameScheduler_h
+#define incl_Foundation_FrameScheduler_h
+
+#include "CoreTypes.h"
+#include "HighPerfClock.h"
+
+#include <boost/function.hpp>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace Foundation
+{
+    //! Time left for frame jobs in the current frame. Given to each job slice by FrameScheduler
+    class FrameBudget
+    {
+    public:
+        //! Constructor
+        /*! \param deadline clock time at which the budget runs out, see Core::GetCurrentClockTime()
+         */
+        explicit FrameBudget(Core::tick_t deadline) : deadline_(deadline) {}
+
+        //! Returns true if the budget has run out. Jobs should check this between units of work and return when true
+        bool IsExceeded() const { return Core::GetCurrentClockTime() >= deadline_; }
+
+        //! Returns time left in seconds, 0 if exceeded
+        f64 GetTimeLeft() const
+        {
+            Core::tick_t now = Core::GetCurrentClockTime();
+            if (now >= deadline_)
+                return 0.0;
+            return (f64)(deadline_ - now) / (f64)Core::GetCurrentClockFreq();
+        }
+
+    private:
+        //! Clock time at which the budget runs out
+        Core::tick_t deadline_;
+    };
+
+    //! A resumable main-thread job. Does work until done or the budget has run out
+    /*! \return true if the job has more work and should be run again next frame, false if it is done
+     */
+    typedef boost::function<bool (const FrameBudget&)> FrameJob;
+
+    //! Identifier of a scheduled frame job. 0 is never used
+    typedef uint frame_job_id_t;
+
+    //! Runs deferred main-thread work of modules within a time budget per frame
+    /*! Modules schedule resumable jobs, e.g. creating resources or regenerating geometry, instead of
+        doing all such work in their Update() with ad-hoc limits. The framework runs the jobs once per
+        frame, after module updates and events, until the frame budget is used up. This keeps the frame
+        time stable while lots of work arrives at once, as when entering a region.
+
+        Each job gets at most one slice per frame. Higher priority jobs run first, and jobs of the same
+        priority take turns, so that the job that was left without a slice runs first on the next frame.
+        The first slice of a frame always runs, even with no budget left, so that jobs can not stall.
+
+        Only use from the main thread.
+
+        \ingroup Foundation_group
+     */
+    class FrameScheduler
+    {
+    public:
+        //! Job priorities
+        enum Priority
+        {
+            //! Work the user is waiting on, e.g. what is in view
+            PriorityHigh = 0,
+            PriorityNormal,
+            //! Work that can wait, e.g. cache maintenance
+            PriorityLow,
+            NumPriorities
+        };
+
+        //! Constructor
+        /*! \param budget time per frame for jobs, in seconds
+         */
+        explicit FrameScheduler(f64 budget);
+
+        //! Destructor
+        ~FrameScheduler();
+
+        //! Schedules a job
+        /*! \param name job name, for profiling and debugging
+            \param job job function
+            \param priority priority
+            \return job id
+         */
+        frame_job_id_t Schedule(const std::string& name, FrameJob job, Priority priority = PriorityNormal);
+
+        //! Cancels a job. May be called from a job, also for the job itself
+        /*! \param id job id
+            \return true if the job was scheduled
+         */
+        bool Cancel(frame_job_id_t id);
+
+        //! Returns true if a job is scheduled
+        bool IsScheduled(frame_job_id_t id) const;
+
+        //! Runs jobs until the frame budget is used up. Called by the framework once per frame
+        void RunJobs();
+
+        //! Sets the time per frame for jobs
+        /*! \param budget budget in seconds
+         */
+        void SetBudget(f64 budget) { budget_ = budget; }
+
+        //! Returns the time per frame for jobs, in seconds
+        f64 GetBudget() const { return budget_; }
+
+        //! Returns number of scheduled jobs
+        uint GetNumJobs() const;
+
+        //! Returns time spent in jobs on the last frame, in seconds
+        f64 GetLastFrameTime() const { return last_frame_time_; }
+
+        //! Returns names of the scheduled jobs, by priority
+        StringVector GetJobNames() const;
+
+    private:
+        //! A scheduled job
+        struct Job
+        {
+            frame_job_id_t id_;
+            std::string name_;
+            FrameJob function_;
+        };
+
+        typedef std::list<Job> JobList;
+
+        //! Jobs by priority, in the order they get their next slice
+        JobList jobs_[NumPriorities];
+
+        //! Time per frame for jobs, in seconds
+        f64 budget_;
+
+        //! Time spent in jobs on the last frame, in seconds
+        f64 last_frame_time_;
+
+        //! Next job id
+        frame_job_id_t next_id_;
+
+        //! Id of the job running now, 0 if none
+        frame_job_id_t running_id_;
+
+        //! Whether the running job was canceled while running
+        bool running_canceled_;
+    };
+}
+
+#endif
@@ -16,12 +16,16 @@
 #include "SceneEvents.h"
 #include "ResourceInterface.h"
 #include "ThreadTaskManager.h"
+#include "FrameScheduler.h"
+#include "MetricsExporter.h"
 #include "RenderServiceInterface.h"
 #include "ConsoleServiceInterface.h"
 #include "ConsoleCommandServiceInterface.h"
 #include "FrameworkQtApplication.h"
 #include "CoreException.h"
 #include "InputServiceInterface.h"
+#include "AsyncLogChannel.h"
+#include "MathBatch.h"
 
 #include <Poco/Logger.h>
 #include <Poco/LoggingFactory.h>
@@ -30,6 +34,8 @@
 #include <Poco/Path.h>
 #include <Poco/UnicodeConverter.h>
 
+#include <sstream>
+
 #include <QApplication>
 #include <QGraphicsView>
 #include <QIcon>
@@ -68,7 +74,8 @@ namespace Foundation
         argv_(argv),
         initialized_(false),
         log_formatter_(0),
-        splitterchannel(0)
+        splitterchannel(0),
+        async_log_channel_(0)
     {
         ParseProgramOptions();
         if (cm_options_.count("help")) 
@@ -115,10 +122,14 @@ namespace Foundation
             // create managers
             module_manager_ = ModuleManagerPtr(new ModuleManager(this));
             component_manager_ = ComponentManagerPtr(new ComponentManager(this));
-            service_manager_ = ServiceManagerPtr(new ServiceManager());
+            service_manager_ = ServiceManagerPtr(new ServiceManager(this));
             event_manager_ = EventManagerPtr(new EventManager(this));
             thread_task_manager_ = ThreadTaskManagerPtr(new ThreadTaskManager(this));
 
+            int frame_job_budget_ms = config_manager_->DeclareSetting(Framework::ConfigurationGroup(), std::string("frame_job_budget_ms"), 5);
+            frame_scheduler_ = FrameSchedulerPtr(new FrameScheduler(frame_job_budget_ms / 1000.0));
+            metrics_exporter_ = MetricsExporterPtr(new MetricsExporter(this));
+
             Scene::Events::RegisterSceneEvents(event_manager_);
             Resource::Events::RegisterResourceEvents(event_manager_);
             Task::Events::RegisterTaskEvents(event_manager_);
@@ -132,7 +143,9 @@ namespace Foundation
     Framework::~Framework()
     {
         engine_.reset();
+        metrics_exporter_.reset();
         thread_task_manager_.reset();
+        frame_scheduler_.reset();
         event_manager_.reset();
         service_manager_.reset();
         component_manager_.reset();
@@ -141,6 +154,10 @@ namespace Foundation
         platform_.reset();
         application_.reset();
 
+        // Write out queued messages while the channels are still alive. Later messages are written synchronously.
+        if (async_log_channel_)
+            async_log_channel_->close();
+
         Poco::Logger::shutdown();
 
         for (size_t i=0 ; i<log_channels_.size() ; ++i)
@@ -182,9 +199,12 @@ namespace Foundation
         log_formatter_->setProperty("times","local");
         Poco::Channel *formatchannel = new Poco::FormattingChannel(log_formatter_,splitterchannel);
 
+        // Formatting and writing to console and file is done in a background thread
+        async_log_channel_ = new AsyncLogChannel(formatchannel);
+
         try
         {
-            Poco::Logger::create("",formatchannel,Poco::Message::PRIO_TRACE);
+            Poco::Logger::create("",async_log_channel_,Poco::Message::PRIO_TRACE);
             Poco::Logger::create("Foundation",Poco::Logger::root().getChannel() ,Poco::Message::PRIO_TRACE);
         }
         catch (Poco::ExistsException &/*e*/)
@@ -209,11 +229,15 @@ namespace Foundation
         Poco::Logger::get("Foundation").setLevel(log_level);
 #endif
 
+        // The first message was written synchronously, so a log file that can't be opened is noticed above
+        async_log_channel_->open();
+
         if (consolechannel)
             log_channels_.push_back(consolechannel);
         log_channels_.push_back(filechannel);
         log_channels_.push_back(splitterchannel);
         log_channels_.push_back(formatchannel);
+        log_channels_.push_back(async_log_channel_);
 
         SAFE_DELETE(loggingfactory);
     }
@@ -283,6 +307,8 @@ namespace Foundation
             double frametime = timer.elapsed();
             
             timer.restart();
+            metrics_exporter_->Update(frametime);
+
             // do synchronized update for modules
             {
                 PROFILE(FW_UpdateModules);
@@ -301,6 +327,12 @@ namespace Foundation
                 event_manager_->ProcessDelayedEvents(frametime);
             }
 
+            // run deferred main-thread work within the frame budget
+            {
+                PROFILE(FW_RunFrameJobs);
+                frame_scheduler_->RunJobs();
+            }
+
             // if we have a renderer service, render now
             boost::weak_ptr<Foundation::RenderServiceInterface> renderer = 
                         service_manager_->GetService<RenderServiceInterface>(Service::ST_Renderer);
@@ -451,6 +483,114 @@ namespace Foundation
         return Console::ResultSuccess();
     }
 
+    Console::CommandResult Framework::ConsoleStartupTimes(const StringVector &params)
+    {
+        boost::shared_ptr<Console::ConsoleServiceInterface> console = GetService<Console::ConsoleServiceInterface>(Foundation::Service::ST_Console).lock();
+        if (console)
+        {
+            StringVector lines = module_manager_->GetStartupReport();
+            for(size_t i = 0 ; i < lines.size() ; ++i)
+                console->Print(lines[i]);
+        }
+
+        return Console::ResultSuccess();
+    }
+
+    Console::CommandResult Framework::ConsoleSpatialIndexBenchmark(const StringVector &params)
+    {
+        std::vector<uint> entity_counts;
+        uint num_queries = 1000;
+        try
+        {
+            if (params.size() > 0)
+                entity_counts.push_back(ParseString<uint>(params[0]));
+            if (params.size() > 1)
+                num_queries = ParseString<uint>(params[1]);
+        }
+        catch (std::exception &)
+        {
+            return Console::ResultFailure("Usage: SpatialIndexBenchmark(entities,queries)");
+        }
+
+        if (entity_counts.empty())
+        {
+            entity_counts.push_back(10000);
+            entity_counts.push_back(100000);
+        }
+
+        boost::shared_ptr<Console::ConsoleServiceInterface> console = GetService<Console::ConsoleServiceInterface>(Foundation::Service::ST_Console).lock();
+        if (console)
+        {
+            for(size_t i = 0 ; i < entity_counts.size() ; ++i)
+                console->Print(Scene::BenchmarkSpatialIndex(entity_counts[i], num_queries));
+        }
+
+        return Console::ResultSuccess();
+    }
+
+    Console::CommandResult Framework::ConsoleMathBenchmark(const StringVector &params)
+    {
+        uint count = 100000;
+        try
+        {
+            if (params.size() > 0)
+                count = ParseString<uint>(params[0]);
+        }
+        catch (std::exception &)
+        {
+            return Console::ResultFailure("Usage: MathBenchmark(count)");
+        }
+
+        return Console::ResultSuccess(BenchmarkMath(count));
+    }
+
+    Console::CommandResult Framework::ConsoleTaskPoolStats(const StringVector &params)
+    {
+        TaskPoolPtr pool = thread_task_manager_->GetTaskPool();
+        if ((params.size() > 0) && (params[0] == "reset"))
+        {
+            pool->ResetStats();
+            return Console::ResultSuccess("Task pool stats reset");
+        }
+        if (params.size() > 0)
+            return Console::ResultFailure("Usage: TaskPoolStats() or TaskPoolStats(reset)");
+
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(3);
+        text << "Threads " << pool->GetNumThreads() << ", queued tasks " << pool->GetQueueDepth() << " (max " << 
+            pool->GetMaxQueueDepth() << "), steals " << pool->GetNumSteals() << std::endl;
+
+        // Times in milliseconds
+        std::map<std::string, PoolTaskStats> stats = pool->GetStats();
+        for(std::map<std::string, PoolTaskStats>::const_iterator i = stats.begin(); i != stats.end(); ++i)
+        {
+            const PoolTaskStats& s = i->second;
+            text << i->first << ": tasks " << s.tasks_ << 
+                ", wait avg " << (s.tasks_ ? s.total_wait_ * 1000.0 / s.tasks_ : 0.0) << " max " << s.max_wait_ * 1000.0 << 
+                ", run avg " << (s.tasks_ ? s.total_run_ * 1000.0 / s.tasks_ : 0.0) << " max " << s.max_run_ * 1000.0 << std::endl;
+        }
+
+        std::vector<ThreadTaskPtr> tasks = thread_task_manager_->GetThreadTasks();
+        for(size_t i = 0; i < tasks.size(); ++i)
+        {
+            text << "Thread task " << tasks[i]->GetTaskDescription() << (tasks[i]->IsPooled() ? " (pooled)" : "") << 
+                ": queued requests " << tasks[i]->GetNumRequests() << std::endl;
+        }
+
+        return Console::ResultSuccess(text.str());
+    }
+
+    Console::CommandResult Framework::ConsoleMetrics(const StringVector &params)
+    {
+        if (!metrics_exporter_->IsEnabled())
+            return Console::ResultFailure("Metrics export is disabled, set enabled to true in the Metrics group of the config to enable");
+        if (metrics_exporter_->GetLastSample().empty())
+            return Console::ResultSuccess("No metrics sample taken yet");
+
+        return Console::ResultSuccess(metrics_exporter_->GetLastSample());
+    }
+
     Console::CommandResult Framework::ConsoleSendEvent(const StringVector &params)
     {
         if (params.size() != 2)
@@ -578,6 +718,29 @@ namespace Foundation
                 "Lists all loaded modules.", 
                 Console::Bind(this, &Framework::ConsoleListModules)));
 
+            console->RegisterCommand(Console::CreateCommand("StartupTimes", 
+                "Shows the startup timeline: time spent in loading and initializing each module, and modules deferred until first use.", 
+                Console::Bind(this, &Framework::ConsoleStartupTimes)));
+
+            console->RegisterCommand(Console::CreateCommand("SpatialIndexBenchmark", 
+                "Times scene spatial index queries against testing all entities. Usage: SpatialIndexBenchmark(entities,queries), "
+                "by default for 10000 and 100000 entities", 
+                Console::Bind(this, &Framework::ConsoleSpatialIndexBenchmark)));
+
+            console->RegisterCommand(Console::CreateCommand("MathBenchmark", 
+                "Times the transform math, the scalar code against the code in use, and shows the largest differences of the results. "
+                "Usage: MathBenchmark(count), by default for 100000 elements", 
+                Console::Bind(this, &Framework::ConsoleMathBenchmark)));
+
+            console->RegisterCommand(Console::CreateCommand("TaskPoolStats", 
+                "Shows the task pool queue depth, and the wait and run times of pool tasks in milliseconds by name. "
+                "Usage: TaskPoolStats(), or TaskPoolStats(reset) to clear the stats", 
+                Console::Bind(this, &Framework::ConsoleTaskPoolStats)));
+
+            console->RegisterCommand(Console::CreateCommand("Metrics", 
+                "Shows the last sample of the exported frame time and subsystem metrics.", 
+                Console::Bind(this, &Framework::ConsoleMetrics)));
+
             console->RegisterCommand(Console::CreateCommand("SendEvent", 
                 "Sends an internal event. Only for events that contain no data. Usage: SendEvent(event category name, event id)", 
                 Console::Bind(this, &Framework::ConsoleSendEvent)));
@@ -650,6 +813,16 @@ namespace Foundation
         return thread_task_manager_;
     }
 
+    FrameSchedulerPtr Framework::GetFrameScheduler()
+    {
+        return frame_scheduler_;
+    }
+
+    MetricsExporterPtr Framework::GetMetricsExporter()
+    {
+        return metrics_exporter_;
+    }
+
     ConfigurationManager &Framework::GetDefaultConfig()
     {
         return *(config_manager_.get());
@@ -33,6 +33,7 @@ namespace Foundation
     class FrameworkQtApplication;
     class KeyStateListener;
     class MainWindow;
+    class AsyncLogChannel;
 
     //! contains entry point for the framework.
     /*! Allows access to various managers and services. The standard way of using
@@ -103,6 +104,12 @@ namespace Foundation
         //! Returns thread task manager.
         ThreadTaskManagerPtr GetThreadTaskManager();
 
+        //! Returns the scheduler of deferred main-thread work.
+        FrameSchedulerPtr GetFrameScheduler();
+
+        //! Returns the exporter of frame time and subsystem metrics.
+        MetricsExporterPtr GetMetricsExporter();
+
         //! Signal the framework to exit
         void Exit();
 
@@ -196,6 +203,21 @@ namespace Foundation
         //! List all loaded modules
         Console::CommandResult ConsoleListModules(const StringVector &params);
 
+        //! Print module startup timeline
+        Console::CommandResult ConsoleStartupTimes(const StringVector &params);
+
+        //! Time spatial index queries of synthetic scenes
+        Console::CommandResult ConsoleSpatialIndexBenchmark(const StringVector &params);
+
+        //! Time and check the scalar and SIMD transform math
+        Console::CommandResult ConsoleMathBenchmark(const StringVector &params);
+
+        //! Show task pool queue depth and task latencies
+        Console::CommandResult ConsoleTaskPoolStats(const StringVector &params);
+
+        //! Show the last exported metrics sample
+        Console::CommandResult ConsoleMetrics(const StringVector &params);
+
         //! send event
         Console::CommandResult ConsoleSendEvent(const StringVector &params);
 
@@ -285,6 +307,12 @@ namespace Foundation
         //! Thread task manager.
         ThreadTaskManagerPtr thread_task_manager_;
 
+        //! Scheduler of deferred main-thread work
+        FrameSchedulerPtr frame_scheduler_;
+
+        //! Exporter of frame time and subsystem metrics
+        MetricsExporterPtr metrics_exporter_;
+
         //! default configuration
         ConfigurationManagerPtr config_manager_;
 
@@ -330,6 +358,9 @@ namespace Foundation
 
         //! Sends log prints for multiple channels.
         Poco::SplitterChannel *splitterchannel;
+
+        //! Writes log messages to the formatting channel from a background thread.
+        AsyncLogChannel *async_log_channel_;
     };
 
     namespace
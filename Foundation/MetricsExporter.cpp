@@ -0,0 +1,338 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "MetricsExporter.h"
+#include "Framework.h"
+#include "ConfigurationManager.h"
+#include "ModuleManager.h"
+#include "ModuleInterface.h"
+#include "ThreadTaskManager.h"
+#include "FrameScheduler.h"
+#include "TaskPool.h"
+#include "Platform.h"
+
+#include <Poco/Path.h>
+#include <Poco/Net/ServerSocket.h>
+#include <Poco/Net/StreamSocket.h>
+#include <Poco/Net/SocketAddress.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <ctime>
+#include <sstream>
+
+// Writing to a client that has disconnected must not raise SIGPIPE, which would terminate the viewer
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+namespace Foundation
+{
+    //! Upper limits of the frame time histogram buckets in milliseconds. The last bucket has the longer frames
+    static const uint FRAME_TIME_BUCKETS[] = { 8, 16, 33, 50, 100, 250 };
+    static const uint NUM_FRAME_TIME_BUCKETS = sizeof(FRAME_TIME_BUCKETS) / sizeof(FRAME_TIME_BUCKETS[0]);
+
+    //! Formats a value, counters without decimals
+    static std::string FormatValue(f64 value)
+    {
+        std::ostringstream str;
+        if ((value == floor(value)) && (fabs(value) < 1e15))
+            str << (long long)value;
+        else
+        {
+            str.setf(std::ios::fixed);
+            str.precision(3);
+            str << value;
+        }
+        return str.str();
+    }
+
+    MetricsExporter::MetricsExporter(Framework *framework) :
+        framework_(framework),
+        enabled_(false),
+        interval_(10.0),
+        time_since_sample_(0.0),
+        file_max_size_(0),
+        next_id_(1),
+        frame_histogram_(NUM_FRAME_TIME_BUCKETS + 1, 0),
+        frames_(0),
+        frame_time_total_(0.0),
+        frame_time_max_(0.0)
+    {
+        const std::string group("Metrics");
+        ConfigurationManager& config = framework_->GetDefaultConfig();
+        enabled_ = config.DeclareSetting<bool>(group, "enabled", false);
+        int interval = config.DeclareSetting<int>(group, "interval_sec", 10);
+        prefix_ = config.DeclareSetting<std::string>(group, "prefix", "naali");
+        std::string file = config.DeclareSetting<std::string>(group, "file", "metrics.log");
+        int file_max_kb = config.DeclareSetting<int>(group, "file_max_kb", 10240);
+        int port = config.DeclareSetting<int>(group, "port", 0);
+
+        if (!enabled_)
+            return;
+
+        interval_ = interval > 0 ? interval : 1;
+        file_max_size_ = file_max_kb > 0 ? file_max_kb * 1024 : 0;
+        if (!prefix_.empty())
+            prefix_ += ".";
+
+        // Relative paths are in the application data directory
+        if (!file.empty())
+        {
+            if (Poco::Path(file).isAbsolute())
+                file_path_ = file;
+            else
+                file_path_ = framework_->GetPlatform()->GetApplicationDataDirectory() + "/" + file;
+            OpenFile();
+        }
+
+        if (port > 0)
+        {
+            try
+            {
+                server_ = boost::shared_ptr<Poco::Net::ServerSocket>(new Poco::Net::ServerSocket(
+                    Poco::Net::SocketAddress("127.0.0.1", (Poco::UInt16)port)));
+            }
+            catch(Poco::Exception& e)
+            {
+                RootLogError("Could not listen for metrics clients on port " + ToString(port) + ": " + e.displayText());
+                server_.reset();
+            }
+        }
+
+        RootLogInfo("Exporting metrics every " + ToString(interval_) + " seconds" +
+            (file_path_.empty() ? std::string() : " to " + file_path_) +
+            (server_ ? " on port " + ToString(port) : std::string()));
+    }
+
+    MetricsExporter::~MetricsExporter()
+    {
+        clients_.clear();
+        server_.reset();
+        if (file_.is_open())
+            file_.close();
+    }
+
+    metric_source_id_t MetricsExporter::RegisterSource(const std::string& name, MetricSource source)
+    {
+        Source new_source;
+        new_source.id_ = next_id_++;
+        if (!next_id_)
+            next_id_ = 1;
+        new_source.name_ = SanitizeName(name);
+        new_source.function_ = source;
+        sources_.push_back(new_source);
+        return new_source.id_;
+    }
+
+    bool MetricsExporter::UnregisterSource(metric_source_id_t id)
+    {
+        for(std::vector<Source>::iterator i = sources_.begin(); i != sources_.end(); ++i)
+        {
+            if (i->id_ == id)
+            {
+                sources_.erase(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void MetricsExporter::Update(f64 frametime)
+    {
+        if (!enabled_)
+            return;
+
+        uint bucket = 0;
+        f64 frametime_ms = frametime * 1000.0;
+        while ((bucket < NUM_FRAME_TIME_BUCKETS) && (frametime_ms > FRAME_TIME_BUCKETS[bucket]))
+            ++bucket;
+        ++frame_histogram_[bucket];
+        ++frames_;
+        frame_time_total_ += frametime;
+        if (frametime > frame_time_max_)
+            frame_time_max_ = frametime;
+
+        time_since_sample_ += frametime;
+        if (time_since_sample_ < interval_)
+            return;
+
+        PROFILE(MetricsExporter_Sample);
+        MetricValues values;
+        CollectValues(values);
+        Export(values);
+        ResetFrameStats();
+    }
+
+    void MetricsExporter::CollectValues(MetricValues& values)
+    {
+        // Frame times of the interval
+        values.push_back(std::make_pair("frame.count", (f64)frames_));
+        values.push_back(std::make_pair("frame.fps", time_since_sample_ > 0.0 ? frames_ / time_since_sample_ : 0.0));
+        values.push_back(std::make_pair("frame.time_avg_ms", frames_ ? frame_time_total_ * 1000.0 / frames_ : 0.0));
+        values.push_back(std::make_pair("frame.time_max_ms", frame_time_max_ * 1000.0));
+        for(uint i = 0; i < NUM_FRAME_TIME_BUCKETS; ++i)
+            values.push_back(std::make_pair("frame.time_le_" + ToString(FRAME_TIME_BUCKETS[i]) + "ms", (f64)frame_histogram_[i]));
+        values.push_back(std::make_pair("frame.time_over_" + ToString(FRAME_TIME_BUCKETS[NUM_FRAME_TIME_BUCKETS - 1]) + "ms",
+            (f64)frame_histogram_[NUM_FRAME_TIME_BUCKETS]));
+
+        // Module update times per frame in the interval. A reloaded module starts its total from zero
+        const ModuleManager::ModuleVector& modules = framework_->GetModuleManager()->GetModuleList();
+        for(size_t i = 0; i < modules.size(); ++i)
+        {
+            std::string name = SanitizeName(modules[i].module_->Name());
+            f64 total = modules[i].update_time_;
+            f64& last = last_module_times_[name];
+            f64 time = total >= last ? total - last : total;
+            last = total;
+            values.push_back(std::make_pair("module." + name + ".update_ms", frames_ ? time * 1000.0 / frames_ : 0.0));
+        }
+
+        // Queues of threaded work
+        ThreadTaskManagerPtr thread_task_manager = framework_->GetThreadTaskManager();
+        TaskPoolPtr pool = thread_task_manager->GetTaskPool();
+        values.push_back(std::make_pair("taskpool.threads", (f64)pool->GetNumThreads()));
+        values.push_back(std::make_pair("taskpool.queue_depth", (f64)pool->GetQueueDepth()));
+        values.push_back(std::make_pair("taskpool.max_queue_depth", (f64)pool->GetMaxQueueDepth()));
+        values.push_back(std::make_pair("taskpool.steals", (f64)pool->GetNumSteals()));
+
+        std::vector<ThreadTaskPtr> tasks = thread_task_manager->GetThreadTasks();
+        for(size_t i = 0; i < tasks.size(); ++i)
+        {
+            std::string name = "threadtask." + SanitizeName(tasks[i]->GetTaskDescription());
+            values.push_back(std::make_pair(name + ".requests", (f64)tasks[i]->GetNumRequests()));
+            values.push_back(std::make_pair(name + ".results", (f64)tasks[i]->GetNumQueuedResults()));
+        }
+
+        FrameSchedulerPtr frame_scheduler = framework_->GetFrameScheduler();
+        values.push_back(std::make_pair("framejobs.count", (f64)frame_scheduler->GetNumJobs()));
+        values.push_back(std::make_pair("framejobs.time_ms", frame_scheduler->GetLastFrameTime() * 1000.0));
+
+        values.push_back(std::make_pair("memory.process_bytes", (f64)framework_->GetPlatform()->GetProcessMemoryUsage()));
+
+        for(size_t i = 0; i < sources_.size(); ++i)
+        {
+            MetricValues source_values;
+            sources_[i].function_(source_values);
+            for(size_t j = 0; j < source_values.size(); ++j)
+                values.push_back(std::make_pair(sources_[i].name_ + "." + SanitizeName(source_values[j].first), source_values[j].second));
+        }
+    }
+
+    void MetricsExporter::Export(const MetricValues& values)
+    {
+        std::string timestamp = ToString((long long)time(0));
+        std::string text;
+        for(size_t i = 0; i < values.size(); ++i)
+            text += prefix_ + values[i].first + " " + FormatValue(values[i].second) + " " + timestamp + "\n";
+        last_sample_ = text;
+
+        if (file_.is_open())
+        {
+            file_ << text;
+            file_.flush();
+            RotateFile();
+        }
+
+        if (server_)
+        {
+            AcceptClients();
+            SendToClients(text);
+        }
+    }
+
+    void MetricsExporter::OpenFile()
+    {
+        file_.open(file_path_.c_str(), std::ios::out | std::ios::app);
+        if (!file_.is_open())
+            RootLogError("Could not open metrics file " + file_path_);
+    }
+
+    void MetricsExporter::RotateFile()
+    {
+        if ((!file_max_size_) || ((uint)file_.tellp() < file_max_size_))
+            return;
+
+        file_.close();
+        try
+        {
+            boost::filesystem::path path(file_path_);
+            boost::filesystem::path backup(file_path_ + ".1");
+            if (boost::filesystem::exists(backup))
+                boost::filesystem::remove(backup);
+            boost::filesystem::rename(path, backup);
+        }
+        catch(std::exception& e)
+        {
+            RootLogError("Could not rotate metrics file " + file_path_ + ": " + e.what());
+        }
+        OpenFile();
+    }
+
+    void MetricsExporter::AcceptClients()
+    {
+        try
+        {
+            while(server_->poll(Poco::Timespan(0), Poco::Net::Socket::SELECT_READ))
+            {
+                boost::shared_ptr<Poco::Net::StreamSocket> client(new Poco::Net::StreamSocket(server_->acceptConnection()));
+                // Never wait for a client, one that does not keep up is dropped
+                client->setBlocking(false);
+#ifdef SO_NOSIGPIPE
+                // No MSG_NOSIGNAL on Mac OS X, there the socket option is used instead
+                client->setOption(SOL_SOCKET, SO_NOSIGPIPE, 1);
+#endif
+                clients_.push_back(client);
+            }
+        }
+        catch(Poco::Exception& e)
+        {
+            RootLogWarning("Could not accept metrics client: " + e.displayText());
+        }
+    }
+
+    void MetricsExporter::SendToClients(const std::string& text)
+    {
+        std::list<boost::shared_ptr<Poco::Net::StreamSocket> >::iterator i = clients_.begin();
+        while(i != clients_.end())
+        {
+            bool sent = false;
+            try
+            {
+                sent = (*i)->sendBytes(text.data(), text.size(), SEND_FLAGS) == (int)text.size();
+            }
+            catch(Poco::Exception&)
+            {
+            }
+
+            if (sent)
+                ++i;
+            else
+                i = clients_.erase(i);
+        }
+    }
+
+    void MetricsExporter::ResetFrameStats()
+    {
+        std::fill(frame_histogram_.begin(), frame_histogram_.end(), 0);
+        frames_ = 0;
+        frame_time_total_ = 0.0;
+        frame_time_max_ = 0.0;
+        time_since_sample_ = 0.0;
+    }
+
+    std::string MetricsExporter::SanitizeName(const std::string& name)
+    {
+        std::string sanitized(name);
+        for(size_t i = 0; i < sanitized.size(); ++i)
+        {
+            char c = sanitized[i];
+            if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'))
+                sanitized[i] = '_';
+        }
+        return sanitized;
+    }
+}
@@ -0,0 +1,187 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Foundation_MetricsExporter_h
+#define incl_Foundation_MetricsExporter_h
+
+#include "CoreTypes.h"
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Poco
+{
+    namespace Net
+    {
+        class ServerSocket;
+        class StreamSocket;
+    }
+}
+
+namespace Foundation
+{
+    class Framework;
+
+    //! Named values of a metrics sample
+    typedef std::vector<std::pair<std::string, f64> > MetricValues;
+
+    //! Adds the current values of a module's metrics. Called in the main thread when a sample is taken
+    /*! Names are relative to the name of the source, e.g. "hits" of source "assetcache" is exported as "assetcache.hits".
+     */
+    typedef boost::function<void (MetricValues&)> MetricSource;
+
+    //! Identifier of a registered metrics source. 0 is never used
+    typedef uint metric_source_id_t;
+
+    //! Samples frame time and subsystem metrics periodically and exports them for monitoring
+    /*! Meant for viewers that run unattended, where the profiler window is not available. Each sample is
+        written as lines of "prefix.name value timestamp", timestamp in seconds since the epoch, the
+        plaintext format of Graphite and compatible collectors. Samples are appended to a file, which is
+        rotated when it grows too big, and sent to clients connected to a TCP port on the loopback interface.
+
+        The framework samples frame times, module update times, task queue depths, frame jobs and process
+        memory usage. Modules add their own metrics, e.g. network traffic or cache hits, with RegisterSource().
+        Counters that modules keep, such as bytes sent, are exported as running totals.
+
+        Configured in the "Metrics" group of the default config. When disabled, which is the default, the
+        exporter does nothing. When enabled, the per-frame cost is a histogram update; the sources are only
+        called when a sample is taken.
+
+        Only use from the main thread.
+
+        \ingroup Foundation_group
+     */
+    class MetricsExporter
+    {
+    public:
+        //! Constructor. Reads the config, opens the file & the port if enabled
+        /*! \param framework framework
+         */
+        explicit MetricsExporter(Framework *framework);
+
+        //! Destructor
+        ~MetricsExporter();
+
+        //! Registers a metrics source
+        /*! \param name source name, prefixed to the names of its values
+            \param source source function
+            \return source id
+         */
+        metric_source_id_t RegisterSource(const std::string& name, MetricSource source);
+
+        //! Unregisters a metrics source. Modules must unregister their sources when uninitialized
+        /*! \param id source id
+            \return true if the source was registered
+         */
+        bool UnregisterSource(metric_source_id_t id);
+
+        //! Records the frame time and takes a sample when the interval has passed. Called by the framework once per frame
+        /*! \param frametime time of the last frame in seconds
+         */
+        void Update(f64 frametime);
+
+        //! Returns true if exporting is enabled
+        bool IsEnabled() const { return enabled_; }
+
+        //! Returns the lines of the last sample, empty if none has been taken
+        const std::string& GetLastSample() const { return last_sample_; }
+
+    private:
+        MetricsExporter(const MetricsExporter &);
+        MetricsExporter &operator =(const MetricsExporter &);
+
+        //! A registered metrics source
+        struct Source
+        {
+            metric_source_id_t id_;
+            std::string name_;
+            MetricSource function_;
+        };
+
+        //! Collects the values of the framework & the registered sources
+        void CollectValues(MetricValues& values);
+
+        //! Formats the values as lines & writes them out
+        void Export(const MetricValues& values);
+
+        //! Opens the output file in append mode
+        void OpenFile();
+
+        //! Renames the output file to a backup & starts a new one, if it has grown too big
+        void RotateFile();
+
+        //! Accepts pending client connections
+        void AcceptClients();
+
+        //! Sends text to the connected clients. Drops clients that fail or can not keep up
+        void SendToClients(const std::string& text);
+
+        //! Clears the frame time stats of the interval
+        void ResetFrameStats();
+
+        //! Returns a name with the characters that separate fields in the output replaced
+        static std::string SanitizeName(const std::string& name);
+
+        //! Framework
+        Framework *framework_;
+
+        //! Whether exporting is enabled
+        bool enabled_;
+
+        //! Sample interval in seconds
+        f64 interval_;
+
+        //! Time since the last sample in seconds
+        f64 time_since_sample_;
+
+        //! Prefix of the exported names
+        std::string prefix_;
+
+        //! Output file path, empty if not written to a file
+        std::string file_path_;
+
+        //! Output file
+        std::ofstream file_;
+
+        //! Size at which the file is rotated, in bytes. 0 to never rotate
+        uint file_max_size_;
+
+        //! Listening socket, null if not listening
+        boost::shared_ptr<Poco::Net::ServerSocket> server_;
+
+        //! Connected clients
+        std::list<boost::shared_ptr<Poco::Net::StreamSocket> > clients_;
+
+        //! Registered sources
+        std::vector<Source> sources_;
+
+        //! Next source id
+        metric_source_id_t next_id_;
+
+        //! Frames in the current interval by frame time, see FRAME_TIME_BUCKETS in the source
+        std::vector<uint> frame_histogram_;
+
+        //! Frames in the current interval
+        uint frames_;
+
+        //! Total frame time in the current interval, in seconds
+        f64 frame_time_total_;
+
+        //! Longest frame time in the current interval, in seconds
+        f64 frame_time_max_;
+
+        //! Total update times of the modules at the last sample, in seconds, to get the time spent per interval
+        std::map<std::string, f64> last_module_times_;
+
+        //! Lines of the last sample
+        std::string last_sample_;
+    };
+}
+
+#endif
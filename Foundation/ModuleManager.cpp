@@ -7,12 +7,22 @@
 
 #include "ConfigurationManager.h"
 #include "CoreException.h"
+#include "ServiceInterface.h"
+#include "EventManager.h"
+#include "MetricsExporter.h"
 
 #include <algorithm>
 #include <sstream>
+#include <iomanip>
 
 #include <Poco/Environment.h>
 #include <Poco/UnicodeConverter.h>
+#include <Poco/Timestamp.h>
+
+#include <QThread>
+
+#include <boost/bind.hpp>
+#include <boost/static_assert.hpp>
 
 #include "MemoryLeakCheck.h"
 
@@ -51,8 +61,17 @@ namespace Foundation
 
     ModuleManager::ModuleManager(Framework *framework) :
         framework_(framework),
-        DEFAULT_MODULES_PATH(framework->GetDefaultConfig().DeclareSetting<std::string>("ModuleManager", "Default_Modules_Path", "./modules"))
+        DEFAULT_MODULES_PATH(framework->GetDefaultConfig().DeclareSetting<std::string>("ModuleManager", "Default_Modules_Path", "./modules")),
+        init_phase_(IP_NotStarted),
+        main_thread_id_(QThread::currentThreadId()),
+        running_parallel_inits_(0),
+        initializing_module_graph_(false),
+        init_phase_time_(0.0)
     {
+        lazy_loading_ = framework->GetDefaultConfig().DeclareSetting<bool>("ModuleManager", "Lazy_Loading", true);
+        parallel_init_ = framework->GetDefaultConfig().DeclareSetting<bool>("ModuleManager", "Parallel_Initialization", true);
+        // Leave one core for the main thread, which initializes the rest of the modules meanwhile.
+        max_init_threads_ = std::max(1, static_cast<int>(boost::thread::hardware_concurrency()) - 1);
     }
 
     ModuleManager::~ModuleManager()
@@ -69,7 +88,7 @@ namespace Foundation
         if (IsExcluded(module->Name()) == false && HasModule(module) == false)
         {
             ModuleSharedPtr modulePtr = ModuleSharedPtr(module);
-            Module::Entry entry = { modulePtr, module->Name(), Module::SharedLibraryPtr() };
+            Module::Entry entry = { modulePtr, module->Name(), Module::SharedLibraryPtr(), 0.0 };
             modules_.push_back(entry);
 #ifndef _DEBUG
              
@@ -84,7 +103,10 @@ namespace Foundation
             Poco::Logger::get(module->Name()).setLevel(log_level);
 #endif
             module->SetFramework(framework_);
+            Poco::Timestamp load_start;
             module->LoadInternal();
+            MutexLock lock(timings_mutex_);
+            GetStartupTiming(module->Name()).load_ = load_start.elapsed() / 1000000.0;
         }
         else
         {
@@ -190,9 +212,16 @@ namespace Foundation
         // Check and warn if any module dependencies could not be satisfied.
         CheckDependencies(moduleDescriptions);
 
+        // Leave out the modules that can be loaded when their services or event categories are first used.
+        SelectDeferredModules(moduleDescriptions);
+
         // Finally, load up all modules. The module description list is now sorted in a topological order, so that the dependencies
         // are satisfied when traversing begin()->end().
         for(std::vector<ModuleLoadDescription>::iterator iter = moduleDescriptions.begin(); iter != moduleDescriptions.end(); ++iter)
+        {
+            for(size_t i = 0; i < iter->moduleNames.size(); ++i)
+                module_descriptions_[iter->moduleNames[i]] = *iter;
+
             try
             {
                 LoadModule(iter->moduleDescFilename.native_directory_string(), iter->moduleNames);
@@ -201,6 +230,286 @@ namespace Foundation
             {
                 Foundation::RootLogError(std::string("Trying to load module ") + iter->ToString() + " threw an exception: " + e.what());
             }
+        }
+    }
+
+    void ModuleManager::SelectDeferredModules(std::vector<ModuleLoadDescription> &modules)
+    {
+        if (!lazy_loading_)
+            return;
+
+        // A lazy module without any services or event categories would never be loaded.
+        std::set<std::string> deferred;
+        for(size_t i = 0; i < modules.size(); ++i)
+            if (modules[i].lazy)
+            {
+                if (modules[i].services.empty() && modules[i].eventCategories.empty())
+                    Foundation::RootLogWarning("Module " + modules[i].ToString() + " is marked lazy but provides no services or event categories. Loading it at startup.");
+                else
+                    deferred.insert(modules[i].moduleNames.begin(), modules[i].moduleNames.end());
+            }
+
+        // Modules that are needed at startup can not be deferred, and neither can their dependencies.
+        // Go through the list backwards; it is in dependency order, so dependents are handled before their dependencies.
+        for(size_t i = modules.size(); i > 0; --i)
+        {
+            const ModuleLoadDescription &desc = modules[i-1];
+            if (deferred.find(desc.moduleNames.front()) != deferred.end())
+                continue;
+            for(size_t j = 0; j < desc.dependencies.size(); ++j)
+                if (deferred.erase(desc.dependencies[j]))
+                {
+                    const ModuleLoadDescription *dependee = FindModuleLoadDescriptionWithEntry(modules, desc.dependencies[j]);
+                    if (dependee)
+                        for(size_t k = 0; k < dependee->moduleNames.size(); ++k)
+                            deferred.erase(dependee->moduleNames[k]);
+                }
+        }
+
+        std::vector<ModuleLoadDescription> startup_modules;
+        for(size_t i = 0; i < modules.size(); ++i)
+            if (deferred.find(modules[i].moduleNames.front()) != deferred.end())
+            {
+                Foundation::RootLogDebug("Deferring loading of " + modules[i].ToString() + " until first use.");
+                deferred_modules_.push_back(modules[i]);
+            }
+            else
+                startup_modules.push_back(modules[i]);
+
+        modules.swap(startup_modules);
+    }
+
+    bool ModuleManager::LoadDeferredModulesForService(service_type_t type)
+    {
+        if (QThread::currentThreadId() != main_thread_id_)
+            return false;
+
+        // Only the main thread changes the deferred list, so it can be searched without locking.
+        size_t index = deferred_modules_.size();
+        for(size_t i = 0; i < deferred_modules_.size() && index == deferred_modules_.size(); ++i)
+            for(size_t j = 0; j < deferred_modules_[i].services.size(); ++j)
+                if (ServiceTypeFromName(deferred_modules_[i].services[j]) == type)
+                {
+                    index = i;
+                    break;
+                }
+
+        // During startup the service may be provided by a module that is being initialized in a worker thread.
+        // Waiting for it also ensures that no worker thread accesses the module list while a deferred module is added.
+        bool waited = false;
+        if (initializing_module_graph_)
+            waited = WaitForParallelInitializations();
+
+        if (index < deferred_modules_.size())
+            return LoadDeferredModule(index);
+
+        return waited;
+    }
+
+    bool ModuleManager::LoadDeferredModulesForEventCategory(const std::string &category)
+    {
+        if (deferred_modules_.empty() || QThread::currentThreadId() != main_thread_id_)
+            return false;
+
+        for(size_t i = 0; i < deferred_modules_.size(); ++i)
+            for(size_t j = 0; j < deferred_modules_[i].eventCategories.size(); ++j)
+                if (deferred_modules_[i].eventCategories[j] == category)
+                {
+                    WaitForParallelInitializations();
+                    return LoadDeferredModule(i);
+                }
+
+        return false;
+    }
+
+    bool ModuleManager::LoadDeferredModule(size_t index)
+    {
+        // Remove from the deferred list first, so that a request made while loading does not load it again.
+        ModuleLoadDescription desc = deferred_modules_[index];
+        deferred_modules_.erase(deferred_modules_.begin() + index);
+
+        for(size_t i = 0; i < desc.dependencies.size(); ++i)
+            for(size_t j = 0; j < deferred_modules_.size(); ++j)
+                if (std::find(deferred_modules_[j].moduleNames.begin(), deferred_modules_[j].moduleNames.end(), desc.dependencies[i]) != deferred_modules_[j].moduleNames.end())
+                {
+                    LoadDeferredModule(j);
+                    break;
+                }
+
+        Foundation::RootLogInfo("Loading deferred module " + desc.ToString() + " on first use.");
+
+        for(size_t i = 0; i < desc.moduleNames.size(); ++i)
+            module_descriptions_[desc.moduleNames[i]] = desc;
+
+        size_t first = modules_.size();
+        try
+        {
+            LoadModule(desc.moduleDescFilename.native_directory_string(), desc.moduleNames);
+        }
+        catch (std::exception &e)
+        {
+            Foundation::RootLogError(std::string("Trying to load module ") + desc.ToString() + " threw an exception: " + e.what());
+        }
+        size_t last = modules_.size();
+
+        {
+            MutexLock lock(timings_mutex_);
+            for(size_t i = first; i < last; ++i)
+                GetStartupTiming(modules_[i].module_->Name()).deferred_ = true;
+        }
+
+        // A module requested before or during startup initialization is initialized by the startup passes, after its dependencies.
+        // The preinitialization pass picks it up from the end of the module list as it is.
+        switch(init_phase_)
+        {
+        case IP_NotStarted:
+        case IP_PreInitialize:
+            break;
+
+        case IP_Initialize:
+        case IP_PostInitialize:
+            for(size_t i = first; i < last; ++i)
+                PreInitializeModule(modules_[i].module_.get());
+            if (initializing_module_graph_)
+            {
+                // The initialization graph has already been built, add the module to it.
+                MutexLock lock(init_mutex_);
+                for(size_t i = first; i < last; ++i)
+                    AddInitNode(i);
+            }
+            else
+            {
+                // The other modules have all been initialized, the postinitialization pass picks it up from the end of the module list.
+                for(size_t i = first; i < last; ++i)
+                    InitializeModule(modules_[i].module_.get());
+            }
+            break;
+
+        case IP_Done:
+            for(size_t i = first; i < last; ++i)
+                PreInitializeModule(modules_[i].module_.get());
+            for(size_t i = first; i < last; ++i)
+                InitializeModule(modules_[i].module_.get());
+            for(size_t i = first; i < last; ++i)
+                PostInitializeModule(modules_[i].module_.get());
+            break;
+        }
+
+        return last > first;
+    }
+
+    service_type_t ModuleManager::ServiceTypeFromName(const std::string &name)
+    {
+        static const struct
+        {
+            const char *name_;
+            Service::Type type_;
+        } services[] =
+        {
+            { "Renderer", Service::ST_Renderer },
+            { "Physics", Service::ST_Physics },
+            { "Gui", Service::ST_Gui },
+            { "WorldLogic", Service::ST_WorldLogic },
+            { "PythonScripting", Service::ST_PythonScripting },
+            { "JavascriptScripting", Service::ST_JavascriptScripting },
+            { "Console", Service::ST_Console },
+            { "ConsoleCommand", Service::ST_ConsoleCommand },
+            { "Asset", Service::ST_Asset },
+            { "Texture", Service::ST_Texture },
+            { "Sound", Service::ST_Sound },
+            { "Input", Service::ST_Input },
+            { "Communications", Service::ST_Communications },
+            { "UiSettings", Service::ST_UiSettings },
+            { "Player", Service::ST_Player },
+            { "WorldBuilding", Service::ST_WorldBuilding }
+        };
+
+        // Fails to compile if a service type is added without a name here
+        BOOST_STATIC_ASSERT(sizeof(services) / sizeof(services[0]) == Service::ST_Unknown);
+
+        for(size_t i = 0; i < sizeof(services) / sizeof(services[0]); ++i)
+            if (name == services[i].name_)
+                return services[i].type_;
+
+        return Service::ST_Unknown;
+    }
+
+    StringVector ModuleManager::GetDeferredModules() const
+    {
+        StringVector names;
+        for(size_t i = 0; i < deferred_modules_.size(); ++i)
+            names.insert(names.end(), deferred_modules_[i].moduleNames.begin(), deferred_modules_[i].moduleNames.end());
+        return names;
+    }
+
+    Module::StartupTiming &ModuleManager::GetStartupTiming(const std::string &name)
+    {
+        for(size_t i = 0; i < startup_timings_.size(); ++i)
+            if (startup_timings_[i].name_ == name)
+                return startup_timings_[i];
+
+        Module::StartupTiming timing;
+        timing.name_ = name;
+        startup_timings_.push_back(timing);
+        return startup_timings_.back();
+    }
+
+    StringVector ModuleManager::GetStartupReport() const
+    {
+        MutexLock lock(timings_mutex_);
+
+        StringVector lines;
+        std::stringstream ss;
+        ss << std::left << std::setw(32) << "Module" << std::right << std::setw(10) << "Load" << std::setw(10) << "PreInit"
+            << std::setw(10) << "Init" << std::setw(10) << "PostInit" << std::setw(10) << "Total" << std::setw(10) << "InitAt" << "  (ms)";
+        lines.push_back(ss.str());
+
+        f64 load = 0.0, preinit = 0.0, init = 0.0, postinit = 0.0;
+        for(size_t i = 0; i < startup_timings_.size(); ++i)
+        {
+            const Module::StartupTiming &t = startup_timings_[i];
+            ss.str("");
+            ss << std::left << std::setw(32) << t.name_ << std::right << std::fixed << std::setprecision(1)
+                << std::setw(10) << t.load_ * 1000.0 << std::setw(10) << t.preinit_ * 1000.0 << std::setw(10) << t.init_ * 1000.0
+                << std::setw(10) << t.postinit_ * 1000.0 << std::setw(10) << (t.load_ + t.preinit_ + t.init_ + t.postinit_) * 1000.0
+                << std::setw(10) << t.init_start_ * 1000.0;
+            if (t.parallel_)
+                ss << "  (initialized in worker thread)";
+            if (t.deferred_)
+                ss << "  (loaded on first use)";
+            lines.push_back(ss.str());
+
+            if (!t.deferred_)
+            {
+                load += t.load_;
+                preinit += t.preinit_;
+                init += t.init_;
+                postinit += t.postinit_;
+            }
+        }
+
+        ss.str("");
+        ss << std::left << std::setw(32) << "Total at startup" << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << load * 1000.0 << std::setw(10) << preinit * 1000.0 << std::setw(10) << init * 1000.0
+            << std::setw(10) << postinit * 1000.0 << std::setw(10) << (load + preinit + init + postinit) * 1000.0;
+        lines.push_back(ss.str());
+
+        ss.str("");
+        ss << "Initialization phase took " << std::fixed << std::setprecision(1) << init_phase_time_ * 1000.0 << " ms, "
+            << "modules spent " << init * 1000.0 << " ms in Initialize()";
+        lines.push_back(ss.str());
+
+        StringVector deferred = GetDeferredModules();
+        if (!deferred.empty())
+        {
+            ss.str("");
+            ss << "Not loaded yet, deferred until first use:";
+            for(size_t i = 0; i < deferred.size(); ++i)
+                ss << " " << deferred[i];
+            lines.push_back(ss.str());
+        }
+
+        return lines;
     }
 
     bool ModuleManager::ModuleLoadDescription::Precedes(const ModuleLoadDescription &rhs) const
@@ -247,6 +556,10 @@ namespace Foundation
 
         StringVector entries;
         StringVector dependencies;
+        StringVector services;
+        StringVector eventCategories;
+        bool lazy = false;
+        bool parallelInit = false;
 
         try
         {
@@ -262,6 +575,14 @@ namespace Foundation
                     dependencies.push_back(config->getString(*it));
                 else if (it->find("entry") != std::string::npos)
                     entries.push_back(config->getString(*it));
+                else if (it->find("provides_service") != std::string::npos)
+                    services.push_back(config->getString(*it));
+                else if (it->find("provides_event_category") != std::string::npos)
+                    eventCategories.push_back(config->getString(*it));
+                else if (it->find("lazy") != std::string::npos)
+                    lazy = config->getBool(*it);
+                else if (it->find("parallel_init") != std::string::npos)
+                    parallelInit = config->getBool(*it);
         }
         catch(const std::exception &e)
         {
@@ -299,40 +620,224 @@ namespace Foundation
             /// \note Currently cannot specify in a single XML file several modules that would have separate dependencies. They all share the same!
             ///       Though, this is not currently in any way seen critical. (just write two xml files if you need separate dependencies)
             desc.dependencies = dependencies; 
+            desc.lazy = lazy;
+            desc.services = services;
+            desc.eventCategories = eventCategories;
+            desc.parallelInit = parallelInit;
             out.push_back(desc);
 //        }
     }
 
     void ModuleManager::InitializeModules()
     {
+        // Deferred modules loaded on first use during the passes are appended to the module list, and to the initialization graph.
+        init_phase_ = IP_PreInitialize;
+        for(size_t i = 0; i < modules_.size(); ++i)
+            PreInitializeModule(modules_[i].module_.get());
+
+        init_phase_ = IP_Initialize;
+        InitializeModuleGraph();
+
+        init_phase_ = IP_PostInitialize;
+        for(size_t i = 0; i < modules_.size(); ++i)
+            PostInitializeModule(modules_[i].module_.get());
+
+        init_phase_ = IP_Done;
+    }
+
+    void ModuleManager::InitializeModuleGraph()
+    {
+        init_phase_start_.update();
+        initializing_module_graph_ = true;
+
+        ScopedLock lock(init_mutex_);
+        init_nodes_.clear();
+        parallel_init_error_.clear();
         for(size_t i = 0; i < modules_.size(); ++i)
+            AddInitNode(i);
+
+        boost::thread_group threads;
+        size_t next_serial = 0;
+        try
         {
-            ModuleInterface *mod = modules_[i].module_.get();
-            if (mod->State() != Foundation::Module::MS_Initialized)
-                PreInitializeModule(mod);
+            for(;;)
+            {
+                // Start the modules that can be initialized in worker threads as soon as their dependencies are done.
+                bool parallel_waiting = false;
+                for(size_t i = 0; i < init_nodes_.size(); ++i)
+                    if (init_nodes_[i].parallel && init_nodes_[i].state == InitNode::Waiting)
+                    {
+                        if (running_parallel_inits_ < max_init_threads_ && InitDependenciesDone(i))
+                            StartParallelInitialization(i, threads);
+                        else
+                            parallel_waiting = true;
+                    }
+
+                // The rest are initialized in the main thread in load order.
+                while(next_serial < init_nodes_.size() && init_nodes_[next_serial].parallel)
+                    ++next_serial;
+                bool serial_waiting = next_serial < init_nodes_.size();
+
+                if (!serial_waiting && !parallel_waiting && running_parallel_inits_ == 0)
+                    break;
+
+                bool run_serial = serial_waiting && InitDependenciesDone(next_serial);
+                if (!run_serial && running_parallel_inits_ == 0)
+                {
+                    // Nothing is running and nothing can be started, so the dependencies must be circular. Break the cycle.
+                    if (serial_waiting)
+                    {
+                        Foundation::RootLogWarning("Circular module dependencies, initializing " + init_nodes_[next_serial].entry + " before its dependencies.");
+                        run_serial = true;
+                    }
+                    else
+                        for(size_t i = 0; i < init_nodes_.size(); ++i)
+                            if (init_nodes_[i].parallel && init_nodes_[i].state == InitNode::Waiting)
+                            {
+                                Foundation::RootLogWarning("Circular module dependencies, initializing " + init_nodes_[i].entry + " before its dependencies.");
+                                StartParallelInitialization(i, threads);
+                                break;
+                            }
+                }
+
+                if (run_serial)
+                {
+                    init_nodes_[next_serial].state = InitNode::Running;
+                    ModuleInterface *mod = init_nodes_[next_serial].module;
+                    lock.unlock();
+                    InitializeModule(mod);
+                    lock.lock();
+                    init_nodes_[next_serial].state = InitNode::Done;
+                    ++next_serial;
+                }
+                else if (running_parallel_inits_ > 0)
+                    init_condition_.wait(lock);
+
+                // Modules initialized in worker threads start receiving events once the main thread knows they are done.
+                framework_->GetEventManager()->RegisterPendingEventSubscribers();
+            }
+        }
+        catch(...)
+        {
+            // The worker threads refer to the modules and to the module manager, let them finish before passing on the error.
+            if (!lock.owns_lock())
+                lock.lock();
+            while(running_parallel_inits_ > 0)
+                init_condition_.wait(lock);
+            lock.unlock();
+            threads.join_all();
+            initializing_module_graph_ = false;
+            throw;
         }
 
-        for(size_t i = 0; i < modules_.size(); ++i)
+        lock.unlock();
+        threads.join_all();
+        initializing_module_graph_ = false;
+        framework_->GetEventManager()->RegisterPendingEventSubscribers();
+
+        init_phase_time_ = init_phase_start_.elapsed() / 1000000.0;
+
+        if (!parallel_init_error_.empty())
+            throw Exception(parallel_init_error_.c_str());
+    }
+
+    void ModuleManager::AddInitNode(size_t module_index)
+    {
+        InitNode node;
+        node.module = modules_[module_index].module_.get();
+        node.entry = modules_[module_index].entry_;
+        std::map<std::string, ModuleLoadDescription>::const_iterator desc = module_descriptions_.find(node.entry);
+        if (desc != module_descriptions_.end())
         {
-            ModuleInterface *mod = modules_[i].module_.get();
-            if (mod->State() != Foundation::Module::MS_Initialized)
-                InitializeModule(mod);
+            node.dependencies = desc->second.dependencies;
+            node.parallel = parallel_init_ && desc->second.parallelInit;
         }
+        init_nodes_.push_back(node);
+    }
 
-        for(size_t i = 0; i < modules_.size(); ++i)
-            PostInitializeModule(modules_[i].module_.get());
+    bool ModuleManager::InitDependenciesDone(size_t index) const
+    {
+        const StringVector &dependencies = init_nodes_[index].dependencies;
+        for(size_t i = 0; i < dependencies.size(); ++i)
+            for(size_t j = 0; j < init_nodes_.size(); ++j)
+                if (init_nodes_[j].entry == dependencies[i] && init_nodes_[j].state != InitNode::Done)
+                    return false;
+
+        // Dependencies which are not in the graph have either been initialized already, or are not loaded at all.
+        return true;
+    }
+
+    void ModuleManager::StartParallelInitialization(size_t index, boost::thread_group &threads)
+    {
+        Foundation::RootLogDebug("Initializing module " + init_nodes_[index].entry + " in a worker thread");
+        init_nodes_[index].state = InitNode::Running;
+        ++running_parallel_inits_;
+        threads.create_thread(boost::bind(&ModuleManager::InitializeModuleInThread, this, index));
+    }
+
+    void ModuleManager::InitializeModuleInThread(size_t index)
+    {
+        ModuleInterface *module = 0;
+        {
+            MutexLock lock(init_mutex_);
+            module = init_nodes_[index].module;
+        }
+
+        std::string error;
+        try
+        {
+            InitializeModule(module);
+        }
+        catch(const std::exception &e)
+        {
+            error = "Initializing module " + module->Name() + " in a worker thread threw an exception: " + e.what();
+        }
+        catch(...)
+        {
+            error = "Initializing module " + module->Name() + " in a worker thread threw an unknown exception";
+        }
+
+        if (!error.empty())
+            Foundation::RootLogError(error);
+
+        MutexLock lock(init_mutex_);
+        init_nodes_[index].state = InitNode::Done;
+        if (!error.empty() && parallel_init_error_.empty())
+            parallel_init_error_ = error;
+        --running_parallel_inits_;
+        init_condition_.notify_all();
+    }
+
+    bool ModuleManager::WaitForParallelInitializations()
+    {
+        ScopedLock lock(init_mutex_);
+        if (running_parallel_inits_ == 0)
+            return false;
+
+        Foundation::RootLogDebug("Waiting for the modules being initialized in worker threads");
+        while(running_parallel_inits_ > 0)
+            init_condition_.wait(lock);
+        return true;
     }
 
     void ModuleManager::UninitializeModules()
     {
+        // Do not load anything on demand while shutting down.
+        deferred_modules_.clear();
+
         for(ModuleVector::reverse_iterator it = modules_.rbegin(); it != modules_.rend(); ++it)
             UninitializeModule(it->module_.get());
     }
 
     void ModuleManager::UpdateModules(f64 frametime)
     {
+        // Per-module update times are only needed for the metrics, so skip the clock reads when nothing exports them
+        MetricsExporterPtr exporter = framework_->GetMetricsExporter();
+        const bool timed = exporter && exporter->IsEnabled();
+
         for(size_t i = 0; i < modules_.size(); ++i)
         {
+            Core::tick_t start = timed ? Core::GetCurrentClockTime() : 0;
             try
             {
                 modules_[i].module_->Update(frametime);
@@ -351,6 +856,8 @@ namespace Foundation
                 RootLogCritical(std::string("UpdateModules caught an unknown exception while updating module " + modules_[i].module_->Name()));
                 throw;
             }
+            if (timed)
+                modules_[i].update_time_ += (f64)(Core::GetCurrentClockTime() - start) / (f64)Core::GetCurrentClockFreq();
         }
     }
 
@@ -367,6 +874,14 @@ namespace Foundation
                 return true;
             }
 
+        // Loaded explicitly, so no longer deferred.
+        for(size_t i = 0; i < deferred_modules_.size(); ++i)
+            if (std::find(deferred_modules_[i].moduleNames.begin(), deferred_modules_[i].moduleNames.end(), module) != deferred_modules_[i].moduleNames.end())
+            {
+                deferred_modules_.erase(deferred_modules_.begin() + i);
+                break;
+            }
+
         StringVector current_modules;
         for(size_t i = 0; i < modules_.size(); ++i)
             current_modules.push_back(modules_[i].entry_);
@@ -459,6 +974,10 @@ namespace Foundation
         std::string path(name);
         path.append(Poco::SharedLibrary::suffix());
 
+        // Time spent in loading the library is accounted to the first module loaded from it.
+        Poco::Timestamp library_load_start;
+        f64 library_load_time = 0.0;
+
         Module::SharedLibraryPtr library;
 
         // See if shared library is already loaded, and if it is, use it
@@ -488,6 +1007,7 @@ namespace Foundation
                 Foundation::RootLogError("Failed to load dynamic library: " + path);
                 return;
             }
+        library_load_time = library_load_start.elapsed() / 1000000.0;
 
         /// Load each module in this shared library.
         for(StringVector::const_iterator it = entries.begin(); it != entries.end(); ++it)
@@ -534,9 +1054,15 @@ namespace Foundation
 #endif
 
             module->SetFramework(framework_);
+            Poco::Timestamp load_start;
             module->LoadInternal();
+            {
+                MutexLock lock(timings_mutex_);
+                GetStartupTiming(module->Name()).load_ = load_start.elapsed() / 1000000.0 + library_load_time;
+            }
+            library_load_time = 0.0;
 
-            Module::Entry entry = { modulePtr, *it, library };
+            Module::Entry entry = { modulePtr, *it, library, 0.0 };
 
             modules_.push_back(entry);
 
@@ -559,7 +1085,12 @@ namespace Foundation
         assert(module);
         assert(module->State() == Foundation::Module::MS_Loaded);
         Foundation::RootLogDebug("Preinitializing module " + module->Name());
+        Poco::Timestamp start;
         module->PreInitializeInternal();
+        {
+            MutexLock lock(timings_mutex_);
+            GetStartupTiming(module->Name()).preinit_ = start.elapsed() / 1000000.0;
+        }
 
         // Do not log preinit success here to avoid extraneous logging.
     }
@@ -569,7 +1100,15 @@ namespace Foundation
         assert(module);
         assert(module->State() == Foundation::Module::MS_Loaded);
         Foundation::RootLogDebug("Initializing module " + module->Name());
+        Poco::Timestamp start;
         module->InitializeInternal();
+        {
+            MutexLock lock(timings_mutex_);
+            Module::StartupTiming &timing = GetStartupTiming(module->Name());
+            timing.init_ = start.elapsed() / 1000000.0;
+            timing.init_start_ = (start - init_phase_start_) / 1000000.0;
+            timing.parallel_ = QThread::currentThreadId() != main_thread_id_;
+        }
 
         // Send a log message in the log channel of the module we just initialized.
         Poco::Logger::get(module->Name()).information(module->Name() + " initialized.");
@@ -580,7 +1119,12 @@ namespace Foundation
         assert(module);
         assert(module->State() == Foundation::Module::MS_Loaded);
         Foundation::RootLogDebug("Postinitializing module " + module->Name());
+        Poco::Timestamp start;
         module->PostInitializeInternal();
+        {
+            MutexLock lock(timings_mutex_);
+            GetStartupTiming(module->Name()).postinit_ = start.elapsed() / 1000000.0;
+        }
 
         // Do not log postinit success here to avoid extraneous logging.
     }
@@ -6,9 +6,12 @@
 #include <boost/filesystem.hpp>
 #include <Poco/SharedLibrary.h>
 #include <Poco/ClassLoader.h>
+#include <Poco/Timestamp.h>
+#include <qnamespace.h>
 
 #include "ModuleInterface.h"
 #include "ModuleReference.h"
+#include "CoreThread.h"
 
 namespace fs = boost::filesystem;
 
@@ -70,6 +73,31 @@ namespace Foundation
             std::string entry_;
             //! shared library this module was loaded from. Null for static library
             SharedLibraryPtr shared_library_;
+            //! total time spent in Update(), in seconds. Only accumulated while the metrics exporter is enabled
+            f64 update_time_;
+        };
+
+        //! Time spent in each startup phase of a module, for the startup timeline report
+        struct StartupTiming
+        {
+            StartupTiming() : load_(0.0), preinit_(0.0), init_(0.0), postinit_(0.0), init_start_(0.0), deferred_(false), parallel_(false) {}
+
+            //! name of the module
+            std::string name_;
+            //! time spent in loading the shared library and Load(), in seconds
+            f64 load_;
+            //! time spent in PreInitialize(), in seconds
+            f64 preinit_;
+            //! time spent in Initialize(), in seconds
+            f64 init_;
+            //! time spent in PostInitialize(), in seconds
+            f64 postinit_;
+            //! time when Initialize() was started, in seconds from the beginning of the initialization phase
+            f64 init_start_;
+            //! true if the module was loaded on first use instead of at startup
+            bool deferred_;
+            //! true if the module was initialized in a worker thread
+            bool parallel_;
         };
     }
 
@@ -117,6 +145,38 @@ namespace Foundation
         //! loads all available modules. Does not initialize them.
         void LoadAvailableModules();
 
+        //! Loads deferred modules that provide the specified service
+        /*! Modules can declare in their xml file that their loading should be deferred until first use,
+            and which services and event categories they provide:
+            \verbatim
+            <config>
+                <entry>PhononPlayerModule</entry>
+                <lazy>true</lazy>
+                <provides_service>Player</provides_service>
+            </config>
+            \endverbatim
+            Called by ServiceManager when an unregistered service is requested. Does nothing if not called from the main thread.
+
+            \param type type of the requested service
+            \return True if a module was loaded, false otherwise
+        */
+        bool LoadDeferredModulesForService(service_type_t type);
+
+        //! Loads deferred modules that provide the specified event category
+        /*! Called by EventManager when an unregistered event category is queried. Does nothing if not called from the main thread.
+
+            \param category name of the event category
+            \return True if a module was loaded, false otherwise
+        */
+        bool LoadDeferredModulesForEventCategory(const std::string &category);
+
+        //! Returns names of the modules whose loading is deferred until first use
+        StringVector GetDeferredModules() const;
+
+        //! Returns the startup timeline report: time spent in Load, PreInitialize, Initialize and PostInitialize per module,
+        //! and when Initialize was started relative to the beginning of the initialization phase
+        StringVector GetStartupReport() const;
+
         //! unloads all available modules. Modules does not get unloaded as such, only the module's unload() function will be called
         /*! Assumptions is that modules only get unloaded once the program exits.
 
@@ -125,7 +185,14 @@ namespace Foundation
         void UnloadModules();
 
         //! initialize all modules
-        /*! All static modules should be declared before calling this.
+        /*! Modules that have declared in their xml file that they can be initialized outside the main thread,
+            \code
+                <parallel_init>true</parallel_init>
+            \endcode
+            are initialized in worker threads as soon as the modules they depend on have been initialized.
+            Other modules are initialized in the main thread in load order, each after its dependencies.
+
+            All static modules should be declared before calling this.
 
             \note should only be called once, when firing up the framework
         */
@@ -237,6 +304,12 @@ namespace Foundation
             boost::filesystem::path moduleDescFilename;
             StringVector moduleNames; ///< The names of the modules contained in this shared library.
             StringVector dependencies;
+            bool lazy; ///< True if loading of the modules should be deferred until their services or event categories are used.
+            StringVector services; ///< Names of the services the modules provide, e.g. "Player" for Service::ST_Player.
+            StringVector eventCategories; ///< Names of the event categories the modules provide.
+            bool parallelInit; ///< True if the modules can be initialized in a worker thread.
+
+            ModuleLoadDescription() : lazy(false), parallelInit(false) {}
 
             /// @return True if this module directly depends on the module rhs, i.e. if this module absolutely needs to be loaded before rhs.
             bool Precedes(const ModuleLoadDescription &rhs) const;
@@ -255,6 +328,54 @@ namespace Foundation
 
         static void CheckDependencies(const std::vector<ModuleLoadDescription> &modules);
 
+        /// Moves the modules that can be loaded on first use to the deferred module list.
+        /// Modules that non-deferred modules depend on are not deferred.
+        void SelectDeferredModules(std::vector<ModuleLoadDescription> &modules);
+
+        /// Loads a deferred module and its deferred dependencies. If startup initialization has begun, the module joins the current
+        /// startup pass so that it is initialized after its dependencies, or is fully initialized if startup has finished.
+        /// @return True if a module was loaded.
+        bool LoadDeferredModule(size_t index);
+
+        /// @return Service type by service name, e.g. "Sound" -> Service::ST_Sound. Service::ST_Unknown if name is not known.
+        static service_type_t ServiceTypeFromName(const std::string &name);
+
+        /// A module in the initialization dependency graph.
+        struct InitNode
+        {
+            enum State { Waiting, Running, Done };
+
+            ModuleInterface *module;
+            std::string entry;
+            StringVector dependencies; ///< Entry names of the modules that must be initialized before this one.
+            bool parallel; ///< True if the module is initialized in a worker thread.
+            State state;
+
+            InitNode() : module(0), parallel(false), state(Waiting) {}
+        };
+
+        /// Initializes the loaded modules in dependency order, running the modules that allow it in worker threads.
+        void InitializeModuleGraph();
+
+        /// Adds the given module to the initialization graph. Call with init_mutex_ locked.
+        void AddInitNode(size_t module_index);
+
+        /// @return True if the modules the given init node depends on have been initialized. Call with init_mutex_ locked.
+        bool InitDependenciesDone(size_t index) const;
+
+        /// Starts initialization of the given init node in a worker thread. Call with init_mutex_ locked.
+        void StartParallelInitialization(size_t index, boost::thread_group &threads);
+
+        /// Worker thread function of parallel initialization.
+        void InitializeModuleInThread(size_t index);
+
+        /// Waits until the modules being initialized in worker threads have finished. Must be called in the main thread.
+        /// @return True if there were modules being initialized.
+        bool WaitForParallelInitializations();
+
+        /// @return Startup timing entry of the module, creates a new entry if it doesn't exist. Call with timings_mutex_ locked.
+        Module::StartupTiming &GetStartupTiming(const std::string &name);
+
         static const ModuleLoadDescription *FindModuleLoadDescriptionWithEntry(const std::vector<ModuleLoadDescription> &modules, const std::string &entryName);
 
         /// Parses and returns all the dependencies that the given module has from its dependency .xml file.
@@ -286,6 +407,59 @@ namespace Foundation
         //! List of modules that should be excluded
         ModuleTypeSet exclude_list_;
 
+        //! Modules whose loading is deferred until first use, in dependency order
+        std::vector<ModuleLoadDescription> deferred_modules_;
+
+        //! Startup timings of modules, in load order
+        std::vector<Module::StartupTiming> startup_timings_;
+
+        //! Protects startup_timings_, Initialize() of modules may be timed in worker threads
+        mutable Mutex timings_mutex_;
+
+        //! Load descriptions of the loaded modules by entry name, for building the initialization graph
+        std::map<std::string, ModuleLoadDescription> module_descriptions_;
+
+        //! Initialization graph of the modules being initialized, protected by init_mutex_
+        std::vector<InitNode> init_nodes_;
+
+        //! Number of modules being initialized in worker threads, protected by init_mutex_
+        int running_parallel_inits_;
+
+        //! True while InitializeModuleGraph() runs, so modules may be initialized in worker threads. Accessed by the main thread only
+        bool initializing_module_graph_;
+
+        //! Error from a module initialized in a worker thread, rethrown in the main thread. Protected by init_mutex_
+        std::string parallel_init_error_;
+
+        Mutex init_mutex_;
+
+        //! Signaled when a module has been initialized in a worker thread
+        Condition init_condition_;
+
+        //! Beginning of the initialization phase
+        Poco::Timestamp init_phase_start_;
+
+        //! Duration of the initialization phase, in seconds
+        f64 init_phase_time_;
+
+        //! True if modules marked parallel_init may be initialized in worker threads
+        bool parallel_init_;
+
+        //! Maximum number of modules initialized in worker threads at the same time
+        int max_init_threads_;
+
+        //! True if modules marked lazy may be deferred
+        bool lazy_loading_;
+
+        //! Startup initialization passes, in the order InitializeModules() runs them
+        enum InitPhase { IP_NotStarted, IP_PreInitialize, IP_Initialize, IP_PostInitialize, IP_Done };
+
+        //! Startup pass in progress, decides how far a deferred module is initialized when it is loaded
+        InitPhase init_phase_;
+
+        //! Thread where modules are loaded and initialized
+        Qt::HANDLE main_thread_id_;
+
         //! Framework pointer.
         Framework *framework_;
     };
@@ -9,6 +9,9 @@
 
 #if !defined(_WINDOWS)
 
+#include <fstream>
+#include <unistd.h>
+
 namespace Foundation
 {
     std::string PlatformNix::GetApplicationDataDirectory()
@@ -40,6 +43,16 @@ namespace Foundation
     {
         return GetApplicationDataDirectoryW();
     }
+
+    size_t PlatformNix::GetProcessMemoryUsage()
+    {
+        // Second field of statm is the resident set size in pages
+        std::ifstream statm("/proc/self/statm");
+        size_t size = 0, resident = 0;
+        if (!(statm >> size >> resident))
+            return 0;
+        return resident * sysconf(_SC_PAGESIZE);
+    }
 }
 
 #endif
@@ -48,6 +48,9 @@ namespace Foundation
         //! \copydoc PlatformWin::GetUserDocumentsDirectoryW()
         std::wstring GetUserDocumentsDirectoryW();
 
+        //! Returns memory used by the process, the resident set size in bytes. 0 if not known
+        size_t GetProcessMemoryUsage();
+
     private:
         Framework *framework_;
     };
@@ -11,6 +11,7 @@
 
 #include <windows.h>
 #include <shlobj.h>
+#include <psapi.h>
 
 namespace Foundation
 {
@@ -84,6 +85,14 @@ namespace Foundation
         }
         throw Exception("Failed to access user documents directory.");
     }
+
+    size_t PlatformWin::GetProcessMemoryUsage()
+    {
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.WorkingSetSize;
+    }
 }
 
 #endif
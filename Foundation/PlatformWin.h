@@ -60,6 +60,9 @@ namespace Foundation
         */
         std::wstring GetUserDocumentsDirectoryW();
 
+        //! Returns memory used by the process, the working set size in bytes. 0 if not known
+        size_t GetProcessMemoryUsage();
+
     private:
         Framework *framework_;
     };
@@ -2,6 +2,8 @@
 
 #include "StableHeaders.h"
 #include "ServiceManager.h"
+#include "Framework.h"
+#include "ModuleManager.h"
 #include "ForwardDefines.h"
 #include "CoreStringUtils.h"
 
@@ -9,17 +11,41 @@ namespace Foundation
 {
     ServiceWeakPtr ServiceManager::GetService(service_type_t type)
     {
-        ServicesMap::iterator it = services_.find(type);
-        if (it == services_.end())
+        ServiceWeakPtr service;
+        if (!FindService(type, service))
         {
             //std::string what("Service type ");
             //what += boost::lexical_cast<std::string>(type) + " not registered!";
             //Foundation::RootLogDebug(what);
 
-            return ServiceWeakPtr();
+            if (!LoadDeferredProvider(type) || !FindService(type, service))
+                return ServiceWeakPtr();
         }
 
-        return it->second;
+        return service;
+    }
+
+    bool ServiceManager::FindService(service_type_t type, ServiceWeakPtr &service) const
+    {
+        MutexLock lock(services_mutex_);
+        ServicesMap::const_iterator it = services_.find(type);
+        if (it == services_.end())
+            return false;
+
+        service = it->second;
+        return true;
+    }
+
+    bool ServiceManager::LoadDeferredProvider(service_type_t type)
+    {
+        if (!framework_)
+            return false;
+
+        ModuleManagerPtr module_manager = framework_->GetModuleManager();
+        if (!module_manager)
+            return false;
+
+        return module_manager->LoadDeferredModulesForService(type);
     }
 
     void ServiceManager::RegisterService(service_type_t type, const ServiceWeakPtr &service)
@@ -28,6 +54,7 @@ namespace Foundation
 
         Foundation::RootLogDebug("Registering service type " + boost::lexical_cast<std::string>(type));
 
+        MutexLock lock(services_mutex_);
         if (services_.find(type) != services_.end())
         {
             Foundation::RootLogWarning("Service provider already registered!");
@@ -48,6 +75,7 @@ namespace Foundation
 
         ServicePtr upped_service = service.lock();
 
+        MutexLock lock(services_mutex_);
         ServicesMap::iterator iter = services_.begin();
         for ( ; iter != services_.end() ; ++iter)
         {
@@ -5,6 +5,7 @@
 
 #include "ServiceInterface.h"
 #include "CoreTypes.h"
+#include "CoreThread.h"
 
 #include <utility>
 #include <map>
@@ -22,8 +23,10 @@ namespace Foundation
     class ServiceManager
     {
     public:
-        //! Default constuctor.
-        ServiceManager() {}
+        //! Constructor.
+        /*! \param framework Framework, used for loading modules whose loading has been deferred until their service is requested
+        */
+        explicit ServiceManager(Framework *framework) : framework_(framework) {}
 
         //! Destructor.
         ~ServiceManager() {}
@@ -53,17 +56,18 @@ namespace Foundation
         template <class T>
         __inline boost::weak_ptr<T> GetService(service_type_t type)
         {
-            ServicesMap::iterator it = services_.find(type);
-            if (it == services_.end())
+            ServiceWeakPtr service;
+            if (!FindService(type, service))
             {
                 //std::string what("Service type ");
                 //what += boost::lexical_cast<std::string>(type) + " not registered!";
                 //Foundation::RootLogDebug(what);
 
-                return boost::weak_ptr<T>();
+                if (!LoadDeferredProvider(type) || !FindService(type, service))
+                    return boost::weak_ptr<T>();
             }
 
-            return boost::dynamic_pointer_cast<T>(it->second.lock());
+            return boost::dynamic_pointer_cast<T>(service.lock());
         }
 
         //! Returns service from service type.
@@ -75,8 +79,8 @@ namespace Foundation
         template <class T>
         __inline const boost::weak_ptr<T> GetService(service_type_t type) const
         {
-            ServicesMap::const_iterator it = services_.find(type);
-            if (it == services_.end())
+            ServiceWeakPtr service;
+            if (!FindService(type, service))
             {
                 //std::string what("Service type " + 
                 //    boost::lexical_cast<std::string>(type) + " not registered!");
@@ -85,7 +89,7 @@ namespace Foundation
                 return boost::weak_ptr<T>();
             }
 
-            return boost::dynamic_pointer_cast<T>(it->second.lock());
+            return boost::dynamic_pointer_cast<T>(service.lock());
         }
 
         /** Returns service by class T.
@@ -94,6 +98,7 @@ namespace Foundation
          */
         template <class T> boost::weak_ptr<T> GetService()
         {
+            MutexLock lock(services_mutex_);
             for(ServicesMap::iterator it = services_.begin(); it != services_.end() ; ++it)
             {
                 boost::weak_ptr<T> service = boost::dynamic_pointer_cast<T>(it->second.lock());
@@ -105,9 +110,23 @@ namespace Foundation
         }
 
         //! Returns true if service type is already registered, false otherwise
-        bool IsRegistered(service_type_t type) const { return (services_.find(type) != services_.end()); }
+        bool IsRegistered(service_type_t type) const
+        {
+            MutexLock lock(services_mutex_);
+            return (services_.find(type) != services_.end());
+        }
 
     private:
+        //! Finds a registered service
+        /*! \return True if service of the type is registered
+        */
+        bool FindService(service_type_t type, ServiceWeakPtr &service) const;
+
+        //! Loads the module providing the service, if its loading has been deferred until first use
+        /*! \return True if a module was loaded
+        */
+        bool LoadDeferredProvider(service_type_t type);
+
         typedef std::map<service_type_t, ServiceWeakPtr> ServicesMap;
         typedef std::map<service_type_t, int> ServicesUsageMap;
 
@@ -117,6 +136,9 @@ namespace Foundation
         //! Contains all registered services
         ServicesMap services_;
 
+        //! Protects services_, modules may register their services while being initialized in a worker thread
+        mutable Mutex services_mutex_;
+
         //! Number of shared ptr uses when registering a service, for debug purposes only!
         ServicesUsageMap services_usage_;
     };
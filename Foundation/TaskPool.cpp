@@ -0,0 +1,230 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "Foundation.h"
+#include "TaskPool.h"
+
+#include <boost/bind.hpp>
+
+namespace Foundation
+{
+    PoolTask::PoolTask(const std::string& name, PoolTaskFunction function) :
+        name_(name),
+        function_(function),
+        queue_time_(0)
+    {
+    }
+
+    TaskPool::TaskPool(uint num_threads) :
+        num_queued_(0),
+        max_queued_(0),
+        stop_(false),
+        steals_(0)
+    {
+        if (!num_threads)
+        {
+            uint hardware_threads = boost::thread::hardware_concurrency();
+            num_threads = hardware_threads > 3 ? hardware_threads - 1 : 2;
+        }
+
+        // Create all workers before starting any, the workers look at each other's queues
+        for(uint i = 0; i < num_threads; ++i)
+            workers_.push_back(WorkerPtr(new Worker()));
+        for(uint i = 0; i < num_threads; ++i)
+            workers_[i]->thread_ = Thread(boost::bind(&TaskPool::RunWorker, this, i));
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            MutexLock lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_condition_.notify_all();
+
+        for(uint i = 0; i < workers_.size(); ++i)
+            workers_[i]->thread_.join();
+    }
+
+    PoolTaskPtr TaskPool::Submit(const std::string& name, PoolTaskFunction function)
+    {
+        PoolTaskPtr task(new PoolTask(name, function));
+        Enqueue(task);
+        return task;
+    }
+
+    uint TaskPool::GetQueueDepth()
+    {
+        MutexLock lock(wake_mutex_);
+        return num_queued_;
+    }
+
+    uint TaskPool::GetMaxQueueDepth()
+    {
+        MutexLock lock(wake_mutex_);
+        return max_queued_;
+    }
+
+    uint TaskPool::GetNumSteals()
+    {
+        MutexLock lock(stats_mutex_);
+        return steals_;
+    }
+
+    std::map<std::string, PoolTaskStats> TaskPool::GetStats()
+    {
+        MutexLock lock(stats_mutex_);
+        return stats_;
+    }
+
+    void TaskPool::ResetStats()
+    {
+        {
+            MutexLock lock(stats_mutex_);
+            stats_.clear();
+            steals_ = 0;
+        }
+        {
+            MutexLock lock(wake_mutex_);
+            max_queued_ = num_queued_;
+        }
+    }
+
+    void TaskPool::RunWorker(uint index)
+    {
+        for(;;)
+        {
+            // Take the task while holding the wake mutex. Tasks are counted only after they are in a queue, so
+            // a counted task is always found, without spinning over the queues while another worker takes it
+            PoolTaskPtr task;
+            {
+                ScopedLock lock(wake_mutex_);
+                while(!num_queued_ && !stop_)
+                    wake_condition_.wait(lock);
+                if (stop_)
+                    return;
+                --num_queued_;
+                task = TakeTask(index);
+            }
+
+            RunTask(task);
+        }
+    }
+
+    int TaskPool::GetCurrentWorker() const
+    {
+        boost::thread::id id = boost::this_thread::get_id();
+        for(uint i = 0; i < workers_.size(); ++i)
+        {
+            if (workers_[i]->thread_.get_id() == id)
+                return i;
+        }
+        return -1;
+    }
+
+    PoolTaskPtr TaskPool::TakeTask(uint index)
+    {
+        PoolTaskPtr task;
+
+        {
+            Worker& own = *workers_[index];
+            MutexLock lock(own.mutex_);
+            if (!own.tasks_.empty())
+            {
+                task = own.tasks_.back();
+                own.tasks_.pop_back();
+                return task;
+            }
+        }
+
+        {
+            MutexLock lock(shared_mutex_);
+            if (!shared_tasks_.empty())
+            {
+                task = shared_tasks_.front();
+                shared_tasks_.pop_front();
+                return task;
+            }
+        }
+
+        for(uint i = 1; i < workers_.size(); ++i)
+        {
+            Worker& victim = *workers_[(index + i) % workers_.size()];
+            MutexLock lock(victim.mutex_);
+            if (!victim.tasks_.empty())
+            {
+                task = victim.tasks_.front();
+                victim.tasks_.pop_front();
+                break;
+            }
+        }
+
+        if (task)
+        {
+            MutexLock lock(stats_mutex_);
+            ++steals_;
+        }
+        return task;
+    }
+
+    void TaskPool::Enqueue(PoolTaskPtr task)
+    {
+        task->queue_time_ = Core::GetCurrentClockTime();
+
+        int worker = GetCurrentWorker();
+        if (worker >= 0)
+        {
+            MutexLock lock(workers_[worker]->mutex_);
+            workers_[worker]->tasks_.push_back(task);
+        }
+        else
+        {
+            MutexLock lock(shared_mutex_);
+            shared_tasks_.push_back(task);
+        }
+
+        {
+            MutexLock lock(wake_mutex_);
+            ++num_queued_;
+            if (num_queued_ > max_queued_)
+                max_queued_ = num_queued_;
+        }
+        wake_condition_.notify_one();
+    }
+
+    void TaskPool::RunTask(PoolTaskPtr task)
+    {
+        Core::tick_t start = Core::GetCurrentClockTime();
+        try
+        {
+            task->function_();
+        }
+        catch(std::exception& e)
+        {
+            RootLogError("Pool task " + task->name_ + " failed: " + e.what());
+        }
+        catch(...)
+        {
+            RootLogError("Pool task " + task->name_ + " failed");
+        }
+        // Release what the function holds now, the task object may be kept around by its submitter
+        task->function_ = PoolTaskFunction();
+        Core::tick_t end = Core::GetCurrentClockTime();
+
+        {
+            f64 freq = (f64)Core::GetCurrentClockFreq();
+            f64 wait = (f64)(start - task->queue_time_) / freq;
+            f64 run = (f64)(end - start) / freq;
+
+            MutexLock lock(stats_mutex_);
+            PoolTaskStats& stats = stats_[task->name_];
+            ++stats.tasks_;
+            stats.total_wait_ += wait;
+            stats.total_run_ += run;
+            if (wait > stats.max_wait_)
+                stats.max_wait_ = wait;
+            if (run > stats.max_run_)
+                stats.max_run_ = run;
+        }
+    }
+}
@@ -0,0 +1,175 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Foundation_TaskPool_h
+#define incl_Foundation_TaskPool_h
+
+#include "CoreTypes.h"
+#include "CoreThread.h"
+#include "HighPerfClock.h"
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Foundation
+{
+    class TaskPool;
+
+    //! Function run by a pool task
+    typedef boost::function<void ()> PoolTaskFunction;
+
+    //! A unit of work run by a TaskPool. Created with TaskPool::Submit()
+    class PoolTask
+    {
+        friend class TaskPool;
+
+    public:
+        //! Returns task name
+        const std::string& GetName() const { return name_; }
+
+    private:
+        PoolTask(const std::string& name, PoolTaskFunction function);
+
+        //! Task name, stats are collected per name
+        std::string name_;
+        //! Function to run
+        PoolTaskFunction function_;
+        //! Clock time when the task was queued
+        Core::tick_t queue_time_;
+    };
+
+    typedef boost::shared_ptr<PoolTask> PoolTaskPtr;
+
+    //! Statistics of pool tasks with the same name
+    struct PoolTaskStats
+    {
+        PoolTaskStats() : tasks_(0), total_wait_(0.0), max_wait_(0.0), total_run_(0.0), max_run_(0.0) {}
+
+        //! Number of tasks run
+        uint tasks_;
+        //! Total time from queuing to start of run, in seconds
+        f64 total_wait_;
+        //! Longest time from queuing to start of run, in seconds
+        f64 max_wait_;
+        //! Total run time, in seconds
+        f64 total_run_;
+        //! Longest run time, in seconds
+        f64 max_run_;
+    };
+
+    //! Thread pool shared by the threaded work of all modules
+    /*! Each worker thread has its own task queue. Tasks submitted from a worker go to the queue of that worker
+        and are run newest first, while tasks submitted from other threads go to a shared queue. An idle worker
+        takes the oldest task of the shared queue, or steals the oldest task of another worker. Results are
+        delivered to the main thread through the ThreadTaskManager.
+
+        Tasks run in any worker and in any order. Work that must be serialized, such as the Work() of a
+        ThreadTask, has to submit its next step only after the previous one has run.
+
+        There is a system-wide TaskPool in the framework's ThreadTaskManager.
+
+        \ingroup Foundation_group
+     */
+    class TaskPool
+    {
+    public:
+        //! Constructor. Starts the worker threads
+        /*! \param num_threads number of worker threads, 0 for one less than the number of hardware threads, but at least 2
+         */
+        explicit TaskPool(uint num_threads);
+
+        //! Destructor. Stops the worker threads. Tasks that have not started are not run
+        ~TaskPool();
+
+        //! Queues a task to run in a worker thread. Thread safe
+        /*! \param name task name, stats are collected per name
+            \param function function to run
+            \return the task
+         */
+        PoolTaskPtr Submit(const std::string& name, PoolTaskFunction function);
+
+        //! Returns number of worker threads
+        uint GetNumThreads() const { return workers_.size(); }
+
+        //! Returns number of tasks waiting for a worker thread
+        uint GetQueueDepth();
+
+        //! Returns highest number of tasks that have been waiting for a worker thread at once
+        uint GetMaxQueueDepth();
+
+        //! Returns number of tasks a worker has taken from the queue of another worker
+        uint GetNumSteals();
+
+        //! Returns stats by task name
+        std::map<std::string, PoolTaskStats> GetStats();
+
+        //! Clears the stats and the highest queue depth
+        void ResetStats();
+
+    private:
+        TaskPool(const TaskPool &);
+        TaskPool &operator =(const TaskPool &);
+
+        //! A worker thread and its tasks
+        struct Worker
+        {
+            //! Protects the task queue
+            Mutex mutex_;
+            //! Tasks submitted from this worker
+            std::deque<PoolTaskPtr> tasks_;
+            //! Thread
+            Thread thread_;
+        };
+
+        typedef boost::shared_ptr<Worker> WorkerPtr;
+
+        //! Worker thread main loop
+        void RunWorker(uint index);
+
+        //! Returns index of the worker running the calling thread, or -1 if not a worker of this pool
+        int GetCurrentWorker() const;
+
+        //! Takes a queued task for a worker: newest of its own, oldest of the shared queue, or oldest of another worker. Call with wake_mutex_ locked
+        PoolTaskPtr TakeTask(uint index);
+
+        //! Queues a task
+        void Enqueue(PoolTaskPtr task);
+
+        //! Runs a task & updates the stats
+        void RunTask(PoolTaskPtr task);
+
+        //! Worker threads
+        std::vector<WorkerPtr> workers_;
+
+        //! Protects the shared queue
+        Mutex shared_mutex_;
+        //! Tasks submitted from outside the worker threads
+        std::deque<PoolTaskPtr> shared_tasks_;
+
+        //! Protects the queue counts & the stop flag. Held by a worker while it takes a task
+        Mutex wake_mutex_;
+        //! Wakes up idle workers
+        Condition wake_condition_;
+        //! Number of queued tasks not yet taken by a worker
+        uint num_queued_;
+        //! Highest number of queued tasks
+        uint max_queued_;
+        //! Whether the workers should stop
+        bool stop_;
+
+        //! Protects the stats
+        Mutex stats_mutex_;
+        //! Stats by task name
+        std::map<std::string, PoolTaskStats> stats_;
+        //! Number of tasks stolen from other workers
+        uint steals_;
+    };
+
+    typedef boost::shared_ptr<TaskPool> TaskPoolPtr;
+}
+
+#endif
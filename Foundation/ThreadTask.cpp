@@ -4,27 +4,63 @@
 #include "Foundation.h"
 #include "ThreadTask.h"
 #include "ThreadTaskManager.h"
+#include "TaskPool.h"
 #include "ForwardDefines.h"
+#include "CoreAtomic.h"
+
+#include <boost/bind.hpp>
 
 namespace Foundation
 {
-    ThreadTask::ThreadTask(const std::string& task_description) :
+    ThreadTask::ThreadTask(const std::string& task_description, bool dedicated_thread) :
         keep_running_(true),
         task_description_(task_description),
         task_manager_(0),
+        task_id_(0),
+        num_queued_results_(0),
         running_(false),
-        finished_(false)
+        finished_(false),
+        dedicated_thread_(dedicated_thread),
+        pooled_(false),
+        scheduled_(false),
+        idle_(false),
+        deferred_(false)
     {
+        result_head_ = result_tail_ = new ResultNode();
     }
 
     ThreadTask::~ThreadTask()
     {
         Stop();
+
+        while (result_tail_)
+        {
+            ResultNode* next = result_tail_->next_;
+            delete result_tail_;
+            result_tail_ = next;
+        }
     }
 
     void ThreadTask::Stop()
     {
         keep_running_ = false;
+
+        if (pooled_)
+        {
+            ScopedLock lock(request_mutex_);
+            // Stopping from the task's own Work(), which returns by itself
+            if (work_thread_id_ == boost::this_thread::get_id())
+                return;
+            while (scheduled_)
+                work_done_condition_.wait(lock);
+            if (running_)
+            {
+                running_ = false;
+                finished_ = true;
+            }
+            return;
+        }
+
         request_condition_.notify_one();
         
         thread_.join();
@@ -37,15 +73,33 @@ namespace Foundation
             if (!running_)
             {
                 thread_.join(); // Make sure it's really stopped, not just set the flag to false
+                TaskPool* pool = 0;
+                if ((!dedicated_thread_) && (task_manager_))
+                    pool = task_manager_->GetTaskPool().get();
+
+                MutexLock lock(request_mutex_);
                 requests_.push_back(request);
                 running_ = true;
                 finished_ = false;
-                thread_ = boost::thread(boost::ref(*this));
+                pooled_ = pool != 0;
+                if (pooled_)
+                {
+                    scheduled_ = true;
+                    pool->Submit(task_description_, boost::bind(&ThreadTask::RunPooledWork, this));
+                }
+                else
+                    thread_ = boost::thread(boost::ref(*this));
             }
             else
             {
                 MutexLock lock(request_mutex_);
                 requests_.push_back(request);
+                // Wake up pooled work that has run out of requests. Deferred work is woken up by the thread task manager
+                if ((pooled_) && (!scheduled_) && (!deferred_) && (task_manager_))
+                {
+                    scheduled_ = true;
+                    task_manager_->GetTaskPool()->Submit(task_description_, boost::bind(&ThreadTask::RunPooledWork, this));
+                }
             }
             request_condition_.notify_one();
         }
@@ -55,6 +109,12 @@ namespace Foundation
         }
     }
 
+    uint ThreadTask::GetNumRequests()
+    {
+        MutexLock lock(request_mutex_);
+        return requests_.size();
+    }
+
     ThreadTaskResultPtr ThreadTask::GetResult() const
     {
         if (!finished_)
@@ -69,10 +129,55 @@ namespace Foundation
         running_ = false;
         finished_ = true;
     }
+
+    void ThreadTask::RunPooledWork()
+    {
+        for (;;)
+        {
+            {
+                MutexLock lock(request_mutex_);
+                work_thread_id_ = boost::this_thread::get_id();
+                idle_ = false;
+            }
+
+            if (keep_running_)
+                Work();
+
+            MutexLock lock(request_mutex_);
+            work_thread_id_ = boost::thread::id();
+            if ((idle_) && (keep_running_))
+            {
+                // A request that arrived after Work() saw the queue empty is handled right away
+                if ((!deferred_) && (!requests_.empty()))
+                    continue;
+
+                // Out of requests, AddRequest() runs Work() again. Or waiting for results to be collected, ResumeDeferredWork() runs it
+                scheduled_ = false;
+            }
+            else
+            {
+                // Work() returned by itself, like a one-shot task does, or the task was stopped
+                scheduled_ = false;
+                running_ = false;
+                finished_ = true;
+            }
+            idle_ = false;
+            work_done_condition_.notify_all();
+            return;
+        }
+    }
     
     bool ThreadTask::WaitForRequests()
     {
         ScopedLock lock(request_mutex_);
+        if (pooled_)
+        {
+            // Do not hold the pool thread, return from Work() instead
+            if (requests_.empty())
+                idle_ = true;
+            return (!requests_.empty());
+        }
+
         while (requests_.empty() && keep_running_)
         {
             request_condition_.wait(lock);
@@ -81,6 +186,36 @@ namespace Foundation
         return (!requests_.empty());
     }
     
+    void ThreadTask::WaitForResultsCollected()
+    {
+        {
+            MutexLock lock(request_mutex_);
+            if (pooled_)
+            {
+                // Do not hold the pool thread, return from Work() instead
+                deferred_ = true;
+                idle_ = true;
+                return;
+            }
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    }
+
+    void ThreadTask::ResumeDeferredWork()
+    {
+        if (!deferred_)
+            return;
+
+        MutexLock lock(request_mutex_);
+        // If Work() has not returned yet, it is resumed on the next collection
+        if ((!deferred_) || (scheduled_) || (!keep_running_) || (!task_manager_))
+            return;
+        deferred_ = false;
+        scheduled_ = true;
+        task_manager_->GetTaskPool()->Submit(task_description_, boost::bind(&ThreadTask::RunPooledWork, this));
+    }
+    
     ThreadTaskRequestPtr ThreadTask::GetNextRequest()
     {
         ThreadTaskRequestPtr request;
@@ -116,7 +251,12 @@ namespace Foundation
             if (task_manager_)
             {
                 result->task_description_ = task_description_;
-                task_manager_->QueueResult(result);
+
+                ResultNode* node = new ResultNode();
+                node->result_ = result;
+                Core::AtomicAdd(&num_queued_results_, 1);
+                ResultNode* prev = Core::AtomicExchangePointer(&result_head_, node);
+                Core::AtomicStorePointer(&prev->next_, node);
                 return true;
             }
             else
@@ -131,4 +271,21 @@ namespace Foundation
         
         return false;
     }
+    
+    void ThreadTask::TakeQueuedResults(std::vector<ThreadTaskResultPtr>& results)
+    {
+        for (;;)
+        {
+            // A null link means the queue is empty, or a work thread is just adding a result; it is taken next time
+            ResultNode* next = Core::AtomicLoadPointer(&result_tail_->next_);
+            if (!next)
+                break;
+
+            delete result_tail_;
+            result_tail_ = next;
+            results.push_back(next->result_);
+            next->result_.reset();
+            Core::AtomicAdd(&num_queued_results_, -1);
+        }
+    }
 }
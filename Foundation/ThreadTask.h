@@ -38,12 +38,24 @@ namespace Foundation
     };
     
     typedef boost::shared_ptr<ThreadTaskResult> ThreadTaskResultPtr;
+
+    //! Identifier of a thread task in a ThreadTaskManager, assigned when the task is added. 0 is never used
+    typedef uint thread_task_id_t;
     
     //! A class for performing threaded work.
     /*! Subclass to use and implement the Work() function. The work can either be 
         - one-shot, use SetResult() and terminate work thread
         - continuous, use QueueResult() to queue results to the thread task manager, while work thread keeps running
           In this mode a thread task manager is needed to post results to, otherwise results will be lost
+
+        When the task has been added to a thread task manager, Work() runs in the manager's TaskPool instead of a
+        thread of its own. There WaitForRequests() does not block: when no requests are left, it makes ShouldRun()
+        return false so that Work() returns, and Work() is run again when the next request arrives. Work() is never
+        run by two threads at once. A task that should not produce more results until the main thread has taken
+        the previous ones calls WaitForResultsCollected(), instead of sleeping in the pool thread. Tasks that block for long, such as network transfers, or that keep working
+        without requests, should ask for a dedicated thread in the constructor instead.
+
+        Queued results go to a lock-free queue of the task, from where the thread task manager collects them.
      */
     class ThreadTask
     {
@@ -53,8 +65,9 @@ namespace Foundation
         //! Constructor
         /*! \param task_description Description of the work this thread will be doing. Should be unique,
             if work requests are to be communicated via the foundation's default ThreadTaskManager
+            \param dedicated_thread If true, Work() always runs in a thread of its own instead of the task pool
          */
-        ThreadTask(const std::string& task_description);
+        ThreadTask(const std::string& task_description, bool dedicated_thread = false);
         
         //! Destructor
         /*! Calls Stop(). Note that in subclass destructors, it would be safest to call Stop() first, at least before
@@ -64,6 +77,9 @@ namespace Foundation
         
         //! Returns task description.
         const std::string& GetTaskDescription() { return task_description_; }
+
+        //! Returns task id, or 0 if not added to a thread task manager
+        thread_task_id_t GetTaskId() const { return task_id_; }
         
         //! Adds a work request and starts the work thread if not running
         void AddRequest(ThreadTaskRequestPtr request);
@@ -90,6 +106,15 @@ namespace Foundation
 
         //! Checks if work thread has been run & finished
         bool HasFinished() const { return finished_; }
+
+        //! Checks if Work() runs in the task pool of the thread task manager
+        bool IsPooled() const { return pooled_; }
+
+        //! Returns number of requests waiting to be handled
+        uint GetNumRequests();
+
+        //! Returns number of queued results not yet collected by the thread task manager
+        uint GetNumQueuedResults() const { return (uint)num_queued_results_; }
         
         //! Commands the work thread to stop after current iteration is complete (continuous tasks only)
         void Stop();
@@ -108,6 +133,12 @@ namespace Foundation
          */
         bool WaitForRequests();
         
+        //! Pauses work until the thread task manager has collected the queued results, e.g. to limit results per frame
+        /*! In the task pool, makes ShouldRun() return false so that Work() returns, leaving the requests queued.
+            Work() is run again when the thread task manager collects the results. In a dedicated thread, sleeps for a moment.
+         */
+        void WaitForResultsCollected();
+        
         //! Gets the next request from the request queue. Returns 0 if queue empty
         ThreadTaskRequestPtr GetNextRequest();
         
@@ -153,13 +184,36 @@ namespace Foundation
         ThreadTaskManager* GetThreadTaskManager() const { return task_manager_; }
         
         //! Whether should keep running the continuous work loop
-        bool ShouldRun() const { return keep_running_; }
+        bool ShouldRun() const { return keep_running_ && !idle_; }
         
     private:
+        //! Runs Work() in the task pool until no requests are left
+        void RunPooledWork();
+        
         //! Sets task manager. Needs to be set to use queued results, otherwise they will be lost
         /*! \param manager Task manager
          */
         void SetThreadTaskManager(ThreadTaskManager* manager) { task_manager_ = manager; }
+
+        //! Sets task id. Called by the thread task manager
+        void SetTaskId(thread_task_id_t id) { task_id_ = id; }
+
+        //! Moves the queued results to a vector. Called by the thread task manager, by one thread at a time
+        /*! \param results vector to append the results to
+         */
+        void TakeQueuedResults(std::vector<ThreadTaskResultPtr>& results);
+
+        //! Runs pooled Work() again if it is waiting for the results to be collected. Called by the thread task manager after taking the results
+        void ResumeDeferredWork();
+
+        //! Node of the lock-free result queue
+        struct ResultNode
+        {
+            ResultNode() : next_(0) {}
+
+            ThreadTaskResultPtr result_;
+            ResultNode * volatile next_;
+        };
         
         //! Task description
         std::string task_description_;
@@ -173,16 +227,38 @@ namespace Foundation
         std::list<ThreadTaskRequestPtr> requests_;
         //! Work thread
         Thread thread_;
+        //! Signaled when pooled Work() returns
+        Condition work_done_condition_;
+        //! Thread running pooled Work() now
+        boost::thread::id work_thread_id_;
         //! Final result, available when work finished
         ThreadTaskResultPtr result_;
         //! Thread task manager, collects queued results
         ThreadTaskManager* task_manager_;
+        //! Task id in the thread task manager
+        thread_task_id_t task_id_;
+        //! Newest queued result node, work threads swap themselves in here
+        ResultNode * volatile result_head_;
+        //! Oldest result node, already collected. Accessed by the thread task manager only
+        ResultNode *result_tail_;
+        //! Number of queued results not yet collected
+        long volatile num_queued_results_;
         //! Keep running-flag
         bool keep_running_;
         //! Running flag
         bool running_;
         //! Finished flag
         bool finished_;
+        //! Whether always runs in a thread of its own
+        bool dedicated_thread_;
+        //! Whether Work() runs in the task pool
+        bool pooled_;
+        //! Whether pooled Work() is queued or running
+        bool scheduled_;
+        //! Whether pooled Work() found no requests, and should return
+        bool idle_;
+        //! Whether pooled Work() waits for the queued results to be collected
+        bool deferred_;
     };
     
     typedef boost::shared_ptr<ThreadTask> ThreadTaskPtr;
@@ -5,13 +5,24 @@
 #include "ForwardDefines.h"
 #include "Framework.h"
 #include "EventManager.h"
+#include "ConfigurationManager.h"
 
 namespace Foundation
 {
 
     ThreadTaskManager::ThreadTaskManager(Framework* framework) :
+        next_task_id_(1),
         framework_(framework)
     {
+        // Additional managers run their tasks in the pool of the system-wide manager, instead of starting threads of their own
+        ThreadTaskManagerPtr system_manager = framework_->GetThreadTaskManager();
+        if (system_manager)
+            task_pool_ = system_manager->GetTaskPool();
+        else
+        {
+            int num_threads = framework_->GetDefaultConfig().DeclareSetting(Framework::ConfigurationGroup(), "task_pool_threads", 0);
+            task_pool_ = TaskPoolPtr(new TaskPool(num_threads > 0 ? num_threads : 0));
+        }
     }
 
     ThreadTaskManager::~ThreadTaskManager()
@@ -23,35 +34,42 @@ namespace Foundation
             (*i)->SetThreadTaskManager(0);
             ++i;
         }
+
+        // Pooled tasks have returned from Work() now
+        task_pool_.reset();
     }
 
-    void ThreadTaskManager::AddThreadTask(ThreadTaskPtr task)
+    thread_task_id_t ThreadTaskManager::AddThreadTask(ThreadTaskPtr task)
     {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
             if ((*i) == task)
             {
                 RootLogWarning("Thread task " + task->GetTaskDescription() + " already added");
-                return; // Already added
+                return task->GetTaskId(); // Already added
             }
             ++i;
         }
         
         task->SetThreadTaskManager(this);
+        task->SetTaskId(next_task_id_++);
+        if (!next_task_id_)
+            next_task_id_ = 1;
         tasks_.push_back(task);
+        return task->GetTaskId();
     }
 
     void ThreadTaskManager::RemoveThreadTask(ThreadTaskPtr task)
     {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
             if ((*i) == task)
             {
-                (*i)->Stop();
-                (*i)->SetThreadTaskManager(0);
-                tasks_.erase(i);
+                EraseTask(i);
                 return;
             }
             ++i;
@@ -62,14 +80,13 @@ namespace Foundation
 
     void ThreadTaskManager::RemoveThreadTask(const std::string& task_description)
     {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
             if ((*i)->GetTaskDescription() == task_description)
             {
-                (*i)->Stop();
-                (*i)->SetThreadTaskManager(0);
-                tasks_.erase(i);
+                EraseTask(i);
                 return;
             }
             ++i;
@@ -80,23 +97,56 @@ namespace Foundation
     
     void ThreadTaskManager::RemoveThreadTasks()
     {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
+        std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
+        while (i != tasks_.end())
+            i = EraseTask(i);
+    }
+
+    std::vector<ThreadTaskPtr>::iterator ThreadTaskManager::EraseTask(std::vector<ThreadTaskPtr>::iterator i)
+    {
+        ThreadTaskPtr task = *i;
+        task->Stop();
+
+        TaskResults removed;
+        removed.id_ = task->GetTaskId();
+        task->TakeQueuedResults(removed.results_);
+        if (!removed.results_.empty())
+            removed_task_results_.push_back(removed);
+
+        result_handlers_.erase(task->GetTaskId());
+        task->SetThreadTaskManager(0);
+        task->SetTaskId(0);
+        return tasks_.erase(i);
+    }
+    
+    std::vector<ThreadTaskPtr> ThreadTaskManager::GetThreadTasks()
+    {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
+        return tasks_;
+    }
+
+    ThreadTaskPtr ThreadTaskManager::GetThreadTask(const std::string& task_description)
+    {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
-            (*i)->Stop();
-            (*i)->SetThreadTaskManager(0);
+            if ((*i)->GetTaskDescription() == task_description)
+                return (*i);
             ++i;
         }
         
-        tasks_.clear();
+        return ThreadTaskPtr();
     }
-    
-    ThreadTaskPtr ThreadTaskManager::GetThreadTask(const std::string& task_description)
+
+    ThreadTaskPtr ThreadTaskManager::GetThreadTask(thread_task_id_t id)
     {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
-            if ((*i)->GetTaskDescription() == task_description)
+            if ((*i)->GetTaskId() == id)
                 return (*i);
             ++i;
         }
@@ -108,6 +158,7 @@ namespace Foundation
     {
         if (request)
         {
+            RecursiveMutexLock tasks_lock(tasks_mutex_);
             std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
             while (i != tasks_.end())
             {
@@ -130,118 +181,177 @@ namespace Foundation
         
         return 0;
     }
-    
-    void ThreadTaskManager::QueueResult(ThreadTaskResultPtr result)
+
+    request_tag_t ThreadTaskManager::AddRequest(thread_task_id_t id, ThreadTaskRequestPtr request)
     {
-        MutexLock lock(result_mutex_);
-        results_.push_back(result);
+        if (request)
+        {
+            ThreadTaskPtr task = GetThreadTask(id);
+            if (task)
+            {
+                request_tag_t tag = framework_->GetEventManager()->GetNextRequestTag();
+                request->tag_ = tag;
+                task->AddRequest(request);
+                return tag;
+            }
+            
+            RootLogError("No thread task with id " + ToString<thread_task_id_t>(id) + ", could not queue request");
+        }
+        else
+        {
+            RootLogError("Null request passed to AddRequest");
+        }
+        
+        return 0;
+    }
+
+    void ThreadTaskManager::RegisterResultHandler(thread_task_id_t id, ThreadTaskResultHandler handler)
+    {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
+        result_handlers_[id] = handler;
+    }
+
+    void ThreadTaskManager::UnregisterResultHandler(thread_task_id_t id)
+    {
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
+        result_handlers_.erase(id);
     }
 
     void ThreadTaskManager::SendResultEvents()
     {
-        std::vector<ThreadTaskResultPtr> results = GetResults();
-        EventManagerPtr event_manager = framework_->GetEventManager();
-        event_category_id_t threadtask_category = event_manager->QueryEventCategory("Task");
-        
-        std::vector<ThreadTaskResultPtr>::iterator i = results.begin();
-        while (i != results.end())
+        std::vector<TaskResults> results;
         {
-            event_manager->SendEvent(threadtask_category, Task::Events::REQUEST_COMPLETED, (*i).get());
-            ++i;
+            RecursiveMutexLock tasks_lock(tasks_mutex_);
+            CollectResults(results, std::string(), 0);
         }
-    }
+        if (results.empty())
+            return;
 
-    std::vector<ThreadTaskResultPtr> ThreadTaskManager::GetResults()
-    {
-        std::vector<ThreadTaskResultPtr> results;
+        EventManagerPtr event_manager = framework_->GetEventManager();
+        event_category_id_t threadtask_category = event_manager->QueryEventCategory("Task");
         
-        // Get non-queued results from tasks, delete finished tasks
-        std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
-        while (i != tasks_.end())
+        for (uint i = 0; i < results.size(); ++i)
         {
-            if ((*i)->HasFinished())
+            // Look up the handler for each batch, an earlier handler may have changed the handlers
+            ThreadTaskResultHandler handler;
             {
-                ThreadTaskResultPtr result = (*i)->GetResult();
-                if (result)
-                    results.push_back(result);
-                i = tasks_.erase(i);
+                RecursiveMutexLock tasks_lock(tasks_mutex_);
+                std::map<thread_task_id_t, ThreadTaskResultHandler>::iterator h = result_handlers_.find(results[i].id_);
+                if (h != result_handlers_.end())
+                    handler = h->second;
             }
-            else ++i;
-        }
-        
-        // Add queued results
-        {
-            MutexLock lock(result_mutex_);
 
-            std::list<ThreadTaskResultPtr>::iterator i = results_.begin();
-            while (i != results_.end())
+            if (handler)
             {
-                results.push_back(*i);
-                ++i;
+                handler(results[i].results_);
+                continue;
+            }
+
+            std::vector<ThreadTaskResultPtr>::iterator j = results[i].results_.begin();
+            while (j != results[i].results_.end())
+            {
+                event_manager->SendEvent(threadtask_category, Task::Events::REQUEST_COMPLETED, (*j).get());
+                ++j;
             }
-            
-            results_.clear();
         }
-        
-        return results;
     }
 
-    std::vector<ThreadTaskResultPtr> ThreadTaskManager::GetResults(const std::string& task_description)
+    void ThreadTaskManager::CollectResults(std::vector<TaskResults>& results, const std::string& task_description, thread_task_id_t id)
     {
-        std::vector<ThreadTaskResultPtr> results;
-        
-        // Get non-queued results from tasks, delete finished tasks
+        // Results of removed tasks first, they were queued before any of the current ones
+        std::vector<TaskResults>::iterator r = removed_task_results_.begin();
+        while (r != removed_task_results_.end())
+        {
+            if (((!id) || (r->id_ == id)) && ((task_description.empty()) || (r->results_[0]->task_description_ == task_description)))
+            {
+                results.push_back(*r);
+                r = removed_task_results_.erase(r);
+            }
+            else ++r;
+        }
+
+        // Get queued & final results from tasks, delete finished tasks
         std::vector<ThreadTaskPtr>::iterator i = tasks_.begin();
         while (i != tasks_.end())
         {
-            if (((*i)->GetTaskDescription() == task_description) && ((*i)->HasFinished()))
+            ThreadTaskPtr task = *i;
+            if (((id) && (task->GetTaskId() != id)) || ((!task_description.empty()) && (task->GetTaskDescription() != task_description)))
             {
-                ThreadTaskResultPtr result = (*i)->GetResult();
+                ++i;
+                continue;
+            }
+
+            TaskResults task_results;
+            task_results.id_ = task->GetTaskId();
+            task->TakeQueuedResults(task_results.results_);
+            task->ResumeDeferredWork();
+
+            if (task->HasFinished())
+            {
+                ThreadTaskResultPtr result = task->GetResult();
                 if (result)
-                    results.push_back(result);
+                    task_results.results_.push_back(result);
                 i = tasks_.erase(i);
             }
             else ++i;
+
+            if (!task_results.results_.empty())
+                results.push_back(task_results);
         }
-        
-        // Add queued results
+    }
+
+    std::vector<ThreadTaskResultPtr> ThreadTaskManager::GetResults()
+    {
+        return GetResults(std::string());
+    }
+
+    std::vector<ThreadTaskResultPtr> ThreadTaskManager::GetResults(const std::string& task_description)
+    {
+        std::vector<TaskResults> task_results;
         {
-            MutexLock lock(result_mutex_);
+            RecursiveMutexLock tasks_lock(tasks_mutex_);
+            CollectResults(task_results, task_description, 0);
+        }
 
-            std::list<ThreadTaskResultPtr>::iterator i = results_.begin();
-            while (i != results_.end())
-            {
-                if ((*i)->task_description_ == task_description)
-                {
-                    results.push_back(*i);
-                    i = results_.erase(i);
-                }
-                else ++i;
-            }
+        std::vector<ThreadTaskResultPtr> results;
+        for (uint i = 0; i < task_results.size(); ++i)
+            results.insert(results.end(), task_results[i].results_.begin(), task_results[i].results_.end());
+        return results;
+    }
+
+    std::vector<ThreadTaskResultPtr> ThreadTaskManager::GetResults(thread_task_id_t id)
+    {
+        std::vector<TaskResults> task_results;
+        {
+            RecursiveMutexLock tasks_lock(tasks_mutex_);
+            CollectResults(task_results, std::string(), id);
         }
-        
+
+        std::vector<ThreadTaskResultPtr> results;
+        for (uint i = 0; i < task_results.size(); ++i)
+            results.insert(results.end(), task_results[i].results_.begin(), task_results[i].results_.end());
         return results;
     }
 
     uint ThreadTaskManager::GetNumResults()
     {
-        MutexLock lock(result_mutex_);
-        return results_.size();
+        return GetNumResults(std::string());
     }
     
     uint ThreadTaskManager::GetNumResults(const std::string& task_description)
     {
         uint num = 0;
         
+        RecursiveMutexLock tasks_lock(tasks_mutex_);
+        for (uint i = 0; i < removed_task_results_.size(); ++i)
         {
-            MutexLock lock(result_mutex_);
-            std::list<ThreadTaskResultPtr>::iterator i = results_.begin();
-            while (i != results_.end())
-            {
-                if ((*i)->task_description_ == task_description)
-                    ++num;
-                ++i;
-            }
+            if ((task_description.empty()) || (removed_task_results_[i].results_[0]->task_description_ == task_description))
+                num += removed_task_results_[i].results_.size();
+        }
+        for (uint i = 0; i < tasks_.size(); ++i)
+        {
+            if ((task_description.empty()) || (tasks_[i]->GetTaskDescription() == task_description))
+                num += tasks_[i]->GetNumQueuedResults();
         }
         
         return num;
@@ -4,23 +4,60 @@
 #define incl_Foundation_ThreadTaskManager_h
 
 #include "ThreadTask.h"
+#include "TaskPool.h"
+
+#include <boost/function.hpp>
 
 namespace Foundation
 {
     class Framework;
+
+    //! Handler of thread task results, called in the main thread with the results of one frame at once
+    typedef boost::function<void (const std::vector<ThreadTaskResultPtr>&)> ThreadTaskResultHandler;
+
+    //! Passes results to a handler of a specific result type, leaving out results of other types
+    template <class T> class TypedThreadTaskResultHandler
+    {
+    public:
+        typedef boost::function<void (const std::vector<boost::shared_ptr<T> >&)> HandlerFunction;
+
+        explicit TypedThreadTaskResultHandler(HandlerFunction handler) : handler_(handler) {}
+
+        void operator()(const std::vector<ThreadTaskResultPtr>& results) const
+        {
+            std::vector<boost::shared_ptr<T> > typed_results;
+            typed_results.reserve(results.size());
+            for (uint i = 0; i < results.size(); ++i)
+            {
+                boost::shared_ptr<T> result = boost::dynamic_pointer_cast<T>(results[i]);
+                if (result)
+                    typed_results.push_back(result);
+            }
+            if (!typed_results.empty())
+                handler_(typed_results);
+        }
+
+    private:
+        HandlerFunction handler_;
+    };
     
     //! Manager of ThreadTasks.
     /*! Takes ownership of ThreadTasks to handle results from them. Necessary to use ThreadTasks in queued result mode.
         There exists a system-wide ThreadTaskManager in the framework, but nothing prevents you creating your own additional
         ThreadTaskManager and registering tasks to it instead.
+
+        The system-wide ThreadTaskManager owns the TaskPool the added ThreadTasks run in. Additional ThreadTaskManagers
+        share the pool of the system-wide one.
+
+        Each added task gets an id. Results of a task for which a result handler is registered by the id are passed
+        to the handler once per frame, all at once, instead of being sent as one REQUEST_COMPLETED event per result.
      */
     class ThreadTaskManager
     {
-        friend class ThreadTask;
-        
     public:
         //! Constructor
-        /*! \param framework Framework, needed for sending events
+        /*! \param framework Framework, needed for sending events. If it has no ThreadTaskManager yet, a task pool is created
+            with the size read from its default config, otherwise the pool of the framework's ThreadTaskManager is used
          */
         explicit ThreadTaskManager(Framework* framework);
         
@@ -29,12 +66,14 @@ namespace Foundation
         
         //! Adds a ThreadTask
         /*! \param task Task to add
+            \return task id
             To not lose any queued results, adding the task to the manager should always be done before adding work requests to the task.
          */
-        void AddThreadTask(ThreadTaskPtr task);
+        thread_task_id_t AddThreadTask(ThreadTaskPtr task);
         
-        //! Removes a ThreadTask
+        //! Removes a ThreadTask, and its result handler
         /*! \param task Task to remove
+            Results the task has queued are still delivered.
          */
         void RemoveThreadTask(ThreadTaskPtr task);
         
@@ -47,11 +86,20 @@ namespace Foundation
         //! Removes all ThreadTasks
         void RemoveThreadTasks();
         
+        //! Gets all ThreadTasks
+        std::vector<ThreadTaskPtr> GetThreadTasks();
+
+        //! Gets the task pool
+        TaskPoolPtr GetTaskPool() const { return task_pool_; }
+        
         //! Gets a ThreadTask by task description
         /*! If many tasks with same description, gets the first one
             \param task_description Task description
          */
         ThreadTaskPtr GetThreadTask(const std::string& task_description);
+
+        //! Gets a ThreadTask by task id
+        ThreadTaskPtr GetThreadTask(thread_task_id_t id);
         
         //! Adds a request by task description
         /*! \param task_description Task description
@@ -70,8 +118,40 @@ namespace Foundation
         {
             return AddRequest(task_description, boost::dynamic_pointer_cast<ThreadTaskRequest>(request));
         }
+
+        //! Adds a request by task id
+        /*! \param id Task id
+            \param request Task request
+            \return a non-zero request tag if request could be fulfilled, zero if not
+         */
+        request_tag_t AddRequest(thread_task_id_t id, ThreadTaskRequestPtr request);
+
+        //! Template version of adding request by task id. Perfoms dynamic_pointer_cast to ThreadTaskRequest from specified class.
+        template <class T> request_tag_t AddRequest(thread_task_id_t id, boost::shared_ptr<T> request)
+        {
+            return AddRequest(id, boost::dynamic_pointer_cast<ThreadTaskRequest>(request));
+        }
+
+        //! Registers a handler for the results of a task. Replaces a previous handler of the task
+        /*! \param id Task id
+            \param handler Handler, called in the main thread with the results of each frame
+         */
+        void RegisterResultHandler(thread_task_id_t id, ThreadTaskResultHandler handler);
+
+        //! Template version of registering a result handler, for results of the specified class. Results of other classes are left out
+        /*! \param id Task id
+            \param handler Handler, called in the main thread with the results of each frame
+         */
+        template <class T> void RegisterResultHandler(thread_task_id_t id, typename TypedThreadTaskResultHandler<T>::HandlerFunction handler)
+        {
+            RegisterResultHandler(id, ThreadTaskResultHandler(TypedThreadTaskResultHandler<T>(handler)));
+        }
+
+        //! Unregisters the result handler of a task. Further results are sent as events
+        void UnregisterResultHandler(thread_task_id_t id);
         
-        //! Checks for results and sends them as events. Deletes finished ThreadTasks.
+        //! Checks for results and passes them to the result handlers, or sends them
+        //! as events. Deletes finished ThreadTasks.
         /*! Framework calls this for the system-wide ThreadTaskManager on each run of the main loop.
          */
         void SendResultEvents();
@@ -81,6 +161,9 @@ namespace Foundation
         
         //! Gets results matching a certain task description. Does not send them as events. Deletes finished ThreadTasks matching description.
         std::vector<ThreadTaskResultPtr> GetResults(const std::string& task_description);
+
+        //! Gets results of a task. Does not pass them to the result handler. Deletes the task if finished.
+        std::vector<ThreadTaskResultPtr> GetResults(thread_task_id_t id);
         
         //! Gets amount of results in queue
         uint GetNumResults();
@@ -89,19 +172,43 @@ namespace Foundation
         uint GetNumResults(const std::string& task_description);
         
     private:
-        //! Queues a result. Called from ThreadTask work thread.
-        /*! \param result Result to queue
+        //! Results of a task collected for delivery
+        struct TaskResults
+        {
+            thread_task_id_t id_;
+            std::vector<ThreadTaskResultPtr> results_;
+        };
+
+        //! Collects results of tasks, by task. Deletes finished ThreadTasks. Call with tasks_mutex_ locked
+        /*! \param results vector to add the results to
+            \param task_description only collect tasks with this description, or all if empty
+            \param id only collect the task with this id, or all if 0
          */
-        void QueueResult(ThreadTaskResultPtr result);
-        
+        void CollectResults(std::vector<TaskResults>& results, const std::string& task_description, thread_task_id_t id);
+
+        //! Stops a task and erases it, keeping its queued results for delivery. Call with tasks_mutex_ locked
+        /*! \param i task to erase
+            \return iterator to the next task
+         */
+        std::vector<ThreadTaskPtr>::iterator EraseTask(std::vector<ThreadTaskPtr>::iterator i);
+
         //! Owned ThreadTasks
         std::vector<ThreadTaskPtr> tasks_;
+
+        //! Task pool
+        TaskPoolPtr task_pool_;
         
-        //! Result queue
-        std::list<ThreadTaskResultPtr> results_;
+        //! ThreadTasks mutex, tasks may be added by modules initialized in a worker thread
+        RecursiveMutex tasks_mutex_;
         
-        //! Result queue mutex
-        Mutex result_mutex_;
+        //! Results of removed tasks, waiting for delivery
+        std::vector<TaskResults> removed_task_results_;
+
+        //! Result handlers by task id
+        std::map<thread_task_id_t, ThreadTaskResultHandler> result_handlers_;
+
+        //! Next task id
+        thread_task_id_t next_task_id_;
         
         //! Framework
         Framework* framework_;
@@ -5,6 +5,8 @@
 
 #include "CoreTypes.h"
 
+#include <boost/function.hpp>
+
 namespace HttpUtilities
 {
     //! Performs a blocking http request
@@ -19,6 +21,9 @@ namespace HttpUtilities
             Post
         };
         
+        //! Receives reply data as it arrives. Return false to abort the request
+        typedef boost::function<bool (const u8 *data, uint size)> ResponseHandler;
+        
         HttpRequest();
         ~HttpRequest();
         
@@ -55,6 +60,12 @@ namespace HttpUtilities
          */
         void SetTimeout(Real seconds);
         
+        //! Sets a handler that gets the reply data in pieces while the request is performed.
+        /*! The data is then not stored, and GetResponseData() returns an empty vector.
+            \param handler Handler, or an empty function to store the data again
+         */
+        void SetResponseHandler(const ResponseHandler &handler) { response_handler_ = handler; }
+        
         //! Performs the request
         void Perform();
         
@@ -92,6 +103,8 @@ namespace HttpUtilities
         std::string content_type_;
         //! Reply data
         std::vector<u8> response_data_;
+        //! Streaming reply data handler
+        ResponseHandler response_handler_;
         //! Request success
         bool success_;
         //! Error reason
@@ -5,14 +5,15 @@
 
 namespace HttpUtilities
 {
+    // Transfers block for long, so they get a thread of their own instead of holding a task pool thread
     HttpTask::HttpTask() :
-        Foundation::ThreadTask("HttpRequest"),
+        Foundation::ThreadTask("HttpRequest", true),
         continuous_(false)
     {
     }
 
     HttpTask::HttpTask(const std::string& task_description, bool continuous) :
-        Foundation::ThreadTask(task_description),
+        Foundation::ThreadTask(task_description, true),
         continuous_(continuous)
     {
     }
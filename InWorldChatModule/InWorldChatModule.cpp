@@ -41,8 +41,6 @@ InWorldChatModule::InWorldChatModule() :
     networkStateEventCategory_(0),
     networkInEventCategory_(0),
     frameworkEventCategory_(0),
-    showChatBubbles_(true),
-    logging_(false),
     logFile_(0)
     //chatWidget_(0)
 {
@@ -73,8 +71,8 @@ void InWorldChatModule::PostInitialize()
         "Sends a chat message. Usage: \"chat(message)\"",
         Console::Bind(this, &InWorldChatModule::ConsoleChat)));
 
-    showChatBubbles_ = framework_->GetDefaultConfig().DeclareSetting("InWorldChatModule", "ShowChatBubbles", true);
-    logging_ = framework_->GetDefaultConfig().DeclareSetting("InWorldChatModule", "Logging", false);
+    showChatBubbles_ = framework_->GetDefaultConfig().DeclareSettingHandle("InWorldChatModule", "ShowChatBubbles", true);
+    logging_ = framework_->GetDefaultConfig().DeclareSettingHandle("InWorldChatModule", "Logging", false);
 }
 
 void InWorldChatModule::Update(f64 frametime)
@@ -111,19 +109,10 @@ bool InWorldChatModule::HandleEvent(event_category_id_t category_id, event_id_t
 
     if (category_id == networkStateEventCategory_)
     {
-        if (event_id == ProtocolUtilities::Events::EVENT_SERVER_CONNECTED)
-        {
-            // Get settings.
-            showChatBubbles_ = framework_->GetDefaultConfig().GetSetting<bool>("InWorldChatModule", "ShowChatBubbles");
-            logging_ = framework_->GetDefaultConfig().GetSetting<bool>("InWorldChatModule", "Logging");
-        }
-        else if (event_id == ProtocolUtilities::Events::EVENT_SERVER_DISCONNECTED)
+        // Setting handles follow changes of the settings, so they need no re-reading on connect.
+        if (event_id == ProtocolUtilities::Events::EVENT_SERVER_DISCONNECTED)
         {
             //SAFE_DELETE(chatWidget_);
-
-            // Save settings.
-            framework_->GetDefaultConfig().SetSetting<bool>("InWorldChatModule", "ShowChatBubbles", showChatBubbles_);
-            framework_->GetDefaultConfig().SetSetting<bool>("InWorldChatModule", "Logging", logging_);
         }
     }
 
@@ -318,7 +307,7 @@ void InWorldChatModule::HandleChatFromSimulatorMessage(ProtocolUtilities::NetInM
     if (message.size() < 1)
         return;
 
-    if (logging_)
+    if (logging_.Get())
     {
         if (!logFile_)
             CreateLogFile();
@@ -333,7 +322,7 @@ void InWorldChatModule::HandleChatFromSimulatorMessage(ProtocolUtilities::NetInM
         }
     }
 
-    if (showChatBubbles_)
+    if (showChatBubbles_.Get())
     {
         Scene::Entity *entity = GetEntityWithId(sourceId);
         if (entity)
@@ -12,6 +12,7 @@
 #include "InWorldChatModuleApi.h"
 #include "ModuleInterface.h"
 #include "ModuleLoggingFunctions.h"
+#include "ConfigurationSetting.h"
 
 #include <QObject>
 
@@ -138,10 +139,10 @@ namespace Naali
         boost::weak_ptr<UiServices::UiModule> uiModule_;
 
         /// Do we want to show the in-world chat bubbles
-        bool showChatBubbles_;
+        Foundation::Setting<bool> showChatBubbles_;
 
         /// Do we want to log the chat messages.
-        bool logging_;
+        Foundation::Setting<bool> logging_;
 
         /// Log file.
         QFile *logFile_;
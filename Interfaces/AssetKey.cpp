@@ -0,0 +1,91 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "AssetKey.h"
+
+#include <QCryptographicHash>
+#include <QByteArray>
+
+namespace Foundation
+{
+    //! Returns value of a hex digit, or -1 if not a hex digit
+    static int HexDigitValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    //! Returns true if position i of a 36-character UUID holds a dash
+    static bool IsUuidDash(size_t i)
+    {
+        return i == 8 || i == 13 || i == 18 || i == 23;
+    }
+
+    bool AssetKey::IsUuid(const std::string& asset_id)
+    {
+        size_t length = asset_id.length();
+        if (length == cSizeBytes * 2)
+        {
+            for(size_t i = 0; i < length; ++i)
+                if (HexDigitValue(asset_id[i]) < 0)
+                    return false;
+            return true;
+        }
+        else if (length == cSizeBytes * 2 + 4)
+        {
+            for(size_t i = 0; i < length; ++i)
+            {
+                if (IsUuidDash(i) ? asset_id[i] != '-' : HexDigitValue(asset_id[i]) < 0)
+                    return false;
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    AssetKey::AssetKey(const std::string& asset_id)
+    {
+        if (IsUuid(asset_id))
+        {
+            const char* str = asset_id.c_str();
+            for(uint i = 0; i < cSizeBytes; ++i)
+            {
+                if (*str == '-')
+                    ++str;
+                data_[i] = (u8)((HexDigitValue(str[0]) << 4) | HexDigitValue(str[1]));
+                str += 2;
+            }
+        }
+        else
+        {
+            QByteArray digest = QCryptographicHash::hash(QByteArray::fromRawData(asset_id.c_str(), asset_id.size()),
+                QCryptographicHash::Md5);
+            memcpy(data_, digest.constData(), cSizeBytes);
+        }
+    }
+
+    std::string AssetKey::ToHexString() const
+    {
+        static const char* digits = "0123456789abcdef";
+        std::string str(cSizeBytes * 2, '0');
+        for(uint i = 0; i < cSizeBytes; ++i)
+        {
+            str[i * 2] = digits[data_[i] >> 4];
+            str[i * 2 + 1] = digits[data_[i] & 0xf];
+        }
+        return str;
+    }
+
+    bool AssetKey::IsNull() const
+    {
+        for(uint i = 0; i < cSizeBytes; ++i)
+            if (data_[i])
+                return false;
+        return true;
+    }
+}
@@ -0,0 +1,72 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_Interfaces_AssetKey_h
+#define incl_Interfaces_AssetKey_h
+
+#include "CoreTypes.h"
+
+#include <string>
+#include <cstring>
+
+namespace Foundation
+{
+    //! Compact 16-byte key of an asset id, for the maps and caches of the asset pipeline
+    /*! Asset ids travel as strings through the asset service API. Internally, maps are keyed by this instead, so that
+        lookups compare and hash 16 bytes instead of strings, and copying a key allocates nothing.
+
+        UUID ids, e.g. "1c1bbda2-304b-4cbf-ba3f-75324b044c73", are stored as their 16 bytes, the same as RexUUID.
+        Other ids, e.g. urls, are stored as the MD5 digest of the id.
+
+        Use with boost::unordered_map, or std::map.
+     */
+    class AssetKey
+    {
+    public:
+        //! Size in bytes
+        static const uint cSizeBytes = 16;
+
+        //! Constructs a null key
+        AssetKey() { memset(data_, 0, cSizeBytes); }
+
+        //! Constructs the key of an asset id
+        explicit AssetKey(const std::string& asset_id);
+
+        //! Constructs a key from 16 bytes
+        static AssetKey FromBytes(const u8* data)
+        {
+            AssetKey key;
+            memcpy(key.data_, data, cSizeBytes);
+            return key;
+        }
+
+        //! Returns true if the asset id is a UUID, which is stored as is
+        static bool IsUuid(const std::string& asset_id);
+
+        //! Returns the key bytes
+        const u8* GetData() const { return data_; }
+
+        //! Returns the key as 32 hex digits, for logging and file names
+        std::string ToHexString() const;
+
+        //! Returns true if all bytes are zero
+        bool IsNull() const;
+
+        bool operator ==(const AssetKey& rhs) const { return memcmp(data_, rhs.data_, cSizeBytes) == 0; }
+        bool operator !=(const AssetKey& rhs) const { return memcmp(data_, rhs.data_, cSizeBytes) != 0; }
+        bool operator <(const AssetKey& rhs) const { return memcmp(data_, rhs.data_, cSizeBytes) < 0; }
+
+    private:
+        u8 data_[cSizeBytes];
+    };
+
+    //! Hash of an asset key, for boost::unordered_map
+    inline std::size_t hash_value(const AssetKey& key)
+    {
+        // The key bytes are UUID or MD5 bytes, which are already well mixed
+        std::size_t hash;
+        memcpy(&hash, key.GetData(), sizeof(hash));
+        return hash;
+    }
+}
+
+#endif
@@ -261,6 +261,9 @@ namespace Communications
             virtual bool IsAudioReceivingEnabled() const = 0;
             virtual double SpeakerVoiceActivity() const = 0;
 
+            //! \return lines of human readable statistics about the session, e.g. audio playback counters
+            virtual QList<QString> Statistics() { return QList<QString>(); }
+
             //virtual void SetSelfPosition(const vector3df& pos) = 0;
 
             //! \todo: Give weak_ptr instead
@@ -5,15 +5,44 @@
 
 #include <Poco/Logger.h>
 
-#define MODULE_LOGGING_FUNCTIONS                                                                                            \
-    static void LogFatal(const std::string &msg)    { Poco::Logger::get(NameStatic()).fatal("Fatal: " + msg);         }     \
-    static void LogCritical(const std::string &msg) { Poco::Logger::get(NameStatic()).critical("Critical: " + msg);   }     \
-    static void LogError(const std::string &msg)    { Poco::Logger::get(NameStatic()).error("Error: " + msg);         }     \
-    static void LogWarning(const std::string &msg)  { Poco::Logger::get(NameStatic()).warning("Warning: " + msg);     }     \
-    static void LogNotice(const std::string &msg)   { Poco::Logger::get(NameStatic()).notice("Notice: " + msg);       }     \
-    static void LogInfo(const std::string &msg)     { Poco::Logger::get(NameStatic()).information(msg);               }     \
-    static void LogTrace(const std::string &msg)    { Poco::Logger::get(NameStatic()).trace("Trace: " + msg);         }     \
-    static void LogDebug(const std::string &msg)    { Poco::Logger::get(NameStatic()).debug("Debug: " + msg);         }
+//! Logging functions for a module or other class with a static NameStatic() function.
+/*! The logger is looked up once and cached, Poco::Logger::get() locks a global mutex. The level is checked before
+    the message prefix is added, but the message itself has already been built by the caller. In hot paths use
+    the MODULE_LOG_* macros below, which do not evaluate the message at all if the level is disabled.
+ */
+#define MODULE_LOGGING_FUNCTIONS                                                                                                \
+    static Poco::Logger &GetLogger()                                                                                            \
+    {                                                                                                                           \
+        static Poco::Logger *logger = 0;                                                                                        \
+        if (!logger)                                                                                                            \
+        {                                                                                                                       \
+            Poco::Logger &l = Poco::Logger::get(NameStatic());                                                                  \
+            l.duplicate();                                                                                                      \
+            logger = &l;                                                                                                        \
+        }                                                                                                                       \
+        return *logger;                                                                                                         \
+    }                                                                                                                           \
+    static bool IsLogEnabled(int priority)          { return GetLogger().getLevel() >= priority; }                              \
+    static void LogFatal(const std::string &msg)    { if (GetLogger().fatal()) GetLogger().fatal("Fatal: " + msg); }            \
+    static void LogCritical(const std::string &msg) { if (GetLogger().critical()) GetLogger().critical("Critical: " + msg); }   \
+    static void LogError(const std::string &msg)    { if (GetLogger().error()) GetLogger().error("Error: " + msg); }            \
+    static void LogWarning(const std::string &msg)  { if (GetLogger().warning()) GetLogger().warning("Warning: " + msg); }      \
+    static void LogNotice(const std::string &msg)   { if (GetLogger().notice()) GetLogger().notice("Notice: " + msg); }         \
+    static void LogInfo(const std::string &msg)     { GetLogger().information(msg); }                                           \
+    static void LogTrace(const std::string &msg)    { if (GetLogger().trace()) GetLogger().trace("Trace: " + msg); }            \
+    static void LogDebug(const std::string &msg)    { if (GetLogger().debug()) GetLogger().debug("Debug: " + msg); }
+
+//! Logs a debug message, evaluating the message expression only if debug level is enabled for the module
+/*! \param module Class with MODULE_LOGGING_FUNCTIONS
+    \param msg Message expression, e.g. "Requesting asset " + asset_id
+ */
+#define MODULE_LOG_DEBUG(module, msg) do { if (module::IsLogEnabled(Poco::Message::PRIO_DEBUG)) module::LogDebug(msg); } while(0)
+
+//! Logs a trace message, evaluating the message expression only if trace level is enabled for the module
+#define MODULE_LOG_TRACE(module, msg) do { if (module::IsLogEnabled(Poco::Message::PRIO_TRACE)) module::LogTrace(msg); } while(0)
+
+//! Logs an info message, evaluating the message expression only if info level is enabled for the module
+#define MODULE_LOG_INFO(module, msg) do { if (module::IsLogEnabled(Poco::Message::PRIO_INFORMATION)) module::LogInfo(msg); } while(0)
 
 #endif
 
@@ -112,6 +112,12 @@ namespace Inventory
         /// @return Inventory root folder.
         virtual AbstractInventoryItem *GetRoot() const = 0;
 
+        /// Searches inventory items by name.
+        /// @param text Search text, case insensitive. Every word must be a prefix of some word of the item name.
+        /// @param max_results Maximum number of results, 0 for no limit.
+        /// @return Matching items, best matches first.
+        virtual QList<AbstractInventoryItem *> SearchItems(const QString &text, int max_results = 0) const = 0;
+
         /// @return Inventory trash folder.
         virtual AbstractInventoryItem *GetTrashFolder() const = 0;
 
@@ -127,6 +133,11 @@ namespace Inventory
         /// @param file_count Number of files to be uploaded.
         void MultiUploadStarted(size_t file_count);
 
+        /// Indicates progress of J2k encoding of the textures of a multiupload.
+        /// @param encoded Number of textures encoded so far.
+        /// @param texture_count Number of textures to be encoded.
+        void EncodingProgress(int encoded, int texture_count);
+
         /// Indicates that asset upload has started.
         /// @param filename Filename.
         void UploadStarted(const QString &filename);
@@ -8,6 +8,7 @@
 #include "StableHeaders.h"
 #include "InventoryAsset.h"
 #include "InventoryFolder.h"
+#include "InventoryIndex.h"
 
 namespace Inventory
 {
@@ -33,6 +34,26 @@ InventoryAsset::~InventoryAsset()
 {
 }
 
+void InventoryAsset::SetName(const QString &name)
+{
+    QString old_name = name_;
+    name_ = name;
+
+    InventoryFolder *folder = dynamic_cast<InventoryFolder *>(parent_);
+    if (folder && folder->GetIndex())
+        folder->GetIndex()->Rename(this, old_name);
+}
+
+void InventoryAsset::SetID(const QString &id)
+{
+    QString old_id = id_;
+    id_ = id;
+
+    InventoryFolder *folder = dynamic_cast<InventoryFolder *>(parent_);
+    if (folder && folder->GetIndex())
+        folder->GetIndex()->ChangeId(this, old_id);
+}
+
 bool InventoryAsset::IsDescendentOf(AbstractInventoryItem *searchFolder) const
 {
     forever
@@ -43,13 +43,13 @@ namespace Inventory
         QString GetName() const {return name_; }
 
         /// AbstractInventoryItem override
-        void SetName(const QString &name) { name_ = name; }
+        void SetName(const QString &name);
 
         /// AbstractInventoryItem override
         QString GetID() const { return id_; }
 
         /// AbstractInventoryItem override
-        void SetID(const QString &id) { id_ = id; }
+        void SetID(const QString &id);
 
         /// AbstractInventoryItem override
         AbstractInventoryItem *GetParent() const { return parent_; }
@@ -0,0 +1,225 @@
+/**
+ *  For conditions of distribution and use, see copyright notice in license.txt
+ *
+ *  @file   InventoryCache.cpp
+ *  @brief  Local on-disk cache of inventory folder contents, validated by folder versions.
+ */
+
+#include "StableHeaders.h"
+#include "InventoryCache.h"
+#include "Profiler.h"
+
+#include <QDataStream>
+#include <QFile>
+
+namespace Inventory
+{
+
+/// Identifies inventory cache files.
+static const quint32 CACHE_FILE_MAGIC = 0x494e5643;
+
+/// Format version of inventory cache files. Files of other versions are ignored.
+static const quint32 CACHE_FILE_VERSION = 1;
+
+QDataStream &operator <<(QDataStream &out, const InventoryCacheItem &item)
+{
+    out << item.isFolder << item.id << item.assetId << item.name << item.description << (qint32)item.inventoryType
+        << (qint32)item.assetType << item.creatorId << item.ownerId << item.groupId << (quint32)item.creationTime;
+    return out;
+}
+
+QDataStream &operator >>(QDataStream &in, InventoryCacheItem &item)
+{
+    qint32 inventory_type, asset_type;
+    quint32 creation_time;
+    in >> item.isFolder >> item.id >> item.assetId >> item.name >> item.description >> inventory_type >> asset_type
+        >> item.creatorId >> item.ownerId >> item.groupId >> creation_time;
+    item.inventoryType = inventory_type;
+    item.assetType = asset_type;
+    item.creationTime = creation_time;
+    return in;
+}
+
+QDataStream &operator <<(QDataStream &out, const InventoryCacheFolder &folder)
+{
+    out << (qint32)folder.version << folder.items;
+    return out;
+}
+
+QDataStream &operator >>(QDataStream &in, InventoryCacheFolder &folder)
+{
+    qint32 version;
+    in >> version >> folder.items;
+    folder.version = version;
+    return in;
+}
+
+InventoryCache::InventoryCache() : loaded_(false), dirty_(false)
+{
+}
+
+void InventoryCache::Merge(const InventoryCacheFolderMap &folders)
+{
+    for(InventoryCacheFolderMap::const_iterator it = folders.begin(); it != folders.end(); ++it)
+        if (!touched_.contains(it.key()))
+            folders_.insert(it.key(), it.value());
+
+    loaded_ = true;
+}
+
+const InventoryCacheFolder *InventoryCache::GetFolder(const QString &id, int version) const
+{
+    InventoryCacheFolderMap::const_iterator it = folders_.find(id);
+    if (it == folders_.end() || it.value().version != version)
+        return 0;
+
+    return &it.value();
+}
+
+void InventoryCache::BeginFetch(const QString &id)
+{
+    if (!fetching_.contains(id))
+        fetching_.insert(id, InventoryCacheFolder());
+}
+
+void InventoryCache::AddFetchedItem(const QString &folder_id, const InventoryCacheItem &item)
+{
+    InventoryCacheFolderMap::iterator it = fetching_.find(folder_id);
+    if (it != fetching_.end())
+        it.value().items.append(item);
+    else
+        Invalidate(folder_id);
+}
+
+void InventoryCache::EndFetch(const QString &folder_id, int version)
+{
+    InventoryCacheFolderMap::iterator it = fetching_.find(folder_id);
+    if (it == fetching_.end())
+        return;
+
+    // The same folder may have been requested more than once.
+    InventoryCacheFolder folder;
+    folder.version = version;
+    QSet<QString> ids;
+    foreach(const InventoryCacheItem &item, it.value().items)
+        if (!ids.contains(item.id))
+        {
+            ids.insert(item.id);
+            folder.items.append(item);
+        }
+
+    folders_.insert(folder_id, folder);
+    fetching_.erase(it);
+    touched_.insert(folder_id);
+    dirty_ = true;
+}
+
+void InventoryCache::Invalidate(const QString &folder_id)
+{
+    touched_.insert(folder_id);
+    if (folders_.remove(folder_id))
+        dirty_ = true;
+}
+
+void InventoryCache::Prune(const QSet<QString> &folder_ids)
+{
+    InventoryCacheFolderMap::iterator it = folders_.begin();
+    while(it != folders_.end())
+    {
+        if (folder_ids.contains(it.key()))
+        {
+            ++it;
+        }
+        else
+        {
+            it = folders_.erase(it);
+            dirty_ = true;
+        }
+    }
+}
+
+bool InventoryCache::Save()
+{
+    if (!loaded_ || !dirty_ || filename_.isEmpty())
+        return true;
+
+    if (!WriteFile(filename_, folders_))
+        return false;
+
+    dirty_ = false;
+    return true;
+}
+
+bool InventoryCache::ReadFile(const QString &filename, InventoryCacheFolderMap &folders)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_5);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != CACHE_FILE_MAGIC || version != CACHE_FILE_VERSION)
+        return false;
+
+    in >> folders;
+    if (in.status() != QDataStream::Ok)
+    {
+        folders.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool InventoryCache::WriteFile(const QString &filename, const InventoryCacheFolderMap &folders)
+{
+    // Write to a temporary file first so that a crash can't leave a truncated cache file behind.
+    QString temp_filename = filename + ".tmp";
+    QFile file(temp_filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_5);
+    out << CACHE_FILE_MAGIC << CACHE_FILE_VERSION << folders;
+    file.close();
+    if (out.status() != QDataStream::Ok)
+    {
+        QFile::remove(temp_filename);
+        return false;
+    }
+
+    QFile::remove(filename);
+    return QFile::rename(temp_filename, filename);
+}
+
+InventoryCacheLoader::InventoryCacheLoader() : Foundation::ThreadTask("InventoryCacheLoader")
+{
+}
+
+void InventoryCacheLoader::Work()
+{
+    while(ShouldRun())
+    {
+        WaitForRequests();
+
+        InventoryCacheLoadRequestPtr request = GetNextRequest<InventoryCacheLoadRequest>();
+        if (request)
+        {
+            PROFILE(InventoryCacheLoader_ReadFile);
+            InventoryCacheLoadResultPtr result(new InventoryCacheLoadResult());
+            result->tag_ = request->tag_;
+            result->task_description_ = GetTaskDescription();
+            result->filename_ = request->filename_;
+            result->success_ = InventoryCache::ReadFile(request->filename_, result->folders_);
+            QueueResult<InventoryCacheLoadResult>(result);
+        }
+
+        RESETPROFILER
+    }
+}
+
+}
@@ -0,0 +1,210 @@
+/**
+ *  For conditions of distribution and use, see copyright notice in license.txt
+ *
+ *  @file   InventoryCache.h
+ *  @brief  Local on-disk cache of inventory folder contents, validated by folder versions.
+ */
+
+#ifndef incl_InventoryModule_InventoryCache_h
+#define incl_InventoryModule_InventoryCache_h
+
+#include "ThreadTask.h"
+
+#include <QMap>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+namespace Inventory
+{
+    /// Cached inventory item or folder.
+    struct InventoryCacheItem
+    {
+        InventoryCacheItem() : isFolder(false), inventoryType(0), assetType(0), creationTime(0) {}
+
+        /// Is this a folder.
+        bool isFolder;
+
+        /// Inventory ID.
+        QString id;
+
+        /// Asset reference, empty for folders.
+        QString assetId;
+
+        /// Name.
+        QString name;
+
+        /// Description.
+        QString description;
+
+        /// Inventory type.
+        int inventoryType;
+
+        /// Asset type.
+        int assetType;
+
+        /// Creator ID.
+        QString creatorId;
+
+        /// Owner ID.
+        QString ownerId;
+
+        /// Group ID.
+        QString groupId;
+
+        /// Time of creation.
+        uint creationTime;
+    };
+
+    /// Cached contents of one inventory folder.
+    struct InventoryCacheFolder
+    {
+        InventoryCacheFolder() : version(0) {}
+
+        /// Folder version the contents were fetched at.
+        int version;
+
+        /// Direct children of the folder.
+        QList<InventoryCacheItem> items;
+    };
+
+    /// Cached folders by folder ID.
+    typedef QMap<QString, InventoryCacheFolder> InventoryCacheFolderMap;
+
+    /// Local on-disk cache of inventory folder contents.
+    /** Contents of a folder are stored with the folder version they were fetched at. If the version in the login
+        inventory skeleton is still the same, the contents can be used instead of fetching the descendents from server.
+        Folders are recorded only while a fetch started with BeginFetch is in progress; items arriving for other
+        folders, e.g. uploads, invalidate the cached contents of their folder.
+    */
+    class InventoryCache
+    {
+    public:
+        /// Default constructor.
+        InventoryCache();
+
+        /// Destructor.
+        ~InventoryCache() {}
+
+        /// Sets the cache file.
+        /// @param filename File name.
+        void SetFileName(const QString &filename) { filename_ = filename; }
+
+        /// @return Cache file name.
+        QString GetFileName() const { return filename_; }
+
+        /// @return Has the cache file been read, or found missing.
+        bool IsLoaded() const { return loaded_; }
+
+        /// Adds folders read from the cache file. Folders fetched during this session are kept.
+        /// @param folders Folders.
+        void Merge(const InventoryCacheFolderMap &folders);
+
+        /// @return Cached contents of a folder, or null if not cached or the version is different.
+        /// @param id Folder ID.
+        /// @param version Current folder version.
+        const InventoryCacheFolder *GetFolder(const QString &id, int version) const;
+
+        /// Starts recording the contents of a folder being fetched from server.
+        /// @param id Folder ID.
+        void BeginFetch(const QString &id);
+
+        /// @return Is a fetch of the folder in progress.
+        bool IsFetching(const QString &id) const { return fetching_.contains(id); }
+
+        /// Records an item received for a folder being fetched.
+        /// @param folder_id Parent folder ID.
+        /// @param item Item.
+        void AddFetchedItem(const QString &folder_id, const InventoryCacheItem &item);
+
+        /// Stores the recorded contents of a fetched folder.
+        /// @param folder_id Folder ID.
+        /// @param version Folder version.
+        void EndFetch(const QString &folder_id, int version);
+
+        /// Removes cached contents of a folder, e.g. when it has been modified during this session.
+        /// @param folder_id Folder ID.
+        void Invalidate(const QString &folder_id);
+
+        /// Removes all folders except the given ones, e.g. folders that no longer exist in the inventory.
+        /// @param folder_ids Folders to keep.
+        void Prune(const QSet<QString> &folder_ids);
+
+        /// Writes the cache file if it has changed. Does nothing if the file hasn't been read yet, to not overwrite it.
+        /// @return True if successful or nothing to do.
+        bool Save();
+
+        /// Reads a cache file. Thread safe.
+        /// @param filename File name.
+        /// @param folders Read folders.
+        /// @return True if successful.
+        static bool ReadFile(const QString &filename, InventoryCacheFolderMap &folders);
+
+        /// Writes a cache file. Thread safe.
+        /// @param filename File name.
+        /// @param folders Folders.
+        /// @return True if successful.
+        static bool WriteFile(const QString &filename, const InventoryCacheFolderMap &folders);
+
+    private:
+        Q_DISABLE_COPY(InventoryCache);
+
+        /// Cache file name.
+        QString filename_;
+
+        /// Cached folders.
+        InventoryCacheFolderMap folders_;
+
+        /// Folders being fetched from server.
+        InventoryCacheFolderMap fetching_;
+
+        /// Folders fetched or invalidated during this session, not to be overwritten by the cache file.
+        QSet<QString> touched_;
+
+        /// Has the cache file been read.
+        bool loaded_;
+
+        /// Have the cached folders changed since reading the file.
+        bool dirty_;
+    };
+
+    /// Request to read an inventory cache file.
+    class InventoryCacheLoadRequest : public Foundation::ThreadTaskRequest
+    {
+    public:
+        /// Cache file name.
+        QString filename_;
+    };
+
+    /// Read inventory cache file.
+    class InventoryCacheLoadResult : public Foundation::ThreadTaskResult
+    {
+    public:
+        InventoryCacheLoadResult() : success_(false) {}
+
+        /// Cache file name.
+        QString filename_;
+
+        /// Read folders.
+        InventoryCacheFolderMap folders_;
+
+        /// Was the file read successfully.
+        bool success_;
+    };
+
+    typedef boost::shared_ptr<InventoryCacheLoadRequest> InventoryCacheLoadRequestPtr;
+    typedef boost::shared_ptr<InventoryCacheLoadResult> InventoryCacheLoadResultPtr;
+
+    /// Threadtask that reads inventory cache files in the background at login.
+    class InventoryCacheLoader : public Foundation::ThreadTask
+    {
+    public:
+        /// Constructor.
+        InventoryCacheLoader();
+
+        /// ThreadTask override.
+        virtual void Work();
+    };
+}
+
+#endif
@@ -0,0 +1,32 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+/// @file InventoryFileUtils.cpp
+/// @brief File helpers shared by the inventory data models and the upload encoder.
+
+#include "StableHeaders.h"
+#include "DebugOperatorNew.h"
+#include "InventoryFileUtils.h"
+
+#include <fstream>
+
+#include "MemoryLeakCheck.h"
+
+namespace Inventory
+{
+
+bool ReadFileData(const std::string &filename, std::vector<u8> &data)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::filebuf *pbuf = file.rdbuf();
+    size_t size = pbuf->pubseekoff(0, std::ios::end, std::ios::in);
+    data.resize(size);
+    pbuf->pubseekpos(0, std::ios::in);
+    if (size)
+        pbuf->sgetn((char *)&data[0], size);
+    return true;
+}
+
+}
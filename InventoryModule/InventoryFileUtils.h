@@ -0,0 +1,23 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+/// @file InventoryFileUtils.h
+/// @brief File helpers shared by the inventory data models and the upload encoder.
+
+#ifndef incl_InventoryModule_InventoryFileUtils_h
+#define incl_InventoryModule_InventoryFileUtils_h
+
+#include "CoreTypes.h"
+
+#include <string>
+#include <vector>
+
+namespace Inventory
+{
+    /// Reads a whole file.
+    /// @param filename File path.
+    /// @param data File data.
+    /// @return True if the file could be opened.
+    bool ReadFileData(const std::string &filename, std::vector<u8> &data);
+}
+
+#endif
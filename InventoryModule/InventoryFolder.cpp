@@ -8,6 +8,7 @@
 #include "StableHeaders.h"
 #include "InventoryFolder.h"
 #include "InventoryAsset.h"
+#include "InventoryIndex.h"
 #include "RexUUID.h"
 
 namespace Inventory
@@ -15,20 +16,58 @@ namespace Inventory
 
 InventoryFolder::InventoryFolder(const QString &id, const QString &name, InventoryFolder *parent, const bool editable) :
     AbstractInventoryItem(id, name, parent, editable), itemType_(AbstractInventoryItem::Type_Folder), dirty_(false),
-    libraryItem_(false)
+    libraryItem_(false), index_(0)
 {
 }
 
 // virtual
 InventoryFolder::~InventoryFolder()
 {
+    // Child folders remove themselves from the index when deleted, assets are removed here.
+    if (index_)
+    {
+        index_->Remove(this);
+        QListIterator<AbstractInventoryItem *> it(children_);
+        while(it.hasNext())
+        {
+            AbstractInventoryItem *item = it.next();
+            if (item->GetItemType() == Type_Asset)
+                index_->Remove(item);
+        }
+    }
+
     qDeleteAll(children_);
 }
 
+void InventoryFolder::SetName(const QString &name)
+{
+    QString old_name = name_;
+    name_ = name;
+    if (index_)
+        index_->Rename(this, old_name);
+}
+
+void InventoryFolder::SetID(const QString &id)
+{
+    QString old_id = id_;
+    id_ = id;
+    if (index_)
+        index_->ChangeId(this, old_id);
+}
+
 AbstractInventoryItem *InventoryFolder::AddChild(AbstractInventoryItem *child)
 {
     child->SetParent(this);
     children_.append(child);
+
+    if (index_)
+    {
+        if (child->GetItemType() == Type_Folder)
+            checked_static_cast<InventoryFolder *>(child)->SetIndex(index_);
+        else
+            index_->Insert(child);
+    }
+
     return children_.back();
 }
 
@@ -38,11 +77,61 @@ bool InventoryFolder::RemoveChildren(int position, int count)
         return false;
 
     for(int row = 0; row < count; ++row)
-        delete children_.takeAt(position);
+    {
+        AbstractInventoryItem *item = children_.takeAt(position);
+        if (index_ && item->GetItemType() == Type_Asset)
+            index_->Remove(item);
+        delete item;
+    }
 
     return true;
 }
 
+void InventoryFolder::DetachChildren()
+{
+    QListIterator<AbstractInventoryItem *> it(children_);
+    while(it.hasNext())
+    {
+        AbstractInventoryItem *item = it.next();
+        if (item->GetItemType() == Type_Folder)
+            checked_static_cast<InventoryFolder *>(item)->SetIndex(0);
+        else if (index_)
+            index_->Remove(item);
+    }
+
+    children_.clear();
+}
+
+void InventoryFolder::SetIndex(InventoryIndex *index)
+{
+    InventoryIndex *old_index = index_;
+    if (old_index == index)
+        return;
+
+    if (old_index)
+        old_index->Remove(this);
+    index_ = index;
+    if (index_)
+        index_->Insert(this);
+
+    QListIterator<AbstractInventoryItem *> it(children_);
+    while(it.hasNext())
+    {
+        AbstractInventoryItem *item = it.next();
+        if (item->GetItemType() == Type_Folder)
+        {
+            checked_static_cast<InventoryFolder *>(item)->SetIndex(index);
+        }
+        else
+        {
+            if (old_index)
+                old_index->Remove(item);
+            if (index_)
+                index_->Insert(item);
+        }
+    }
+}
+
 /*
 void InventoryFolder::DeleteChild(InventoryItemBase *child)
 {
@@ -92,6 +181,16 @@ InventoryFolder *InventoryFolder::GetFirstChildFolderByName(const QString &searc
     if (GetName() == searchName)
         return const_cast<InventoryFolder *>(this);
 
+    if (index_)
+    {
+        QList<AbstractInventoryItem *> folders;
+        foreach(InventoryFolder *folder, index_->GetFoldersByName(searchName))
+            if (folder->IsDescendentOf(const_cast<InventoryFolder *>(this)))
+                folders.append(folder);
+
+        return static_cast<InventoryFolder *>(InventoryIndex::FirstInTreeOrder(folders));
+    }
+
     QListIterator<AbstractInventoryItem *> it(children_);
     while(it.hasNext())
     {
@@ -116,6 +215,16 @@ InventoryFolder *InventoryFolder::GetFirstChildFolderByName(const QString &searc
 
 InventoryFolder *InventoryFolder::GetChildFolderById(const QString &searchId) const
 {
+    if (index_)
+    {
+        QList<AbstractInventoryItem *> folders;
+        foreach(AbstractInventoryItem *item, index_->GetItemsById(searchId))
+            if (item->GetItemType() == Type_Folder && item->IsDescendentOf(const_cast<InventoryFolder *>(this)))
+                folders.append(item);
+
+        return static_cast<InventoryFolder *>(InventoryIndex::FirstInTreeOrder(folders));
+    }
+
     QListIterator<AbstractInventoryItem *> it(children_);
     while(it.hasNext())
     {
@@ -164,6 +273,21 @@ InventoryAsset *InventoryFolder::GetChildAssetById(const QString &searchId) cons
 
 AbstractInventoryItem *InventoryFolder::GetChildById(const QString &searchId) const
 {
+    if (index_)
+    {
+        // Placeholder items share the same id in every folder, so check the direct children first.
+        foreach(AbstractInventoryItem *item, children_)
+            if (item->GetID() == searchId)
+                return item;
+
+        QList<AbstractInventoryItem *> items;
+        foreach(AbstractInventoryItem *item, index_->GetItemsById(searchId))
+            if (item->IsDescendentOf(const_cast<InventoryFolder *>(this)))
+                items.append(item);
+
+        return InventoryIndex::FirstInTreeOrder(items);
+    }
+
     QListIterator<AbstractInventoryItem *> it(children_);
     while(it.hasNext())
     {
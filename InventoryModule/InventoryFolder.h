@@ -14,6 +14,7 @@
 namespace Inventory
 {
     class InventoryAsset;
+    class InventoryIndex;
 
     class InventoryFolder : public AbstractInventoryItem
     {
@@ -36,13 +37,13 @@ namespace Inventory
         QString GetName() const { return name_; }
 
         /// AbstractInventoryItem override
-        void SetName(const QString &name) { name_ = name; }
+        void SetName(const QString &name);
 
         /// AbstractInventoryItem override
         QString GetID() const { return id_; }
 
         /// AbstractInventoryItem override
-        void SetID(const QString &id) { id_ = id; }
+        void SetID(const QString &id);
 
         /// AbstractInventoryItem override
         AbstractInventoryItem *GetParent() const { return parent_; }
@@ -89,6 +90,10 @@ namespace Inventory
         /// @note It's not recommended to use this directly. This function is used by InventoryItemModel::removeRows().
         bool RemoveChildren(int position, int count);
 
+        /// Removes all children from this folder without deleting them.
+        /// @note The children are also removed from the index. Used by WebDAV when refetching folder contents.
+        void DetachChildren();
+
         /// Deletes child.
         /// @param child Child to be deleted.
 //        void DeleteChild(AbstractInventoryItem *child);
@@ -97,14 +102,24 @@ namespace Inventory
         /// @param id of the child to be deleted.
 //        void DeleteChild(const QString &id);
 
+        /// Attaches this folder and its whole subtree to an index. Removes them from the previous index, if any.
+        /// Children added later are indexed automatically.
+        /// @param index Index, or null to only remove from the previous index.
+        void SetIndex(InventoryIndex *index);
+
+        /// @return Index this folder belongs to, or null if none.
+        InventoryIndex *GetIndex() const { return index_; }
+
         /// @return First folder by the requested name or null if the folder isn't found.
         /// @param name Search name.
         /// @return Pointer to requested folder, or null if not found.
+        /// @note Uses the index if this folder is indexed.
         InventoryFolder *GetFirstChildFolderByName(const QString &name) const;
 
         /// Returns pointer to requested folder.
         /// @param searchId Search ID.
         /// @return Pointer to the requested folder, or null if not found.
+        /// @note Uses the index if this folder is indexed.
         InventoryFolder *GetChildFolderById(const QString &searchId) const;
 
         /// Returns pointer to requested asset.
@@ -116,6 +131,7 @@ namespace Inventory
         /// Returns pointer to requested child item.
         /// @param searchId Search ID.
         /// @return Pointer to the requested item, or null if not found.
+        /// @note Uses the index if this folder is indexed.
         AbstractInventoryItem *GetChildById(const QString &searchId) const;
 
         /// Returns the first asset with the requested asset ID.
@@ -168,6 +184,9 @@ namespace Inventory
 
         /// Library asset flag.
         bool libraryItem_;
+
+        /// Index this folder belongs to, not owned.
+        InventoryIndex *index_;
     };
 }
 
@@ -0,0 +1,220 @@
+/**
+ *  For conditions of distribution and use, see copyright notice in license.txt
+ *
+ *  @file   InventoryIndex.cpp
+ *  @brief  Id, name and search indices of an inventory item tree.
+ */
+
+#include "StableHeaders.h"
+#include "InventoryIndex.h"
+#include "InventoryFolder.h"
+
+#include <QRegExp>
+#include <QSet>
+
+#include <algorithm>
+
+namespace Inventory
+{
+
+/// Returns the row numbers from the root to an item.
+static std::vector<int> GetTreePath(const AbstractInventoryItem *item)
+{
+    std::vector<int> path;
+    AbstractInventoryItem *parent = item->GetParent();
+    while(parent)
+    {
+        InventoryFolder *folder = static_cast<InventoryFolder *>(parent);
+        path.push_back(folder->GetChildren().indexOf(const_cast<AbstractInventoryItem *>(item)));
+        item = parent;
+        parent = item->GetParent();
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/// Search result ranking: exact name matches first, then names beginning with the search text, then the rest.
+static int GetSearchRank(const QString &name, const QString &text)
+{
+    if (name.compare(text, Qt::CaseInsensitive) == 0)
+        return 0;
+    if (name.startsWith(text, Qt::CaseInsensitive))
+        return 1;
+    return 2;
+}
+
+/// Search result with sort key.
+struct SearchResult
+{
+    int rank;
+    QString name;
+    AbstractInventoryItem *item;
+
+    bool operator <(const SearchResult &rhs) const
+    {
+        if (rank != rhs.rank)
+            return rank < rhs.rank;
+        return name < rhs.name;
+    }
+};
+
+void InventoryIndex::Insert(AbstractInventoryItem *item)
+{
+    ids_.insert(item->GetID(), item);
+    if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
+        folderNames_.insert(item->GetName(), static_cast<InventoryFolder *>(item));
+    InsertName(item, item->GetName());
+}
+
+void InventoryIndex::Remove(AbstractInventoryItem *item)
+{
+    ids_.remove(item->GetID(), item);
+    if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
+        folderNames_.remove(item->GetName(), static_cast<InventoryFolder *>(item));
+    RemoveName(item, item->GetName());
+}
+
+void InventoryIndex::Rename(AbstractInventoryItem *item, const QString &old_name)
+{
+    if (!ids_.contains(item->GetID(), item))
+        return;
+
+    if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
+    {
+        InventoryFolder *folder = static_cast<InventoryFolder *>(item);
+        folderNames_.remove(old_name, folder);
+        folderNames_.insert(item->GetName(), folder);
+    }
+
+    RemoveName(item, old_name);
+    InsertName(item, item->GetName());
+}
+
+void InventoryIndex::ChangeId(AbstractInventoryItem *item, const QString &old_id)
+{
+    if (!ids_.contains(old_id, item))
+        return;
+
+    ids_.remove(old_id, item);
+    ids_.insert(item->GetID(), item);
+}
+
+void InventoryIndex::Clear()
+{
+    ids_.clear();
+    folderNames_.clear();
+    tokens_.clear();
+}
+
+QList<AbstractInventoryItem *> InventoryIndex::Search(const QString &text, int max_results) const
+{
+    QList<AbstractInventoryItem *> items;
+    QStringList search_tokens = Tokenize(text);
+    if (search_tokens.isEmpty())
+        return items;
+
+    // Scan the items of the longest search token, it has the least candidates
+    QString scan_token = search_tokens.first();
+    foreach(const QString &token, search_tokens)
+        if (token.length() > scan_token.length())
+            scan_token = token;
+
+    QString search_text = text.trimmed();
+    QSet<AbstractInventoryItem *> checked;
+    std::vector<SearchResult> results;
+
+    QMultiMap<QString, AbstractInventoryItem *>::const_iterator it = tokens_.lowerBound(scan_token);
+    for(; it != tokens_.end() && it.key().startsWith(scan_token); ++it)
+    {
+        AbstractInventoryItem *item = it.value();
+        if (checked.contains(item))
+            continue;
+        checked.insert(item);
+
+        // Every search token must begin some token of the name
+        QStringList name_tokens = Tokenize(item->GetName());
+        bool match = true;
+        foreach(const QString &search_token, search_tokens)
+        {
+            bool found = false;
+            foreach(const QString &name_token, name_tokens)
+                if (name_token.startsWith(search_token))
+                {
+                    found = true;
+                    break;
+                }
+
+            if (!found)
+            {
+                match = false;
+                break;
+            }
+        }
+
+        if (!match)
+            continue;
+
+        SearchResult result;
+        result.rank = GetSearchRank(item->GetName(), search_text);
+        result.name = item->GetName().toLower();
+        result.item = item;
+        results.push_back(result);
+    }
+
+    std::stable_sort(results.begin(), results.end());
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        if (max_results > 0 && items.size() >= max_results)
+            break;
+        items.append(results[i].item);
+    }
+
+    return items;
+}
+
+AbstractInventoryItem *InventoryIndex::FirstInTreeOrder(const QList<AbstractInventoryItem *> &items)
+{
+    if (items.isEmpty())
+        return 0;
+    if (items.size() == 1)
+        return items.first();
+
+    AbstractInventoryItem *first = items.first();
+    std::vector<int> first_path = GetTreePath(first);
+    for(int i = 1; i < items.size(); ++i)
+    {
+        std::vector<int> path = GetTreePath(items[i]);
+        if (std::lexicographical_compare(path.begin(), path.end(), first_path.begin(), first_path.end()))
+        {
+            first = items[i];
+            first_path = path;
+        }
+    }
+
+    return first;
+}
+
+QStringList InventoryIndex::Tokenize(const QString &name)
+{
+    return name.toLower().split(QRegExp("\\W+"), QString::SkipEmptyParts);
+}
+
+void InventoryIndex::InsertName(AbstractInventoryItem *item, const QString &name)
+{
+    QStringList tokens = Tokenize(name);
+    tokens.removeDuplicates();
+    foreach(const QString &token, tokens)
+        tokens_.insert(token, item);
+}
+
+void InventoryIndex::RemoveName(AbstractInventoryItem *item, const QString &name)
+{
+    QStringList tokens = Tokenize(name);
+    tokens.removeDuplicates();
+    foreach(const QString &token, tokens)
+        tokens_.remove(token, item);
+}
+
+}
@@ -0,0 +1,97 @@
+/**
+ *  For conditions of distribution and use, see copyright notice in license.txt
+ *
+ *  @file   InventoryIndex.h
+ *  @brief  Id, name and search indices of an inventory item tree.
+ */
+
+#ifndef incl_InventoryModule_InventoryIndex_h
+#define incl_InventoryModule_InventoryIndex_h
+
+#include <QMultiHash>
+#include <QMultiMap>
+#include <QStringList>
+
+namespace Inventory
+{
+    class AbstractInventoryItem;
+    class InventoryFolder;
+
+    /// Id, name and search indices of an inventory item tree.
+    /** Owned by a data model and attached to its root folder with InventoryFolder::SetIndex. Folders keep
+        the index up to date when children are added, removed or renamed, and use it for their recursive lookups.
+        Item names are split to lowercase word tokens, which are kept sorted for prefix search.
+    */
+    class InventoryIndex
+    {
+    public:
+        /// Default constructor.
+        InventoryIndex() {}
+
+        /// Destructor.
+        ~InventoryIndex() {}
+
+        /// Adds an item to the index. Not recursive.
+        /// @param item Item.
+        void Insert(AbstractInventoryItem *item);
+
+        /// Removes an item from the index. Not recursive.
+        /// @param item Item.
+        void Remove(AbstractInventoryItem *item);
+
+        /// Updates the name of an indexed item. Does nothing if the item isn't in the index.
+        /// @param item Item, already renamed.
+        /// @param old_name Previous name.
+        void Rename(AbstractInventoryItem *item, const QString &old_name);
+
+        /// Updates the id of an indexed item. Does nothing if the item isn't in the index.
+        /// @param item Item, already with the new id.
+        /// @param old_id Previous id.
+        void ChangeId(AbstractInventoryItem *item, const QString &old_id);
+
+        /// Removes all items from the index.
+        void Clear();
+
+        /// @return Number of indexed items.
+        int Count() const { return ids_.size(); }
+
+        /// @return All indexed items with the requested id. While an item is being moved, it may exist twice.
+        QList<AbstractInventoryItem *> GetItemsById(const QString &id) const { return ids_.values(id); }
+
+        /// @return All indexed folders with the requested name.
+        QList<InventoryFolder *> GetFoldersByName(const QString &name) const { return folderNames_.values(name); }
+
+        /// Searches items by name. Every word of the search text must be a prefix of some word of the item name.
+        /// @param text Search text, case insensitive.
+        /// @param max_results Maximum number of results, 0 for no limit.
+        /// @return Matching items, exact name matches first, then names beginning with the search text.
+        QList<AbstractInventoryItem *> Search(const QString &text, int max_results = 0) const;
+
+        /// @return The item that comes first in depth first order of the inventory tree, or null if the list is empty.
+        /// @param items Items of the same tree.
+        static AbstractInventoryItem *FirstInTreeOrder(const QList<AbstractInventoryItem *> &items);
+
+        /// Splits a name to lowercase word tokens.
+        static QStringList Tokenize(const QString &name);
+
+    private:
+        Q_DISABLE_COPY(InventoryIndex);
+
+        /// Adds name tokens of an item.
+        void InsertName(AbstractInventoryItem *item, const QString &name);
+
+        /// Removes name tokens of an item.
+        void RemoveName(AbstractInventoryItem *item, const QString &name);
+
+        /// Items by id.
+        QMultiHash<QString, AbstractInventoryItem *> ids_;
+
+        /// Folders by name.
+        QMultiHash<QString, InventoryFolder *> folderNames_;
+
+        /// Items by lowercase name token, sorted for prefix search.
+        QMultiMap<QString, AbstractInventoryItem *> tokens_;
+    };
+}
+
+#endif
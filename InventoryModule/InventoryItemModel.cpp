@@ -622,6 +622,20 @@ QString InventoryItemModel::GetItemId(const QModelIndex &index) const
         return QString();
 }
 
+QModelIndex InventoryItemModel::Search(const QString &text) const
+{
+    QList<AbstractInventoryItem *> items = dataModel_->SearchItems(text, 1);
+    if (items.isEmpty())
+        return QModelIndex();
+
+    AbstractInventoryItem *item = items.first();
+    InventoryFolder *parentItem = static_cast<InventoryFolder *>(item->GetParent());
+    if (!parentItem)
+        return QModelIndex();
+
+    return createIndex(parentItem->GetChildren().indexOf(item), 0, reinterpret_cast<void *>(item));
+}
+
 void InventoryItemModel::Update(AbstractInventoryItem *parent)
 {
     QModelIndexList indexList = persistentIndexList();
@@ -195,6 +195,11 @@ namespace Inventory
         /// Returns item ID of item at spesific index, or empty string if item not found.
         QString GetItemId(const QModelIndex &index) const;
 
+        /// Searches inventory items by name using the data model's search index.
+        /// @param text Search text.
+        /// @return Model index of the best matching item, or invalid index if nothing was found.
+        QModelIndex Search(const QString &text) const;
+
     signals:
         /// Sent when model index is dirty and it needs refreshing.
         void IndexModelIsDirty(const QModelIndex &index);
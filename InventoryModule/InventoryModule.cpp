@@ -18,10 +18,12 @@
 #include "InventoryAsset.h"
 #include "ItemPropertiesWindow.h"
 #include "InventoryService.h"
+#include "InventoryCache.h"
 #include "UiServiceInterface.h"
 
 #include "Framework.h"
 #include "EventManager.h"
+#include "ThreadTaskManager.h"
 #include "ModuleManager.h"
 #include "ServiceManager.h"
 #include "WorldStream.h"
@@ -59,6 +61,7 @@ InventoryModule::InventoryModule() :
     assetEventCategory_(0),
     resourceEventCategory_(0),
     frameworkEventCategory_(0),
+    taskEventCategory_(0),
     inventoryWindow_(0),
 //    uploadProgressWindow_(0),
     inventoryType_(IDMT_Unknown),
@@ -82,6 +85,10 @@ void InventoryModule::Initialize()
     eventManager_->RegisterEvent(inventoryEventCategory_, Events::EVENT_INVENTORY_ITEM_OPEN, "InventoryItemOpen");
     eventManager_->RegisterEvent(inventoryEventCategory_, Events::EVENT_INVENTORY_ITEM_DOWNLOADED, "InventoryItemDownloaded");
 
+    // Cache files are read in the background at login.
+    cacheLoader_ = boost::shared_ptr<InventoryCacheLoader>(new InventoryCacheLoader());
+    framework_->GetThreadTaskManager()->AddThreadTask(cacheLoader_);
+
     // Register console commands.
     RegisterConsoleCommand(Console::CreateCommand("Upload",
         "Upload an asset. Usage: Upload(AssetType, Name, Description)",
@@ -101,6 +108,7 @@ void InventoryModule::PostInitialize()
     frameworkEventCategory_ = eventManager_->QueryEventCategory("Framework");
     assetEventCategory_ = eventManager_->QueryEventCategory("Asset");
     resourceEventCategory_ = eventManager_->QueryEventCategory("Resource");
+    taskEventCategory_ = eventManager_->QueryEventCategory("Task");
 }
 
 void InventoryModule::Uninitialize()
@@ -113,6 +121,9 @@ void InventoryModule::Uninitialize()
     eventManager_.reset();
     currentWorldStream_.reset();
     inventory_.reset();
+
+    framework_->GetThreadTaskManager()->RemoveThreadTask(cacheLoader_);
+    cacheLoader_.reset();
 }
 
 void InventoryModule::Update(f64 frametime)
@@ -211,6 +222,10 @@ bool InventoryModule::HandleEvent(event_category_id_t category_id, event_id_t ev
                 // Set world stream used for sending udp packets.
                 static_cast<OpenSimInventoryDataModel *>(inventory_.get())->SetWorldStream(currentWorldStream_);
 
+                // Start reading the cached folder contents of this agent.
+                if (currentWorldStream_)
+                    static_cast<OpenSimInventoryDataModel *>(inventory_.get())->LoadCache(currentWorldStream_->GetInfo().agentID);
+
                 inventoryType_ = IDMT_OpenSim;
                 inventoryWindow_->InitInventoryTreeModel(inventory_);
                 SAFE_DELETE(service_);
@@ -251,6 +266,9 @@ bool InventoryModule::HandleEvent(event_category_id_t category_id, event_id_t ev
 
             descendents_ = -1;
             SAFE_DELETE(service_);
+
+            if (inventoryType_ == IDMT_OpenSim && inventory_.get())
+                checked_static_cast<OpenSimInventoryDataModel *>(inventory_.get())->SaveCache();
             break;
         }
         default:
@@ -351,6 +369,14 @@ bool InventoryModule::HandleEvent(event_category_id_t category_id, event_id_t ev
         return false;
     }
 
+    // Thread task results
+    if (category_id == taskEventCategory_)
+    {
+        if (inventoryType_ == IDMT_OpenSim && inventory_.get())
+            checked_static_cast<OpenSimInventoryDataModel *>(inventory_.get())->HandleTaskEvent(event_id, data);
+        return false;
+    }
+
     // Asset download related handlers.
     if (inventoryType_ == IDMT_OpenSim)
     {
@@ -854,6 +880,9 @@ void InventoryModule::ConnectSignals()
     QObject::connect(inventory_.get(), SIGNAL(MultiUploadStarted(size_t)),
         uploadProgressWindow_, SLOT(OpenUploadProgress(size_t)));
 
+    QObject::connect(inventory_.get(), SIGNAL(EncodingProgress(int, int)),
+        uploadProgressWindow_, SLOT(EncodingProgress(int, int)));
+
     QObject::connect(inventory_.get(), SIGNAL(UploadStarted(const QString &)),
         uploadProgressWindow_, SLOT(UploadStarted(const QString &)));
 
@@ -35,6 +35,7 @@ namespace Inventory
     class AbstractInventoryDataModel;
     typedef boost::shared_ptr<AbstractInventoryDataModel> InventoryPtr;
     class InventoryService;
+    class InventoryCacheLoader;
 
     class INVENTORY_MODULE_API InventoryModule : public QObject, public Foundation::ModuleInterface
     {
@@ -151,6 +152,9 @@ namespace Inventory
         /// Resource event category.
         event_category_id_t resourceEventCategory_;
 
+        /// Thread task event category.
+        event_category_id_t taskEventCategory_;
+
         /// Inventory window.
         InventoryWindow *inventoryWindow_;
 
@@ -174,6 +178,9 @@ namespace Inventory
 
         /// Used when handling InventoryDescendents packet.
         int descendents_;
+
+        /// Threadtask reading inventory cache files.
+        boost::shared_ptr<InventoryCacheLoader> cacheLoader_;
     };
 }
 
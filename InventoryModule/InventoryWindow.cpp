@@ -288,11 +288,19 @@ void InventoryWindow::CopyAssetReference()
 
 void InventoryWindow::Search(const QString &text)
 {
-    treeView_->expandAll();
-    treeView_->keyboardSearch(text);
-    QModelIndex index = treeView_->selectionModel()->currentIndex();
-    if (index.isValid())
-        treeView_->selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
+    if (!inventoryItemModel_ || text.trimmed().isEmpty())
+        return;
+
+    QModelIndex index = inventoryItemModel_->Search(text);
+    if (!index.isValid())
+        return;
+
+    // Expand only the folders leading to the match instead of the whole tree.
+    for(QModelIndex parent = index.parent(); parent.isValid(); parent = parent.parent())
+        treeView_->expand(parent);
+
+    treeView_->scrollTo(index);
+    treeView_->selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
 }
 
 void InventoryWindow::UpdateActions()
@@ -7,7 +7,13 @@
 #include "DebugOperatorNew.h"
 #include "J2kEncoder.h"
 #include "InventoryModule.h"
+#include "InventoryFileUtils.h"
 #include <OgreColourValue.h>
+#include <OgrePixelFormat.h>
+#include <OgreDataStream.h>
+#include <OgreException.h>
+
+#include <boost/bind.hpp>
 
 #include "openjpeg.h"
 #include "MemoryLeakCheck.h"
@@ -158,32 +164,18 @@ bool J2kEncode(Ogre::Image &src_image, std::vector<u8> &outbuf, bool reversible)
     image->x1 = width;
     image->y1 = height;
 
-    int i = 0;
-    for (int y = 0; y < height; ++y)
+    // Convert the whole image to 8-bit RGBA at once, reading the pixels one by one as floats is much slower.
+    std::vector<u8> pixels(width * height * 4);
+    Ogre::PixelBox rgba(width, height, 1, Ogre::PF_BYTE_RGBA, &pixels[0]);
+    Ogre::PixelUtil::bulkPixelConversion(src_image.getPixelBox(), rgba);
+
+    const int num_pixels = width * height;
+    for (int c = 0; c < num_comps; ++c)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            Ogre::ColourValue pixel = src_image.getColourAt(x,y,0);
-            for (int c = 0; c < num_comps; ++c)
-            {
-                switch (c)
-                {
-                case 0:
-                    image->comps[c].data[i] = pixel.r * 255.0;
-                    break;
-                case 1:
-                    image->comps[c].data[i] = pixel.g * 255.0;
-                    break;
-                case 2:
-                    image->comps[c].data[i] = pixel.b * 255.0;
-                    break;
-                case 3:
-                    image->comps[c].data[i] = pixel.a * 255.0;
-                    break;
-                }
-            }
-            ++i;
-        }
+        int *data = image->comps[c].data;
+        const u8 *src = &pixels[c];
+        for (int i = 0; i < num_pixels; ++i, src += 4)
+            data[i] = *src;
     }
 
     // Encode the destination image.
@@ -236,4 +228,116 @@ bool J2kEncode(Ogre::Image &src_image, std::vector<u8> &outbuf, bool reversible)
     return true;
 }
 
+bool J2kEncodeImageFile(const std::vector<u8> &src_data, std::vector<u8> &outbuf)
+{
+    if (src_data.empty())
+        return false;
+
+    Ogre::Image image;
+    try
+    {
+#include "DisableMemoryLeakCheck.h"
+        Ogre::DataStreamPtr stream(new Ogre::MemoryDataStream((void*)&src_data[0], src_data.size(), false));
+#include "EnableMemoryLeakCheck.h"
+        image.load(stream);
+    }
+    catch (Ogre::Exception &e)
+    {
+        InventoryModule::LogError("Error loading image: " + std::string(e.what()));
+        return false;
+    }
+
+    return J2kEncode(image, outbuf, false);
+}
+
+J2kEncodeQueue::J2kEncodeQueue(uint max_threads) :
+    maxThreads_(max_threads),
+    numThreads_(0),
+    outstanding_(0),
+    stop_(false)
+{
+    if (!maxThreads_)
+    {
+        uint cores = boost::thread::hardware_concurrency();
+        maxThreads_ = cores > 1 ? cores - 1 : 1;
+    }
+}
+
+J2kEncodeQueue::~J2kEncodeQueue()
+{
+    {
+        MutexLock lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    threads_.join_all();
+}
+
+void J2kEncodeQueue::Add(const J2kEncodeJobPtr &job)
+{
+    {
+        MutexLock lock(mutex_);
+        queued_.push_back(job);
+        ++outstanding_;
+
+        // Start a worker for each waiting job until the maximum is reached.
+        if (numThreads_ < maxThreads_ && numThreads_ < outstanding_)
+        {
+            threads_.create_thread(boost::bind(&J2kEncodeQueue::Run, this));
+            ++numThreads_;
+        }
+    }
+    condition_.notify_all();
+}
+
+J2kEncodeJobPtr J2kEncodeQueue::WaitFinished()
+{
+    ScopedLock lock(mutex_);
+    while(finished_.empty() && outstanding_ > 0)
+        condition_.wait(lock);
+
+    if (finished_.empty())
+        return J2kEncodeJobPtr();
+
+    J2kEncodeJobPtr job = finished_.front();
+    finished_.pop_front();
+    --outstanding_;
+    return job;
+}
+
+void J2kEncodeQueue::Run()
+{
+    for(;;)
+    {
+        J2kEncodeJobPtr job;
+        {
+            ScopedLock lock(mutex_);
+            while(!stop_ && queued_.empty())
+                condition_.wait(lock);
+            if (stop_)
+                return;
+
+            job = queued_.front();
+            queued_.pop_front();
+        }
+
+        if (job->source.empty() && !job->filename.empty())
+        {
+            if (!ReadFileData(job->filename, job->source))
+                InventoryModule::LogError("Could not open the file: " + job->filename + ".");
+        }
+
+        job->success = J2kEncodeImageFile(job->source, job->encoded);
+
+        // Source data is not needed anymore, don't keep it while the job waits to be uploaded.
+        std::vector<u8>().swap(job->source);
+
+        {
+            MutexLock lock(mutex_);
+            finished_.push_back(job);
+        }
+        condition_.notify_all();
+    }
+}
+
 }
@@ -8,6 +8,11 @@
 
 #include <OgreImage.h>
 #include "CoreTypes.h"
+#include "CoreThread.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <list>
 
 namespace J2k
 {
@@ -31,6 +36,90 @@ namespace J2k
     /// @param outbuf
     /// @param reversible
     bool J2kEncode(Ogre::Image &src_image, std::vector<u8> &outbuf, bool reversible);
+
+    /// Decodes an image file and encodes it to J2k.
+    /// @param src_data Image file data in any format Ogre can load.
+    /// @param outbuf Encoded data.
+    /// @return True if successful.
+    bool J2kEncodeImageFile(const std::vector<u8> &src_data, std::vector<u8> &outbuf);
+
+    /// Image to be encoded by J2kEncodeQueue.
+    struct J2kEncodeJob
+    {
+        J2kEncodeJob() : id(0), success(false) {}
+
+        /// Id for the caller to identify the job.
+        int id;
+
+        /// Image file to read, if source is empty.
+        std::string filename;
+
+        /// Image file data.
+        std::vector<u8> source;
+
+        /// Encoded J2k data.
+        std::vector<u8> encoded;
+
+        /// Was the image read and encoded succesfully.
+        bool success;
+    };
+
+    typedef boost::shared_ptr<J2kEncodeJob> J2kEncodeJobPtr;
+
+    /// Encodes images to J2k on a pool of worker threads.
+    /** Jobs are started in the order they are added, and taken out in the order they finish, so the images
+        encoded first can be uploaded while the rest are still being encoded. Workers are started as needed,
+        up to one per CPU core less the one the caller runs on.
+    */
+    class J2kEncodeQueue
+    {
+    public:
+        /// Constructor.
+        /// @param max_threads Maximum number of worker threads, 0 to decide by the number of CPU cores.
+        explicit J2kEncodeQueue(uint max_threads = 0);
+
+        /// Destructor. Stops the workers, jobs not started are discarded.
+        ~J2kEncodeQueue();
+
+        /// Adds an image to be encoded.
+        /// @param job Job.
+        void Add(const J2kEncodeJobPtr &job);
+
+        /// Waits for the next job to finish.
+        /// @return Finished job, or null if all added jobs have been returned already.
+        J2kEncodeJobPtr WaitFinished();
+
+    private:
+        /// Worker thread function.
+        void Run();
+
+        /// Maximum number of worker threads.
+        uint maxThreads_;
+
+        /// Number of worker threads started.
+        uint numThreads_;
+
+        /// Jobs added and not yet returned by WaitFinished.
+        uint outstanding_;
+
+        /// Jobs waiting for a worker.
+        std::list<J2kEncodeJobPtr> queued_;
+
+        /// Finished jobs.
+        std::list<J2kEncodeJobPtr> finished_;
+
+        /// Should workers exit.
+        bool stop_;
+
+        /// Protects the job lists and counters.
+        Mutex mutex_;
+
+        /// Signaled when a job is added or finished.
+        Condition condition_;
+
+        /// Worker threads.
+        boost::thread_group threads_;
+    };
 }
 
 #endif
@@ -12,11 +12,14 @@
 #include "InventoryFolder.h"
 #include "InventoryAsset.h"
 #include "J2kEncoder.h"
+#include "InventoryFileUtils.h"
 
 #include "Framework.h"
 #include "ModuleManager.h"
 #include "ServiceManager.h"
 #include "EventManager.h"
+#include "ThreadTaskManager.h"
+#include "Platform.h"
 #include "Inventory/InventorySkeleton.h"
 #include "Inventory/InventoryEvents.h"
 #include "AssetEvents.h"
@@ -33,6 +36,7 @@
 #include <QImage>
 #include <QStringList>
 #include <QTime>
+#include <QTimer>
 
 #include <OgreImage.h>
 #include <OgreException.h>
@@ -56,6 +60,7 @@ OpenSimInventoryDataModel::OpenSimInventoryDataModel(
 
 OpenSimInventoryDataModel::~OpenSimInventoryDataModel()
 {
+    SaveCache();
     SAFE_DELETE(rootFolder_);
 }
 
@@ -79,6 +84,22 @@ AbstractInventoryItem *OpenSimInventoryDataModel::GetChildById(const QString &se
     return rootFolder_->GetChildById(searchId);
 }
 
+QList<AbstractInventoryItem *> OpenSimInventoryDataModel::SearchItems(const QString &text, int max_results) const
+{
+    // Limit is applied after filtering out the "Loading..." placeholders.
+    QList<AbstractInventoryItem *> items = index_.Search(text);
+    QList<AbstractInventoryItem *> results;
+    foreach(AbstractInventoryItem *item, items)
+    {
+        if (max_results > 0 && results.size() >= max_results)
+            break;
+        if (item->GetID() != "DummyItem")
+            results.append(item);
+    }
+
+    return results;
+}
+
 AbstractInventoryItem *OpenSimInventoryDataModel::GetRoot() const
 {
     return rootFolder_;
@@ -124,9 +145,12 @@ AbstractInventoryItem *OpenSimInventoryDataModel::GetOrCreateNewFolder(
     // Inform the server.
     // We don't want to notify server if we're creating folders "ordered" by server via InventoryDescecendents packet.
     if (notify_server)
+    {
         currentWorldStream_->SendCreateInventoryFolderPacket(
             RexUUID(parent->GetID().toStdString()), RexUUID(newFolder->GetID().toStdString()),
             255, newFolder->GetName().toStdString().c_str());
+        cache_.Invalidate(parent->GetID());
+    }
 
     newFolder->SetDirty(true);
     return parent->AddChild(newFolder);
@@ -161,6 +185,26 @@ bool OpenSimInventoryDataModel::FetchInventoryDescendents(AbstractInventoryItem
     if (item->GetItemType() != AbstractInventoryItem::Type_Folder)
         return false;
 
+    // Use the cached contents if the folder hasn't changed since they were fetched. Otherwise record the
+    // contents received from server to the cache.
+    QMap<QString, int>::const_iterator version = folderVersions_.find(item->GetID());
+    if (version != folderVersions_.end())
+    {
+        if (cache_.GetFolder(item->GetID(), version.value()))
+        {
+            // The view is fetching rows right now, so the folder is filled afterwards like from server.
+            if (!pendingCacheFills_.contains(item->GetID()))
+            {
+                pendingCacheFills_.append(item->GetID());
+                QTimer::singleShot(0, this, SLOT(FillFoldersFromCache()));
+            }
+
+            return true;
+        }
+
+        cache_.BeginFetch(item->GetID());
+    }
+
     ///\note    Due to some server-side mystery behaviour we must send the same packet twice: once
     ///         with fetch_folders = true & fetch_items = false and once with fetch_folders = false & fetch_items = true
     ///         in order to reveice the inventory item information correctly (asset&inventory types at least).
@@ -182,6 +226,8 @@ bool OpenSimInventoryDataModel::FetchInventoryDescendents(AbstractInventoryItem
 
 void OpenSimInventoryDataModel::NotifyServerAboutItemMove(AbstractInventoryItem *item)
 {
+    cache_.Invalidate(item->GetParent()->GetID());
+
     if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
         currentWorldStream_->SendMoveInventoryFolderPacket(QSTR_TO_UUID(item->GetID()),
             QSTR_TO_UUID(item->GetParent()->GetID()));
@@ -193,6 +239,8 @@ void OpenSimInventoryDataModel::NotifyServerAboutItemMove(AbstractInventoryItem
 
 void OpenSimInventoryDataModel::NotifyServerAboutItemCopy(AbstractInventoryItem *item)
 {
+    cache_.Invalidate(item->GetParent()->GetID());
+
     if (item->GetItemType() == AbstractInventoryItem::Type_Asset)
         currentWorldStream_->SendCopyInventoryItemPacket(QSTR_TO_UUID(worldLibraryOwnerId_),
             QSTR_TO_UUID(item->GetID()), QSTR_TO_UUID(item->GetParent()->GetID()), item->GetName().toStdString());
@@ -200,8 +248,13 @@ void OpenSimInventoryDataModel::NotifyServerAboutItemCopy(AbstractInventoryItem
 
 void OpenSimInventoryDataModel::NotifyServerAboutItemRemove(AbstractInventoryItem *item)
 {
+    cache_.Invalidate(item->GetParent()->GetID());
+
     if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
+    {
         currentWorldStream_->SendRemoveInventoryFolderPacket(QSTR_TO_UUID(item->GetID()));
+        cache_.Invalidate(item->GetID());
+    }
 
     if (item->GetItemType() == AbstractInventoryItem::Type_Asset)
         currentWorldStream_->SendRemoveInventoryItemPacket(QSTR_TO_UUID(item->GetID()));
@@ -209,6 +262,8 @@ void OpenSimInventoryDataModel::NotifyServerAboutItemRemove(AbstractInventoryIte
 
 void OpenSimInventoryDataModel::NotifyServerAboutItemUpdate(AbstractInventoryItem *item, const QString &old_name)
 {
+    cache_.Invalidate(item->GetParent()->GetID());
+
     if (item->GetItemType() == AbstractInventoryItem::Type_Folder)
         currentWorldStream_->SendUpdateInventoryFolderPacket(QSTR_TO_UUID(item->GetID()),
             QSTR_TO_UUID(item->GetParent()->GetID()), 127, item->GetName().toStdString());
@@ -574,45 +629,165 @@ void OpenSimInventoryDataModel::HandleAssetReadyForOpen(Foundation::EventDataInt
 void OpenSimInventoryDataModel::HandleInventoryDescendents(Foundation::EventDataInterface *data)
 {
     InventoryItemEventData *item_data = checked_static_cast<InventoryItemEventData *>(data);
+    QString parent_id = item_data->parentId.ToQString();
+
+    // Record the contents of folders being fetched. Items arriving for other folders, e.g. uploads,
+    // invalidate the cached contents.
+    if (!item_data->id.IsNull())
+    {
+        InventoryCacheItem item;
+        item.isFolder = item_data->item_type == IIT_Folder;
+        item.id = item_data->id.ToQString();
+        item.name = item_data->name.c_str();
+        if (!item.isFolder)
+        {
+            item.assetId = item_data->assetId.ToQString();
+            item.description = item_data->description.c_str();
+            item.inventoryType = item_data->inventoryType;
+            item.assetType = item_data->assetType;
+            item.creatorId = item_data->creatorId.ToQString();
+            item.ownerId = item_data->ownerId.ToQString();
+            item.groupId = item_data->groupId.ToQString();
+            item.creationTime = item_data->creationTime;
+        }
+
+        cache_.AddFetchedItem(parent_id, item);
+    }
+
+    if (item_data->lastItem && cache_.IsFetching(parent_id))
+        cache_.EndFetch(parent_id, folderVersions_.value(parent_id));
+
+    AddDescendent(*item_data);
+}
+
+void OpenSimInventoryDataModel::LoadCache(const RexUUID &agent_id)
+{
+    Foundation::Framework *framework = owner_->GetFramework();
+    QDir cache_dir(QString(framework->GetPlatform()->GetApplicationDataDirectory().c_str()) + "/inventorycache");
+    if (!cache_dir.exists())
+        cache_dir.mkpath(".");
+
+    cache_.SetFileName(cache_dir.absoluteFilePath(agent_id.ToQString() + ".dat"));
+
+    InventoryCacheLoadRequestPtr request(new InventoryCacheLoadRequest());
+    request->filename_ = cache_.GetFileName();
+    framework->GetThreadTaskManager()->AddRequest<InventoryCacheLoadRequest>("InventoryCacheLoader", request);
+}
+
+void OpenSimInventoryDataModel::SaveCache()
+{
+    // Forget folders that no longer exist.
+    cache_.Prune(QSet<QString>::fromList(folderVersions_.keys()));
+
+    if (!cache_.Save())
+        InventoryModule::LogWarning("Could not write inventory cache file " + cache_.GetFileName().toStdString() + ".");
+}
+
+void OpenSimInventoryDataModel::HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface *data)
+{
+    if (event_id != Task::Events::REQUEST_COMPLETED)
+        return;
 
-    AbstractInventoryItem *parentFolder = GetChildFolderById(item_data->parentId.ToQString());
+    InventoryCacheLoadResult *result = dynamic_cast<InventoryCacheLoadResult *>(data);
+    if (!result || result->task_description_ != "InventoryCacheLoader" || result->filename_ != cache_.GetFileName())
+        return;
+
+    // If the file was missing or unreadable, it is rewritten when saving.
+    cache_.Merge(result->folders_);
+    if (result->success_)
+        InventoryModule::LogDebug("Read " + QString::number(result->folders_.size()).toStdString() +
+            " cached inventory folders.");
+}
+
+void OpenSimInventoryDataModel::FillFoldersFromCache()
+{
+    QStringList folder_ids = pendingCacheFills_;
+    pendingCacheFills_.clear();
+
+    foreach(const QString &folder_id, folder_ids)
+    {
+        const InventoryCacheFolder *folder = cache_.GetFolder(folder_id, folderVersions_.value(folder_id));
+        if (!folder)
+        {
+            // Invalidated in the meantime, fetch from server instead.
+            AbstractInventoryItem *item = GetChildFolderById(folder_id);
+            if (item)
+                FetchInventoryDescendents(item);
+            continue;
+        }
+
+        RexUUID parent_id(folder_id.toStdString());
+        QList<InventoryCacheItem> items = folder->items;
+        if (items.isEmpty())
+        {
+            InventoryItemEventData folder_data(IIT_Folder);
+            folder_data.parentId = parent_id;
+            folder_data.lastItem = true;
+            AddDescendent(folder_data);
+            continue;
+        }
+
+        for(int i = 0; i < items.size(); ++i)
+        {
+            const InventoryCacheItem &item = items[i];
+            InventoryItemEventData item_data(item.isFolder ? IIT_Folder : IIT_Asset);
+            item_data.id = RexUUID(item.id.toStdString());
+            item_data.parentId = parent_id;
+            item_data.name = item.name.toStdString();
+            item_data.assetId = RexUUID(item.assetId.toStdString());
+            item_data.description = item.description.toStdString();
+            item_data.inventoryType = item.inventoryType;
+            item_data.assetType = item.assetType;
+            item_data.creatorId = RexUUID(item.creatorId.toStdString());
+            item_data.ownerId = RexUUID(item.ownerId.toStdString());
+            item_data.groupId = RexUUID(item.groupId.toStdString());
+            item_data.creationTime = item.creationTime;
+            item_data.lastItem = i == items.size() - 1;
+            AddDescendent(item_data);
+        }
+    }
+}
+
+void OpenSimInventoryDataModel::AddDescendent(const InventoryItemEventData &item_data)
+{
+    AbstractInventoryItem *parentFolder = GetChildFolderById(item_data.parentId.ToQString());
     if (!parentFolder)
         return;
 
     static_cast<InventoryFolder *>(parentFolder)->SetDirty(false);
 
-    AbstractInventoryItem *existing = GetChildById(item_data->id.ToQString());
-    if (!existing)
+    // Empty folders are reported with a null item.
+    AbstractInventoryItem *existing = GetChildById(item_data.id.ToQString());
+    if (!existing && !item_data.id.IsNull())
     {
-        if (item_data->item_type == IIT_Folder)
+        if (item_data.item_type == IIT_Folder)
         {
             InventoryFolder *newFolder = static_cast<InventoryFolder *>(GetOrCreateNewFolder(
-                item_data->id.ToQString(), *parentFolder, false));
+                item_data.id.ToQString(), *parentFolder, item_data.name.c_str(), false));
 
-            newFolder->SetName(item_data->name.c_str());
-            ///\todo newFolder->SetType(item_data->type);
+            ///\todo newFolder->SetType(item_data.type);
             newFolder->SetDirty(true);
         }
-        else if (item_data->item_type == IIT_Asset)
+        else if (item_data.item_type == IIT_Asset)
         {
             InventoryAsset *newAsset = static_cast<InventoryAsset *>(GetOrCreateNewAsset(
-                item_data->id.ToQString(), item_data->assetId.ToQString(),
-                *parentFolder, item_data->name.c_str()));
+                item_data.id.ToQString(), item_data.assetId.ToQString(),
+                *parentFolder, item_data.name.c_str()));
 
-            newAsset->SetDescription(item_data->description.c_str());
-            newAsset->SetInventoryType(item_data->inventoryType);
-            newAsset->SetAssetType(item_data->assetType);
-            newAsset->SetCreatorId(item_data->creatorId);
-            newAsset->SetOwnerId(item_data->ownerId);
-            newAsset->SetGroupId(item_data->groupId);
-            newAsset->SetCreationTime(item_data->creationTime);
+            newAsset->SetDescription(item_data.description.c_str());
+            newAsset->SetInventoryType(item_data.inventoryType);
+            newAsset->SetAssetType(item_data.assetType);
+            newAsset->SetCreatorId(item_data.creatorId);
+            newAsset->SetOwnerId(item_data.ownerId);
+            newAsset->SetGroupId(item_data.groupId);
+            newAsset->SetCreationTime(item_data.creationTime);
 
             // Request names for the UUID's.
             SendNameUuidRequest(newAsset);
         }
     }
 
-    if (item_data->lastItem)
+    if (item_data.lastItem)
     {
         emit NewItem(parentFolder);
         EmitFolderDescendentsFetched(parentFolder->GetID());
@@ -644,23 +819,14 @@ bool OpenSimInventoryDataModel::UploadFile(
     if (filename.find('/',0) == 0)
         filename.erase(0, 1);
 #endif
-    std::ifstream file(filename.c_str(), std::ios::binary);
-    if (!file.is_open())
+    std::vector<u8> data;
+    if (!ReadFileData(filename, data))
     {
         InventoryModule::LogError("Could not open the file: " + filename + ".");
         return false;
     }
 
-    QVector<uchar> buffer;
-
-    std::filebuf *pbuf = file.rdbuf();
-    size_t size = pbuf->pubseekoff(0, std::ios::end, std::ios::in);
-    buffer.resize(size);
-    pbuf->pubseekpos(0, std::ios::in);
-    pbuf->sgetn((char *)&buffer[0], size);
-    file.close();
-
-    return UploadBuffer(asset_type, filename, name, description, folder_id, buffer);
+    return UploadBuffer(asset_type, filename, name, description, folder_id, data);
 }
 
 bool OpenSimInventoryDataModel::UploadBuffer(
@@ -669,7 +835,37 @@ bool OpenSimInventoryDataModel::UploadBuffer(
     const std::string& name,
     const std::string& description,
     const RexUUID& folder_id,
-    const QVector<uchar>& buffer)
+    const std::vector<u8> &data)
+{
+    if (data.empty())
+    {
+        InventoryModule::LogError("Upload buffer of " + filename + " was empty.");
+        return false;
+    }
+
+    // If the file is texture, use Ogre image and J2k encoding.
+    if (asset_type == RexTypes::RexAT_Texture)
+    {
+        std::vector<u8> encoded_buffer;
+        if (!J2k::J2kEncodeImageFile(data, encoded_buffer))
+        {
+            InventoryModule::LogError("Could not J2k encode the image file.");
+            return false;
+        }
+
+        return UploadData(asset_type, filename, name, description, folder_id, encoded_buffer);
+    }
+
+    return UploadData(asset_type, filename, name, description, folder_id, data);
+}
+
+bool OpenSimInventoryDataModel::UploadData(
+    const asset_type_t asset_type,
+    const std::string &filename,
+    const std::string &name,
+    const std::string &description,
+    const RexUUID &folder_id,
+    const std::vector<u8> &data)
 {
     if (uploadCapability_.empty())
     {
@@ -718,38 +914,7 @@ bool OpenSimInventoryDataModel::UploadBuffer(
     request2.SetUrl(upload_url);
     request2.SetMethod(HttpUtilities::HttpRequest::Post);
 
-    // If the file is texture, use Ogre image and J2k encoding.
-    if (asset_type == RexTypes::RexAT_Texture)
-    {
-        Ogre::Image image;
-        try
-        {
-#include "DisableMemoryLeakCheck.h"
-            Ogre::DataStreamPtr stream(new Ogre::MemoryDataStream((void*)&buffer[0], buffer.size(), false));
-#include "EnableMemoryLeakCheck.h"
-            image.load(stream);
-        }
-        catch (Ogre::Exception &e)
-        {
-            InventoryModule::LogError("Error loading image: " + std::string(e.what()));
-            return false;
-        }
-
-        std::vector<u8> encoded_buffer;
-        bool success = J2k::J2kEncode(image, encoded_buffer, false);
-        if (!success)
-        {
-            InventoryModule::LogError("Could not J2k encode the image file.");
-            return false;
-        }
-        
-        request2.SetRequestData("application/octet-stream", encoded_buffer);
-    }
-    else
-    {
-        // Other assets can be uploaded as raw data.
-        request2.SetRequestData("application/octet-stream", buffer.toStdVector());
-    }
+    request2.SetRequestData("application/octet-stream", data);
 
     response.clear();
     response_str.clear();
@@ -838,6 +1003,7 @@ void OpenSimInventoryDataModel::CreateNewFolderFromFolderSkeleton(
 
     InventoryFolder *newFolder = new InventoryFolder(folder_skeleton->id.ToQString(),
         folder_skeleton->name.c_str(), parent_folder, folder_skeleton->editable);
+    folderVersions_[newFolder->GetID()] = folder_skeleton->version;
     //if (!folder_skeleton->HasChildren())
     newFolder->SetDirty(true);
 
@@ -881,12 +1047,15 @@ void OpenSimInventoryDataModel::SetupModelData(ProtocolUtilities::InventorySkele
     worldLibraryOwnerId_ = inventory_skeleton->worldLibraryOwnerId.ToQString();
 
     CreateNewFolderFromFolderSkeleton(0, inventory_skeleton->GetRoot());
+    if (rootFolder_)
+        rootFolder_->SetIndex(&index_);
 }
 
 void OpenSimInventoryDataModel::ThreadedUploadFiles(QStringList &filenames, QStringList &item_names)
 {
+    std::vector<UploadItem> items;
+
     // Iterate trought every asset.
-    int asset_count = 0;
     QStringList::iterator name_it = item_names.begin();
     for(QStringList::iterator it = filenames.begin(); it != filenames.end(); ++it)
     {
@@ -894,21 +1063,17 @@ void OpenSimInventoryDataModel::ThreadedUploadFiles(QStringList &filenames, QStr
         QString real_filename = filename;
         real_filename = real_filename.midRef(real_filename.lastIndexOf(QDir::separator())+1).toString();
 
-        emit UploadStarted(real_filename);
-
         asset_type_t asset_type = RexTypes::GetAssetTypeFromFilename(filename.toStdString());
         if (asset_type == RexAT_None)
         {
+            emit UploadStarted(real_filename);
             emit UploadFailed(real_filename, "Invalid file extension");
             InventoryModule::LogError("Invalid file extension. File can't be uploaded: " + filename.toStdString());
             continue;
         }
 
-        // Create the asset uploading info XML message.
-        std::string it_str = RexTypes::GetInventoryTypeString(asset_type);
-        std::string at_str = RexTypes::GetAssetTypeString(asset_type);
         std::string cat_name = RexTypes::GetCategoryNameForAssetType(asset_type);
-        
+
         ///\todo User-defined name and desc when we got the UI.
         QString name;
         if (name_it != item_names.end())
@@ -919,8 +1084,6 @@ void OpenSimInventoryDataModel::ThreadedUploadFiles(QStringList &filenames, QStr
         else
             name = CreateNameFromFilename(filename);
 
-        std::string description = "(No Description)";
-
         RexUUID folder_id(GetFirstChildFolderByName(cat_name.c_str())->GetID().toStdString());
         if (folder_id.IsNull())
         {
@@ -928,17 +1091,23 @@ void OpenSimInventoryDataModel::ThreadedUploadFiles(QStringList &filenames, QStr
             continue;
         }
 
-        if (UploadFile(asset_type, filename.toStdString(), name.toStdString(), description, folder_id))
-        {
-            emit UploadCompleted(real_filename);
-            ++asset_count;
-        }
-        else
-        {
-            emit UploadFailed(real_filename, "Network error");
-        }
+        // The files are read when their turn comes, textures by the encoding workers.
+        UploadItem item;
+        item.assetType = asset_type;
+        item.filename = filename.toStdString();
+#ifdef Q_WS_WIN
+        // Remove leading '/' on Windows environment, if it exists.
+        if (item.filename.find('/',0) == 0)
+            item.filename.erase(0, 1);
+#endif
+        item.displayName = real_filename;
+        item.name = name.toStdString();
+        item.folderId = folder_id;
+        items.push_back(item);
     }
 
+    int asset_count = UploadItems(items, true);
+
     emit MultiUploadCompleted();
     InventoryModule::LogInfo("Multiupload:" + ToString(asset_count) + " assets succesfully uploaded.");
 }
@@ -951,14 +1120,18 @@ void OpenSimInventoryDataModel::ThreadedUploadBuffers(QStringList filenames, QVe
         return;
     }
 
+    std::vector<UploadItem> items;
+
     // Iterate trought every asset.
-    int asset_count = 0;
     QVector<QVector<uchar> >::iterator it2 = buffers.begin();
 
     QStringListIterator it(filenames);
     while(it.hasNext())
     {
         QString filename = it.next();
+        const QVector<uchar> &buffer = *it2;
+        ++it2;
+
         asset_type_t asset_type = RexTypes::GetAssetTypeFromFilename(filename.toStdString());
         if (asset_type == RexAT_None)
         {
@@ -966,14 +1139,10 @@ void OpenSimInventoryDataModel::ThreadedUploadBuffers(QStringList filenames, QVe
             continue;
         }
 
-        // Create the asset uploading info XML message.
-        std::string it_str = RexTypes::GetInventoryTypeString(asset_type);
-        std::string at_str = RexTypes::GetAssetTypeString(asset_type);
         std::string cat_name = RexTypes::GetCategoryNameForAssetType(asset_type);
 
         ///\todo User-defined name and desc when we got the UI.
         QString name = CreateNameFromFilename(filename);
-        std::string description = "(No Description)";
 
         RexUUID folder_id(GetFirstChildFolderByName(cat_name.c_str())->GetID().toStdString());
         if (folder_id.IsNull())
@@ -982,15 +1151,120 @@ void OpenSimInventoryDataModel::ThreadedUploadBuffers(QStringList filenames, QVe
             continue;
         }
 
-        if (UploadBuffer(asset_type, filename.toStdString(), name.toStdString(), description, folder_id, *it2))
-            ++asset_count;
+        if (buffer.isEmpty())
+        {
+            InventoryModule::LogError("Upload buffer of " + filename.toStdString() + " was empty.");
+            continue;
+        }
 
-        ++it2;
+        UploadItem item;
+        item.assetType = asset_type;
+        item.filename = filename.toStdString();
+        item.displayName = filename;
+        item.name = name.toStdString();
+        item.folderId = folder_id;
+        item.data.assign(buffer.begin(), buffer.end());
+        items.push_back(item);
     }
 
+    int asset_count = UploadItems(items, false);
+
     InventoryModule::LogInfo("Multiupload:" + ToString(asset_count) + " assets succesfully uploaded.");
 }
 
+int OpenSimInventoryDataModel::UploadItems(std::vector<UploadItem> &items, bool notify)
+{
+    int asset_count = 0;
+    int texture_count = 0;
+    int encoded_count = 0;
+    J2k::J2kEncodeQueue encoder;
+
+    // Start encoding all textures first, so the other assets are uploaded while the workers are busy.
+    for(size_t i = 0; i < items.size(); ++i)
+    {
+        UploadItem &item = items[i];
+        if (item.assetType != RexTypes::RexAT_Texture)
+            continue;
+
+        J2k::J2kEncodeJobPtr job(new J2k::J2kEncodeJob);
+        job->id = (int)i;
+        job->filename = item.filename;
+        job->source.swap(item.data);
+        encoder.Add(job);
+        ++texture_count;
+    }
+
+    if (notify && texture_count > 0)
+        emit EncodingProgress(0, texture_count);
+
+    for(size_t i = 0; i < items.size(); ++i)
+    {
+        UploadItem &item = items[i];
+        if (item.assetType == RexTypes::RexAT_Texture)
+            continue;
+
+        if (item.data.empty() && !ReadFileData(item.filename, item.data))
+        {
+            InventoryModule::LogError("Could not open the file: " + item.filename + ".");
+            if (notify)
+            {
+                emit UploadStarted(item.displayName);
+                emit UploadFailed(item.displayName, "Could not read the file");
+            }
+            continue;
+        }
+
+        if (UploadItemData(item, notify))
+            ++asset_count;
+        std::vector<u8>().swap(item.data);
+    }
+
+    // Upload the textures in the order they finish encoding.
+    J2k::J2kEncodeJobPtr job;
+    while((job = encoder.WaitFinished()))
+    {
+        UploadItem &item = items[job->id];
+        ++encoded_count;
+        if (notify)
+            emit EncodingProgress(encoded_count, texture_count);
+
+        if (!job->success)
+        {
+            InventoryModule::LogError("Could not J2k encode the image file " + item.filename + ".");
+            if (notify)
+            {
+                emit UploadStarted(item.displayName);
+                emit UploadFailed(item.displayName, "Image encoding failed");
+            }
+            continue;
+        }
+
+        item.data.swap(job->encoded);
+        if (UploadItemData(item, notify))
+            ++asset_count;
+        std::vector<u8>().swap(item.data);
+    }
+
+    return asset_count;
+}
+
+bool OpenSimInventoryDataModel::UploadItemData(const UploadItem &item, bool notify)
+{
+    if (notify)
+        emit UploadStarted(item.displayName);
+
+    if (UploadData(item.assetType, item.filename, item.name, "(No Description)", item.folderId, item.data))
+    {
+        if (notify)
+            emit UploadCompleted(item.displayName);
+        return true;
+    }
+
+    if (notify)
+        emit UploadFailed(item.displayName, "Network error");
+    return false;
+}
+
 void OpenSimInventoryDataModel::SendNameUuidRequest(InventoryAsset *asset)
 {
     std::vector<RexUUID> names, groups;
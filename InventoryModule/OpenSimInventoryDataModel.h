@@ -9,6 +9,8 @@
 #define incl_InventoryModule_OpenSimInventoryDataModel_h
 
 #include "AbstractInventoryDataModel.h"
+#include "InventoryIndex.h"
+#include "InventoryCache.h"
 
 #include "RexTypes.h"
 
@@ -38,6 +40,7 @@ namespace Inventory
     class InventoryModule;
     class InventoryFolder;
     class InventoryAsset;
+    class InventoryItemEventData;
 
     /// Data model providing the OpenSim inventory model backend functionality.
     class OpenSimInventoryDataModel : public AbstractInventoryDataModel
@@ -114,6 +117,10 @@ namespace Inventory
         /// AbstractInventoryDataModel override.
         AbstractInventoryItem *GetTrashFolder() const;
 
+        /// AbstractInventoryDataModel override.
+        /// @note Placeholder "Loading..." items are not returned.
+        QList<AbstractInventoryItem *> SearchItems(const QString &text, int max_results = 0) const;
+
         /// @return Pointer to "My Inventory" folder or null if not found.
         InventoryFolder *GetMyInventoryFolder() const;
 
@@ -139,6 +146,19 @@ namespace Inventory
         /// @param data Event data.
         void HandleInventoryDescendents(Foundation::EventDataInterface *data);
 
+        /// Starts reading the inventory cache of an agent in the background.
+        /// Until it has been read, folder descendents are fetched from server.
+        /// @param agent_id Agent ID.
+        void LoadCache(const RexUUID &agent_id);
+
+        /// Writes the inventory cache, if it has changed.
+        void SaveCache();
+
+        /// Handles thread task events. Receives the read inventory cache.
+        /// @param event_id Event ID.
+        /// @param data Event data.
+        void HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface *data);
+
         /// Handles RESOURCE_READY event.
         /// @param data Event data.
 //        void HandleResourceReady(Foundation::EventDataInterface *data);
@@ -181,7 +201,24 @@ namespace Inventory
             const std::string &name,
             const std::string &description,
             const RexUUID &folder_id,
-            const QVector<uchar>& buffer);
+            const std::vector<u8> &data);
+
+        /** Posts asset data to the upload capability.
+            @param asset_type_t Asset type.
+            @param filename Filename.
+            @param name User-defined name.
+            @param description User-defined description.
+            @param folder_id Id of the destination folder for this item.
+            @param data Asset data, textures already J2k encoded.
+            @return true if successful
+         */
+        bool UploadData(
+            const asset_type_t asset_type,
+            const std::string &filename,
+            const std::string &name,
+            const std::string &description,
+            const RexUUID &folder_id,
+            const std::vector<u8> &data);
 
         /// @return Does asset uploader have upload capability set.
         bool HasUploadCapability() const { return uploadCapability_ != ""; }
@@ -199,9 +236,17 @@ namespace Inventory
         /// @param asset Inventory asset for which the requst is made.
         void SendNameUuidRequest(InventoryAsset *asset);
 
+    private slots:
+        /// Adds the cached contents of the folders requested with FetchInventoryDescendents.
+        void FillFoldersFromCache();
+
     private:
         Q_DISABLE_COPY(OpenSimInventoryDataModel);
 
+        /// Adds an item received from server or read from the cache to its parent folder.
+        /// @param item_data Item data.
+        void AddDescendent(const InventoryItemEventData &item_data);
+
         /// Utility function for creating new folders from the folder skeletons. Used recursively.
         /// @param parent_folder Parent folder.
         /// @param folder_skeleton Folder skeleton for the folder to be created.
@@ -213,6 +258,41 @@ namespace Inventory
         /// @param inventory_skeleton OpenSim inventory skeleton.
         void SetupModelData(ProtocolUtilities::InventorySkeleton *inventory_skeleton);
 
+        /// Asset of a multiupload.
+        struct UploadItem
+        {
+            /// Asset type.
+            asset_type_t assetType;
+
+            /// Full filename.
+            std::string filename;
+
+            /// Filename without path, shown in upload notifications.
+            QString displayName;
+
+            /// User-defined name.
+            std::string name;
+
+            /// Id of the destination folder.
+            RexUUID folderId;
+
+            /// Asset data. Empty if the file hasn't been read yet.
+            std::vector<u8> data;
+        };
+
+        /// Uploads the assets of a multiupload. Textures are J2k encoded on worker threads, and each asset
+        /// is uploaded as soon as its data is ready.
+        /// @param items Assets.
+        /// @param notify Emit the upload signals.
+        /// @return Number of succesfully uploaded assets.
+        int UploadItems(std::vector<UploadItem> &items, bool notify);
+
+        /// Uploads one asset of a multiupload with ready data.
+        /// @param item Asset.
+        /// @param notify Emit the upload signals.
+        /// @return true if successful
+        bool UploadItemData(const UploadItem &item, bool notify);
+
         /// Used by UploadFiles.
         void ThreadedUploadFiles(QStringList &filenames, QStringList &item_names);
 
@@ -236,6 +316,18 @@ namespace Inventory
         /// The root folder.
         InventoryFolder *rootFolder_;
 
+        /// Id and search index of the inventory tree.
+        InventoryIndex index_;
+
+        /// Cached folder contents.
+        InventoryCache cache_;
+
+        /// Folder versions from the login inventory skeleton, used to validate the cache.
+        QMap<QString, int> folderVersions_;
+
+        /// Folders to be filled from the cache.
+        QStringList pendingCacheFills_;
+
         /// World Library owner id.
         QString worldLibraryOwnerId_;
 
@@ -83,6 +83,13 @@ void UploadProgressWindow::UploadStarted(const QString &filename)
     }
 }
 
+void UploadProgressWindow::EncodingProgress(int encoded, int texture_count)
+{
+    // Uploads of the encoded textures overwrite the label, so show encoding progress only until they start.
+    if (uploadCount_ == 0)
+        labelFileNumber_->setText(QString("Encoding images (%1/%2)").arg(encoded).arg(texture_count));
+}
+
 void UploadProgressWindow::CloseUploadProgress()
 {
     progressBar_->reset();
@@ -46,6 +46,11 @@ namespace Inventory
         ///
         void UploadStarted(const QString &filename);
 
+        /// Shows J2k encoding progress of the textures.
+        /// @param encoded Number of textures encoded so far.
+        /// @param texture_count Number of textures to be encoded.
+        void EncodingProgress(int encoded, int texture_count);
+
         ///
         void CloseUploadProgress();
 
@@ -63,6 +63,11 @@ namespace Inventory
         return rootFolder_->GetChildById(searchId);
     }
 
+    QList<AbstractInventoryItem *> WebDavInventoryDataModel::SearchItems(const QString &text, int max_results) const
+    {
+        return index_.Search(text, max_results);
+    }
+
     AbstractInventoryItem *WebDavInventoryDataModel::GetOrCreateNewFolder(const QString &id, AbstractInventoryItem &parentFolder,
             const QString &name, const bool &notify_server)
     {
@@ -154,7 +159,7 @@ namespace Inventory
             return false;
 
         // Delete children
-        selected->GetChildren().clear();
+        selected->DetachChildren();
 
         QString itemPath = selected->GetID();
         QStringList children = webdavclient_.call("listResources", QVariantList() << itemPath).toStringList();
@@ -460,6 +465,7 @@ namespace Inventory
         if (!rootFolder_)
         {
             rootFolder_ = new InventoryFolder("root", "Webdav Inventory", false, 0);
+            rootFolder_->SetIndex(&index_);
             parentFolder = new InventoryFolder("", QString("My Inventory"), false, rootFolder_);
             rootFolder_->AddChild(parentFolder);
             rootFolder_->SetDirty(true);
@@ -494,7 +500,10 @@ namespace Inventory
     void WebDavInventoryDataModel::ErrorOccurredCreateEmptyRootFolder()
     {
         if (!rootFolder_)
+        {
             rootFolder_ = new InventoryFolder("root", "Error while fetching Webdav Inventory", false, 0);
+            rootFolder_->SetIndex(&index_);
+        }
         InventoryFolder *parentFolder = new InventoryFolder("/", QString("My Inventory"), false, rootFolder_);
         rootFolder_->AddChild(parentFolder);
         rootFolder_->SetDirty(true);
@@ -10,6 +10,7 @@
 
 #include "AbstractInventoryDataModel.h"
 #include "InventoryFolder.h"
+#include "InventoryIndex.h"
 
 #include "PythonQt.h"
 
@@ -70,6 +71,9 @@ namespace Inventory
         /// AbstractInventoryDataModel override.
         AbstractInventoryItem *GetTrashFolder() const { return 0; };
 
+        /// AbstractInventoryDataModel override.
+        QList<AbstractInventoryItem *> SearchItems(const QString &text, int max_results = 0) const;
+
         /// AbstractInventoryDataModel override.
         bool OpenItem(AbstractInventoryItem *item);
 
@@ -124,6 +128,9 @@ namespace Inventory
         /// The root folder.
         InventoryFolder *rootFolder_;
 
+        /// Id and search index of the inventory tree.
+        InventoryIndex index_;
+
         /// Pointer to PythonQt main module
         PythonQtObjectPtr pythonQtMainModule_;
 
@@ -4,11 +4,14 @@
 #include "JavascriptScriptModule.h"
 #include "ModuleManager.h"
 #include "ConsoleCommandServiceInterface.h"
+#include "SceneManager.h"
 
 //#include <QtScript>
 #include <QScriptEngine>
 #include <QtGui>
 #include <QObject>
+#include <QVector3D>
+#include <QQuaternion>
 Q_SCRIPT_DECLARE_QMETAOBJECT(QPushButton, QWidget*)
 
 //#include <QtUiTools>
@@ -64,6 +67,8 @@ namespace JavascriptScript
         //LogInfo("Javascript thinks 1 + 1 = " + res.toString().toStdString());
 
         engine.globalObject().setProperty("print", engine.newFunction(JavascriptScript::Print));
+        engine.globalObject().setProperty("getTransforms", engine.newFunction(JavascriptScript::GetTransforms));
+        engine.globalObject().setProperty("setTransforms", engine.newFunction(JavascriptScript::SetTransforms));
         //engine.globalObject().setProperty("loadUI", engine.newFunction(JavascriptScript::LoadUI));
 
         QScriptValue objectbutton= engine.scriptValueFromQMetaObject<QPushButton>();
@@ -246,3 +251,86 @@ QScriptValue JavascriptScript::ScriptRunFile(QScriptContext *context, QScriptEng
 
     return QScriptValue();
 }
+
+//! Numbers per entity in the arrays of getTransforms and setTransforms.
+static const int TRANSFORM_NUMBERS = 7;
+
+//! Returns the placeable of an entity in the default scene, or null. Accessed through its properties,
+//! so this module doesn't need to link to the renderer.
+static QObject *GetPlaceable(const Scene::ScenePtr &scene, entity_id_t id)
+{
+    Scene::EntityPtr entity = scene->GetEntity(id);
+    if (!entity)
+        return 0;
+    return entity->GetComponent("EC_OgrePlaceable").get();
+}
+
+QScriptValue JavascriptScript::GetTransforms(QScriptContext *context, QScriptEngine *engine)
+{
+    QScriptValue ids = context->argument(0);
+    if (!ids.isArray())
+        return context->throwError(QScriptContext::TypeError, "getTransforms: argument should be an array of entity ids.");
+
+    Scene::ScenePtr scene = JavascriptScriptModule::GetInstance()->GetFramework()->GetDefaultWorldScene();
+    if (!scene)
+        return context->throwError("getTransforms: no scene.");
+
+    quint32 count = ids.property("length").toUInt32();
+    QScriptValue result = engine->newArray(count * TRANSFORM_NUMBERS);
+    quint32 index = 0;
+    for(quint32 i = 0; i < count; ++i)
+    {
+        QVector3D pos;
+        QQuaternion orient;
+        QObject *placeable = GetPlaceable(scene, ids.property(i).toUInt32());
+        if (placeable)
+        {
+            pos = placeable->property("Position").value<QVector3D>();
+            orient = placeable->property("Orientation").value<QQuaternion>();
+        }
+
+        result.setProperty(index++, pos.x());
+        result.setProperty(index++, pos.y());
+        result.setProperty(index++, pos.z());
+        result.setProperty(index++, orient.x());
+        result.setProperty(index++, orient.y());
+        result.setProperty(index++, orient.z());
+        result.setProperty(index++, orient.scalar());
+    }
+
+    return result;
+}
+
+QScriptValue JavascriptScript::SetTransforms(QScriptContext *context, QScriptEngine *engine)
+{
+    QScriptValue ids = context->argument(0);
+    QScriptValue values = context->argument(1);
+    if (!ids.isArray() || !values.isArray())
+        return context->throwError(QScriptContext::TypeError, "setTransforms: arguments should be an array of entity ids and an array of numbers.");
+
+    quint32 count = ids.property("length").toUInt32();
+    if (values.property("length").toUInt32() < count * TRANSFORM_NUMBERS)
+        return context->throwError(QScriptContext::RangeError, "setTransforms: values array needs 7 numbers per entity.");
+
+    Scene::ScenePtr scene = JavascriptScriptModule::GetInstance()->GetFramework()->GetDefaultWorldScene();
+    if (!scene)
+        return context->throwError("setTransforms: no scene.");
+
+    quint32 set = 0;
+    for(quint32 i = 0; i < count; ++i)
+    {
+        QObject *placeable = GetPlaceable(scene, ids.property(i).toUInt32());
+        if (!placeable)
+            continue;
+
+        quint32 index = i * TRANSFORM_NUMBERS;
+        QVector3D pos(values.property(index).toNumber(), values.property(index + 1).toNumber(), values.property(index + 2).toNumber());
+        QQuaternion orient(values.property(index + 6).toNumber(), values.property(index + 3).toNumber(),
+            values.property(index + 4).toNumber(), values.property(index + 5).toNumber());
+        placeable->setProperty("Position", QVariant::fromValue(pos));
+        placeable->setProperty("Orientation", QVariant::fromValue(orient));
+        ++set;
+    }
+
+    return QScriptValue(engine, set);
+}
@@ -57,6 +57,14 @@ namespace JavascriptScript
     //QScriptValue LoadUI(QScriptContext *context, QScriptEngine *engine);
     QScriptValue Print(QScriptContext *context, QScriptEngine *engine);
     QScriptValue ScriptRunFile(QScriptContext *context, QScriptEngine *engine);
+
+    //! getTransforms(ids): returns a flat array with 7 numbers per entity: position x, y, z, orientation x, y, z, w.
+    //! Entities without a placeable get zero position and identity orientation.
+    QScriptValue GetTransforms(QScriptContext *context, QScriptEngine *engine);
+
+    //! setTransforms(ids, values): sets positions and orientations from a flat array laid out as in getTransforms.
+    //! Returns the number of entities set.
+    QScriptValue SetTransforms(QScriptContext *context, QScriptEngine *engine);
 }
 
 #endif
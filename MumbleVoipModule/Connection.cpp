@@ -18,6 +18,7 @@
 #include "Channel.h"
 #include "User.h"
 #include "PCMAudioFrame.h"
+#include "VoiceMixer.h"
 #include <QUrl>
 #include <celt/celt_types.h>
 #include <celt/celt.h>
@@ -81,7 +82,7 @@ namespace MumbleVoip
             authenticated_(false),
             celt_mode_(0),
             celt_encoder_(0),
-            celt_decoder_(0),
+            mixer_(0),
             sending_audio_(false),
             receiving_audio_(true),
             frame_sequence_(0),
@@ -94,6 +95,9 @@ namespace MumbleVoip
 
         InitializeCELT();
 
+        mixer_ = new VoiceMixer();
+        mixer_->start();
+
         MumbleClient::MumbleClientLib* mumble_lib = MumbleClient::MumbleClientLib::instance();
         QMutexLocker client_locker(&mutex_client_);
         client_ = mumble_lib->NewClient();
@@ -136,6 +140,7 @@ namespace MumbleVoip
         QMutexLocker locker1(&mutex_raw_udp_tunnel_);
 
         UninitializeCELT();
+        SAFE_DELETE(mixer_); // stops the mixer thread
 
         QMutexLocker locker2(&mutex_encode_queue_);
         while (encode_queue_.size() > 0)
@@ -222,8 +227,6 @@ namespace MumbleVoip
         celt_encoder_ctl(celt_encoder_, CELT_SET_PREDICTION(0));
 	    celt_encoder_ctl(celt_encoder_, CELT_SET_VBR_RATE(AudioQuality()));
 
-        celt_decoder_ = CreateCELTDecoder();
-
         MumbleVoipModule::LogDebug("CELT initialized.");
     }
 
@@ -231,40 +234,10 @@ namespace MumbleVoip
     {
         celt_encoder_destroy(celt_encoder_);
         celt_encoder_ = 0;
-        celt_decoder_destroy(celt_decoder_);
         celt_mode_destroy(celt_mode_);
         MumbleVoipModule::LogDebug("CELT uninitialized.");
     }
 
-    CELTDecoder* Connection::CreateCELTDecoder()
-    {
-        int error = 0;
-        CELTDecoder* decoder = celt_decoder_create(celt_mode_,NUMBER_OF_CHANNELS, &error);
-        switch (error)
-        {
-        case CELT_OK:
-           return decoder;
-        case CELT_BAD_ARG:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_BAD_ARG");
-            return 0;
-        case CELT_INVALID_MODE:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_INVALID_MODE");
-            return 0;
-        case CELT_INTERNAL_ERROR:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_INTERNAL_ERROR");
-            return 0;
-        case CELT_UNIMPLEMENTED:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_UNIMPLEMENTED");
-            return 0;
-        case CELT_ALLOC_FAIL:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_ALLOC_FAIL");
-            return 0;
-        default:
-            MumbleVoipModule::LogError("Cannot create CELT decoder: unknow reason");
-            return 0;
-        }
-    }
-
     void Connection::Join(QString channel_name)
     {
         QMutexLocker locker1(&mutex_authentication_);
@@ -291,26 +264,29 @@ namespace MumbleVoip
         client_->JoinChannel(channel->Id());
     }
 
-    AudioPacket Connection::GetAudioPacket()
+    bool Connection::GetMixedAudioFrame(MixedAudioFrame &mixed_frame)
     {
-        QMutexLocker userlist_locker(&mutex_users_);
+        return mixer_->GetMixedFrame(mixed_frame);
+    }
 
-        foreach(User* user, users_)
-        {
-            if (!user->tryLock())
-                continue;
+    void Connection::ReleaseAudioFrame(PCMAudioFrame* frame)
+    {
+        mixer_->ReleaseFrame(frame);
+    }
 
-            PCMAudioFrame* frame = user->GetAudioFrame();
-            if (frame)
-            {
-                user->unlock();
-                return AudioPacket(user, frame);
-            }
+    void Connection::SetPlaybackListener(Vector3df position, const QSet<int> &muted_sessions)
+    {
+        mixer_->SetListener(position, muted_sessions);
+    }
 
-            user->unlock();
-        }
+    bool Connection::GetPlaybackStatistics(int session, VoiceSpeakerStatistics &statistics)
+    {
+        return mixer_->GetSpeakerStatistics(session, statistics);
+    }
 
-        return AudioPacket(0,0);
+    VoiceMixerStatistics Connection::PlaybackStatistics()
+    {
+        return mixer_->Statistics();
     }
 
     void Connection::SendAudio(bool send)
@@ -499,6 +475,7 @@ namespace MumbleVoip
         data_stream >> seq;
 
         bool last_frame = true;
+        int frame_index = 0;
         do
         {
 		    int header = static_cast<unsigned char>(data_stream.next());
@@ -508,7 +485,8 @@ namespace MumbleVoip
             data_stream.skip(frame_size);
 
             if (frame_size > 0)
-				HandleIncomingCELTFrame(session, (unsigned char*)frame_data, frame_size);
+				HandleIncomingCELTFrame(session, seq + frame_index, (unsigned char*)frame_data, frame_size);
+            frame_index++;
 	    }
         while (!last_frame && data_stream.isValid());
         if (!data_stream.isValid())
@@ -527,6 +505,8 @@ namespace MumbleVoip
             data_stream >> position.x;
             position.x *= -1;
 
+            mixer_->SetSpeakerPosition(session, position);
+
             //QMutexLocker user_locker(&mutex_users_);
             if (mutex_users_.tryLock())
             {
@@ -584,6 +564,7 @@ namespace MumbleVoip
         QString message = QString("User '%1' Left.").arg(user->Name());
         MumbleVoipModule::LogDebug(message.toStdString());
         user->SetLeft();
+        mixer_->RemoveSpeaker(user->Session());
         emit UserLeftFromServer(user);
     }
 
@@ -623,7 +604,7 @@ namespace MumbleVoip
         return 0;
     }
 
-    void Connection::HandleIncomingCELTFrame(int session, unsigned char* data, int size)
+    void Connection::HandleIncomingCELTFrame(int session, int sequence, unsigned char* data, int size)
     {
 		mutex_users_.lock();
         User* user = users_[session];
@@ -635,42 +616,14 @@ namespace MumbleVoip
             return;
         }
 
-        PCMAudioFrame* audio_frame = new PCMAudioFrame(SAMPLE_RATE, SAMPLE_WIDTH, NUMBER_OF_CHANNELS, SAMPLES_IN_FRAME*SAMPLE_WIDTH/8);
-        int ret = celt_decode(celt_decoder_, data, size, (short*)audio_frame->DataPtr());
+        // Decoding and playback buffering are done in mixer thread
+        mixer_->QueueFrame(session, sequence, data, size);
 
-        switch (ret)
+        if (user->tryLock(5)) // 5 ms
         {
-        case CELT_OK:
-            {
-                if (user->tryLock(5)) // 5 ms
-                {
-                    user->AddToPlaybackBuffer(audio_frame);
-                    user->unlock();
-                    return;
-                }
-                else
-                {
-                    MumbleVoipModule::LogWarning("Audio packet dropped: user locket");
-                }
-            }
-            break;
-        case CELT_BAD_ARG:
-            MumbleVoipModule::LogError("CELT decoding error: CELT_BAD_ARG");
-            break;
-        case CELT_INVALID_MODE:
-            MumbleVoipModule::LogError("CELT decoding error: CELT_INVALID_MODE");
-            break;
-        case CELT_INTERNAL_ERROR:
-            MumbleVoipModule::LogError("CELT decoding error: CELT_INTERNAL_ERROR");
-            break;
-        case CELT_CORRUPTED_DATA:
-            MumbleVoipModule::LogError("CELT decoding error: CELT_CORRUPTED_DATA");
-            break;
-        case CELT_UNIMPLEMENTED:
-            MumbleVoipModule::LogError("CELT decoding error: CELT_UNIMPLEMENTED");
-            break;
+            user->AudioFrameReceived();
+            user->unlock();
         }
-        delete audio_frame;
     }
 
     void Connection::SetEncodingQuality(double quality)
@@ -7,7 +7,7 @@
 #include <QList>
 #include <QMutex>
 #include <QMap>
-#include <QPair>
+#include <QSet>
 #include <QTimer>
 #include "Core.h"
 #include "MumbleDefines.h"
@@ -23,7 +23,6 @@ namespace MumbleClient
 
 struct CELTMode;
 struct CELTEncoder;
-struct CELTDecoder;
 
 namespace MumbleVoip
 {
@@ -31,8 +30,10 @@ namespace MumbleVoip
     class User;
     class PCMAudioFrame;
     class ServerInfo;
-
-    typedef QPair<User*, PCMAudioFrame*> AudioPacket;
+    class VoiceMixer;
+    struct MixedAudioFrame;
+    struct VoiceSpeakerStatistics;
+    struct VoiceMixerStatistics;
 
     //! Connection to a single mumble server.
     //!
@@ -69,10 +70,24 @@ namespace MumbleVoip
         //! @todo HANDLE REJOIN
         virtual void Join(const Channel* channel);
 
-        //! @return first <user,audio frame> pair from playback queue
-        //!         return <0,0> if playback queue is empty
-        //! The caller must delete audio frame object after usage
-        virtual AudioPacket GetAudioPacket();
+        //! Takes oldest mixed audio frame ready for playback
+        //! Received audio is decoded and mixed to a few output streams in VoiceMixer thread.
+        //! The caller must return audio frame object with ReleaseAudioFrame after usage
+        //! @return false if there is no audio frames available
+        virtual bool GetMixedAudioFrame(MixedAudioFrame &mixed_frame);
+
+        //! Returns audio frame received from GetMixedAudioFrame for reuse
+        virtual void ReleaseAudioFrame(PCMAudioFrame* frame);
+
+        //! Set listener position used for positional mixing and sessions of users
+        //! whose audio is not played back
+        virtual void SetPlaybackListener(Vector3df position, const QSet<int> &muted_sessions);
+
+        //! @return false if there is no statistics for given user
+        virtual bool GetPlaybackStatistics(int session, VoiceSpeakerStatistics &statistics);
+
+        //! @return playback counters of all users
+        virtual VoiceMixerStatistics PlaybackStatistics();
 
         //! Encode and send given frame to Mumble server
         //! Frame object is NOT deleted by this method 
@@ -151,7 +166,7 @@ namespace MumbleVoip
 
     private slots:
         void AddToUserList(User* user);
-        void HandleIncomingCELTFrame(int session, unsigned char* data, int size);
+        void HandleIncomingCELTFrame(int session, int sequence, unsigned char* data, int size);
         void UpdateUserStates();
 
     private:
@@ -163,7 +178,6 @@ namespace MumbleVoip
 
         void InitializeCELT();
         void UninitializeCELT();
-        CELTDecoder* CreateCELTDecoder();
         int AudioQuality();
 
         bool CheckState(QList<State> allowed_states); // testing
@@ -178,7 +192,7 @@ namespace MumbleVoip
 
         CELTMode* celt_mode_;
         CELTEncoder* celt_encoder_;
-        CELTDecoder* celt_decoder_;
+        VoiceMixer* mixer_;
 
         unsigned char encode_buffer_[ENCODE_BUFFER_SIZE_];
         bool authenticated_;
@@ -0,0 +1,73 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "DebugOperatorNew.h"
+
+#include "PCMAudioFramePool.h"
+#include "PCMAudioFrame.h"
+
+#include "MemoryLeakCheck.h"
+
+namespace MumbleVoip
+{
+    PCMAudioFramePool::PCMAudioFramePool(int sample_rate, int sample_width, int channels, int data_size, int max_size) :
+        sample_rate_(sample_rate),
+        sample_width_(sample_width),
+        channels_(channels),
+        data_size_(data_size),
+        max_size_(max_size),
+        allocated_count_(0)
+    {
+    }
+
+    PCMAudioFramePool::~PCMAudioFramePool()
+    {
+        QMutexLocker locker(&mutex_free_frames_);
+        foreach(PCMAudioFrame* frame, free_frames_)
+            SAFE_DELETE(frame);
+        free_frames_.clear();
+    }
+
+    PCMAudioFrame* PCMAudioFramePool::Get()
+    {
+        QMutexLocker locker(&mutex_free_frames_);
+        if (free_frames_.size() > 0)
+            return free_frames_.takeLast();
+
+        allocated_count_++;
+        return new PCMAudioFrame(sample_rate_, sample_width_, channels_, data_size_);
+    }
+
+    void PCMAudioFramePool::Release(PCMAudioFrame* frame)
+    {
+        if (!frame)
+            return;
+
+        if (frame->DataSize() != data_size_ || frame->SampleRate() != sample_rate_ || frame->SampleWidth() != sample_width_ || frame->Channels() != channels_)
+        {
+            delete frame;
+            return;
+        }
+
+        QMutexLocker locker(&mutex_free_frames_);
+        if (free_frames_.size() >= max_size_)
+        {
+            delete frame;
+            return;
+        }
+        free_frames_.append(frame);
+    }
+
+    int PCMAudioFramePool::FreeCount()
+    {
+        QMutexLocker locker(&mutex_free_frames_);
+        return free_frames_.size();
+    }
+
+    int PCMAudioFramePool::AllocatedCount()
+    {
+        QMutexLocker locker(&mutex_free_frames_);
+        return allocated_count_;
+    }
+
+} // namespace MumbleVoip
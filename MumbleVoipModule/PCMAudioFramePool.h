@@ -0,0 +1,53 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_MumbleVoipModule_PCMAudioFramePool_h
+#define incl_MumbleVoipModule_PCMAudioFramePool_h
+
+#include <QList>
+#include <QMutex>
+
+namespace MumbleVoip
+{
+    class PCMAudioFrame;
+
+    //! Thread safe pool of equally sized PCMAudioFrame objects
+    //!
+    //! Audio frames are created and released hundreds of times per second per speaker,
+    //! so released frames are kept for reuse instead of deleting them.
+    class PCMAudioFramePool
+    {
+    public:
+        //! @param max_size maximum number of free frames kept in the pool
+        PCMAudioFramePool(int sample_rate, int sample_width, int channels, int data_size, int max_size);
+
+        //! Deletes all free frames. Frames in use are not owned by the pool.
+        virtual ~PCMAudioFramePool();
+
+        //! @return free frame from the pool or a new frame if the pool is empty
+        //! @note Data of returned frame is not initialized
+        virtual PCMAudioFrame* Get();
+
+        //! Returns frame to the pool. Frame is deleted if the pool is full or
+        //! the frame format doesn't match the pool.
+        virtual void Release(PCMAudioFrame* frame);
+
+        //! @return number of free frames in the pool
+        virtual int FreeCount();
+
+        //! @return number of frames created by the pool
+        virtual int AllocatedCount();
+
+    private:
+        int sample_rate_;
+        int sample_width_;
+        int channels_;
+        int data_size_;
+        int max_size_;
+        int allocated_count_;
+        QList<PCMAudioFrame*> free_frames_;
+        QMutex mutex_free_frames_;
+    };
+
+} // namespace MumbleVoip
+
+#endif // incl_MumbleVoipModule_PCMAudioFramePool_h
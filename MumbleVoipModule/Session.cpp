@@ -13,6 +13,7 @@
 #include "User.h"
 #include "Channel.h"
 #include "Connection.h"
+#include "VoiceMixer.h"
 #include "Participant.h"
 #include "MumbleLibrary.h"
 #include "MumbleVoipModule.h"
@@ -463,61 +464,61 @@ namespace MumbleVoip
             if (!audio_receiving_enabled_)
 				return;
 
-            for(;;)
+            Vector3df avatar_position;
+            Vector3df avatar_direction;
+            GetOwnAvatarPosition(avatar_position, avatar_direction);
+
+            QSet<int> muted_sessions;
+            foreach(Participant* participant, participants_)
+            {
+                if (participant->IsMuted() && participant->UserPtr())
+                    muted_sessions.insert(participant->UserPtr()->Session());
+            }
+            connection_->SetPlaybackListener(avatar_position, muted_sessions);
+
+            // Frames of each mixer output stream are played back as one buffer
+            QMap<int, Foundation::SoundServiceInterface::SoundBuffer> sound_buffers;
+            QMap<int, MixedAudioFrame> last_frames;
+            MixedAudioFrame mixed_frame;
+            while (connection_->GetMixedAudioFrame(mixed_frame))
+            {
+                PCMAudioFrame* frame = mixed_frame.frame;
+                Foundation::SoundServiceInterface::SoundBuffer &sound_buffer = sound_buffers[mixed_frame.stream];
+                if (sound_buffer.data_.size() == 0)
+                {
+                    sound_buffer.frequency_ = frame->SampleRate();
+                    sound_buffer.sixteenbit_ = frame->SampleWidth() == 16;
+                    sound_buffer.stereo_ = frame->Channels() == 2;
+                }
+                size_t offset = sound_buffer.data_.size();
+                sound_buffer.data_.resize(offset + frame->DataSize());
+                memcpy(&sound_buffer.data_[offset], frame->DataPtr(), frame->DataSize());
+
+                last_frames[mixed_frame.stream] = mixed_frame;
+                connection_->ReleaseAudioFrame(frame);
+            }
+
+            for (QMap<int, Foundation::SoundServiceInterface::SoundBuffer>::iterator i = sound_buffers.begin(); i != sound_buffers.end(); ++i)
             {
-                AudioPacket packet = connection_->GetAudioPacket();
-                if (packet.second == 0)
-                    break; // nothing to play anymore
-
-				bool muted = false;
-				foreach(Participant* participant, participants_)
-				{
-					if (participant->UserPtr() == packet.first && participant->IsMuted())
-					{
-						muted = true;
-						break;
-					}
-				}
-				if (!muted)
-					PlaybackAudioFrame(packet.first, packet.second);
+                const MixedAudioFrame &last_frame = last_frames[i.key()];
+                PlaybackSoundBuffer(i.key(), i.value(), last_frame.positional, last_frame.position);
             }
         }
 
-        void Session::PlaybackAudioFrame(User* user, PCMAudioFrame* frame)
+        void Session::PlaybackSoundBuffer(int stream, Foundation::SoundServiceInterface::SoundBuffer &sound_buffer, bool positional, Vector3df position)
         {
             boost::shared_ptr<Foundation::SoundServiceInterface> sound_service = SoundService();
             if (!sound_service.get())
                 return;    
 
-            Foundation::SoundServiceInterface::SoundBuffer sound_buffer;
-            
-            sound_buffer.data_.resize(frame->DataSize());
-            memcpy(&sound_buffer.data_[0], frame->DataPtr(), frame->DataSize());
+            sound_id_t channel = 0;
+            if (audio_playback_channels_.contains(stream))
+                channel = audio_playback_channels_[stream];
 
-            sound_buffer.frequency_ = frame->SampleRate();
-            if (frame->SampleWidth() == 16)
-                sound_buffer.sixteenbit_ = true;
-            else
-                sound_buffer.sixteenbit_ = false;
-            
-            if (frame->Channels() == 2)
-                sound_buffer.stereo_ = true;
-            else
-                sound_buffer.stereo_ = false;
-
-            QMutexLocker user_locker(user);
-            if (audio_playback_channels_.contains(user->Session()))
-                if (user->PositionKnown())
-                    sound_service->PlaySoundBuffer3D(sound_buffer, Foundation::SoundServiceInterface::Voice, user->Position(), audio_playback_channels_[user->Session()]);
-                else
-                    sound_service->PlaySoundBuffer(sound_buffer,  Foundation::SoundServiceInterface::Voice, audio_playback_channels_[user->Session()]);
+            if (positional)
+                audio_playback_channels_[stream] = sound_service->PlaySoundBuffer3D(sound_buffer, Foundation::SoundServiceInterface::Voice, position, channel);
             else
-                if (user->PositionKnown())
-                    audio_playback_channels_[user->Session()] = sound_service->PlaySoundBuffer3D(sound_buffer, Foundation::SoundServiceInterface::Voice, user->Position(), 0);
-                else
-                    audio_playback_channels_[user->Session()] = sound_service->PlaySoundBuffer(sound_buffer,  Foundation::SoundServiceInterface::Voice, 0);
-
-            delete frame;
+                audio_playback_channels_[stream] = sound_service->PlaySoundBuffer(sound_buffer,  Foundation::SoundServiceInterface::Voice, channel);
         }
 
         boost::shared_ptr<Foundation::SoundServiceInterface> Session::SoundService()
@@ -543,16 +544,30 @@ namespace MumbleVoip
             QList<QString> lines;
             QString line = QString("  Total %1 participants:").arg(participants_.size());
             lines.append(line);
+            if (!connection_)
+                return lines;
+
             foreach(Participant* p, participants_)
             {
                 User* user = p->UserPtr();
                 if (!user)
                     continue;
-                int buffer_len = user->PlaybackBufferLengthMs();
-                int drop = static_cast<int>( 100*user->VoicePacketDropRatio() );
-                QString line = QString("    participant %1:   audio buffer=%2 ms   frame loss=%3 %").arg(p->Name()).arg(buffer_len).arg(drop);
+                VoiceSpeakerStatistics stats;
+                if (!connection_->GetPlaybackStatistics(user->Session(), stats))
+                    continue;
+                int drop = 0;
+                if (stats.received_frames > 0)
+                    drop = 100*(stats.late_frames + stats.dropped_frames) / stats.received_frames;
+                QString line = QString("    participant %1:   audio buffer=%2 ms   frame loss=%3 %   late=%4   dropped=%5   concealed=%6")
+                    .arg(p->Name()).arg(stats.buffer_length_ms).arg(drop).arg(stats.late_frames).arg(stats.dropped_frames).arg(stats.concealed_frames);
                 lines.append(line);
             }
+
+            VoiceMixerStatistics mixer_stats = connection_->PlaybackStatistics();
+            line = QString("  Mixer: %1 speakers   received=%2   late=%3   dropped=%4   concealed=%5   output dropped=%6   pooled frames=%7")
+                .arg(mixer_stats.speakers).arg(mixer_stats.received_frames).arg(mixer_stats.late_frames).arg(mixer_stats.dropped_frames)
+                .arg(mixer_stats.concealed_frames).arg(mixer_stats.output_dropped_frames).arg(mixer_stats.allocated_frames);
+            lines.append(line);
             return lines;
         }
 
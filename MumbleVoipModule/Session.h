@@ -67,7 +67,7 @@ namespace MumbleVoip
             QString GetAvatarFullName(QString uuid) const;
             void SendRecordedAudio();
             void PlaybackReceivedAudio();
-            void PlaybackAudioFrame(User* user, PCMAudioFrame* frame);
+            void PlaybackSoundBuffer(int stream, Foundation::SoundServiceInterface::SoundBuffer &sound_buffer, bool positional, Vector3df position);
             boost::shared_ptr<Foundation::SoundServiceInterface> SoundService();
     
             Foundation::Framework* framework_;
@@ -86,7 +86,7 @@ namespace MumbleVoip
             const ServerInfo &server_info_;
             User* self_user_;
             QString channel_name_;
-            QMap<int, sound_id_t> audio_playback_channels_;
+            QMap<int, sound_id_t> audio_playback_channels_; // mixer output stream -> sound channel
             std::string recording_device_;
 
         private slots:
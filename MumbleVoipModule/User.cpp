@@ -4,11 +4,9 @@
 #include "DebugOperatorNew.h"
 
 #include "User.h"
-#include "PCMAudioFrame.h"
 #include "MumbleVoipModule.h"
 #include "stdint.h"
 #include "MumbleDefines.h"
-#include "PCMAudioFrame.h"
 #include <QTimer>
 #include "Channel.h"
 #include <mumbleclient/user.h>
@@ -23,19 +21,13 @@ namespace MumbleVoip
           position_known_(false),
           position_(0,0,0),
           left_(false),
-          channel_(channel),
-          received_voice_packet_count_(0),
-          voice_packet_drop_count_(0)
+          channel_(channel)
     {
         last_audio_frame_time_.start(); // initialize time state so that restart is possible later
     }
 
     User::~User()
     {
-        foreach(PCMAudioFrame* audio, playback_queue_)
-            SAFE_DELETE(audio);
-
-        playback_queue_.clear();
     }
 
     QString User::Name() const
@@ -75,20 +67,8 @@ namespace MumbleVoip
         return speaking_;
     }
 
-    void User::AddToPlaybackBuffer(PCMAudioFrame* frame)
+    void User::AudioFrameReceived()
     {
-        received_voice_packet_count_++;
-        if (PlaybackBufferLengthMs() > PLAYBACK_BUFFER_MAX_LENGTH_MS_)
-        {
-            foreach(PCMAudioFrame* frame, playback_queue_)
-            {
-                delete frame;
-                voice_packet_drop_count_++;
-            }
-            playback_queue_.clear();
-        }
-
-        playback_queue_.push_back(frame);
         last_audio_frame_time_.restart();
 
         if (!speaking_)
@@ -111,26 +91,6 @@ namespace MumbleVoip
         return position_;
     }
 
-    int User::PlaybackBufferLengthMs() const
-    {
-        return 1000 * playback_queue_.size() * SAMPLES_IN_FRAME / SAMPLE_RATE;
-    }
-    
-    PCMAudioFrame* User::GetAudioFrame()
-    {
-        if (playback_queue_.size() == 0)
-            return 0;
-
-        return playback_queue_.takeFirst();
-    }
-
-    double User::VoicePacketDropRatio() const
-    {
-        if (received_voice_packet_count_ == 0)
-            return 0;
-        return static_cast<double>(voice_packet_drop_count_)/received_voice_packet_count_;
-    }
-
     void User::CheckSpeakingState()
     {
         bool was_speaking = speaking_;
@@ -19,7 +19,6 @@ namespace MumbleClient
 namespace MumbleVoip
 {
     class Channel;
-    class PCMAudioFrame;
 
     //! Wrapper over libmumbleclient library's User class
     //! Present mumble client intance on MurMur server
@@ -59,30 +58,20 @@ namespace MumbleVoip
         //! @return position od the user
         virtual Vector3df Position() const;
 
-        //! @return length of playback buffer is ms for this user 
-        virtual int PlaybackBufferLengthMs() const ;
-
-        //! @return oldest audio frame available for playback 
-        //! @note caller must delete audio frame object after usage
-        virtual PCMAudioFrame* GetAudioFrame();
-
         //! Set user status to be left
         virtual void SetLeft() { left_ = true; emit Left(); }
 
         //! @return true if the user has left the channel
         virtual bool IsLeft() const { return left_; }
 
-        virtual double VoicePacketDropRatio() const;
-
         //! @return actual channel id of this user. This can be different than channel id
         //!         of channel object returned by Channel() method call.
         virtual int CurrentChannelID() const; 
 
     public slots:
-        //! Put audio frame to end of playback buffer 
-        //! If playback buffer is full it is cleared first.
-        //! @param farme Audio data frame received from network and ment to be for playback locally
-        void AddToPlaybackBuffer(PCMAudioFrame* frame);
+        //! Updates speaking state when audio frame is received from this user
+        //! The frame itself is decoded and buffered for playback by VoiceMixer
+        void AudioFrameReceived();
 
         //! Updatedes user last known position
         //! Also set position_known_ flag up
@@ -95,18 +84,14 @@ namespace MumbleVoip
 
     private:
         static const int SPEAKING_TIMEOUT_MS = 100; // time to emit StopSpeaking after las audio packet is received
-        static const int PLAYBACK_BUFFER_MAX_LENGTH_MS_= 200;
 
         const MumbleClient::User& user_;
         bool speaking_;
         Vector3df position_;
         bool position_known_;
 
-        QList<PCMAudioFrame*> playback_queue_;
         bool left_;
         MumbleVoip::Channel* channel_;
-        int received_voice_packet_count_;
-        int voice_packet_drop_count_;
         QTime last_audio_frame_time_;
 
     signals:
@@ -0,0 +1,493 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "DebugOperatorNew.h"
+
+#include "VoiceMixer.h"
+#include "MumbleVoipModule.h"
+#include "PCMAudioFrame.h"
+#include "PCMAudioFramePool.h"
+#include <QTime>
+#include <QtAlgorithms>
+#include <celt/celt_types.h>
+#include <celt/celt.h>
+
+#include "MemoryLeakCheck.h"
+
+namespace MumbleVoip
+{
+    const float VoiceMixer::NON_POSITIONAL_MIX_GAIN = 0.5f;
+
+    VoiceMixer::VoiceMixer() :
+        running_(true),
+        celt_mode_(0),
+        frame_pool_(0)
+    {
+        for (int i = 0; i < POSITIONAL_STREAM_COUNT; ++i)
+            positional_streams_[i] = -1;
+
+        frame_pool_ = new PCMAudioFramePool(SAMPLE_RATE, SAMPLE_WIDTH, NUMBER_OF_CHANNELS, SAMPLES_IN_FRAME*SAMPLE_WIDTH/8, FRAME_POOL_MAX_SIZE);
+        InitializeCELT();
+    }
+
+    VoiceMixer::~VoiceMixer()
+    {
+        Stop();
+
+        foreach(int session, speakers_.keys())
+            DeleteSpeaker(session);
+
+        while (output_frames_.size() > 0)
+        {
+            MixedAudioFrame mixed_frame = output_frames_.takeFirst();
+            SAFE_DELETE(mixed_frame.frame);
+        }
+
+        UninitializeCELT();
+        SAFE_DELETE(frame_pool_);
+    }
+
+    void VoiceMixer::InitializeCELT()
+    {
+        int error = 0;
+        celt_mode_ = celt_mode_create(SAMPLE_RATE, SAMPLES_IN_FRAME, &error);
+        if (error != 0)
+        {
+            QString message = QString("Voice mixer: CELT initialization failed, error code = %1").arg(error);
+            MumbleVoipModule::LogWarning(message.toStdString());
+            celt_mode_ = 0;
+        }
+    }
+
+    void VoiceMixer::UninitializeCELT()
+    {
+        if (celt_mode_)
+            celt_mode_destroy(celt_mode_);
+        celt_mode_ = 0;
+    }
+
+    CELTDecoder* VoiceMixer::CreateCELTDecoder()
+    {
+        if (!celt_mode_)
+            return 0;
+
+        int error = 0;
+        CELTDecoder* decoder = celt_decoder_create(celt_mode_, NUMBER_OF_CHANNELS, &error);
+        switch (error)
+        {
+        case CELT_OK:
+           return decoder;
+        case CELT_BAD_ARG:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_BAD_ARG");
+            return 0;
+        case CELT_INVALID_MODE:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_INVALID_MODE");
+            return 0;
+        case CELT_INTERNAL_ERROR:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_INTERNAL_ERROR");
+            return 0;
+        case CELT_UNIMPLEMENTED:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_UNIMPLEMENTED");
+            return 0;
+        case CELT_ALLOC_FAIL:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: CELT_ALLOC_FAIL");
+            return 0;
+        default:
+            MumbleVoipModule::LogError("Cannot create CELT decoder: unknow reason");
+            return 0;
+        }
+    }
+
+    void VoiceMixer::run()
+    {
+        MumbleVoipModule::LogDebug("Voice mixer started");
+
+        QTime time;
+        time.start();
+        int ticks = 0;
+
+        mutex_.lock();
+        while (running_)
+        {
+            int due_ticks = time.elapsed() / FRAME_LENGTH_MS - ticks;
+            if (due_ticks <= 0)
+            {
+                stop_condition_.wait(&mutex_, FRAME_LENGTH_MS - time.elapsed() % FRAME_LENGTH_MS);
+                continue;
+            }
+
+            // Do not try to catch up after long stall, just skip the lost time
+            if (due_ticks > MAX_CATCH_UP_TICKS)
+            {
+                ticks += due_ticks - MAX_CATCH_UP_TICKS;
+                due_ticks = MAX_CATCH_UP_TICKS;
+            }
+
+            mutex_.unlock();
+            for (int i = 0; i < due_ticks; ++i)
+                Tick();
+            ticks += due_ticks;
+            mutex_.lock();
+        }
+        mutex_.unlock();
+
+        MumbleVoipModule::LogDebug("Voice mixer stopped");
+    }
+
+    void VoiceMixer::Stop()
+    {
+        mutex_.lock();
+        running_ = false;
+        stop_condition_.wakeAll();
+        mutex_.unlock();
+        wait();
+    }
+
+    void VoiceMixer::QueueFrame(int session, int sequence, const unsigned char* data, int size)
+    {
+        EncodedFrame frame;
+        frame.session = session;
+        frame.sequence = sequence;
+        frame.data = QByteArray(reinterpret_cast<const char*>(data), size);
+
+        QMutexLocker locker(&mutex_);
+        incoming_frames_.append(frame);
+    }
+
+    void VoiceMixer::SetSpeakerPosition(int session, Vector3df position)
+    {
+        QMutexLocker locker(&mutex_);
+        speaker_positions_[session] = position;
+    }
+
+    void VoiceMixer::RemoveSpeaker(int session)
+    {
+        QMutexLocker locker(&mutex_);
+        removed_speakers_.append(session);
+        speaker_positions_.remove(session);
+    }
+
+    void VoiceMixer::SetListener(Vector3df position, const QSet<int> &muted_sessions)
+    {
+        QMutexLocker locker(&mutex_);
+        listener_position_ = position;
+        muted_sessions_ = muted_sessions;
+    }
+
+    bool VoiceMixer::GetMixedFrame(MixedAudioFrame &mixed_frame)
+    {
+        QMutexLocker locker(&mutex_);
+        if (output_frames_.size() == 0)
+            return false;
+
+        mixed_frame = output_frames_.takeFirst();
+        return true;
+    }
+
+    void VoiceMixer::ReleaseFrame(PCMAudioFrame* frame)
+    {
+        frame_pool_->Release(frame);
+    }
+
+    bool VoiceMixer::GetSpeakerStatistics(int session, VoiceSpeakerStatistics &statistics)
+    {
+        QMutexLocker locker(&mutex_);
+        if (!speaker_statistics_.contains(session))
+            return false;
+
+        statistics = speaker_statistics_[session];
+        return true;
+    }
+
+    VoiceMixerStatistics VoiceMixer::Statistics()
+    {
+        QMutexLocker locker(&mutex_);
+        return statistics_;
+    }
+
+    void VoiceMixer::Tick()
+    {
+        QList<EncodedFrame> incoming_frames;
+        QList<int> removed_speakers;
+        QMap<int, Vector3df> positions;
+        Vector3df listener;
+        QSet<int> muted_sessions;
+        {
+            QMutexLocker locker(&mutex_);
+            incoming_frames = incoming_frames_;
+            incoming_frames_.clear();
+            removed_speakers = removed_speakers_;
+            removed_speakers_.clear();
+            positions = speaker_positions_;
+            listener = listener_position_;
+            muted_sessions = muted_sessions_;
+        }
+
+        foreach(const EncodedFrame &frame, incoming_frames)
+        {
+            Speaker* speaker = GetSpeaker(frame.session);
+            if (speaker)
+                BufferFrame(speaker, frame.sequence, frame.data);
+        }
+
+        foreach(int session, removed_speakers)
+            DeleteSpeaker(session);
+
+        QList<DecodedFrame> decoded_frames;
+        for (QMap<int, Speaker*>::iterator i = speakers_.begin(); i != speakers_.end(); ++i)
+        {
+            PCMAudioFrame* frame = PlayoutFrame(i.value());
+            if (frame)
+                decoded_frames.append(DecodedFrame(i.key(), frame));
+        }
+
+        QList<MixedAudioFrame> output;
+        Mix(decoded_frames, positions, listener, muted_sessions, output);
+
+        QMutexLocker locker(&mutex_);
+        output_frames_.append(output);
+        while (output_frames_.size() > OUTPUT_QUEUE_MAX_FRAMES)
+        {
+            MixedAudioFrame mixed_frame = output_frames_.takeFirst();
+            frame_pool_->Release(mixed_frame.frame);
+            totals_.output_dropped_frames++;
+        }
+
+        speaker_statistics_.clear();
+        for (QMap<int, Speaker*>::iterator i = speakers_.begin(); i != speakers_.end(); ++i)
+        {
+            VoiceSpeakerStatistics statistics = i.value()->statistics;
+            statistics.buffer_length_ms = i.value()->jitter_buffer.size() * FRAME_LENGTH_MS;
+            speaker_statistics_[i.key()] = statistics;
+        }
+        statistics_ = totals_;
+        statistics_.speakers = speakers_.size();
+        statistics_.allocated_frames = frame_pool_->AllocatedCount();
+    }
+
+    VoiceMixer::Speaker* VoiceMixer::GetSpeaker(int session)
+    {
+        if (speakers_.contains(session))
+            return speakers_[session];
+
+        CELTDecoder* decoder = CreateCELTDecoder();
+        if (!decoder)
+            return 0;
+
+        Speaker* speaker = new Speaker();
+        speaker->decoder = decoder;
+        speakers_[session] = speaker;
+        return speaker;
+    }
+
+    void VoiceMixer::DeleteSpeaker(int session)
+    {
+        if (!speakers_.contains(session))
+            return;
+
+        Speaker* speaker = speakers_.take(session);
+        celt_decoder_destroy(speaker->decoder);
+        SAFE_DELETE(speaker);
+
+        for (int i = 0; i < POSITIONAL_STREAM_COUNT; ++i)
+            if (positional_streams_[i] == session)
+                positional_streams_[i] = -1;
+    }
+
+    void VoiceMixer::BufferFrame(Speaker* speaker, int sequence, const QByteArray &data)
+    {
+        speaker->statistics.received_frames++;
+        totals_.received_frames++;
+
+        if (speaker->next_sequence - sequence > SEQUENCE_RESET_FRAMES)
+        {
+            // Speaker has reconnected and started sequence numbers from the beginning
+            speaker->jitter_buffer.clear();
+            speaker->playing = false;
+            speaker->buffering_ticks = 0;
+            speaker->next_sequence = 0;
+        }
+
+        if (sequence < speaker->next_sequence)
+        {
+            speaker->statistics.late_frames++;
+            totals_.late_frames++;
+            return;
+        }
+
+        if (speaker->jitter_buffer.contains(sequence))
+            return; // duplicate
+
+        speaker->jitter_buffer[sequence] = data;
+
+        while (speaker->jitter_buffer.size() > JITTER_BUFFER_MAX_FRAMES)
+        {
+            int oldest = speaker->jitter_buffer.begin().key();
+            speaker->jitter_buffer.erase(speaker->jitter_buffer.begin());
+            if (speaker->playing && speaker->next_sequence <= oldest)
+                speaker->next_sequence = oldest + 1;
+            speaker->statistics.dropped_frames++;
+            totals_.dropped_frames++;
+        }
+    }
+
+    PCMAudioFrame* VoiceMixer::PlayoutFrame(Speaker* speaker)
+    {
+        if (!speaker->playing)
+        {
+            if (speaker->jitter_buffer.isEmpty())
+            {
+                speaker->buffering_ticks = 0;
+                return 0;
+            }
+
+            // Wait until the buffer is filled, or the talk spurt is shorter than the buffer
+            speaker->buffering_ticks++;
+            if (speaker->jitter_buffer.size() < JITTER_BUFFER_TARGET_FRAMES && speaker->buffering_ticks < JITTER_BUFFER_TARGET_FRAMES)
+                return 0;
+
+            speaker->playing = true;
+            speaker->buffering_ticks = 0;
+            speaker->next_sequence = speaker->jitter_buffer.begin().key();
+        }
+
+        if (speaker->jitter_buffer.isEmpty())
+        {
+            speaker->playing = false; // end of talk spurt or buffer underrun
+            return 0;
+        }
+
+        int first_sequence = speaker->jitter_buffer.begin().key();
+        if (first_sequence - speaker->next_sequence > FRAMES_PER_PACKET)
+            speaker->next_sequence = first_sequence; // more than one packet missing, skip instead of concealing
+
+        PCMAudioFrame* frame = frame_pool_->Get();
+        int ret = CELT_OK;
+        if (first_sequence == speaker->next_sequence)
+        {
+            QByteArray data = speaker->jitter_buffer.take(first_sequence);
+            ret = celt_decode(speaker->decoder, reinterpret_cast<unsigned char*>(data.data()), data.size(), reinterpret_cast<short*>(frame->DataPtr()));
+        }
+        else
+        {
+            ret = celt_decode(speaker->decoder, 0, 0, reinterpret_cast<short*>(frame->DataPtr()));
+            speaker->statistics.concealed_frames++;
+            totals_.concealed_frames++;
+        }
+        speaker->next_sequence++;
+
+        if (ret != CELT_OK)
+        {
+            QString message = QString("CELT decoding error: %1").arg(ret);
+            MumbleVoipModule::LogError(message.toStdString());
+            frame_pool_->Release(frame);
+            return 0;
+        }
+        return frame;
+    }
+
+    void VoiceMixer::Mix(QList<DecodedFrame> &decoded_frames, const QMap<int, Vector3df> &positions, Vector3df listener, const QSet<int> &muted_sessions, QList<MixedAudioFrame> &output)
+    {
+        QList<DecodedFrame> audible_frames;
+        foreach(const DecodedFrame &decoded_frame, decoded_frames)
+        {
+            if (muted_sessions.contains(decoded_frame.first))
+                frame_pool_->Release(decoded_frame.second);
+            else
+                audible_frames.append(decoded_frame);
+        }
+
+        // Nearest speakers with known position get own positional streams
+        QList<QPair<float, int> > distances; // squared distance, session
+        foreach(const DecodedFrame &decoded_frame, audible_frames)
+        {
+            if (positions.contains(decoded_frame.first))
+                distances.append(QPair<float, int>(positions[decoded_frame.first].getDistanceFromSQ(listener), decoded_frame.first));
+        }
+        qSort(distances);
+
+        QSet<int> nearest_sessions;
+        for (int i = 0; i < distances.size() && i < POSITIONAL_STREAM_COUNT; ++i)
+            nearest_sessions.insert(distances[i].second);
+
+        // Keep speakers in their current streams to avoid jumps in playback
+        for (int i = 0; i < POSITIONAL_STREAM_COUNT; ++i)
+            if (!nearest_sessions.contains(positional_streams_[i]))
+                positional_streams_[i] = -1;
+
+        QMap<int, int> stream_of_session;
+        for (int i = 0; i < POSITIONAL_STREAM_COUNT; ++i)
+            if (positional_streams_[i] != -1)
+                stream_of_session[positional_streams_[i]] = i;
+
+        foreach(int session, nearest_sessions)
+        {
+            if (stream_of_session.contains(session))
+                continue;
+            for (int i = 0; i < POSITIONAL_STREAM_COUNT; ++i)
+            {
+                if (positional_streams_[i] == -1)
+                {
+                    positional_streams_[i] = session;
+                    stream_of_session[session] = i;
+                    break;
+                }
+            }
+        }
+
+        PCMAudioFrame* non_positional_frame = 0;
+        foreach(const DecodedFrame &decoded_frame, audible_frames)
+        {
+            int session = decoded_frame.first;
+            if (stream_of_session.contains(session))
+            {
+                MixedAudioFrame mixed_frame;
+                mixed_frame.stream = stream_of_session[session];
+                mixed_frame.positional = true;
+                mixed_frame.position = positions[session];
+                mixed_frame.frame = decoded_frame.second;
+                output.append(mixed_frame);
+                continue;
+            }
+
+            if (!non_positional_frame)
+            {
+                non_positional_frame = frame_pool_->Get();
+                memset(non_positional_frame->DataPtr(), 0, non_positional_frame->DataSize());
+            }
+
+            // Speakers without position are played at full volume, far away speakers attenuated
+            float gain = positions.contains(session) ? NON_POSITIONAL_MIX_GAIN : 1.0f;
+            MixTo(non_positional_frame, decoded_frame.second, gain);
+            frame_pool_->Release(decoded_frame.second);
+        }
+
+        if (non_positional_frame)
+        {
+            MixedAudioFrame mixed_frame;
+            mixed_frame.stream = POSITIONAL_STREAM_COUNT;
+            mixed_frame.positional = false;
+            mixed_frame.position = Vector3df(0,0,0);
+            mixed_frame.frame = non_positional_frame;
+            output.append(mixed_frame);
+        }
+    }
+
+    void VoiceMixer::MixTo(PCMAudioFrame* target, PCMAudioFrame* source, float gain)
+    {
+        short* target_samples = reinterpret_cast<short*>(target->DataPtr());
+        const short* source_samples = reinterpret_cast<const short*>(source->DataPtr());
+        int sample_count = std::min(target->DataSize(), source->DataSize()) / sizeof(short);
+
+        for (int i = 0; i < sample_count; ++i)
+        {
+            int sample = target_samples[i] + static_cast<int>(source_samples[i] * gain);
+            if (sample > 32767)
+                sample = 32767;
+            if (sample < -32768)
+                sample = -32768;
+            target_samples[i] = static_cast<short>(sample);
+        }
+    }
+
+} // namespace MumbleVoip
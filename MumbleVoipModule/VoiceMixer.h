@@ -0,0 +1,181 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_MumbleVoipModule_VoiceMixer_h
+#define incl_MumbleVoipModule_VoiceMixer_h
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QPair>
+#include "Core.h"
+#include "MumbleDefines.h"
+
+struct CELTMode;
+struct CELTDecoder;
+
+namespace MumbleVoip
+{
+    class PCMAudioFrame;
+    class PCMAudioFramePool;
+
+    //! Mixed audio frame ready for playback
+    struct MixedAudioFrame
+    {
+        //! Output stream index, 0 .. VoiceMixer::OUTPUT_STREAM_COUNT-1
+        int stream;
+        //! true if frame should be played at position
+        bool positional;
+        Vector3df position;
+        //! Frame must be returned with VoiceMixer::ReleaseFrame after usage
+        PCMAudioFrame* frame;
+    };
+
+    //! Playback counters of one speaker
+    struct VoiceSpeakerStatistics
+    {
+        VoiceSpeakerStatistics() : buffer_length_ms(0), received_frames(0), late_frames(0), dropped_frames(0), concealed_frames(0) {}
+        int buffer_length_ms;
+        int received_frames;
+        //! Frames received after their playback time
+        int late_frames;
+        //! Frames dropped because of jitter buffer overflow
+        int dropped_frames;
+        //! Missing frames replaced by packet loss concealment
+        int concealed_frames;
+    };
+
+    //! Playback counters of the whole mixer
+    struct VoiceMixerStatistics
+    {
+        VoiceMixerStatistics() : speakers(0), received_frames(0), late_frames(0), dropped_frames(0), concealed_frames(0), output_dropped_frames(0), allocated_frames(0) {}
+        int speakers;
+        int received_frames;
+        int late_frames;
+        int dropped_frames;
+        int concealed_frames;
+        //! Mixed frames dropped because nobody played them back
+        int output_dropped_frames;
+        //! Audio frames allocated by frame pool
+        int allocated_frames;
+    };
+
+    //! Decodes and mixes received voice in a dedicated audio thread.
+    //!
+    //! Encoded CELT frames are queued from mumble library thread with QueueFrame. Every 10 ms
+    //! the mixer thread moves them to per speaker jitter buffers, decodes one frame per speaker
+    //! with speaker's own CELT decoder and mixes the result to OUTPUT_STREAM_COUNT streams:
+    //! nearest speakers are played positionally in their own stream and the rest are mixed together
+    //! to one attenuated non-positional stream. Main thread fetches mixed frames with GetMixedFrame.
+    class VoiceMixer : public QThread
+    {
+    public:
+        static const int POSITIONAL_STREAM_COUNT = 4;
+        static const int OUTPUT_STREAM_COUNT = POSITIONAL_STREAM_COUNT + 1;
+
+        VoiceMixer();
+        virtual ~VoiceMixer();
+
+        virtual void run();
+
+        //! Stops the mixer thread and waits until it has finished
+        virtual void Stop();
+
+        //! Queues encoded frame for decoding
+        //! @param sequence the sequence number of the frame
+        //! @param data CELT encoded frame, data is copied
+        virtual void QueueFrame(int session, int sequence, const unsigned char* data, int size);
+
+        //! Sets the last known position of speaker
+        virtual void SetSpeakerPosition(int session, Vector3df position);
+
+        //! Removes speaker and frees it's decoder
+        virtual void RemoveSpeaker(int session);
+
+        //! Sets the listener position and the speakers which are not played back
+        virtual void SetListener(Vector3df position, const QSet<int> &muted_sessions);
+
+        //! Takes oldest mixed frame from output queue
+        //! @return false if there is no mixed frames available
+        virtual bool GetMixedFrame(MixedAudioFrame &mixed_frame);
+
+        //! Returns frame received from GetMixedFrame to the frame pool
+        virtual void ReleaseFrame(PCMAudioFrame* frame);
+
+        //! @return false if speaker is not known
+        virtual bool GetSpeakerStatistics(int session, VoiceSpeakerStatistics &statistics);
+
+        virtual VoiceMixerStatistics Statistics();
+
+    private:
+        static const int FRAME_LENGTH_MS = 1000 * SAMPLES_IN_FRAME / SAMPLE_RATE;
+        static const int JITTER_BUFFER_TARGET_FRAMES = FRAMES_PER_PACKET + 2; // playback starts when this many frames are buffered
+        static const int JITTER_BUFFER_MAX_FRAMES = 4*FRAMES_PER_PACKET;
+        static const int SEQUENCE_RESET_FRAMES = 100; // frame this much older than playback position means the speaker has restarted sequence numbering
+        static const int OUTPUT_QUEUE_MAX_FRAMES = OUTPUT_STREAM_COUNT*JITTER_BUFFER_MAX_FRAMES;
+        static const int FRAME_POOL_MAX_SIZE = 256;
+        static const int MAX_CATCH_UP_TICKS = 5;
+        static const float NON_POSITIONAL_MIX_GAIN; // attenuation of speakers which didn't fit to positional streams
+
+        //! Encoded frame waiting to be moved to speaker's jitter buffer
+        struct EncodedFrame
+        {
+            int session;
+            int sequence;
+            QByteArray data;
+        };
+
+        //! Speaker state, used only by mixer thread
+        struct Speaker
+        {
+            Speaker() : decoder(0), next_sequence(0), playing(false), buffering_ticks(0) {}
+            CELTDecoder* decoder;
+            QMap<int, QByteArray> jitter_buffer; // sequence -> encoded frame
+            int next_sequence;
+            bool playing;
+            int buffering_ticks;
+            VoiceSpeakerStatistics statistics;
+        };
+
+        typedef QPair<int, PCMAudioFrame*> DecodedFrame; // session, frame
+
+        void InitializeCELT();
+        void UninitializeCELT();
+        CELTDecoder* CreateCELTDecoder();
+
+        void Tick();
+        Speaker* GetSpeaker(int session);
+        void DeleteSpeaker(int session);
+        void BufferFrame(Speaker* speaker, int sequence, const QByteArray &data);
+        PCMAudioFrame* PlayoutFrame(Speaker* speaker);
+        void Mix(QList<DecodedFrame> &decoded_frames, const QMap<int, Vector3df> &positions, Vector3df listener, const QSet<int> &muted_sessions, QList<MixedAudioFrame> &output);
+        void MixTo(PCMAudioFrame* target, PCMAudioFrame* source, float gain);
+
+        bool running_;
+        CELTMode* celt_mode_;
+        PCMAudioFramePool* frame_pool_;
+
+        // Mixer thread state
+        QMap<int, Speaker*> speakers_;
+        int positional_streams_[POSITIONAL_STREAM_COUNT]; // session playing in stream, -1 if free
+        VoiceMixerStatistics totals_;
+
+        // Shared state, protected by mutex_
+        QList<EncodedFrame> incoming_frames_;
+        QList<int> removed_speakers_;
+        QMap<int, Vector3df> speaker_positions_;
+        Vector3df listener_position_;
+        QSet<int> muted_sessions_;
+        QList<MixedAudioFrame> output_frames_;
+        QMap<int, VoiceSpeakerStatistics> speaker_statistics_;
+        VoiceMixerStatistics statistics_;
+        QMutex mutex_;
+        QWaitCondition stop_condition_;
+    };
+
+} // namespace MumbleVoip
+
+#endif // incl_MumbleVoipModule_VoiceMixer_h
@@ -4,18 +4,44 @@
 #include "EC_OgreMesh.h"
 #include "EC_OgreAnimationController.h"
 #include "OgreRenderingModule.h"
+#include "Renderer.h"
 
 #include <Ogre.h>
 
+#include <sstream>
+
 namespace OgreRenderer
 {
-    EC_OgreAnimationController::EC_OgreAnimationController(Foundation::ModuleInterface* module)
+    //! Controllers whose skeletons far entities can share, by mesh and animation state key
+    typedef std::map<std::string, EC_OgreAnimationController*> SkeletonLeaderMap;
+    static SkeletonLeaderMap skeleton_leaders;
+    
+    //! Used to spread reduced rate updates of different controllers to different frames
+    static uint next_lod_frame = 0;
+    
+    EC_OgreAnimationController::EC_OgreAnimationController(Foundation::ModuleInterface* module) :
+        renderer_(checked_static_cast<OgreRenderingModule*>(module)->GetRenderer()),
+        lod_(LOD_FULL),
+        accumulated_time_(0.0),
+        lod_frame_(next_lod_frame++),
+        skeleton_leader_(0)
     {
+        Foundation::ConfigurationManager& config = module->GetFramework()->GetDefaultConfig();
+        lod_enabled_ = config.DeclareSetting("AnimationLod", "enabled", true);
+        near_distance_ = config.DeclareSetting("AnimationLod", "near_distance", 20.0f);
+        far_distance_ = config.DeclareSetting("AnimationLod", "far_distance", 60.0f);
+        mid_update_interval_ = std::max(config.DeclareSetting("AnimationLod", "mid_update_interval", 2), 1);
+        far_update_interval_ = std::max(config.DeclareSetting("AnimationLod", "far_update_interval", 4), 1);
+        freeze_offscreen_ = config.DeclareSetting("AnimationLod", "freeze_offscreen", true);
+        share_skeletons_ = config.DeclareSetting("AnimationLod", "share_skeletons", false);
+        
         ResetState();
     }
     
     EC_OgreAnimationController::~EC_OgreAnimationController()
     {
+        StopSharingSkeleton();
+        ReleaseSkeletonFollowers();
     }
     
     void EC_OgreAnimationController::SetMeshEntity(Foundation::ComponentPtr mesh_entity)
@@ -34,6 +60,17 @@ namespace OgreRenderer
         Ogre::Entity* entity = GetEntity();
         if (!entity) return;
         
+        // Far and off-screen entities are updated less often, with the time accumulated in between
+        accumulated_time_ += frametime;
+        if (!UpdateLod(entity))
+            return;
+        frametime = accumulated_time_;
+        accumulated_time_ = 0.0;
+        
+        // If the skeleton is shared, the animations are evaluated by the controller that owns it
+        if (UpdateSkeletonSharing(entity))
+            return;
+        
         std::vector<std::string> erase_list;
         
         // Loop through all animations & update them as necessary
@@ -216,7 +253,170 @@ namespace OgreRenderer
     
     void EC_OgreAnimationController::ResetState()
     {
+        StopSharingSkeleton();
+        ReleaseSkeletonFollowers();
         animations_.clear();
+        accumulated_time_ = 0.0;
+    }
+    
+    bool EC_OgreAnimationController::UpdateLod(Ogre::Entity* entity)
+    {
+        AnimationLod lod = LOD_FULL;
+        uint interval = 1;
+        
+        RendererPtr renderer = renderer_.lock();
+        Ogre::Camera* camera = renderer ? renderer->GetCurrentCamera() : 0;
+        if (lod_enabled_ && camera)
+        {
+            if (!entity->isInScene() || (freeze_offscreen_ && !camera->isVisible(entity->getWorldBoundingBox(true))))
+                lod = LOD_FROZEN;
+            else
+            {
+                Real distance = camera->getDerivedPosition().distance(entity->getParentNode()->_getDerivedPosition());
+                if (distance > far_distance_)
+                {
+                    lod = LOD_REDUCED;
+                    interval = far_update_interval_;
+                }
+                else if (distance > near_distance_)
+                {
+                    lod = LOD_REDUCED;
+                    interval = mid_update_interval_;
+                }
+            }
+        }
+        
+        // Only far entities share skeletons
+        if (lod != lod_ && lod != LOD_REDUCED)
+        {
+            StopSharingSkeleton();
+            ReleaseSkeletonFollowers();
+        }
+        lod_ = lod;
+        
+        if (lod_ == LOD_FROZEN)
+            return false;
+        
+        return (++lod_frame_ % interval) == 0;
+    }
+    
+    std::string EC_OgreAnimationController::GetSharingKey(Ogre::Entity* entity) const
+    {
+        if (animations_.empty() || !entity->hasSkeleton())
+            return std::string();
+        
+        // Bones controlled by appearance modifiers are not shared
+        Ogre::SkeletonInstance* skel = entity->getSkeleton();
+        for (uint i = 0; i < skel->getNumBones(); ++i)
+            if (skel->getBone(i)->isManuallyControlled())
+                return std::string();
+        
+        // Only the state of looping animations that are not fading is independent of time
+        std::stringstream key;
+        key << mesh_name_;
+        for (AnimationMap::const_iterator i = animations_.begin(); i != animations_.end(); ++i)
+        {
+            if (i->second.phase_ != PHASE_PLAY || i->second.num_repeats_ != 0 || i->second.auto_stop_)
+                return std::string();
+            key << "|" << i->first << ":" << i->second.speed_factor_ << ":" << i->second.weight_factor_ << ":" << i->second.high_priority_;
+        }
+        
+        return key.str();
+    }
+    
+    bool EC_OgreAnimationController::UpdateSkeletonSharing(Ogre::Entity* entity)
+    {
+        if (!share_skeletons_ || lod_ != LOD_REDUCED)
+            return false;
+        
+        std::string key = GetSharingKey(entity);
+        if (key != sharing_key_)
+        {
+            StopSharingSkeleton();
+            ReleaseSkeletonFollowers();
+            sharing_key_ = key;
+        }
+        
+        if (sharing_key_.empty())
+            return false;
+        if (skeleton_leader_)
+            return true;
+        
+        SkeletonLeaderMap::iterator i = skeleton_leaders.find(sharing_key_);
+        if (i == skeleton_leaders.end())
+        {
+            // First one with this state evaluates the skeleton for the others
+            skeleton_leaders[sharing_key_] = this;
+            return false;
+        }
+        if (i->second == this)
+            return false;
+        
+        EC_OgreAnimationController* leader = i->second;
+        Ogre::Entity* leader_entity = leader->GetEntity();
+        if (!leader_entity || leader->sharing_key_ != sharing_key_)
+            return false;
+        
+        try
+        {
+            entity->shareSkeletonInstanceWith(leader_entity);
+        }
+        catch (Ogre::Exception& e)
+        {
+            OgreRenderingModule::LogWarning("Could not share skeleton of mesh " + mesh_name_ + ": " + e.what());
+            return false;
+        }
+        
+        skeleton_leader_ = leader;
+        leader->skeleton_followers_.insert(this);
+        return true;
+    }
+    
+    void EC_OgreAnimationController::StopSharingSkeleton()
+    {
+        if (!skeleton_leader_)
+            return;
+        
+        skeleton_leader_->skeleton_followers_.erase(this);
+        skeleton_leader_ = 0;
+        
+        Ogre::Entity* entity = GetEntity();
+        if (!entity || !entity->sharesSkeletonInstance())
+            return;
+        
+        // Continue the animations from where the shared skeleton left them
+        std::map<std::string, Real> time_positions;
+        for (AnimationMap::const_iterator i = animations_.begin(); i != animations_.end(); ++i)
+        {
+            Ogre::AnimationState* animstate = GetAnimationState(entity, i->first);
+            if (animstate)
+                time_positions[i->first] = animstate->getTimePosition();
+        }
+        
+        entity->stopSharingSkeletonInstance();
+        
+        for (std::map<std::string, Real>::const_iterator i = time_positions.begin(); i != time_positions.end(); ++i)
+        {
+            Ogre::AnimationState* animstate = GetAnimationState(entity, i->first);
+            if (animstate)
+            {
+                animstate->setLoop(animations_[i->first].num_repeats_ == 0);
+                animstate->setTimePosition(i->second);
+            }
+        }
+    }
+    
+    void EC_OgreAnimationController::ReleaseSkeletonFollowers()
+    {
+        SkeletonLeaderMap::iterator i = skeleton_leaders.find(sharing_key_);
+        if (i != skeleton_leaders.end() && i->second == this)
+            skeleton_leaders.erase(i);
+        
+        // Followers get their own skeleton instances, this one keeps the shared one
+        while (!skeleton_followers_.empty())
+            (*skeleton_followers_.begin())->StopSharingSkeleton();
+        
+        sharing_key_.clear();
     }
     
     Ogre::AnimationState* EC_OgreAnimationController::GetAnimationState(Ogre::Entity* entity, const std::string& name)
@@ -255,6 +455,9 @@ namespace OgreRenderer
 
     bool EC_OgreAnimationController::EnableAnimation(const std::string& name, bool looped, Real fadein, bool high_priority)
     {
+        // Changes to a shared animation state would affect the other entities too
+        StopSharingSkeleton();
+        
         Ogre::Entity* entity = GetEntity();
         Ogre::AnimationState* animstate = GetAnimationState(entity, name);
         if (!animstate) 
@@ -427,6 +630,8 @@ namespace OgreRenderer
 
     bool EC_OgreAnimationController::SetAnimationTimePosition(const std::string& name, Real newPosition)
     {
+        StopSharingSkeleton();
+        
         Ogre::Entity* entity = GetEntity();
         Ogre::AnimationState* animstate = GetAnimationState(entity, name);
         if (!animstate) 
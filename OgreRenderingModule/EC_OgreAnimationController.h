@@ -16,8 +16,18 @@ namespace Ogre
 
 namespace OgreRenderer
 {
+    class Renderer;
+    
+    typedef boost::shared_ptr<Renderer> RendererPtr;
+    typedef boost::weak_ptr<Renderer> RendererWeakPtr;
+    
     //! Ogre-specific mesh entity animation controller
     /*! Needs to be told of an EC_OgreMesh component to be usable
+
+        Animations are updated with a level of detail chosen by distance to the camera: near entities every frame,
+        farther entities every few frames with the accumulated time, and off-screen entities not at all until they
+        become visible again. Far entities of the same mesh playing the same looped animations may share one evaluated
+        skeleton. The policy is read from the "AnimationLod" configuration group.
         \ingroup OgreRenderingModuleClient
      */
     class OGRE_MODULE_API EC_OgreAnimationController : public Foundation::ComponentInterface
@@ -43,6 +53,17 @@ namespace OgreRenderer
             PHASE_FREE //in external control. for dynamiccomponent testing now
         };
 
+        //! Enumeration of animation level of detail
+        enum AnimationLod
+        {
+            //! Animations are updated every frame
+            LOD_FULL,
+            //! Animations are updated every few frames with the accumulated time
+            LOD_REDUCED,
+            //! Entity is off-screen, time is accumulated but the pose is not updated
+            LOD_FROZEN
+        };
+
         //! Structure for an ongoing animation
         struct Animation
         {
@@ -141,6 +162,12 @@ namespace OgreRenderer
         //! Returns all running animations
         const AnimationMap& GetRunningAnimations() const { return animations_; }
         
+        //! Returns level of detail chosen on the last update
+        AnimationLod GetLod() const { return lod_; }
+        
+        //! Returns true if the skeleton is evaluated by another controller of the same mesh and animation state
+        bool IsSharingSkeleton() const { return skeleton_leader_ != 0; }
+        
     private:
         //! Constructor
         /*! \param module renderer module
@@ -160,6 +187,28 @@ namespace OgreRenderer
         //! Resets internal state
         void ResetState();
         
+        //! Chooses level of detail by distance to the camera and visibility
+        /*! \return true if animations should be updated on this frame
+         */
+        bool UpdateLod(Ogre::Entity* entity);
+        
+        //! Returns key identifying the mesh and animation state for skeleton sharing, or empty if the skeleton can not be shared
+        std::string GetSharingKey(Ogre::Entity* entity) const;
+        
+        //! Starts or stops sharing the skeleton with another controller as the animation state changes
+        /*! \return true if the skeleton is shared and evaluated by another controller
+         */
+        bool UpdateSkeletonSharing(Ogre::Entity* entity);
+        
+        //! Stops sharing the skeleton of another controller, keeping the current animation time positions
+        void StopSharingSkeleton();
+        
+        //! Stops other controllers sharing the skeleton of this controller
+        void ReleaseSkeletonFollowers();
+        
+        //! Renderer, for the camera
+        RendererWeakPtr renderer_;
+        
         //! Mesh entity component 
         Foundation::ComponentPtr mesh_entity_;
         
@@ -174,6 +223,45 @@ namespace OgreRenderer
 
     	//! Bone blend mask of low-priority animations
     	Ogre::AnimationState::BoneBlendMask lowpriority_mask_;        
+        
+        //! Current level of detail
+        AnimationLod lod_;
+        
+        //! Time not yet applied to the animations
+        f64 accumulated_time_;
+        
+        //! Frame counter for reduced rate updates
+        uint lod_frame_;
+        
+        //! Whether level of detail is used at all
+        bool lod_enabled_;
+        
+        //! Entities nearer than this are updated every frame
+        Real near_distance_;
+        
+        //! Entities farther than this are updated every far_update_interval_ frames
+        Real far_distance_;
+        
+        //! Update interval in frames between near and far distance
+        uint mid_update_interval_;
+        
+        //! Update interval in frames beyond far distance
+        uint far_update_interval_;
+        
+        //! Whether animations of off-screen entities are frozen
+        bool freeze_offscreen_;
+        
+        //! Whether far entities may share an evaluated skeleton
+        bool share_skeletons_;
+        
+        //! Mesh and animation state key of the shared skeleton
+        std::string sharing_key_;
+        
+        //! Controller whose skeleton this controller's entity shares, or null
+        EC_OgreAnimationController* skeleton_leader_;
+        
+        //! Controllers whose entities share the skeleton of this controller's entity
+        std::set<EC_OgreAnimationController*> skeleton_followers_;
     };
 }
 
@@ -156,6 +156,7 @@ namespace OgreRenderer
             Ogre::SceneNode* node = placeable->GetSceneNode();
             node->attachObject(entity_);
             attached_ = true;
+            placeable->UpdateSpatialIndex();
         }
     }
     
@@ -167,6 +168,7 @@ namespace OgreRenderer
             Ogre::SceneNode* node = placeable->GetSceneNode();
             node->detachObject(entity_);
             attached_ = false;
+            placeable->UpdateSpatialIndex();
         }
     }
     
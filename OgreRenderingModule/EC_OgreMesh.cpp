@@ -57,16 +57,19 @@ namespace OgreRenderer
     void EC_OgreMesh::SetAdjustPosition(const Vector3df& position)
     {
         adjustment_node_->setPosition(Ogre::Vector3(position.x, position.y, position.z));
+        UpdateSpatialIndex();
     }
 
     void EC_OgreMesh::SetAdjustOrientation(const Quaternion& orientation)
     {
         adjustment_node_->setOrientation(Ogre::Quaternion(orientation.w, orientation.x, orientation.y, orientation.z));
+        UpdateSpatialIndex();
     }
     
     void EC_OgreMesh::SetAdjustScale(const Vector3df& scale)
     {
         adjustment_node_->setScale(Ogre::Vector3(scale.x, scale.y, scale.z));
+        UpdateSpatialIndex();
     }
     
     void EC_OgreMesh::SetAttachmentPosition(uint index, const Vector3df& position)
@@ -635,6 +638,12 @@ namespace OgreRenderer
         max = Vector3df(bboxmax.x, bboxmax.y, bboxmax.z);
     }
     
+    void EC_OgreMesh::UpdateSpatialIndex()
+    {
+        if ((attached_) && (placeable_))
+            checked_static_cast<EC_OgrePlaceable*>(placeable_.get())->UpdateSpatialIndex();
+    }
+
     void EC_OgreMesh::DetachEntity()
     {
         if ((!attached_) || (!entity_) || (!placeable_))
@@ -646,6 +655,7 @@ namespace OgreRenderer
         node->removeChild(adjustment_node_);
                 
         attached_ = false;
+        placeable->UpdateSpatialIndex();
     }
     
     void EC_OgreMesh::AttachEntity()
@@ -659,6 +669,7 @@ namespace OgreRenderer
         adjustment_node_->attachObject(entity_);
                 
         attached_ = true;
+        placeable->UpdateSpatialIndex();
     }
     
     Ogre::Mesh* EC_OgreMesh::PrepareMesh(const std::string& mesh_name, bool clone)
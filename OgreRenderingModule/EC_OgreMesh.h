@@ -222,6 +222,9 @@ namespace OgreRenderer
         //! detaches entity from placeable
         void DetachEntity();
         
+        //! updates the spatial index bounds of the placeable after the adjustment of the mesh changes
+        void UpdateSpatialIndex();
+        
         //! placeable component 
         Foundation::ComponentPtr placeable_;
         
@@ -4,6 +4,8 @@
 #include "OgreRenderingModule.h"
 #include "Renderer.h"
 #include "EC_OgrePlaceable.h"
+#include "Entity.h"
+#include "SceneManager.h"
 #include <Ogre.h>
 
 namespace OgreRenderer
@@ -27,6 +29,12 @@ namespace OgreRenderer
     
     EC_OgrePlaceable::~EC_OgrePlaceable()
     {
+        if (parent_)
+        {
+            std::vector<EC_OgrePlaceable*> &siblings = checked_static_cast<EC_OgrePlaceable*>(parent_.get())->children_;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+        }
+
         if (renderer_.expired())
             return;
         RendererPtr renderer = renderer_.lock();
@@ -60,8 +68,16 @@ namespace OgreRenderer
             return;
         }
         DetachNode();
+        if (parent_)
+        {
+            std::vector<EC_OgrePlaceable*> &siblings = checked_static_cast<EC_OgrePlaceable*>(parent_.get())->children_;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+        }
         parent_ = placeable;
+        if (parent_)
+            checked_static_cast<EC_OgrePlaceable*>(parent_.get())->children_.push_back(this);
         AttachNode();
+        UpdateSpatialIndex();
     }
     
     Vector3df EC_OgrePlaceable::GetPosition() const
@@ -122,11 +138,13 @@ namespace OgreRenderer
     {
         link_scene_node_->setPosition(Ogre::Vector3(position.x, position.y, position.z));
         AttachNode(); // Nodes become visible only after having their position set at least once
+        UpdateSpatialIndex();
     }
 
     void EC_OgrePlaceable::SetOrientation(const Quaternion& orientation)
     {
         link_scene_node_->setOrientation(Ogre::Quaternion(orientation.w, orientation.x, orientation.y, orientation.z));
+        UpdateSpatialIndex();
     }
 
     void EC_OgrePlaceable::LookAt(const Vector3df& look_at)
@@ -135,21 +153,25 @@ namespace OgreRenderer
         // so start in identity transform
         link_scene_node_->setOrientation(Ogre::Quaternion::IDENTITY);
         link_scene_node_->lookAt(Ogre::Vector3(look_at.x, look_at.y, look_at.z), Ogre::Node::TS_WORLD);
+        UpdateSpatialIndex();
     }
     
     void EC_OgrePlaceable::SetYaw(Real radians)
     {
         link_scene_node_->yaw(Ogre::Radian(radians), Ogre::Node::TS_WORLD);
+        UpdateSpatialIndex();
     }
 
     void EC_OgrePlaceable::SetPitch(Real radians)
     {
         link_scene_node_->pitch(Ogre::Radian(radians));
+        UpdateSpatialIndex();
     }
  
    void EC_OgrePlaceable::SetRoll(Real radians)
     {
         link_scene_node_->roll(Ogre::Radian(radians));
+        UpdateSpatialIndex();
     } 
 
    float EC_OgrePlaceable::GetYaw() const
@@ -171,6 +193,7 @@ namespace OgreRenderer
     void EC_OgrePlaceable::SetScale(const Vector3df& scale)
     {
         scene_node_->setScale(Ogre::Vector3(scale.x, scale.y, scale.z));
+        UpdateSpatialIndex();
     }
 
     void EC_OgrePlaceable::AttachNode()
@@ -225,6 +248,49 @@ namespace OgreRenderer
         attached_ = false;
     }
 
+    //! merges the world bounds of the objects attached to a geometry node and its child nodes, e.g. the mesh adjustment node
+    static void MergeAttachedBounds(Ogre::SceneNode* node, Ogre::AxisAlignedBox& bounds)
+    {
+        Ogre::SceneNode::ObjectIterator objects = node->getAttachedObjectIterator();
+        while(objects.hasMoreElements())
+            bounds.merge(objects.getNext()->getWorldBoundingBox(true));
+
+        Ogre::Node::ChildNodeIterator children = node->getChildIterator();
+        while(children.hasMoreElements())
+            MergeAttachedBounds(static_cast<Ogre::SceneNode*>(children.getNext()), bounds);
+    }
+
+    void EC_OgrePlaceable::UpdateSpatialIndex()
+    {
+        // Nodes not yet positioned are not in the scene
+        if (!attached_)
+            return;
+        Scene::Entity* entity = GetParentEntity();
+        if (!entity || !entity->GetScene())
+            return;
+
+        // Bound the geometry by the world box of the attached mesh or custom object. Without finite geometry bounds,
+        // use the sphere of a unit cube scaled by the node, which fits the prims
+        Ogre::AxisAlignedBox bounds;
+        MergeAttachedBounds(scene_node_, bounds);
+        if (bounds.isFinite())
+        {
+            const Ogre::Vector3& min = bounds.getMinimum();
+            const Ogre::Vector3& max = bounds.getMaximum();
+            entity->GetScene()->GetSpatialIndex().Update(entity->GetId(), Vector3df(min.x, min.y, min.z), Vector3df(max.x, max.y, max.z), this);
+        }
+        else
+        {
+            const Ogre::Vector3& pos = scene_node_->_getDerivedPosition();
+            Real radius = 0.5f * scene_node_->_getDerivedScale().length();
+            entity->GetScene()->GetSpatialIndex().Update(entity->GetId(), Vector3df(pos.x - radius, pos.y - radius, pos.z - radius),
+                Vector3df(pos.x + radius, pos.y + radius, pos.z + radius), this);
+        }
+
+        for(uint i = 0; i < children_.size(); ++i)
+            children_[i]->UpdateSpatialIndex();
+    }
+
     //experimental QVector3D acessors
     QVector3D EC_OgrePlaceable::GetQPosition() const
     {
@@ -288,6 +354,7 @@ namespace OgreRenderer
 
         }
         link_scene_node_->translate(m, Ogre::Vector3(x, y, z), Ogre::Node::TS_LOCAL);
+        UpdateSpatialIndex();
         const Ogre::Vector3 newpos = link_scene_node_->getPosition();
         return QVector3D(newpos.x, newpos.y, newpos.z);
     }
@@ -126,6 +126,11 @@ namespace OgreRenderer
             as this doesn't take scaling into account!
          */
         Ogre::SceneNode* GetLinkSceneNode() const { return link_scene_node_; }
+
+        //! updates bounds of the entity, and of the entities of child placeables, in the spatial index of the scene
+        /*! Called when the node moves. Components that attach geometry to the scene node call this when the geometry changes
+         */
+        void UpdateSpatialIndex();
                        
         //! returns select priority
         int GetSelectPriority() const { return select_priority_; }
@@ -163,12 +168,15 @@ namespace OgreRenderer
         
         //! detaches scenenode from parent
         void DetachNode();
-        
+
         //! renderer
         RendererWeakPtr renderer_;
         
         //! parent placeable
         Foundation::ComponentPtr parent_;
+
+        //! placeables which have this as parent, for updating their spatial index bounds when this moves
+        std::vector<EC_OgrePlaceable*> children_;
         
         //! Ogre scene node for geometry. scale is handled here
         Ogre::SceneNode* scene_node_;
@@ -0,0 +1,632 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "MeshBvh.h"
+#include "Profiler.h"
+
+#include <Ogre.h>
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <cstdlib>
+
+namespace OgreRenderer
+{
+    //! Max. number of triangles in a leaf node
+    const uint cMaxLeafTriangles = 4;
+
+    //! Max. depth of the hierarchy
+    const uint cMaxDepth = 40;
+
+    //! Orders triangles by their centroid along an axis
+    class CentroidLess
+    {
+    public:
+        CentroidLess(const std::vector<Ogre::Vector3> &centroids, int axis) : centroids_(centroids), axis_(axis) {}
+
+        bool operator()(uint a, uint b) const { return centroids_[a][axis_] < centroids_[b][axis_]; }
+
+    private:
+        const std::vector<Ogre::Vector3> &centroids_;
+        int axis_;
+    };
+
+    // Get the mesh information for the given mesh. Version which supports animation
+    // Adapted from http://www.ogre3d.org/wiki/index.php/Raycasting_to_the_polygon_level
+    void GetMeshInformation(
+        Ogre::Entity *entity,
+        std::vector<Ogre::Vector3>& vertices,
+        std::vector<Ogre::Vector2>& texcoords,
+        std::vector<uint>& indices,
+        std::vector<uint>& submeshstartindex,
+        const Ogre::Vector3 &position,
+        const Ogre::Quaternion &orient,
+        const Ogre::Vector3 &scale)
+    {
+        bool added_shared = false;
+        size_t current_offset = 0;
+        size_t shared_offset = 0;
+        size_t next_offset = 0;
+        size_t index_offset = 0;
+        size_t vertex_count = 0;
+        size_t index_count = 0;
+        Ogre::MeshPtr mesh = entity->getMesh();
+
+        bool useSoftwareBlendingVertices = entity->hasSkeleton();
+        if (useSoftwareBlendingVertices)
+            entity->_updateAnimation();
+
+        submeshstartindex.resize(mesh->getNumSubMeshes());
+
+        // Calculate how many vertices and indices we're going to need
+        for(unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            Ogre::SubMesh* submesh = mesh->getSubMesh( i );
+            // We only need to add the shared vertices once
+            if (submesh->useSharedVertices)
+            {
+                if (!added_shared)
+                {
+                    vertex_count += mesh->sharedVertexData->vertexCount;
+                    added_shared = true;
+                }
+            }
+            else
+            {
+                vertex_count += submesh->vertexData->vertexCount;
+            }
+
+            // Add the indices
+            submeshstartindex[i] = index_count;
+            index_count += submesh->indexData->indexCount;
+        }
+
+        // Allocate space for the vertices and indices
+        vertices.resize(vertex_count);
+        texcoords.resize(vertex_count);
+        indices.resize(index_count);
+
+        added_shared = false;
+
+        // Run through the submeshes again, adding the data into the arrays
+        for(unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            Ogre::SubMesh* submesh = mesh->getSubMesh(i);
+
+            // Get vertex data
+            //Ogre::VertexData* vertex_data = submesh->useSharedVertices ? mesh->sharedVertexData : submesh->vertexData;
+            Ogre::VertexData* vertex_data;
+
+            //When there is animation:
+            if (useSoftwareBlendingVertices)
+                vertex_data = submesh->useSharedVertices ? entity->_getSkelAnimVertexData() : entity->getSubEntity(i)->_getSkelAnimVertexData();
+            else
+                vertex_data = submesh->useSharedVertices ? mesh->sharedVertexData : submesh->vertexData;
+
+            if ((!submesh->useSharedVertices)||(submesh->useSharedVertices && !added_shared))
+            {
+                if(submesh->useSharedVertices)
+                {
+                    added_shared = true;
+                    shared_offset = current_offset;
+                }
+
+                const Ogre::VertexElement* posElem =
+                    vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
+                const Ogre::VertexElement *texElem = 
+                    vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_TEXTURE_COORDINATES);
+
+                Ogre::HardwareVertexBufferSharedPtr vbuf =
+                    vertex_data->vertexBufferBinding->getBuffer(posElem->getSource());
+
+                unsigned char* vertex =
+                    static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+
+                // There is _no_ baseVertexPointerToElement() which takes an Ogre::Real or a double
+                //  as second argument. So make it float, to avoid trouble when Ogre::Real will
+                //  be comiled/typedefed as double:
+                //      Ogre::Real* pReal;
+                float* pReal = 0;
+
+                for(size_t j = 0; j < vertex_data->vertexCount; ++j, vertex += vbuf->getVertexSize())
+                {
+                    posElem->baseVertexPointerToElement(vertex, &pReal);
+
+                    Ogre::Vector3 pt(pReal[0], pReal[1], pReal[2]);
+
+                    vertices[current_offset + j] = (orient * (pt * scale)) + position;
+                    if (texElem)
+                    {
+                        texElem->baseVertexPointerToElement(vertex, &pReal);
+                        texcoords[current_offset + j] = Ogre::Vector2(pReal[0], pReal[1]);
+                    }
+                    else
+                        texcoords[current_offset + j] = Ogre::Vector2(0.0f, 0.0f);
+                }
+
+                vbuf->unlock();
+                next_offset += vertex_data->vertexCount;
+            }
+
+            Ogre::IndexData* index_data = submesh->indexData;
+            size_t numTris = index_data->indexCount / 3;
+            Ogre::HardwareIndexBufferSharedPtr ibuf = index_data->indexBuffer;
+
+            unsigned long*  pLong = static_cast<unsigned long*>(ibuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+            unsigned short* pShort = reinterpret_cast<unsigned short*>(pLong);
+            size_t offset = (submesh->useSharedVertices)? shared_offset : current_offset;
+
+            bool use32bitindexes = (ibuf->getType() == Ogre::HardwareIndexBuffer::IT_32BIT);
+            if (use32bitindexes)
+                for(size_t k = 0; k < numTris*3; ++k)
+                    indices[index_offset++] = pLong[k] + static_cast<uint>(offset);
+            else
+                for(size_t k = 0; k < numTris*3; ++k)
+                    indices[index_offset++] = static_cast<uint>(pShort[k]) + static_cast<unsigned long>(offset);
+
+            ibuf->unlock();
+            current_offset = next_offset;
+        }
+    }
+
+    MeshBvh::MeshBvh()
+    {
+    }
+
+    void MeshBvh::Build(std::vector<Ogre::Vector3> &vertices, std::vector<Ogre::Vector2> &texcoords,
+        std::vector<uint> &indices, std::vector<uint> &submeshstartindex)
+    {
+        vertices_.swap(vertices);
+        texcoords_.swap(texcoords);
+        indices_.swap(indices);
+        submeshstartindex_.swap(submeshstartindex);
+        vertices.clear();
+        texcoords.clear();
+        indices.clear();
+        submeshstartindex.clear();
+
+        nodes_.clear();
+        triangles_.clear();
+
+        uint num_triangles = indices_.size() / 3;
+        if (!num_triangles)
+            return;
+
+        std::vector<Ogre::Vector3> centroids(num_triangles);
+        triangles_.resize(num_triangles);
+        for(uint i = 0; i < num_triangles; ++i)
+        {
+            triangles_[i] = i;
+            centroids[i] = (vertices_[indices_[i*3]] + vertices_[indices_[i*3+1]] + vertices_[indices_[i*3+2]]) / 3.0f;
+        }
+
+        // A binary tree with leaves of at least one triangle has less than 2n nodes
+        nodes_.reserve(num_triangles * 2);
+        nodes_.resize(1);
+        BuildNode(0, 0, num_triangles, centroids, 0);
+    }
+
+    void MeshBvh::BuildNode(uint node, uint begin, uint end, const std::vector<Ogre::Vector3> &centroids, uint depth)
+    {
+        // Bounds of the triangles, and of their centroids for choosing the split axis
+        Ogre::Vector3 min(std::numeric_limits<Ogre::Real>::max());
+        Ogre::Vector3 max(-std::numeric_limits<Ogre::Real>::max());
+        Ogre::Vector3 cmin = min;
+        Ogre::Vector3 cmax = max;
+        for(uint i = begin; i < end; ++i)
+        {
+            uint tri = triangles_[i];
+            for(uint j = 0; j < 3; ++j)
+            {
+                const Ogre::Vector3 &v = vertices_[indices_[tri*3+j]];
+                min.makeFloor(v);
+                max.makeCeil(v);
+            }
+            cmin.makeFloor(centroids[tri]);
+            cmax.makeCeil(centroids[tri]);
+        }
+
+        nodes_[node].min_ = min;
+        nodes_[node].max_ = max;
+
+        Ogre::Vector3 extent = cmax - cmin;
+        int axis = 0;
+        if (extent.y > extent.x)
+            axis = 1;
+        if (extent.z > extent[axis])
+            axis = 2;
+
+        if (end - begin <= cMaxLeafTriangles || depth >= cMaxDepth || extent[axis] <= 0.0f)
+        {
+            nodes_[node].first_ = begin;
+            nodes_[node].count_ = end - begin;
+            return;
+        }
+
+        // Split at the median centroid along the longest axis
+        uint mid = begin + (end - begin) / 2;
+        std::nth_element(triangles_.begin() + begin, triangles_.begin() + mid, triangles_.begin() + end,
+            CentroidLess(centroids, axis));
+
+        uint left = nodes_.size();
+        nodes_[node].first_ = left;
+        nodes_[node].count_ = 0;
+        nodes_.resize(left + 2);
+
+        BuildNode(left, begin, mid, centroids, depth + 1);
+        BuildNode(left + 1, mid, end, centroids, depth + 1);
+    }
+
+    Ogre::Real MeshBvh::IntersectNode(const Node &node, const Ogre::Vector3 &origin, const Ogre::Vector3 &inv_dir,
+        Ogre::Real max_distance)
+    {
+        // Slab test. Zero direction components give infinite inverses, which the comparisons handle.
+        Ogre::Real tmin = 0.0f;
+        Ogre::Real tmax = max_distance;
+        for(int i = 0; i < 3; ++i)
+        {
+            Ogre::Real t1 = (node.min_[i] - origin[i]) * inv_dir[i];
+            Ogre::Real t2 = (node.max_[i] - origin[i]) * inv_dir[i];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            if (t1 > tmin)
+                tmin = t1;
+            if (t2 < tmax)
+                tmax = t2;
+            if (tmin > tmax)
+                return -1.0f;
+        }
+
+        return tmin;
+    }
+
+    bool MeshBvh::Raycast(const Ogre::Ray &ray, bool positive_side, bool negative_side, Ogre::Real &distance,
+        uint &triangle) const
+    {
+        if (nodes_.empty())
+            return false;
+
+        const Ogre::Vector3 &origin = ray.getOrigin();
+        const Ogre::Vector3 &dir = ray.getDirection();
+        Ogre::Vector3 inv_dir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+
+        Ogre::Real closest = std::numeric_limits<Ogre::Real>::max();
+        bool hit = false;
+
+        if (IntersectNode(nodes_[0], origin, inv_dir, closest) < 0.0f)
+            return false;
+
+        uint stack[cMaxDepth * 2 + 2];
+        uint stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while(stack_size)
+        {
+            const Node &node = nodes_[stack[--stack_size]];
+
+            if (node.count_)
+            {
+                for(uint i = node.first_; i < node.first_ + node.count_; ++i)
+                {
+                    uint tri = triangles_[i];
+                    std::pair<bool, Ogre::Real> result = Ogre::Math::intersects(ray, vertices_[indices_[tri*3]],
+                        vertices_[indices_[tri*3+1]], vertices_[indices_[tri*3+2]], positive_side, negative_side);
+                    if (result.first && result.second < closest)
+                    {
+                        closest = result.second;
+                        triangle = tri;
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first, so that the farther one is more likely to be pruned
+            uint left = node.first_;
+            uint right = node.first_ + 1;
+            Ogre::Real left_distance = IntersectNode(nodes_[left], origin, inv_dir, closest);
+            Ogre::Real right_distance = IntersectNode(nodes_[right], origin, inv_dir, closest);
+            if (left_distance >= 0.0f && right_distance >= 0.0f)
+            {
+                if (left_distance < right_distance)
+                    std::swap(left, right);
+                stack[stack_size++] = left;
+                stack[stack_size++] = right;
+            }
+            else if (left_distance >= 0.0f)
+                stack[stack_size++] = left;
+            else if (right_distance >= 0.0f)
+                stack[stack_size++] = right;
+        }
+
+        if (hit)
+            distance = closest;
+        return hit;
+    }
+
+    Ogre::Vector2 MeshBvh::GetUV(uint triangle, const Ogre::Vector3 &point) const
+    {
+        uint index = triangle * 3;
+        const Ogre::Vector3 &t1 = vertices_[indices_[index]];
+        const Ogre::Vector3 &t2 = vertices_[indices_[index+1]];
+        const Ogre::Vector3 &t3 = vertices_[indices_[index+2]];
+
+        Ogre::Vector3 v1 = point - t1;
+        Ogre::Vector3 v2 = point - t2;
+        Ogre::Vector3 v3 = point - t3;
+
+        float area1 = (v2.crossProduct(v3)).length() / 2.0f;
+        float area2 = (v1.crossProduct(v3)).length() / 2.0f;
+        float area3 = (v1.crossProduct(v2)).length() / 2.0f;
+        float sum_area = area1 + area2 + area3;
+        if (sum_area == 0.0)
+            return Ogre::Vector2(0.0f, 0.0f);
+
+        Ogre::Vector3 bary(area1 / sum_area, area2 / sum_area, area3 / sum_area);
+        return texcoords_[indices_[index]] * bary.x + texcoords_[indices_[index+1]] * bary.y +
+            texcoords_[indices_[index+2]] * bary.z;
+    }
+
+    uint MeshBvh::GetSubmesh(uint triangle) const
+    {
+        std::vector<uint>::const_iterator it = std::upper_bound(submeshstartindex_.begin(), submeshstartindex_.end(),
+            triangle * 3);
+        if (it == submeshstartindex_.begin())
+            return 0;
+        return (it - submeshstartindex_.begin()) - 1;
+    }
+
+    size_t MeshBvh::GetMemoryUse() const
+    {
+        return nodes_.capacity() * sizeof(Node) + triangles_.capacity() * sizeof(uint) +
+            vertices_.capacity() * sizeof(Ogre::Vector3) + texcoords_.capacity() * sizeof(Ogre::Vector2) +
+            indices_.capacity() * sizeof(uint) + submeshstartindex_.capacity() * sizeof(uint);
+    }
+
+    //! Number of hierarchies built between removals of those of deleted meshes
+    const uint cPruneInterval = 64;
+
+    MeshBvhCache::MeshBvhCache() :
+        builds_since_prune_(0)
+    {
+    }
+
+    MeshBvhPtr MeshBvhCache::GetMeshBvh(Ogre::Entity *entity)
+    {
+        Ogre::MeshPtr mesh = entity->getMesh();
+        if (mesh.isNull() || !mesh->isLoaded())
+            return MeshBvhPtr();
+
+        size_t num_vertices = mesh->sharedVertexData ? mesh->sharedVertexData->vertexCount : 0;
+        size_t num_indices = 0;
+        for(unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            Ogre::SubMesh* submesh = mesh->getSubMesh(i);
+            if (!submesh->useSharedVertices)
+                num_vertices += submesh->vertexData->vertexCount;
+            num_indices += submesh->indexData->indexCount;
+        }
+
+        CachedMesh &cached = meshes_[mesh->getHandle()];
+        if (cached.bvh_ && cached.num_vertices_ == num_vertices && cached.num_indices_ == num_indices)
+            return cached.bvh_;
+
+        PROFILE(MeshBvhCache_Build);
+
+        std::vector<Ogre::Vector3> vertices;
+        std::vector<Ogre::Vector2> texcoords;
+        std::vector<uint> indices;
+        std::vector<uint> submeshstartindex;
+        GetMeshInformation(entity, vertices, texcoords, indices, submeshstartindex,
+            Ogre::Vector3::ZERO, Ogre::Quaternion::IDENTITY, Ogre::Vector3::UNIT_SCALE);
+
+        MeshBvhPtr bvh(new MeshBvh());
+        bvh->Build(vertices, texcoords, indices, submeshstartindex);
+        cached.bvh_ = bvh;
+        cached.num_vertices_ = num_vertices;
+        cached.num_indices_ = num_indices;
+
+        if (++builds_since_prune_ >= cPruneInterval)
+            Prune();
+
+        return bvh;
+    }
+
+    void MeshBvhCache::Clear()
+    {
+        meshes_.clear();
+        builds_since_prune_ = 0;
+    }
+
+    void MeshBvhCache::Prune()
+    {
+        builds_since_prune_ = 0;
+
+        Ogre::MeshManager &manager = Ogre::MeshManager::getSingleton();
+        CachedMeshMap::iterator it = meshes_.begin();
+        while(it != meshes_.end())
+        {
+            if (manager.getByHandle(it->first).isNull())
+                meshes_.erase(it++);
+            else
+                ++it;
+        }
+    }
+
+    //! Prim mesh of the benchmark scene, with its transform
+    struct BenchmarkMesh
+    {
+        MeshBvh bvh_;
+        std::vector<Ogre::Vector3> vertices_;
+        std::vector<uint> indices_;
+        Ogre::Vector3 position_;
+        Ogre::Quaternion orientation_;
+        Ogre::Vector3 scale_;
+        Ogre::AxisAlignedBox world_bounds_;
+    };
+
+    static Ogre::Real RandomReal(Ogre::Real min, Ogre::Real max)
+    {
+        return min + (max - min) * (Ogre::Real)rand() / (Ogre::Real)RAND_MAX;
+    }
+
+    //! Makes a sphere of rings x segments quads, like a sphere prim
+    static void MakeSphere(uint rings, uint segments, std::vector<Ogre::Vector3> &vertices, std::vector<uint> &indices)
+    {
+        for(uint r = 0; r <= rings; ++r)
+        {
+            Ogre::Real phi = Ogre::Math::PI * r / rings;
+            for(uint s = 0; s <= segments; ++s)
+            {
+                Ogre::Real theta = Ogre::Math::TWO_PI * s / segments;
+                vertices.push_back(Ogre::Vector3(sin(phi) * cos(theta), sin(phi) * sin(theta), cos(phi)) * 0.5f);
+            }
+        }
+
+        for(uint r = 0; r < rings; ++r)
+            for(uint s = 0; s < segments; ++s)
+            {
+                uint a = r * (segments + 1) + s;
+                uint b = a + segments + 1;
+                indices.push_back(a); indices.push_back(b); indices.push_back(a + 1);
+                indices.push_back(a + 1); indices.push_back(b); indices.push_back(b + 1);
+            }
+    }
+
+    //! Finds the closest hit on a mesh by transforming all of its vertices and testing all triangles, like raycasts
+    //! did before the hierarchies
+    static bool RaycastAllTriangles(const BenchmarkMesh &mesh, const Ogre::Ray &ray, std::vector<Ogre::Vector3> &world,
+        Ogre::Real &distance)
+    {
+        world.resize(mesh.vertices_.size());
+        for(uint i = 0; i < mesh.vertices_.size(); ++i)
+            world[i] = (mesh.orientation_ * (mesh.vertices_[i] * mesh.scale_)) + mesh.position_;
+
+        bool hit = false;
+        for(uint i = 0; i + 2 < mesh.indices_.size(); i += 3)
+        {
+            std::pair<bool, Ogre::Real> result = Ogre::Math::intersects(ray, world[mesh.indices_[i]],
+                world[mesh.indices_[i+1]], world[mesh.indices_[i+2]], true, false);
+            if (result.first && (!hit || result.second < distance))
+            {
+                distance = result.second;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    std::string BenchmarkMeshBvh(uint num_meshes, uint num_rays)
+    {
+        const Ogre::Real region_size = 256.0f;
+
+        srand(1);
+
+        // Build the scene: mostly detailed spheres, some low detail ones, with random transforms
+        std::vector<BenchmarkMesh> meshes(num_meshes);
+        uint num_triangles = 0;
+        size_t memory_use = 0;
+        Poco::Timestamp build_start;
+        for(uint i = 0; i < num_meshes; ++i)
+        {
+            BenchmarkMesh &mesh = meshes[i];
+            if (i % 4 == 3)
+                MakeSphere(2, 4, mesh.vertices_, mesh.indices_);
+            else
+                MakeSphere(12, 24, mesh.vertices_, mesh.indices_);
+
+            mesh.position_ = Ogre::Vector3(RandomReal(0.0f, region_size), RandomReal(0.0f, region_size), RandomReal(20.0f, 40.0f));
+            Ogre::Vector3 axis(RandomReal(-1.0f, 1.0f), RandomReal(-1.0f, 1.0f), RandomReal(-1.0f, 1.0f));
+            axis.normalise();
+            mesh.orientation_.FromAngleAxis(Ogre::Radian(RandomReal(0.0f, Ogre::Math::TWO_PI)), axis);
+            mesh.scale_ = Ogre::Vector3(RandomReal(0.5f, 10.0f), RandomReal(0.5f, 10.0f), RandomReal(0.5f, 10.0f));
+
+            mesh.world_bounds_.setNull();
+            for(uint j = 0; j < mesh.vertices_.size(); ++j)
+                mesh.world_bounds_.merge((mesh.orientation_ * (mesh.vertices_[j] * mesh.scale_)) + mesh.position_);
+
+            std::vector<Ogre::Vector3> vertices = mesh.vertices_;
+            std::vector<Ogre::Vector2> texcoords(vertices.size(), Ogre::Vector2::ZERO);
+            std::vector<uint> indices = mesh.indices_;
+            std::vector<uint> submeshstartindex(1, 0);
+            mesh.bvh_.Build(vertices, texcoords, indices, submeshstartindex);
+            num_triangles += mesh.bvh_.GetNumTriangles();
+            memory_use += mesh.bvh_.GetMemoryUse();
+        }
+        double build_time = build_start.elapsed() / 1000000.0;
+
+        // Rays from above the scene towards random points on it, like picks from an avatar camera
+        std::vector<Ogre::Ray> rays(num_rays);
+        for(uint i = 0; i < num_rays; ++i)
+        {
+            Ogre::Vector3 origin(RandomReal(0.0f, region_size), RandomReal(0.0f, region_size), 60.0f);
+            Ogre::Vector3 target(RandomReal(0.0f, region_size), RandomReal(0.0f, region_size), 20.0f);
+            rays[i] = Ogre::Ray(origin, (target - origin).normalisedCopy());
+        }
+
+        // Both methods test only meshes whose bounds the ray hits, as with the Ogre ray scene query
+        std::vector<std::vector<uint> > candidates(num_rays);
+        uint num_candidates = 0;
+        for(uint i = 0; i < num_rays; ++i)
+            for(uint j = 0; j < num_meshes; ++j)
+                if (Ogre::Math::intersects(rays[i], meshes[j].world_bounds_).first)
+                {
+                    candidates[i].push_back(j);
+                    ++num_candidates;
+                }
+
+        std::vector<Ogre::Real> all_distances(num_rays, -1.0f);
+        std::vector<Ogre::Vector3> world;
+        Poco::Timestamp all_start;
+        for(uint i = 0; i < num_rays; ++i)
+            for(uint j = 0; j < candidates[i].size(); ++j)
+            {
+                Ogre::Real distance = 0.0f;
+                if (RaycastAllTriangles(meshes[candidates[i][j]], rays[i], world, distance) &&
+                    (all_distances[i] < 0.0f || distance < all_distances[i]))
+                    all_distances[i] = distance;
+            }
+        double all_time = all_start.elapsed() / 1000000.0;
+
+        std::vector<Ogre::Real> bvh_distances(num_rays, -1.0f);
+        Poco::Timestamp bvh_start;
+        for(uint i = 0; i < num_rays; ++i)
+            for(uint j = 0; j < candidates[i].size(); ++j)
+            {
+                const BenchmarkMesh &mesh = meshes[candidates[i][j]];
+                Ogre::Quaternion inv_orientation = mesh.orientation_.Inverse();
+                Ogre::Ray object_ray((inv_orientation * (rays[i].getOrigin() - mesh.position_)) / mesh.scale_,
+                    (inv_orientation * rays[i].getDirection()) / mesh.scale_);
+                Ogre::Real distance = 0.0f;
+                uint triangle;
+                if (mesh.bvh_.Raycast(object_ray, true, false, distance, triangle) &&
+                    (bvh_distances[i] < 0.0f || distance < bvh_distances[i]))
+                    bvh_distances[i] = distance;
+            }
+        double bvh_time = bvh_start.elapsed() / 1000000.0;
+
+        uint hits = 0;
+        uint mismatches = 0;
+        for(uint i = 0; i < num_rays; ++i)
+        {
+            if (all_distances[i] >= 0.0f)
+                ++hits;
+            if ((all_distances[i] < 0.0f) != (bvh_distances[i] < 0.0f) ||
+                fabs(all_distances[i] - bvh_distances[i]) > 0.001f * std::max(1.0f, all_distances[i]))
+                ++mismatches;
+        }
+
+        std::ostringstream report;
+        report << "Meshes: " << num_meshes << ", triangles: " << num_triangles << ", hierarchy build time: "
+            << build_time * 1000.0 << " ms, memory: " << memory_use / 1024 << " KiB" << std::endl;
+        report << "Rays: " << num_rays << ", hits: " << hits << ", meshes with bounds hit: " << num_candidates << std::endl;
+        report << "All triangles: " << all_time * 1000.0 << " ms, " << all_time * 1000000.0 / std::max(num_rays, 1u)
+            << " us per ray" << std::endl;
+        report << "Hierarchy: " << bvh_time * 1000.0 << " ms, " << bvh_time * 1000000.0 / std::max(num_rays, 1u)
+            << " us per ray" << std::endl;
+        report << "Rays with differing hits: " << mismatches;
+        return report.str();
+    }
+}
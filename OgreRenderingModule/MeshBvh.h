@@ -0,0 +1,159 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_OgreRenderer_MeshBvh_h
+#define incl_OgreRenderer_MeshBvh_h
+
+#include <OgreVector2.h>
+#include <OgreVector3.h>
+#include <OgreRay.h>
+
+#include <vector>
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+namespace Ogre
+{
+    class Entity;
+    class Quaternion;
+}
+
+namespace OgreRenderer
+{
+    //! Reads the triangles of the mesh of an entity, transformed by position, orient and scale
+    /*! Skinned meshes are read in their current pose, which requires software skinning.
+        \param vertices returns vertex positions
+        \param texcoords returns texture coordinates of the vertices
+        \param indices returns three vertex indices per triangle
+        \param submeshstartindex returns first index of each submesh in indices
+     */
+    void GetMeshInformation(
+        Ogre::Entity *entity,
+        std::vector<Ogre::Vector3>& vertices,
+        std::vector<Ogre::Vector2>& texcoords,
+        std::vector<uint>& indices,
+        std::vector<uint>& submeshstartindex,
+        const Ogre::Vector3 &position,
+        const Ogre::Quaternion &orient,
+        const Ogre::Vector3 &scale);
+
+    //! Bounding volume hierarchy of the triangles of a mesh, for polygon-accurate raycasts
+    /*! Built once from the mesh data in object space. Rays are transformed into object space for the test, so the same
+        hierarchy serves all entities using the mesh, regardless of their transforms.
+        \ingroup OgreRenderingModuleClient
+     */
+    class MeshBvh
+    {
+    public:
+        MeshBvh();
+
+        //! Builds the hierarchy. The vectors are swapped into the hierarchy, and are empty after the call.
+        /*! \param vertices vertex positions in object space
+            \param texcoords texture coordinates of the vertices
+            \param indices three vertex indices per triangle
+            \param submeshstartindex first index of each submesh in indices
+         */
+        void Build(std::vector<Ogre::Vector3> &vertices, std::vector<Ogre::Vector2> &texcoords,
+            std::vector<uint> &indices, std::vector<uint> &submeshstartindex);
+
+        //! Finds the closest triangle hit by a ray
+        /*! \param ray ray in object space. The direction need not be unit length, distance is measured in its lengths
+            \param positive_side whether to hit triangles facing against the ray
+            \param negative_side whether to hit triangles facing along the ray
+            \param distance returns distance of the hit along the ray
+            \param triangle returns index of the triangle hit
+            \return true if a triangle was hit
+         */
+        bool Raycast(const Ogre::Ray &ray, bool positive_side, bool negative_side, Ogre::Real &distance, uint &triangle) const;
+
+        //! Returns texture coordinates of a point on a triangle
+        Ogre::Vector2 GetUV(uint triangle, const Ogre::Vector3 &point) const;
+
+        //! Returns submesh of a triangle
+        uint GetSubmesh(uint triangle) const;
+
+        //! Returns number of triangles
+        uint GetNumTriangles() const { return indices_.size() / 3; }
+
+        //! Returns approximate memory use in bytes
+        size_t GetMemoryUse() const;
+
+    private:
+        //! Node of the hierarchy. Leaf nodes hold count_ triangles starting at first_ in triangles_, inner nodes have
+        //! their children at first_ and first_ + 1.
+        struct Node
+        {
+            Ogre::Vector3 min_;
+            Ogre::Vector3 max_;
+            uint first_;
+            uint count_;
+        };
+
+        //! Builds the subtree of node from triangles_[begin, end)
+        void BuildNode(uint node, uint begin, uint end, const std::vector<Ogre::Vector3> &centroids, uint depth);
+
+        //! Returns entry distance of a ray into the bounds of a node, or a negative value on a miss
+        static Ogre::Real IntersectNode(const Node &node, const Ogre::Vector3 &origin, const Ogre::Vector3 &inv_dir,
+            Ogre::Real max_distance);
+
+        std::vector<Node> nodes_;
+        std::vector<uint> triangles_;
+        std::vector<Ogre::Vector3> vertices_;
+        std::vector<Ogre::Vector2> texcoords_;
+        std::vector<uint> indices_;
+        std::vector<uint> submeshstartindex_;
+    };
+
+    typedef boost::shared_ptr<MeshBvh> MeshBvhPtr;
+
+    //! Raycast hierarchies of meshes, built on first use
+    /*! \ingroup OgreRenderingModuleClient
+     */
+    class MeshBvhCache
+    {
+    public:
+        MeshBvhCache();
+
+        //! Returns the hierarchy of the mesh of an entity, or null if the mesh isn't loaded
+        /*! The hierarchy is rebuilt if the mesh has been recreated or its geometry has changed. Skinned meshes should
+            not be raycast through the hierarchy, as it holds the bind pose.
+         */
+        MeshBvhPtr GetMeshBvh(Ogre::Entity *entity);
+
+        //! Removes the hierarchies of all meshes
+        void Clear();
+
+        //! Returns number of cached meshes
+        size_t GetNumMeshes() const { return meshes_.size(); }
+
+    private:
+        //! Removes the hierarchies of meshes which no longer exist
+        void Prune();
+
+        struct CachedMesh
+        {
+            MeshBvhPtr bvh_;
+            //! Counts of the geometry the hierarchy was built from, to notice changes of the mesh
+            size_t num_vertices_;
+            size_t num_indices_;
+        };
+
+        //! Hierarchies by mesh resource handle, which Ogre never reuses for another mesh
+        typedef std::map<unsigned long long, CachedMesh> CachedMeshMap;
+        CachedMeshMap meshes_;
+
+        //! Number of hierarchies built since last prune
+        uint builds_since_prune_;
+    };
+
+    //! Raycasts a synthetic scene of prim meshes both by testing all triangles and through hierarchies
+    /*! Needs no renderer or scene. Checks that the methods agree on the hits.
+        \param num_meshes number of meshes in the scene
+        \param num_rays number of rays to cast
+        \return report of the timings
+     */
+    std::string BenchmarkMeshBvh(uint num_meshes, uint num_rays);
+}
+
+#endif
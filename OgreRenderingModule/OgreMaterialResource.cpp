@@ -6,6 +6,7 @@
 #include "OgreRenderingModule.h"
 #include "OgreMaterialUtils.h"
 #include "ResourceHandler.h"
+#include "AssetKey.h"
 
 #include <Ogre.h>
 
@@ -34,15 +35,20 @@ namespace OgreRenderer
     
     bool OgreMaterialResource::SetData(Foundation::AssetPtr source)
     {
-        // Remove old material if any
-        RemoveMaterial();
-        references_.clear();
-        original_textures_.clear();
+        OgreMaterialScript script;
+        if (!PrepareScript(source, script))
+        {
+            RemoveMaterial();
+            references_.clear();
+            original_textures_.clear();
+            return false;
+        }
 
-        Ogre::MaterialManager& matmgr = Ogre::MaterialManager::getSingleton(); 
+        return SetScript(script);
+    }
 
-        OgreRenderingModule::LogDebug("Parsing material " + source->GetId());
-        
+    bool OgreMaterialResource::PrepareScript(Foundation::AssetPtr source, OgreMaterialScript& script)
+    {
         if (!source)
         {
             OgreRenderingModule::LogError("Null source asset data pointer");
@@ -54,12 +60,15 @@ namespace OgreRenderer
             return false;
         }
 
+        OgreRenderingModule::LogDebug("Parsing material " + source->GetId());
+
         Ogre::DataStreamPtr data = Ogre::DataStreamPtr(new Ogre::MemoryDataStream(const_cast<u8 *>(source->GetData()), source->GetSize()));
 
-        static int tempname_count = 0;
-        tempname_count++;
-        std::string tempname = "TempMat" + ToString<int>(tempname_count);
-        
+        // Named after the asset, so that scripts prepared in different threads do not share a counter
+        script.temp_name_ = "TempMat" + Foundation::AssetKey(source->GetId()).ToHexString();
+        script.references_.clear();
+        script.textures_.clear();
+
         try
         {
             int num_materials = 0;
@@ -85,7 +94,7 @@ namespace OgreRenderer
                         {
                             if (num_materials == 0)
                             {
-                                line = "material " + tempname;
+                                line = "material " + script.temp_name_;
                                 ++num_materials;
                             }
                             else
@@ -102,8 +111,8 @@ namespace OgreRenderer
                                 std::string tex_name = line.substr(8);
                                 // Note: we assume all texture references are asset based. ResourceHandler checks later whether this is true,
                                 // before requesting the reference
-                                references_.push_back(Foundation::ResourceReference(tex_name, OgreTextureResource::GetTypeStatic()));
-                                original_textures_.push_back(tex_name);
+                                script.references_.push_back(Foundation::ResourceReference(tex_name, OgreTextureResource::GetTypeStatic()));
+                                script.textures_.push_back(tex_name);
                             }
                         }
 
@@ -122,7 +131,29 @@ namespace OgreRenderer
                 }
             }
 
-            std::string output_str = output.str();
+            script.script_ = output.str();
+        } catch (Ogre::Exception &e)
+        {
+            OgreRenderingModule::LogWarning(e.what());
+            OgreRenderingModule::LogWarning("Failed to parse Ogre material " + source->GetId() + ".");
+            return false;
+        }
+        return true;
+    }
+
+    bool OgreMaterialResource::SetScript(const OgreMaterialScript& script)
+    {
+        // Remove old material if any
+        RemoveMaterial();
+        references_ = script.references_;
+        original_textures_ = script.textures_;
+
+        Ogre::MaterialManager& matmgr = Ogre::MaterialManager::getSingleton(); 
+        const std::string& tempname = script.temp_name_;
+        
+        try
+        {
+            std::string output_str = script.script_;
             Ogre::DataStreamPtr modified_data = Ogre::DataStreamPtr(new Ogre::MemoryDataStream((u8 *)(&output_str[0]), output_str.size()));
 
             matmgr.parseScript(modified_data, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
@@ -131,7 +162,7 @@ namespace OgreRenderer
             if (tempmat.isNull())
             {
                 OgreRenderingModule::LogWarning(std::string("Failed to create an Ogre material from material asset ") +
-                    source->GetId());
+                    id_);
 
                 return false;
             }
@@ -176,7 +207,7 @@ namespace OgreRenderer
         } catch (Ogre::Exception &e)
         {
             OgreRenderingModule::LogWarning(e.what());
-            OgreRenderingModule::LogWarning("Failed to parse Ogre material " + source->GetId() + ".");
+            OgreRenderingModule::LogWarning("Failed to parse Ogre material " + id_ + ".");
             try
             {
                 if (!matmgr.getByName(tempname).isNull())
@@ -14,6 +14,19 @@ namespace OgreRenderer
     class OgreMaterialResource;
     typedef boost::shared_ptr<OgreMaterialResource> OgreMaterialResourcePtr;
 
+    //! A material script prepared for Ogre, see OgreMaterialResource::PrepareScript
+    struct OgreMaterialScript
+    {
+        //! Script text, with the material renamed to temp_name_
+        std::string script_;
+        //! Temporary material name used while parsing the script
+        std::string temp_name_;
+        //! Texture references of the material
+        Foundation::ResourceReferenceVector references_;
+        //! Original texture names
+        StringVector textures_;
+    };
+
     //! An Ogre-specific material script resource
     /*! \ingroup OgreRenderingModuleClient
      */
@@ -51,6 +64,19 @@ namespace OgreRenderer
         */
         bool SetData(Foundation::AssetPtr source);
 
+        //! sets contents from a prepared material script
+        /*! \param script script prepared from the material asset data
+            \return true if successful
+        */
+        bool SetScript(const OgreMaterialScript& script);
+
+        //! prepares material asset data for parsing. Uses no Ogre managers, so may be called from any thread
+        /*! \param source asset data of the material
+            \param script prepared script
+            \return true if successful
+        */
+        static bool PrepareScript(Foundation::AssetPtr source, OgreMaterialScript& script);
+
         //! sets to contain an external material pointer
         void SetMaterial(Ogre::MaterialPtr material);
 
@@ -15,6 +15,7 @@
 #include "EC_OgreAnimationController.h"
 #include "EC_OgreEnvironment.h"
 #include "EC_OgreCamera.h"
+#include "MeshBvh.h"
 
 #include "InputEvents.h"
 #include "SceneEvents.h"
@@ -110,6 +111,9 @@ namespace OgreRenderer
         RegisterConsoleCommand(Console::CreateCommand(
                 "RenderStats", "Prints out render statistics.", 
                 Console::Bind(this, &OgreRenderingModule::ConsoleStats)));
+        RegisterConsoleCommand(Console::CreateCommand(
+                "RaycastBenchmark", "Raycasts a synthetic scene of prim meshes, with and without the mesh hierarchies. Usage: RaycastBenchmark(meshes,rays)",
+                Console::Bind(this, &OgreRenderingModule::ConsoleRaycastBenchmark)));
         renderer_settings_ = RendererSettingsPtr(new RendererSettings(framework_));
     }
 
@@ -199,6 +203,25 @@ namespace OgreRenderer
 
         return Console::ResultFailure("No renderer found.");
     }
+
+    Console::CommandResult OgreRenderingModule::ConsoleRaycastBenchmark(const StringVector &params)
+    {
+        uint num_meshes = 2000;
+        uint num_rays = 1000;
+        try
+        {
+            if (params.size() > 0)
+                num_meshes = ParseString<uint>(params[0]);
+            if (params.size() > 1)
+                num_rays = ParseString<uint>(params[1]);
+        }
+        catch (std::exception &)
+        {
+            return Console::ResultFailure("Usage: RaycastBenchmark(meshes,rays)");
+        }
+
+        return Console::ResultSuccess(BenchmarkMeshBvh(num_meshes, num_rays));
+    }
 }
 
 extern "C" void POCO_LIBRARY_API SetProfiler(Foundation::Profiler *profiler);
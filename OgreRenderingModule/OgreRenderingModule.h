@@ -54,6 +54,9 @@ namespace OgreRenderer
         //! callback for console command
         Console::CommandResult ConsoleStats(const StringVector &params);
 
+        //! callback for console command
+        Console::CommandResult ConsoleRaycastBenchmark(const StringVector &params);
+
     private:
         //! Type name of the module.
         static std::string type_name_static_;
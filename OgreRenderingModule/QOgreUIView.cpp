@@ -18,7 +18,8 @@ namespace OgreRenderer
     QOgreUIView::QOgreUIView (QWidget *parent) : 
         QGraphicsView(parent),
         win_(0),
-        view_(0)
+        view_(0),
+        dirty_(false)
     {
         setScene(new QGraphicsScene(this)); // Set parent to scene for qt cleanup
         Initialize_();
@@ -68,13 +69,13 @@ namespace OgreRenderer
     void QOgreUIView::SetWorldView(QOgreWorldView *view) 
     { 
         view_ = view; 
-        connect(scene(), SIGNAL( changed(const QList<QRectF> &) ), this, SLOT( SceneChange() )); 
+        connect(scene(), SIGNAL( changed(const QList<QRectF> &) ), this, SLOT( SceneChange(const QList<QRectF> &) )); 
     }
 
     void QOgreUIView::SetScene(QGraphicsScene *new_scene)
     {
         setScene(new_scene);
-        QObject::connect(scene(), SIGNAL( changed (const QList<QRectF> &) ), this, SLOT( SceneChange() ));   
+        QObject::connect(scene(), SIGNAL( changed (const QList<QRectF> &) ), this, SLOT( SceneChange(const QList<QRectF> &) ));   
     }
 
     void QOgreUIView::InitializeWorldView(int width, int height)
@@ -220,8 +221,26 @@ namespace OgreRenderer
             scene()->setSceneRect(viewport()->rect());          
     }
 
-    void QOgreUIView::SceneChange()
+    void QOgreUIView::setDirty(bool dirty)
     {
-        setDirty(true);
+        dirty_ = dirty;
+        if (dirty)
+            dirty_region_ = QRegion(viewport()->rect());
+        else
+            dirty_region_ = QRegion();
+    }
+
+    void QOgreUIView::SceneChange(const QList<QRectF> &rects)
+    {
+        if (rects.isEmpty())
+        {
+            setDirty(true);
+            return;
+        }
+
+        // Grow the rects by a pixel on each side to cover antialiased item edges
+        foreach(const QRectF &rect, rects)
+            dirty_region_ += mapFromScene(rect).boundingRect().adjusted(-1, -1, 1, 1);
+        dirty_ = true;
     }
 }
@@ -11,6 +11,7 @@
 
 #include <QGraphicsView>
 #include <QKeyEvent>
+#include <QRegion>
 
 namespace Foundation { class KeyBindings; }
 
@@ -33,9 +34,13 @@ namespace OgreRenderer
         Ogre::RenderWindow *CreateRenderWindow (const std::string &name, int width, int height, int left, int top, bool fullscreen);
 
     public slots:
-        void setDirty(bool dirty) { dirty_ = dirty; }
+        //! Marks the whole view dirty, or clears the dirty state and region
+        void setDirty(bool dirty);
         bool isDirty() { return dirty_; }
 
+        //! Returns the area of the view, in viewport coordinates, changed since the view was last marked clean
+        const QRegion &GetDirtyRegion() const { return dirty_region_; }
+
         void UpdateKeyBindings(Foundation::KeyBindings *bindings);
 
     protected:
@@ -48,12 +53,13 @@ namespace OgreRenderer
         Ogre::RenderWindow  *win_;
         QOgreWorldView *view_;
         bool dirty_;
+        QRegion dirty_region_;
 
         QList<QKeySequence> python_run_keys_;
         QList<QKeySequence> console_toggle_keys_;
 
     private slots:
-        void SceneChange();
+        void SceneChange(const QList<QRectF> &rects);
 
     signals:
         void ConsoleToggleRequest();
@@ -20,7 +20,7 @@ namespace OgreRenderer
         // set up off-screen texture
         Ogre::TexturePtr ui_overlay_texture_ = Ogre::TextureManager::getSingleton().createManual(
             texture_name_, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-            Ogre::TEX_TYPE_2D, width, height, 0, Ogre::PF_A8R8G8B8, Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+            Ogre::TEX_TYPE_2D, width, height, 0, Ogre::PF_A8R8G8B8, Ogre::TU_DYNAMIC_WRITE_ONLY);
 
         Ogre::MaterialPtr material(Ogre::MaterialManager::getSingleton().create(
             "test/material/UI", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME));
@@ -104,6 +104,25 @@ namespace OgreRenderer
         texture->getBuffer()->blitFromMemory(ui);
     }
 
+    void QOgreWorldView::OverlayUI(Ogre::PixelBox &ui, const std::vector<Ogre::Box> &boxes)
+    {
+        PROFILE(QOgreWorldView_OverlayUI);
+        Ogre::TextureManager &mgr = Ogre::TextureManager::getSingleton();
+        Ogre::TexturePtr texture = mgr.getByName(texture_name_);
+        assert(texture.get());
+
+        // While a resize is pending the texture and image sizes differ, then the whole image is scaled into the texture
+        Ogre::HardwarePixelBufferSharedPtr buffer = texture->getBuffer();
+        if (buffer->getWidth() != ui.getWidth() || buffer->getHeight() != ui.getHeight())
+        {
+            buffer->blitFromMemory(ui);
+            return;
+        }
+
+        for(uint i = 0; i < boxes.size(); ++i)
+            buffer->blitFromMemory(ui.getSubVolume(boxes[i]), boxes[i]);
+    }
+
     void QOgreWorldView::ShowUiOverlay()
     {
         ui_overlay_->show();
@@ -4,6 +4,7 @@
 #define incl_OgreRenderer_QOgreWorldView_h
 
 #include <string>
+#include <vector>
 
 namespace Ogre
 {
@@ -13,6 +14,7 @@ namespace Ogre
     class Overlay;
     class OverlayElement;
     class PixelBox;
+    struct Box;
 }
 
 namespace OgreRenderer
@@ -31,6 +33,12 @@ namespace OgreRenderer
         void RenderOneFrame();
         void OverlayUI(Ogre::PixelBox &ui);
 
+        //! Uploads only the given boxes of the UI image into the overlay texture
+        /*! \param ui UI image, same size as the overlay texture
+            \param boxes changed areas of the image
+         */
+        void OverlayUI(Ogre::PixelBox &ui, const std::vector<Ogre::Box> &boxes);
+
         void ShowUiOverlay();
         void HideUiOverlay();
 
@@ -13,6 +13,7 @@
 #include "EC_OgreMovableTextOverlay.h"
 #include "QOgreUIView.h"
 #include "QOgreWorldView.h"
+#include "MeshBvh.h"
 
 #include "SceneEvents.h"
 #include "ConfigurationManager.h"
@@ -42,6 +43,9 @@ using namespace Foundation;
 
 namespace OgreRenderer
 {
+    //! Max. number of separately repainted and uploaded UI rectangles per frame, more are merged to their bounding rect
+    const int cMaxUiDirtyRects = 16;
+
     //! Ogre renderable listener to find out visible objects for each frame
     class RenderableListener : public Ogre::RenderQueue::RenderableListener
     {
@@ -131,6 +135,9 @@ namespace OgreRenderer
         last_width_(0),
         last_height_(0),
         resized_dirty_(0),
+        ui_pixels_updated_(0),
+        ui_rects_updated_(0),
+        mesh_bvh_cache_(new MeshBvhCache()),
         view_distance_(500.0)
     {
         InitializeQt();
@@ -511,27 +518,61 @@ namespace OgreRenderer
             resized_dirty_ = 2;
         }
 
+        ui_pixels_updated_ = 0;
+        ui_rects_updated_ = 0;
+
         if (q_ogre_ui_view_->isDirty() || resized_dirty_)
         {
             PROFILE(Renderer_Render_QtBlit);
 
             QSize viewsize(q_ogre_ui_view_-> viewport()-> size());
             QRect viewrect(QPoint(0, 0), viewsize);
+            QRegion dirty = q_ogre_ui_view_->GetDirtyRegion() & viewrect;
 
             // Compositing back buffer
             if (backBuffer.width() != viewsize.width() || backBuffer.height() != viewsize.height() || backBuffer.format() != QImage::Format_ARGB32_Premultiplied)
+            {
                 backBuffer = QImage(viewsize, QImage::Format_ARGB32_Premultiplied);
-            backBuffer.fill(Qt::transparent);
+                dirty = viewrect;
+            }
+            if (resized_dirty_)
+                dirty = viewrect;
+
+            // Many small rects cost more in paint and upload calls than their bounding rect
+            QVector<QRect> rects = dirty.rects();
+            if (rects.size() > cMaxUiDirtyRects)
+            {
+                dirty = dirty.boundingRect();
+                rects = dirty.rects();
+            }
 
-            // Paint ui view into buffer
-            QPainter painter(&backBuffer);
-            q_ogre_ui_view_->viewport()->render(&painter, QPoint(0,0), QRegion(viewrect), QWidget::DrawChildren);
+            if (!rects.isEmpty())
+            {
+                // Clear the changed area and paint ui view into it. render() places the top-left corner of the source
+                // region's bounding rect at the target offset, so pass that to paint the region in place.
+                QPainter painter(&backBuffer);
+                painter.setCompositionMode(QPainter::CompositionMode_Source);
+                foreach(const QRect &rect, rects)
+                    painter.fillRect(rect, Qt::transparent);
+                painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+                q_ogre_ui_view_->viewport()->render(&painter, dirty.boundingRect().topLeft(), dirty, QWidget::DrawChildren);
+                painter.end();
+
+                // Blit changed areas of ogre view into buffer
+                std::vector<Ogre::Box> boxes;
+                boxes.reserve(rects.size());
+                foreach(const QRect &rect, rects)
+                {
+                    boxes.push_back(Ogre::Box(rect.left(), rect.top(), rect.right() + 1, rect.bottom() + 1));
+                    ui_pixels_updated_ += rect.width() * rect.height();
+                }
+                ui_rects_updated_ = rects.size();
 
-            // Blit ogre view into buffer
-            Ogre::Box bounds(0, 0, viewsize.width(), viewsize.height());
-            Ogre::PixelBox bufbox(bounds, Ogre::PF_A8R8G8B8, (void *)backBuffer.bits());
+                Ogre::Box bounds(0, 0, viewsize.width(), viewsize.height());
+                Ogre::PixelBox bufbox(bounds, Ogre::PF_A8R8G8B8, (void *)backBuffer.bits());
 
-            q_ogre_world_view_->OverlayUI(bufbox);
+                q_ogre_world_view_->OverlayUI(bufbox, boxes);
+            }
             if (resized_dirty_ > 0)
                 resized_dirty_--;
         }
@@ -558,144 +599,6 @@ namespace OgreRenderer
         return 0; // should never happen
     }
 
-    // Get the mesh information for the given mesh. Version which supports animation
-    // Adapted from http://www.ogre3d.org/wiki/index.php/Raycasting_to_the_polygon_level
-    void GetMeshInformation(
-        Ogre::Entity *entity,
-        std::vector<Ogre::Vector3>& vertices,
-        std::vector<Ogre::Vector2>& texcoords,
-        std::vector<uint>& indices,
-        std::vector<uint>& submeshstartindex,
-        const Ogre::Vector3 &position,
-        const Ogre::Quaternion &orient,
-        const Ogre::Vector3 &scale)
-    {
-        bool added_shared = false;
-        size_t current_offset = 0;
-        size_t shared_offset = 0;
-        size_t next_offset = 0;
-        size_t index_offset = 0;
-        size_t vertex_count = 0;
-        size_t index_count = 0;
-        Ogre::MeshPtr mesh = entity->getMesh();
-
-        bool useSoftwareBlendingVertices = entity->hasSkeleton();
-        if (useSoftwareBlendingVertices)
-            entity->_updateAnimation();
-
-        submeshstartindex.resize(mesh->getNumSubMeshes());
-
-        // Calculate how many vertices and indices we're going to need
-        for(unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
-        {
-            Ogre::SubMesh* submesh = mesh->getSubMesh( i );
-            // We only need to add the shared vertices once
-            if (submesh->useSharedVertices)
-            {
-                if (!added_shared)
-                {
-                    vertex_count += mesh->sharedVertexData->vertexCount;
-                    added_shared = true;
-                }
-            }
-            else
-            {
-                vertex_count += submesh->vertexData->vertexCount;
-            }
-
-            // Add the indices
-            submeshstartindex[i] = index_count;
-            index_count += submesh->indexData->indexCount;
-        }
-
-        // Allocate space for the vertices and indices
-        vertices.resize(vertex_count);
-        texcoords.resize(vertex_count);
-        indices.resize(index_count);
-
-        added_shared = false;
-
-        // Run through the submeshes again, adding the data into the arrays
-        for(unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
-        {
-            Ogre::SubMesh* submesh = mesh->getSubMesh(i);
-
-            // Get vertex data
-            //Ogre::VertexData* vertex_data = submesh->useSharedVertices ? mesh->sharedVertexData : submesh->vertexData;
-            Ogre::VertexData* vertex_data;
-
-            //When there is animation:
-            if (useSoftwareBlendingVertices)
-                vertex_data = submesh->useSharedVertices ? entity->_getSkelAnimVertexData() : entity->getSubEntity(i)->_getSkelAnimVertexData();
-            else
-                vertex_data = submesh->useSharedVertices ? mesh->sharedVertexData : submesh->vertexData;
-
-            if ((!submesh->useSharedVertices)||(submesh->useSharedVertices && !added_shared))
-            {
-                if(submesh->useSharedVertices)
-                {
-                    added_shared = true;
-                    shared_offset = current_offset;
-                }
-
-                const Ogre::VertexElement* posElem =
-                    vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
-                const Ogre::VertexElement *texElem = 
-                    vertex_data->vertexDeclaration->findElementBySemantic(Ogre::VES_TEXTURE_COORDINATES);
-
-                Ogre::HardwareVertexBufferSharedPtr vbuf =
-                    vertex_data->vertexBufferBinding->getBuffer(posElem->getSource());
-
-                unsigned char* vertex =
-                    static_cast<unsigned char*>(vbuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
-
-                // There is _no_ baseVertexPointerToElement() which takes an Ogre::Real or a double
-                //  as second argument. So make it float, to avoid trouble when Ogre::Real will
-                //  be comiled/typedefed as double:
-                //      Ogre::Real* pReal;
-                float* pReal = 0;
-
-                for(size_t j = 0; j < vertex_data->vertexCount; ++j, vertex += vbuf->getVertexSize())
-                {
-                    posElem->baseVertexPointerToElement(vertex, &pReal);
-
-                    Ogre::Vector3 pt(pReal[0], pReal[1], pReal[2]);
-
-                    vertices[current_offset + j] = (orient * (pt * scale)) + position;
-                    if (texElem)
-                    {
-                        texElem->baseVertexPointerToElement(vertex, &pReal);
-                        texcoords[current_offset + j] = Ogre::Vector2(pReal[0], pReal[1]);
-                    }
-                    else
-                        texcoords[current_offset + j] = Ogre::Vector2(0.0f, 0.0f);
-                }
-
-                vbuf->unlock();
-                next_offset += vertex_data->vertexCount;
-            }
-
-            Ogre::IndexData* index_data = submesh->indexData;
-            size_t numTris = index_data->indexCount / 3;
-            Ogre::HardwareIndexBufferSharedPtr ibuf = index_data->indexBuffer;
-
-            unsigned long*  pLong = static_cast<unsigned long*>(ibuf->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
-            unsigned short* pShort = reinterpret_cast<unsigned short*>(pLong);
-            size_t offset = (submesh->useSharedVertices)? shared_offset : current_offset;
-
-            bool use32bitindexes = (ibuf->getType() == Ogre::HardwareIndexBuffer::IT_32BIT);
-            if (use32bitindexes)
-                for(size_t k = 0; k < numTris*3; ++k)
-                    indices[index_offset++] = pLong[k] + static_cast<uint>(offset);
-            else
-                for(size_t k = 0; k < numTris*3; ++k)
-                    indices[index_offset++] = static_cast<uint>(pShort[k]) + static_cast<unsigned long>(offset);
-
-            ibuf->unlock();
-            current_offset = next_offset;
-        }
-    }
-
     Ogre::Vector2 FindUVs(
         const Ogre::Ray& ray,
         float distance,
@@ -831,40 +734,85 @@ namespace OgreRenderer
             {
                 Ogre::Entity* ogre_entity = static_cast<Ogre::Entity*>(entry.movable);
                 assert(ogre_entity != 0);
+                Ogre::Node *node = ogre_entity->getParentNode();
+
+                bool hit = false;
+                Ogre::Real distance = 0.0f;
+                Ogre::Vector2 uv(0.0f, 0.0f);
+                uint submesh = 0;
 
-                // get the mesh information
-                GetMeshInformation(ogre_entity, vertices, texcoords, indices, submeshstartindex,
-                    ogre_entity->getParentNode()->_getDerivedPosition(),
-                    ogre_entity->getParentNode()->_getDerivedOrientation(),
-                    ogre_entity->getParentNode()->_getDerivedScale());
+                // Skinned meshes deform every frame, so their triangles are read in the current pose for each raycast.
+                // Others are tested through a hierarchy cached in object space.
+                MeshBvhPtr bvh;
+                if (!ogre_entity->hasSkeleton())
+                    bvh = mesh_bvh_cache_->GetMeshBvh(ogre_entity);
 
-                // test for hitting individual triangles on the mesh
-                for (int j = 0; j < ((int)indices.size())-2; j += 3)
+                if (bvh)
                 {
-                    // check for a hit against this triangle
-                    std::pair<bool, Ogre::Real> hit = Ogre::Math::intersects(ray, vertices[indices[j]],
-                        vertices[indices[j+1]], vertices[indices[j+2]], true, false);
-                    if (hit.first)
+                    const Ogre::Vector3 &scale = node->_getDerivedScale();
+                    if (scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f)
+                        continue;
+
+                    // The object space direction is not normalized, so that distances along both rays are the same
+                    Ogre::Quaternion inv_orientation = node->_getDerivedOrientation().Inverse();
+                    Ogre::Ray object_ray((inv_orientation * (ray.getOrigin() - node->_getDerivedPosition())) / scale,
+                        (inv_orientation * ray.getDirection()) / scale);
+
+                    // Mirroring scale flips the facing of the triangles
+                    bool mirrored = scale.x * scale.y * scale.z < 0.0f;
+
+                    uint triangle = 0;
+                    hit = bvh->Raycast(object_ray, !mirrored, mirrored, distance, triangle);
+                    if (hit)
                     {
-                        if ((closest_distance < 0.0f) || (hit.second < closest_distance) || (current_priority > closest_priority))
+                        uv = bvh->GetUV(triangle, object_ray.getPoint(distance));
+                        submesh = bvh->GetSubmesh(triangle);
+                    }
+                }
+                else
+                {
+                    // get the mesh information
+                    GetMeshInformation(ogre_entity, vertices, texcoords, indices, submeshstartindex,
+                        node->_getDerivedPosition(), node->_getDerivedOrientation(), node->_getDerivedScale());
+
+                    // test for hitting individual triangles on the mesh
+                    int found = -1;
+                    for (int j = 0; j < ((int)indices.size())-2; j += 3)
+                    {
+                        // check for a hit against this triangle
+                        std::pair<bool, Ogre::Real> tri_hit = Ogre::Math::intersects(ray, vertices[indices[j]],
+                            vertices[indices[j+1]], vertices[indices[j+2]], true, false);
+                        if (tri_hit.first && (found < 0 || tri_hit.second < distance))
                         {
-                            if (current_priority >= closest_priority)
-                            {
-                                // this is the closest/best so far, save it
-                                closest_distance = hit.second;
-                                closest_priority = current_priority;
-
-                                Ogre::Vector2 uv = FindUVs(ray, hit.second, vertices, texcoords, indices, j); 
-                                Ogre::Vector3 point = ray.getPoint(closest_distance);
-
-                                result.entity_ = entity;
-                                result.pos_ = Vector3df(point.x, point.y, point.z);
-                                result.submesh_ = GetSubmeshFromIndexRange(j, submeshstartindex);
-                                result.u_ = uv.x;
-                                result.v_ = uv.y;
-                            }
+                            distance = tri_hit.second;
+                            found = j;
                         }
                     }
+
+                    if (found >= 0)
+                    {
+                        hit = true;
+                        uv = FindUVs(ray, distance, vertices, texcoords, indices, found);
+                        submesh = GetSubmeshFromIndexRange(found, submeshstartindex);
+                    }
+                }
+
+                if (hit && ((closest_distance < 0.0f) || (distance < closest_distance) || (current_priority > closest_priority)))
+                {
+                    if (current_priority >= closest_priority)
+                    {
+                        // this is the closest/best so far, save it
+                        closest_distance = distance;
+                        closest_priority = current_priority;
+
+                        Ogre::Vector3 point = ray.getPoint(closest_distance);
+
+                        result.entity_ = entity;
+                        result.pos_ = Vector3df(point.x, point.y, point.z);
+                        result.submesh_ = submesh;
+                        result.u_ = uv.x;
+                        result.v_ = uv.y;
+                    }
                 }
             }
             else
@@ -44,11 +44,13 @@ namespace OgreRenderer
     class RenderableListener;
     class QOgreUIView;
     class QOgreWorldView;
+    class MeshBvhCache;
 
     typedef boost::shared_ptr<Ogre::Root> OgreRootPtr;
     typedef boost::shared_ptr<LogListener> OgreLogListenerPtr;
     typedef boost::shared_ptr<ResourceHandler> ResourceHandlerPtr;
     typedef boost::shared_ptr<RenderableListener> RenderableListenerPtr;
+    typedef boost::shared_ptr<MeshBvhCache> MeshBvhCachePtr;
 
     //! Ogre renderer
     /*! Created by OgreRenderingModule. Implements the RenderServiceInterface.
@@ -220,7 +222,7 @@ namespace OgreRenderer
         void PostInitialize();
 
         //! Performs update. Called by OgreRenderingModule
-        /*! Pumps Ogre window events.
+        /*! Pumps Ogre window events, and creates Ogre resources from prepared asset data.
          */
         void Update(f64 frametime);
 
@@ -243,6 +245,12 @@ namespace OgreRenderer
         /// Used to perform alpha-keying based input.
         QImage &GetBackBuffer() { return backBuffer; }
 
+        //! Returns number of UI pixels repainted and uploaded to the overlay texture last frame
+        uint GetUiPixelsUpdated() const { return ui_pixels_updated_; }
+
+        //! Returns number of rectangles the UI pixels of last frame were updated in
+        uint GetUiRectsUpdated() const { return ui_rects_updated_; }
+
     public slots:
         //! Toggles fullscreen
         void SetFullScreen(bool value);
@@ -347,6 +355,13 @@ namespace OgreRenderer
         //! resized dirty count
         int resized_dirty_;
 
+        //! UI pixels and rects repainted and uploaded last frame
+        uint ui_pixels_updated_;
+        uint ui_rects_updated_;
+
+        //! Raycast hierarchies of meshes
+        MeshBvhCachePtr mesh_bvh_cache_;
+
         //! For render function
         QImage ui_buffer_;
         QRect last_view_rect_;
@@ -11,6 +11,7 @@
 #include "OgreSkeletonResource.h"
 #include "ResourceInterface.h"
 #include "ResourceHandler.h"
+#include "ResourcePreparer.h"
 #include "OgreMaterialUtils.h"
 #include "RexTypes.h"
 #include "TextureServiceInterface.h"
@@ -18,12 +19,16 @@
 #include "Framework.h"
 #include "EventManager.h"
 #include "ServiceManager.h"
+#include "ThreadTaskManager.h"
+#include "FrameScheduler.h"
 
+#include <boost/bind.hpp>
 
 namespace OgreRenderer
 {
     ResourceHandler::ResourceHandler(Foundation::Framework* framework) :
-        framework_(framework)
+        framework_(framework),
+        finalize_job_(0)
     {
         source_types_[OgreTextureResource::GetTypeStatic()] = RexTypes::ASSETTYPENAME_TEXTURE;
         source_types_[OgreMeshResource::GetTypeStatic()] = RexTypes::ASSETTYPENAME_MESH;
@@ -46,7 +51,11 @@ namespace OgreRenderer
             }
             ++i;
         }
-                
+
+        if (preparer_)
+            framework_->GetThreadTaskManager()->RemoveThreadTask(preparer_);
+        framework_->GetFrameScheduler()->Cancel(finalize_job_);
+        prepared_resources_.clear();
         resources_.clear();
     }
     
@@ -55,6 +64,12 @@ namespace OgreRenderer
         Foundation::EventManagerPtr event_manager = framework_->GetEventManager();
         
         resource_event_category_ = event_manager->QueryEventCategory("Resource");
+
+        // Create the resource preparer thread task and let the framework thread task manager handle it
+        preparer_ = Foundation::ThreadTaskPtr(new ResourcePreparer());
+        Foundation::ThreadTaskManagerPtr manager = framework_->GetThreadTaskManager();
+        Foundation::thread_task_id_t preparer_id = manager->AddThreadTask(preparer_);
+        manager->RegisterResultHandler<ResourcePrepareResult>(preparer_id, boost::bind(&ResourceHandler::HandlePreparedResources, this, _1));
     }
     
     Foundation::ResourcePtr ResourceHandler::GetResource(const std::string& id, const std::string& type)
@@ -151,14 +166,10 @@ namespace OgreRenderer
                 if (expected_request_tags_.find(event_data->tag_) == expected_request_tags_.end())
                     return false;
 
-                if (event_data->asset_type_ == RexTypes::ASSETTYPENAME_MESH)
-                    UpdateMesh(event_data->asset_, event_data->tag_);
-
-                if (event_data->asset_type_ == RexTypes::ASSETTYPENAME_SKELETON)
-                    UpdateSkeleton(event_data->asset_, event_data->tag_);
-
-                if (event_data->asset_type_ == RexTypes::ASSETTYPENAME_MATERIAL_SCRIPT)
-                    UpdateMaterial(event_data->asset_, event_data->tag_);
+                if ((event_data->asset_type_ == RexTypes::ASSETTYPENAME_MESH) ||
+                    (event_data->asset_type_ == RexTypes::ASSETTYPENAME_SKELETON) ||
+                    (event_data->asset_type_ == RexTypes::ASSETTYPENAME_MATERIAL_SCRIPT))
+                    PrepareResource(event_data->asset_, event_data->asset_type_, event_data->tag_);
 
                 if (event_data->asset_type_ == RexTypes::ASSETTYPENAME_PARTICLE_SCRIPT)
                     UpdateParticles(event_data->asset_, event_data->tag_);
@@ -172,13 +183,13 @@ namespace OgreRenderer
             {
                 Asset::Events::AssetCanceled *event_data = checked_static_cast<Asset::Events::AssetCanceled*>(data);
                 // Send a RESOURCE_CANCELED event for each request that was made for this asset, then clear the tags
-                const RequestTagVector& tags = request_tags_[event_data->asset_id_];
+                RequestTagVector tags;
+                TakeRequestTags(Foundation::AssetKey(event_data->asset_id_), tags);
                 for (uint i = 0; i < tags.size(); ++i)
                 {
                     Resource::Events::ResourceCanceled canceled_event_data(event_data->asset_id_, tags[i]);
                     framework_->GetEventManager()->SendEvent(resource_event_category_, Resource::Events::RESOURCE_CANCELED, &canceled_event_data);
                 }
-                request_tags_.erase(event_data->asset_id_);
                 
                 // Check if the asset matches outstanding resource references
                 std::map<std::string, Foundation::ResourceReferenceVector>::iterator i = outstanding_references_.begin();
@@ -225,6 +236,101 @@ namespace OgreRenderer
         return false;
     }
 
+    void ResourceHandler::HandlePreparedResources(const std::vector<ResourcePrepareResultPtr>& results)
+    {
+        for (uint i = 0; i < results.size(); ++i)
+        {
+            // Request the referred assets now, so that they download while the resource waits for its turn to be created
+            if (results[i]->success_)
+                RequestPreparedReferences(results[i]->references_);
+
+            prepared_resources_.push_back(results[i]);
+        }
+
+        Foundation::FrameSchedulerPtr scheduler = framework_->GetFrameScheduler();
+        if (!scheduler->IsScheduled(finalize_job_))
+        {
+            finalize_job_ = scheduler->Schedule("ResourceHandler_FinalizeResources",
+                boost::bind(&ResourceHandler::FinalizeResources, this, _1));
+        }
+    }
+
+    bool ResourceHandler::FinalizeResources(const Foundation::FrameBudget& budget)
+    {
+        PROFILE(ResourceHandler_FinalizeResources);
+
+        // Always create at least one resource per slice, so that a small budget can not stall loading
+        while (!prepared_resources_.empty())
+        {
+            ResourcePrepareResultPtr prepared = prepared_resources_.front();
+            prepared_resources_.pop_front();
+            FinalizeResource(prepared);
+
+            if (budget.IsExceeded())
+                break;
+        }
+
+        return !prepared_resources_.empty();
+    }
+
+    void ResourceHandler::PrepareResource(Foundation::AssetPtr source, const std::string& asset_type, request_tag_t tag)
+    {
+        expected_request_tags_.erase(tag);
+        if (!source)
+            return;
+
+        // If the resource already has valid data, there is nothing to prepare
+        Foundation::ResourceMap::iterator i = resources_.find(source->GetId());
+        if ((!preparer_) || ((i != resources_.end()) && (i->second->IsValid())))
+        {
+            if (asset_type == RexTypes::ASSETTYPENAME_MESH)
+                UpdateMesh(source);
+            else if (asset_type == RexTypes::ASSETTYPENAME_SKELETON)
+                UpdateSkeleton(source);
+            else if (asset_type == RexTypes::ASSETTYPENAME_MATERIAL_SCRIPT)
+                UpdateMaterial(source);
+            return;
+        }
+
+        ResourcePrepareRequestPtr request(new ResourcePrepareRequest());
+        request->asset_ = source;
+        request->asset_type_ = asset_type;
+        preparer_->AddRequest<ResourcePrepareRequest>(request);
+    }
+
+    void ResourceHandler::RequestPreparedReferences(const Foundation::ResourceReferenceVector& references)
+    {
+        boost::shared_ptr<Foundation::AssetServiceInterface> asset_service =
+            framework_->GetServiceManager()->GetService<Foundation::AssetServiceInterface>(Foundation::Service::ST_Asset).lock();
+        if (!asset_service)
+            return;
+
+        for (uint i = 0; i < references.size(); ++i)
+        {
+            // Mesh and material scripts may also refer to resources by names that are not assets
+            if (!asset_service->IsValidId(references[i].id_, references[i].type_))
+                continue;
+            Foundation::ResourcePtr res = GetResourceInternal(references[i].id_, references[i].type_);
+            if ((res) && (res->IsValid()))
+                continue;
+            if (request_tags_.find(Foundation::AssetKey(references[i].id_)) != request_tags_.end())
+                continue;
+
+            RequestResource(references[i].id_, references[i].type_);
+        }
+    }
+
+    void ResourceHandler::FinalizeResource(ResourcePrepareResultPtr prepared)
+    {
+        if (prepared->asset_type_ == RexTypes::ASSETTYPENAME_MESH)
+            UpdateMesh(prepared->asset_);
+        else if (prepared->asset_type_ == RexTypes::ASSETTYPENAME_SKELETON)
+            UpdateSkeleton(prepared->asset_);
+        // A material script that failed to prepare has already been reported
+        else if ((prepared->asset_type_ == RexTypes::ASSETTYPENAME_MATERIAL_SCRIPT) && (prepared->success_))
+            UpdateMaterial(prepared->asset_, &prepared->material_script_);
+    }
+
     request_tag_t ResourceHandler::RequestTexture(const std::string& id)
     {
         request_tag_t tag = framework_->GetEventManager()->GetNextRequestTag();
@@ -273,19 +379,20 @@ namespace OgreRenderer
         if (texture_service)
         {
             // Perform the actual decode request only once, for the first request
-            if (request_tags_.find(id) == request_tags_.end())
+            Foundation::AssetKey key(id);
+            if (request_tags_.find(key) == request_tags_.end())
             {
                 request_tag_t source_tag = texture_service->RequestTexture(id);
                 if (source_tag)
                 {
                     expected_request_tags_.insert(source_tag);
-                    request_tags_[id].push_back(tag); 
+                    request_tags_[key].push_back(tag); 
                     return tag;
                 }
             }
             else
             {
-                request_tags_[id].push_back(tag); 
+                request_tags_[key].push_back(tag); 
                 return tag;
             }
         }
@@ -306,9 +413,19 @@ namespace OgreRenderer
             tex = Foundation::ResourcePtr(new OgreTextureResource(source_tex->GetId()));
         }
 
-        // If highest level, erase texture decode request tag (should not get more raw resource events for this texture)
+        // If highest level, erase texture decode request tag and take the request tags (should not get more raw resource events for this texture)
+        RequestTagVector tags;
         if (source_tex->GetLevel() == 0)
+        {
             expected_request_tags_.erase(tag);
+            TakeRequestTags(Foundation::AssetKey(source_tex->GetId()), tags);
+        }
+        else
+        {
+            RequestTagMap::const_iterator i = request_tags_.find(Foundation::AssetKey(source_tex->GetId()));
+            if (i != request_tags_.end())
+                tags = i->second;
+        }
 
         // If success, send Ogre resource ready event
         bool success = false;
@@ -319,7 +436,6 @@ namespace OgreRenderer
             // Update any legacy materials already created for the texture
             UpdateLegacyMaterials(source_tex->GetId());
             
-            const RequestTagVector& tags = request_tags_[source_tex->GetId()];
             for (uint i = 0; i < tags.size(); ++i)
             {
                 Resource::Events::ResourceReady event_data(tex->GetId(), tex, tags[i]);
@@ -329,10 +445,6 @@ namespace OgreRenderer
             success = true;
         }
 
-        // If highest level, erase also request tags 
-        if (source_tex->GetLevel() == 0)
-            request_tags_.erase(source_tex->GetId());
-
         return success;
     }    
 
@@ -358,19 +470,20 @@ namespace OgreRenderer
         if (asset_service)
         {
             // Perform the actual asset request only once, for the first request
-            if (request_tags_.find(id) == request_tags_.end())
+            Foundation::AssetKey key(id);
+            if (request_tags_.find(key) == request_tags_.end())
             {
                 request_tag_t source_tag = asset_service->RequestAsset(id, source_types_[type]);
                 if (source_tag) 
                 {
-                    request_tags_[id].push_back(tag);
+                    request_tags_[key].push_back(tag);
                     expected_request_tags_.insert(source_tag);
                     return tag;
                 }
             }
             else
             {
-                request_tags_[id].push_back(tag); 
+                request_tags_[key].push_back(tag); 
                 return tag;
             }
         }
@@ -378,10 +491,8 @@ namespace OgreRenderer
         return 0;
     }
 
-    bool ResourceHandler::UpdateMesh(Foundation::AssetPtr source, request_tag_t tag)
+    bool ResourceHandler::UpdateMesh(Foundation::AssetPtr source)
     {    
-        expected_request_tags_.erase(tag);
-            
         // If not found, prepare new
         Foundation::ResourcePtr mesh = GetResourceInternal(source->GetId(), OgreMeshResource::GetTypeStatic());
         if (!mesh)
@@ -430,10 +541,8 @@ namespace OgreRenderer
         return success;
     }
 
-    bool ResourceHandler::UpdateMaterial(Foundation::AssetPtr source, request_tag_t tag)
+    bool ResourceHandler::UpdateMaterial(Foundation::AssetPtr source, const OgreMaterialScript* prepared)
     {    
-        expected_request_tags_.erase(tag);
-            
         // If not found, prepare new
         Foundation::ResourcePtr material = GetResourceInternal(source->GetId(), OgreMaterialResource::GetTypeStatic());
         if (!material)
@@ -446,7 +555,7 @@ namespace OgreRenderer
 
         // If data successfully set, or already have valid data, success; check resource references if any
         StringVector tex_names;
-        if ((material_res->IsValid()) || (material_res->SetData(source)))
+        if ((material_res->IsValid()) || (prepared ? material_res->SetScript(*prepared) : material_res->SetData(source)))
         {
             resources_[source->GetId()] = material;
             ProcessResourceReferences(material);
@@ -484,10 +593,8 @@ namespace OgreRenderer
         return success;
     }
     
-    bool ResourceHandler::UpdateSkeleton(Foundation::AssetPtr source, request_tag_t tag)
+    bool ResourceHandler::UpdateSkeleton(Foundation::AssetPtr source)
     {    
-        expected_request_tags_.erase(tag);
-            
         // If not found, prepare new
         Foundation::ResourcePtr skeleton = GetResourceInternal(source->GetId(), OgreSkeletonResource::GetTypeStatic());
         if (!skeleton)
@@ -545,13 +652,13 @@ namespace OgreRenderer
         // If no outstanding references, send RESOURCE_READY
         if (!GetNumOutstandingReferences(resource->GetId()))
         {
-            const RequestTagVector& tags = request_tags_[resource->GetId()];
+            RequestTagVector tags;
+            TakeRequestTags(Foundation::AssetKey(resource->GetId()), tags);
             for (uint i = 0; i < tags.size(); ++i)
             {
                 Resource::Events::ResourceReady event_data(resource->GetId(), resource, tags[i]);
                 framework_->GetEventManager()->SendEvent(resource_event_category_, Resource::Events::RESOURCE_READY, &event_data);
             }
-            request_tags_.erase(resource->GetId());
         }
     }
     
@@ -595,13 +702,13 @@ namespace OgreRenderer
                     if (send_ready)
                     {
                         OgreRenderingModule::LogDebug("Last reference, sending RESOURCE_READY for " + dependent->GetId());
-                        const RequestTagVector& tags = request_tags_[dependent->GetId()];
+                        RequestTagVector tags;
+                        TakeRequestTags(Foundation::AssetKey(dependent->GetId()), tags);
                         for (uint i = 0; i < tags.size(); ++i)
                         {
                             Resource::Events::ResourceReady event_data(dependent->GetId(), dependent, tags[i]);
                             framework_->GetEventManager()->SendEvent(resource_event_category_, Resource::Events::RESOURCE_READY, &event_data);
                         }
-                        request_tags_.erase(dependent->GetId());
                     }
                 }
             }
@@ -610,6 +717,16 @@ namespace OgreRenderer
         }
     }
         
+    void ResourceHandler::TakeRequestTags(const Foundation::AssetKey& key, RequestTagVector& tags)
+    {
+        RequestTagMap::iterator i = request_tags_.find(key);
+        if (i == request_tags_.end())
+            return;
+
+        tags.swap(i->second);
+        request_tags_.erase(i);
+    }
+
     //! Gets number of outstanding (not yet loaded) references for resource
     unsigned ResourceHandler::GetNumOutstandingReferences(const std::string& id)
     {
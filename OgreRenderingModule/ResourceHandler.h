@@ -5,11 +5,24 @@
 
 #include "ResourceInterface.h"
 #include "AssetInterface.h"
+#include "AssetKey.h"
+#include "ThreadTask.h"
+#include "FrameScheduler.h"
 #include "OgreModuleApi.h"
 
+#include <boost/unordered_map.hpp>
+
 namespace OgreRenderer
 {
+    class ResourcePrepareResult;
+    struct OgreMaterialScript;
+    typedef boost::shared_ptr<ResourcePrepareResult> ResourcePrepareResultPtr;
+
     //! Manages Ogre resources & requests for their data from the asset system. Used internally by Renderer.
+    /*! Mesh, skeleton and material assets are first prepared in a ResourcePreparer thread, which also finds the
+        assets they refer to. The referred assets are requested as soon as the prepared data arrives, and the Ogre
+        resources are then created in a frame job of the framework FrameScheduler, within the frame budget.
+     */
     class OGRE_MODULE_API ResourceHandler
     {
     public:
@@ -39,7 +52,7 @@ namespace OgreRenderer
 
         //! Handles a resource event. Called by OgreRenderingModule
         bool HandleResourceEvent(event_id_t event_id, Foundation::EventDataInterface* data);
-        
+
         //! Internal method to parse braces from an Ogre script. Returns true if line contained open/close brace
         static bool ProcessBraces(const std::string& line, int& brace_level);
         
@@ -68,26 +81,41 @@ namespace OgreRenderer
          */
         bool UpdateTexture(Foundation::ResourcePtr source, request_tag_t tag);
 
+        //! Queues a mesh, skeleton or material asset to be prepared in the resource preparer thread
+        /*! If the resource already has valid data, or the thread is not running, updates the resource right away.
+            \param source Asset
+            \param asset_type Asset type
+            \param tag Request tag from asset event
+         */
+        void PrepareResource(Foundation::AssetPtr source, const std::string& asset_type, request_tag_t tag);
+
+        //! Requests the resources referred to by prepared asset data, that are not loaded yet
+        /*! The references are requested again by ProcessResourceReferences once the resource is created. Those
+            requests then join the ones made here, instead of starting new transfers.
+         */
+        void RequestPreparedReferences(const Foundation::ResourceReferenceVector& references);
+
+        //! Creates or updates the resource of prepared asset data
+        void FinalizeResource(ResourcePrepareResultPtr prepared);
+
         //! Creates or updates a mesh, based on source asset data
         /*! \param source Asset
-            \param tag Request tag from asset event
             \return true if successful
          */
-        bool UpdateMesh(Foundation::AssetPtr source, request_tag_t tag); 
+        bool UpdateMesh(Foundation::AssetPtr source); 
 
         //! Creates or updates a skeleton, based on source asset data
         /*! \param source Asset
-            \param tag Request tag from asset event
             \return true if successful
          */
-        bool UpdateSkeleton(Foundation::AssetPtr source, request_tag_t tag); 
+        bool UpdateSkeleton(Foundation::AssetPtr source); 
 
         //! Creates or updates a material, based on source asset data
         /*! \param source The material asset data.
-            \param tag Request tag from raw asset resource event
+            \param prepared Prepared material script, or null to prepare it now
             \return true if successful
          */
-        bool UpdateMaterial(Foundation::AssetPtr source, request_tag_t tag);
+        bool UpdateMaterial(Foundation::AssetPtr source, const OgreMaterialScript* prepared = 0);
 
         //! Creates or updates particle scripts, based on source asset data
         /*! \param source The particle script asset data.
@@ -116,6 +144,13 @@ namespace OgreRenderer
         //! Gets number of outstanding (not yet loaded) references for resource
         unsigned GetNumOutstandingReferences(const std::string& id);
 
+        //! Moves the request tags of a resource out of the request tag map
+        /*! Events sent for the tags may request the same resource again, so the tags are taken out before sending.
+            \param key Key of the resource id
+            \param tags Vector that receives the tags, empty if there were no requests
+         */
+        void TakeRequestTags(const Foundation::AssetKey& key, RequestTagVector& tags);
+
         //! resource event category
         event_category_id_t resource_event_category_;
                 
@@ -126,7 +161,8 @@ namespace OgreRenderer
         std::set<request_tag_t> expected_request_tags_;
         
         //! Map of resource request tags by resource
-        std::map<std::string, RequestTagVector> request_tags_;
+        typedef boost::unordered_map<Foundation::AssetKey, RequestTagVector> RequestTagMap;
+        RequestTagMap request_tags_;
         
         //! Map of source asset types by renderer resource type
         std::map<std::string, std::string> source_types_;
@@ -136,6 +172,23 @@ namespace OgreRenderer
         
         //! Map of outstanding reference requests per resource
         std::map<std::string, Foundation::ResourceReferenceVector> outstanding_references_;
+
+        //! Asset data prepared by the resource preparer thread, waiting for its Ogre resource to be created
+        std::list<ResourcePrepareResultPtr> prepared_resources_;
+
+        //! Resource preparer thread
+        Foundation::ThreadTaskPtr preparer_;
+
+        //! Handles the asset data prepared during a frame. Called by the thread task manager
+        void HandlePreparedResources(const std::vector<ResourcePrepareResultPtr>& results);
+
+        //! Creates Ogre resources from prepared asset data until the frame budget is used. Frame job
+        /*! \return true if prepared data is left for the next frame
+         */
+        bool FinalizeResources(const Foundation::FrameBudget& budget);
+
+        //! Frame job that creates Ogre resources from prepared data, 0 if none
+        Foundation::frame_job_id_t finalize_job_;
         
         //! Framework we belong to
         Foundation::Framework* framework_;
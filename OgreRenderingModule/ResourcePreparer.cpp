@@ -0,0 +1,215 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "ResourcePreparer.h"
+#include "OgreRenderingModule.h"
+#include "OgreMeshResource.h"
+#include "OgreSkeletonResource.h"
+#include "RexTypes.h"
+#include "Profiler.h"
+
+namespace OgreRenderer
+{
+    //! Chunk ids of the Ogre binary mesh and skeleton formats
+    static const u16 OGRE_HEADER_CHUNK = 0x1000;
+    static const u16 OGRE_MESH_CHUNK = 0x3000;
+    static const u16 OGRE_SUBMESH_CHUNK = 0x4000;
+    static const u16 OGRE_SKELETON_LINK_CHUNK = 0x6000;
+    //! Size of a chunk id and length
+    static const uint OGRE_CHUNK_HEADER_SIZE = 6;
+
+    //! Reads the chunks of Ogre binary data, in either byte order
+    class OgreChunkReader
+    {
+    public:
+        OgreChunkReader(const u8* data, uint size) :
+            data_(data),
+            size_(size),
+            position_(0),
+            swap_(false)
+        {
+        }
+
+        //! Reads the file header and detects the byte order
+        bool ReadHeader()
+        {
+            u16 id;
+            if (!ReadU16(id))
+                return false;
+            if (id != OGRE_HEADER_CHUNK)
+            {
+                swap_ = true;
+                if (Swap16(id) != OGRE_HEADER_CHUNK)
+                    return false;
+            }
+
+            std::string version;
+            return ReadString(version);
+        }
+
+        bool ReadU16(u16& value)
+        {
+            if (position_ + sizeof(u16) > size_)
+                return false;
+            memcpy(&value, data_ + position_, sizeof(u16));
+            if (swap_)
+                value = Swap16(value);
+            position_ += sizeof(u16);
+            return true;
+        }
+
+        bool ReadU32(u32& value)
+        {
+            if (position_ + sizeof(u32) > size_)
+                return false;
+            memcpy(&value, data_ + position_, sizeof(u32));
+            if (swap_)
+                value = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+            position_ += sizeof(u32);
+            return true;
+        }
+
+        //! Reads a newline-terminated string
+        bool ReadString(std::string& str)
+        {
+            const u8* begin = data_ + position_;
+            const u8* end = data_ + size_;
+            const u8* newline = std::find(begin, end, '\n');
+            if (newline == end)
+                return false;
+            str.assign((const char*)begin, newline - begin);
+            position_ += (newline - begin) + 1;
+            return true;
+        }
+
+        //! Reads a chunk header. The length includes the header
+        bool ReadChunk(u16& id, uint& start, uint& end)
+        {
+            start = position_;
+            u32 length;
+            if ((!ReadU16(id)) || (!ReadU32(length)))
+                return false;
+            if ((length < OGRE_CHUNK_HEADER_SIZE) || (length > size_ - start))
+                return false;
+            end = start + length;
+            return true;
+        }
+
+        void Skip(uint bytes) { position_ = std::min(position_ + bytes, size_); }
+        void Seek(uint position) { position_ = std::min(position, size_); }
+        uint GetPosition() const { return position_; }
+
+    private:
+        static u16 Swap16(u16 value) { return (u16)((value >> 8) | (value << 8)); }
+
+        const u8* data_;
+        uint size_;
+        uint position_;
+        bool swap_;
+    };
+
+    ResourcePreparer::ResourcePreparer() :
+        Foundation::ThreadTask("ResourcePreparer")
+    {
+    }
+
+    void ResourcePreparer::Work()
+    {
+        while (ShouldRun())
+        {
+            WaitForRequests();
+
+            ResourcePrepareRequestPtr request = GetNextRequest<ResourcePrepareRequest>();
+            if (request)
+            {
+                PROFILE(ResourcePreparer_Prepare);
+                Prepare(request);
+            }
+
+            RESETPROFILER
+        }
+    }
+
+    void ResourcePreparer::Prepare(ResourcePrepareRequestPtr request)
+    {
+        ResourcePrepareResultPtr result(new ResourcePrepareResult());
+        result->asset_ = request->asset_;
+        result->asset_type_ = request->asset_type_;
+
+        Foundation::AssetPtr asset = request->asset_;
+        if (!asset)
+        {
+            QueueResult<ResourcePrepareResult>(result);
+            return;
+        }
+
+        if (request->asset_type_ == RexTypes::ASSETTYPENAME_MATERIAL_SCRIPT)
+        {
+            result->success_ = OgreMaterialResource::PrepareScript(asset, result->material_script_);
+            result->references_ = result->material_script_.references_;
+        }
+        else if (request->asset_type_ == RexTypes::ASSETTYPENAME_MESH)
+        {
+            // A mesh the scan does not understand is still given to Ogre, which reports the actual error
+            StringVector materials;
+            std::string skeleton;
+            if (ReadMeshReferences(asset->GetData(), asset->GetSize(), materials, skeleton))
+            {
+                for(uint i = 0; i < materials.size(); ++i)
+                    result->references_.push_back(Foundation::ResourceReference(materials[i], OgreMaterialResource::GetTypeStatic()));
+                if (!skeleton.empty())
+                    result->references_.push_back(Foundation::ResourceReference(skeleton, OgreSkeletonResource::GetTypeStatic()));
+            }
+            else
+                OgreRenderingModule::LogDebug("Could not read the references of mesh " + asset->GetId());
+            result->success_ = true;
+        }
+        else
+            result->success_ = true;
+
+        QueueResult<ResourcePrepareResult>(result);
+    }
+
+    bool ResourcePreparer::ReadMeshReferences(const u8* data, uint size, StringVector& materials, std::string& skeleton)
+    {
+        materials.clear();
+        skeleton.clear();
+        if (!data)
+            return false;
+
+        OgreChunkReader reader(data, size);
+        if (!reader.ReadHeader())
+            return false;
+
+        u16 id;
+        uint start, end;
+        while (reader.ReadChunk(id, start, end))
+        {
+            if (id == OGRE_MESH_CHUNK)
+            {
+                // Skip the skeletally animated flag, then go through the mesh subchunks
+                reader.Skip(1);
+                u16 sub_id;
+                uint sub_start, sub_end;
+                while ((reader.GetPosition() < end) && (reader.ReadChunk(sub_id, sub_start, sub_end)) && (sub_end <= end))
+                {
+                    std::string name;
+                    if ((sub_id == OGRE_SUBMESH_CHUNK) && (reader.ReadString(name)))
+                    {
+                        if ((!name.empty()) && (std::find(materials.begin(), materials.end(), name) == materials.end()))
+                            materials.push_back(name);
+                    }
+                    else if ((sub_id == OGRE_SKELETON_LINK_CHUNK) && (reader.ReadString(name)))
+                        skeleton = name;
+
+                    reader.Seek(sub_end);
+                }
+                return true;
+            }
+
+            reader.Seek(end);
+        }
+
+        return false;
+    }
+}
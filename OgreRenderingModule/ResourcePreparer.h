@@ -0,0 +1,76 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_OgreRenderer_ResourcePreparer_h
+#define incl_OgreRenderer_ResourcePreparer_h
+
+#include "ThreadTask.h"
+#include "AssetInterface.h"
+#include "ResourceInterface.h"
+#include "OgreMaterialResource.h"
+
+namespace OgreRenderer
+{
+    //! Request to prepare the data of a mesh, skeleton or material asset
+    class ResourcePrepareRequest : public Foundation::ThreadTaskRequest
+    {
+    public:
+        //! Asset
+        Foundation::AssetPtr asset_;
+        //! Asset type
+        std::string asset_type_;
+    };
+
+    //! Prepared asset data, ready to be turned into an Ogre resource in the main thread
+    class ResourcePrepareResult : public Foundation::ThreadTaskResult
+    {
+    public:
+        ResourcePrepareResult() : success_(false) {}
+
+        //! Asset
+        Foundation::AssetPtr asset_;
+        //! Asset type
+        std::string asset_type_;
+        //! Whether the data is usable
+        bool success_;
+        //! Resources the asset refers to, to be requested right away
+        Foundation::ResourceReferenceVector references_;
+        //! Prepared script of a material asset
+        OgreMaterialScript material_script_;
+    };
+
+    typedef boost::shared_ptr<ResourcePrepareRequest> ResourcePrepareRequestPtr;
+    typedef boost::shared_ptr<ResourcePrepareResult> ResourcePrepareResultPtr;
+
+    //! Prepares mesh, skeleton and material asset data in a thread, used by ResourceHandler
+    /*! Material scripts are scanned and rewritten for Ogre, and meshes are scanned for the materials and the skeleton
+        they use, so that ResourceHandler can request the referred assets before creating the Ogre resources.
+        Creating the Ogre resources themselves uses the Ogre resource managers and hardware buffers, so it stays in
+        the main thread.
+     */
+    class ResourcePreparer : public Foundation::ThreadTask
+    {
+    public:
+        //! Constructor
+        ResourcePreparer();
+
+        //! Work function
+        virtual void Work();
+
+        //! Reads the material names and the skeleton name of a binary Ogre mesh, without creating the mesh
+        /*! \param data mesh data
+            \param size mesh data size
+            \param materials returns the material names of the submeshes
+            \param skeleton returns the skeleton name, or empty if no skeleton
+            \return true if the data is an Ogre mesh
+         */
+        static bool ReadMeshReferences(const u8* data, uint size, StringVector& materials, std::string& skeleton);
+
+    private:
+        //! Prepares asset data & queues result
+        /*! \param request request to serve
+         */
+        void Prepare(ResourcePrepareRequestPtr request);
+    };
+}
+
+#endif
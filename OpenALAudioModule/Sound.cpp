@@ -54,6 +54,27 @@ namespace OpenALAudio
         return true;
     }
     
+    bool Sound::LoadStreamData(VorbisDataPtr data)
+    {
+        DeleteBuffer();
+        
+        if ((!data) || (data->empty()))
+            return false;
+        
+        stream_data_ = data;
+        size_ = data->size();
+        return true;
+    }
+    
+    VorbisStreamPtr Sound::CreateStream() const
+    {
+        if (!stream_data_)
+            return VorbisStreamPtr();
+        
+        ResetAge();
+        return VorbisStreamPtr(new VorbisStream(name_, stream_data_));
+    }
+    
     bool Sound::CreateBuffer()
     {    
         if (!handle_)
@@ -76,5 +97,10 @@ namespace OpenALAudio
             handle_ = 0;
             size_ = 0;
         }
+        if (stream_data_)
+        {
+            stream_data_.reset();
+            size_ = 0;
+        }
     } 
 }
\ No newline at end of file
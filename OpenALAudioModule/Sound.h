@@ -6,6 +6,7 @@
 #include <AL/alc.h>
 
 #include "SoundServiceInterface.h"
+#include "VorbisDecoder.h"
 
 namespace OpenALAudio
 {
@@ -22,13 +23,25 @@ namespace OpenALAudio
         /*! Any existing sound data will be erased.
          */
         bool LoadFromBuffer(const Foundation::SoundServiceInterface::SoundBuffer& buffer);
+        
+        //! Set compressed ogg vorbis data to be streamed on playback, instead of decoding it all at once
+        /*! Any existing sound data will be erased.
+         */
+        bool LoadStreamData(VorbisDataPtr data);
+        
+        //! Create a new stream for playing the sound. Returns null if not a streaming sound
+        VorbisStreamPtr CreateStream() const;
 
         //! Return sound name
         const std::string& GetName() const { return name_; }
-        //! Return OpenAL handle
+        //! Return OpenAL handle. Zero for streaming sounds, they are buffered by the channel
         ALuint GetHandle() const { ResetAge(); return handle_; }
-        //! Return datasize of sound in bytes
+        //! Return datasize of sound in bytes. For streaming sounds this is the compressed size
         uint GetSize() const { return size_; }
+        //! Return whether sound has data and can be played
+        bool IsLoaded() const { return (handle_ != 0) || (stream_data_.get() != 0); }
+        //! Return whether sound is played by streaming
+        bool IsStreaming() const { return stream_data_.get() != 0; }
 
         //! Return age of sound (for caching)
         f64 GetAge() const { return age_; }
@@ -49,6 +62,8 @@ namespace OpenALAudio
         ALuint handle_;
         //! Total size of audio data
         uint size_;    
+        //! Compressed data for streaming sounds
+        VorbisDataPtr stream_data_;
         //! Age of sound (resetted when last accessed)
         mutable f64 age_;
     };
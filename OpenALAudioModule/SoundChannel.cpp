@@ -4,16 +4,21 @@
 #include "OpenALAudioModule.h"
 #include "SoundChannel.h"
 
+#include <algorithm>
+
 namespace OpenALAudio
 {
     static const Real MINIMUM_ROLLOFF = 0.1f;
     static const Real DEFAULT_ROLLOFF = 2.0f;
     static const Real DEFAULT_INNER_RADIUS = 1.0f;
     static const Real DEFAULT_OUTER_RADIUS = 50.0f;
+    //! Amount of OpenAL buffers cycled by a streaming channel
+    static const uint STREAM_BUFFERS = 4;
     
-    SoundChannel::SoundChannel(Foundation::SoundServiceInterface::SoundType type) :
+    SoundChannel::SoundChannel(Foundation::SoundServiceInterface::SoundType type, VorbisStreamerPtr streamer) :
         type_(type),
         handle_(0),
+        streamer_(streamer),
         pitch_(1.0f),
         gain_(1.0f),
         master_gain_(1.0f),
@@ -32,6 +37,7 @@ namespace OpenALAudio
     SoundChannel::~SoundChannel()
     {
         DeleteSource();
+        DeleteStreamBuffers();
     }
     
     void SoundChannel::Update(const Vector3df& listener_pos)
@@ -41,6 +47,12 @@ namespace OpenALAudio
         QueueBuffers();
         UnqueueBuffers();
         
+        if (stream_)
+        {
+            UpdateStream();
+            return;
+        }
+        
         if (state_ == Foundation::SoundServiceInterface::Playing)
         {
             if (handle_)
@@ -139,6 +151,13 @@ namespace OpenALAudio
             alSourcei(handle_, AL_BUFFER, 0);
         }
         
+        if (stream_)
+        {
+            stream_->Close();
+            stream_.reset();
+        }
+        free_stream_buffers_ = stream_buffers_;
+        
         pending_sounds_.clear();
         playing_sounds_.clear();
         
@@ -178,6 +197,14 @@ namespace OpenALAudio
             enable = false;
         
         looped_ = enable;
+        
+        // Streams loop by rewinding the decoder, not by OpenAL
+        if (stream_)
+        {
+            stream_->SetLooped(looped_);
+            return;
+        }
+        
         if (handle_)
             alSourcei(handle_, AL_LOOPING, looped_ ? AL_TRUE : AL_FALSE);
     }
@@ -282,7 +309,7 @@ namespace OpenALAudio
         // See that we do have waiting sounds and they're ready to play
         if (!pending_sounds_.size())
             return;
-        if ((*pending_sounds_.begin())->GetHandle() == 0)
+        if (!(*pending_sounds_.begin())->IsLoaded())
             return;
         
         // Create source now if did not exist already
@@ -293,6 +320,13 @@ namespace OpenALAudio
             return;
         }
         
+        // Streaming sounds are buffered by the channel itself
+        if ((*pending_sounds_.begin())->IsStreaming())
+        {
+            StartStream(*pending_sounds_.begin());
+            return;
+        }
+        
         bool queued = false;
         
         // Buffer pending sounds, move them to playing vector
@@ -353,7 +387,12 @@ namespace OpenALAudio
             {
                 ALuint buffer = 0;
                 alSourceUnqueueBuffers(handle_, 1, &buffer);
-                if (buffer)
+                if ((buffer) && (std::find(stream_buffers_.begin(), stream_buffers_.end(), buffer) != stream_buffers_.end()))
+                {
+                    // Stream buffer played, can be refilled
+                    free_stream_buffers_.push_back(buffer);
+                }
+                else if (buffer)
                 {
                     // See if we find matching buffer from the sounds vector.
                     // If found, erase so that the sound may be freed if not used elsewhere
@@ -370,4 +409,100 @@ namespace OpenALAudio
         }
     }
     
-}
\ No newline at end of file
+    void SoundChannel::StartStream(SoundPtr sound)
+    {
+        pending_sounds_.pop_front();
+        
+        VorbisStreamPtr stream = sound->CreateStream();
+        if ((!streamer_) || (!stream) || (!stream->Open()))
+        {
+            OpenALAudioModule::LogError("Could not start streaming sound " + sound->GetName());
+            state_ = Foundation::SoundServiceInterface::Stopped;
+            return;
+        }
+        
+        // Flush whatever was queued before, looping is done by the stream
+        alSourceStop(handle_);
+        alSourcei(handle_, AL_BUFFER, 0);
+        alSourcei(handle_, AL_LOOPING, AL_FALSE);
+        free_stream_buffers_ = stream_buffers_;
+        
+        stream->SetLooped(looped_);
+        stream_ = stream;
+        playing_sounds_.push_back(sound);
+        
+        VorbisStreamRequestPtr request(new VorbisStreamRequest());
+        request->stream_ = stream;
+        streamer_->AddRequest<VorbisStreamRequest>(request);
+        
+        // Playback starts once the first chunk has been decoded
+        state_ = Foundation::SoundServiceInterface::Playing;
+    }
+    
+    void SoundChannel::UpdateStream()
+    {
+        if ((!stream_) || (!handle_))
+            return;
+        
+        ALenum openal_format = stream_->IsStereo() ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+        
+        // Refill free buffers with decoded chunks, creating buffers as needed
+        for (;;)
+        {
+            if (free_stream_buffers_.empty())
+            {
+                if (stream_buffers_.size() >= STREAM_BUFFERS)
+                    break;
+                ALuint new_buffer = 0;
+                alGenBuffers(1, &new_buffer);
+                if (!new_buffer)
+                {
+                    OpenALAudioModule::LogError("Could not create OpenAL sound buffer");
+                    break;
+                }
+                stream_buffers_.push_back(new_buffer);
+                free_stream_buffers_.push_back(new_buffer);
+            }
+            
+            if (!stream_->GetChunk(stream_chunk_))
+                break;
+            
+            ALuint buffer = free_stream_buffers_.back();
+            alGetError();
+            alBufferData(buffer, openal_format, &stream_chunk_[0], stream_chunk_.size(), stream_->GetFrequency());
+            alSourceQueueBuffers(handle_, 1, &buffer);
+            ALenum error = alGetError();
+            if (error != AL_NONE)
+            {
+                OpenALAudioModule::LogError("Could not queue OpenAL stream buffer: " + ToString<int>(error));
+                break;
+            }
+            free_stream_buffers_.pop_back();
+        }
+        
+        ALint playing;
+        alGetSourcei(handle_, AL_SOURCE_STATE, &playing);
+        if (playing == AL_PLAYING)
+            return;
+        
+        // Not playing: either not started yet, the decoder fell behind, or the stream has ended
+        if (free_stream_buffers_.size() < stream_buffers_.size())
+            alSourcePlay(handle_);
+        else if (stream_->IsFinished())
+        {
+            stream_->Close();
+            stream_.reset();
+            playing_sounds_.clear();
+            state_ = Foundation::SoundServiceInterface::Stopped;
+        }
+    }
+    
+    void SoundChannel::DeleteStreamBuffers()
+    {
+        if (stream_buffers_.size())
+            alDeleteBuffers(stream_buffers_.size(), &stream_buffers_[0]);
+        
+        stream_buffers_.clear();
+        free_stream_buffers_.clear();
+    }
+}
@@ -12,7 +12,10 @@ namespace OpenALAudio
     {
     public:
         //! Constructor.
-        SoundChannel(Foundation::SoundServiceInterface::SoundType type);
+        /*! \param type Sound type
+            \param streamer Decode-ahead thread for playing streaming sounds
+         */
+        SoundChannel(Foundation::SoundServiceInterface::SoundType type, VorbisStreamerPtr streamer = VorbisStreamerPtr());
         //! Destructor.
         ~SoundChannel();
         
@@ -55,6 +58,12 @@ namespace OpenALAudio
         void QueueBuffers();
         //! Remove processed buffers
         void UnqueueBuffers();
+        //! Start playing a streaming sound
+        void StartStream(SoundPtr sound);
+        //! Refill stream buffers with decoded data & restart playback after underrun
+        void UpdateStream();
+        //! Delete the OpenAL buffers used for streaming
+        void DeleteStreamBuffers();
         //! Create OpenAL source if one does not exist yet
         bool CreateSource();
         //! Delete OpenAL source
@@ -74,6 +83,16 @@ namespace OpenALAudio
         std::list<SoundPtr> pending_sounds_;
         //! Currently playing sound buffers
         std::vector<SoundPtr> playing_sounds_;
+        //! Decode-ahead thread for streaming sounds
+        VorbisStreamerPtr streamer_;
+        //! Currently playing stream, if any
+        VorbisStreamPtr stream_;
+        //! OpenAL buffers used for streaming
+        std::vector<ALuint> stream_buffers_;
+        //! Stream buffers not currently queued to the source
+        std::vector<ALuint> free_stream_buffers_;
+        //! Decoded stream chunk being uploaded. Kept to reuse its storage
+        std::vector<u8> stream_chunk_;
         //! Pitch
         Real pitch_;
         //! Gain
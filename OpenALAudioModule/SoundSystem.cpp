@@ -19,6 +19,7 @@
 namespace OpenALAudio
 {
     const uint DEFAULT_SOUND_CACHE_SIZE = 32 * 1024 * 1024;
+    const uint DEFAULT_SOUND_STREAM_THRESHOLD = 1024 * 1024;
     const f64 CACHE_CHECK_INTERVAL = 1.0;
     
     SoundSystem::SoundSystem(Foundation::Framework *framework) : 
@@ -31,10 +32,12 @@ namespace OpenALAudio
         capture_sample_size_(0),
         next_channel_id_(0),
         sound_cache_size_(DEFAULT_SOUND_CACHE_SIZE),
+        sound_stream_threshold_(DEFAULT_SOUND_STREAM_THRESHOLD),
         update_time_(0),
         listener_position_(0.0, 0.0, 0.0)
     {
         sound_cache_size_ = framework_->GetDefaultConfig().DeclareSetting("SoundSystem", "sound_cache_size", DEFAULT_SOUND_CACHE_SIZE);
+        sound_stream_threshold_ = framework_->GetDefaultConfig().DeclareSetting("SoundSystem", "sound_stream_threshold", DEFAULT_SOUND_STREAM_THRESHOLD);
         
         // By default, initialize default playback device
         Initialize();
@@ -43,6 +46,10 @@ namespace OpenALAudio
         VorbisDecoder* decoder = new VorbisDecoder();
         framework_->GetThreadTaskManager()->AddThreadTask(Foundation::ThreadTaskPtr(decoder));
         
+        // Create the decode-ahead thread task for streaming sounds. Channels feed it directly
+        streamer_ = VorbisStreamerPtr(new VorbisStreamer());
+        framework_->GetThreadTaskManager()->AddThreadTask(streamer_);
+        
         // Set default master gains for sound types
         master_gain_ = framework_->GetDefaultConfig().DeclareSetting("SoundSystem", "master_gain", 1.0f);
         sound_master_gain_[Foundation::SoundServiceInterface::Triggered] = framework_->GetDefaultConfig().DeclareSetting("SoundSystem", "triggered_sound_gain", 1.0f);
@@ -229,7 +236,7 @@ namespace OpenALAudio
         if (i == channels_.end())
         {
             i = channels_.insert(
-                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), SoundChannelPtr(new SoundChannel(type)))).first;
+                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), CreateChannel(type))).first;
         }
         
         i->second->SetMasterGain(sound_master_gain_[type] * master_gain_);
@@ -252,7 +259,7 @@ namespace OpenALAudio
         if (i == channels_.end())
         {
             i = channels_.insert(
-                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), SoundChannelPtr(new SoundChannel(type)))).first;
+                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), CreateChannel(type))).first;
         }
        
         i->second->SetMasterGain(sound_master_gain_[type] * master_gain_);
@@ -272,7 +279,7 @@ namespace OpenALAudio
         if (i == channels_.end())
         {
             i = channels_.insert(
-                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), SoundChannelPtr(new SoundChannel(type)))).first;
+                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), CreateChannel(type))).first;
         }
         
         i->second->SetMasterGain(sound_master_gain_[type] * master_gain_);
@@ -291,7 +298,7 @@ namespace OpenALAudio
         if (i == channels_.end())
         {
             i = channels_.insert(
-                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), SoundChannelPtr(new SoundChannel(type)))).first;
+                std::pair<sound_id_t, SoundChannelPtr>(GetNextSoundChannelID(), CreateChannel(type))).first;
         }
         
         i->second->SetMasterGain(sound_master_gain_[type] * master_gain_);
@@ -365,6 +372,11 @@ namespace OpenALAudio
         i->second->SetRange(inner_radius, outer_radius, rolloff);
     }
 
+    SoundChannelPtr SoundSystem::CreateChannel(Foundation::SoundServiceInterface::SoundType type)
+    {
+        return SoundChannelPtr(new SoundChannel(type, streamer_));
+    }
+    
     sound_id_t SoundSystem::GetNextSoundChannelID()
     {
         for (;;)
@@ -449,27 +461,37 @@ namespace OpenALAudio
             return;
         
         uint total_size = 0;
-        SoundMap::iterator oldest_sound = sounds_.end();
-        f64 oldest_age = 0.0;
         
         SoundMap::iterator i = sounds_.begin();
         while (i != sounds_.end())
         {
             i->second->AddAge(update_time_);   
             total_size += i->second->GetSize();
-            // Don't erase zero size sounds, because they haven't been created yet and are probably waiting for assetdata
-            if ((i->second->GetAge() >= oldest_age) && (i->second->GetSize()))
-            {
-                oldest_age = i->second->GetAge();
-                oldest_sound = i;
-            }
             ++i;
         }
-
-        if (total_size > sound_cache_size_)
+        
+        // Remove oldest sounds until the cache fits the memory budget
+        while (total_size > sound_cache_size_)
         {
-            if (oldest_sound != sounds_.end())
-                sounds_.erase(oldest_sound);
+            SoundMap::iterator oldest_sound = sounds_.end();
+            f64 oldest_age = 0.0;
+            
+            for (i = sounds_.begin(); i != sounds_.end(); ++i)
+            {
+                // Don't erase zero size sounds, because they haven't been created yet and are probably waiting for assetdata.
+                // Also keep sounds that channels are still playing, erasing them would not free any memory
+                if ((i->second->GetAge() >= oldest_age) && (i->second->GetSize()) && (i->second.unique()))
+                {
+                    oldest_age = i->second->GetAge();
+                    oldest_sound = i;
+                }
+            }
+            
+            if (oldest_sound == sounds_.end())
+                break;
+            
+            total_size -= oldest_sound->second->GetSize();
+            sounds_.erase(oldest_sound);
         }
         
         update_time_ = 0.0;
@@ -494,6 +516,7 @@ namespace OpenALAudio
         pbuf->pubseekpos(0, std::ios::in);
         pbuf->sgetn((char *)&new_request->buffer_[0], size);
         file.close();
+        new_request->stream_threshold_ = sound_stream_threshold_;
         
         framework_->GetThreadTaskManager()->AddRequest("VorbisDecoder", new_request);
         return true;
@@ -507,13 +530,14 @@ namespace OpenALAudio
         if (!result || result->task_description_ != "VorbisDecoder")
             return false;
 
-        // Check if this was for a resource request, if so, stuff the data
+        // Check if this was for a resource request, if so, stuff the data. Streamed results have no data; 
+        // the resource request will get its own full decode
         for (;;)
         {
             request_tag_t tag = 0;
 
             std::map<request_tag_t, std::string>::iterator i = sound_resource_requests_.begin();
-            while (i != sound_resource_requests_.end())
+            while ((!result->streaming_) && (i != sound_resource_requests_.end()))
             {
                 if (i->second == result->name_)
                 {
@@ -546,6 +570,11 @@ namespace OpenALAudio
         // If sound already has data, do not stuff again
         if (i->second->GetSize() != 0)
             return true;
+        if (result->streaming_)
+        {
+            i->second->LoadStreamData(result->stream_data_);
+            return true;
+        }
         if (!result->buffer_.data_.size())
             return true;
         
@@ -586,6 +615,9 @@ namespace OpenALAudio
             new_request->buffer_.resize(event_data->asset_->GetSize());
             //! \todo use asset data directly instead of copying to decode request buffer
             memcpy(&new_request->buffer_[0], event_data->asset_->GetData(), event_data->asset_->GetSize());
+            // Resource requests want the whole decoded data
+            if (!resource_request)
+                new_request->stream_threshold_ = sound_stream_threshold_;
             framework_->GetThreadTaskManager()->AddRequest("VorbisDecoder", new_request);
         }
         
@@ -230,9 +230,12 @@ namespace OpenALAudio
          */
         bool DecodeLocalOggFile(Sound* sound, const std::string& name);
         
-        //! Update sound cache. Ages sounds and removes oldest if cache too big
+        //! Update sound cache. Ages sounds and removes oldest unused ones until cache fits the memory budget
         void UpdateCache(f64 frametime);
         
+        //! Create a new sound channel
+        SoundChannelPtr CreateChannel(Foundation::SoundServiceInterface::SoundType type);
+        
         //! Framework
         Foundation::Framework* framework_;
         //! Initialized flag
@@ -251,6 +254,10 @@ namespace OpenALAudio
         SoundMap sounds_;
         //! Sound cache size
         uint sound_cache_size_;
+        //! Decoded size above which sounds are streamed instead of decoded at once
+        uint sound_stream_threshold_;
+        //! Decode-ahead thread for streaming sounds
+        VorbisStreamerPtr streamer_;
         //! Update timer (for cache)
         f64 update_time_;
         //! Next channel id
@@ -10,6 +10,12 @@
 namespace OpenALAudio
 {
     static const int MAX_DECODE_SIZE = 16384;
+    //! Size of one decoded stream chunk, ~0.35 seconds of 44.1kHz 16bit stereo audio
+    static const uint STREAM_CHUNK_SIZE = 65536;
+    //! Maximum amount of chunks decoded ahead per stream
+    static const uint MAX_STREAM_CHUNKS = 4;
+    //! How long the streamer sleeps when all streams are full
+    static const int STREAMER_IDLE_WAIT_MS = 10;
     
     class OggMemDataSource
     {
@@ -157,6 +163,25 @@ namespace OpenALAudio
             QueueResult<VorbisDecodeResult>(result);
             return;
         }
+        
+        // If the decoded sound would be big, do not decode now, but hand the datastream back for streaming playback
+        if (request->stream_threshold_)
+        {
+            ogg_int64_t samples = ov_pcm_total(&vf, -1);
+            if ((samples > 0) && (samples * vi->channels * 2 > request->stream_threshold_))
+            {
+                std::ostringstream msg;
+                msg << "Streaming ogg vorbis sound " << request->name_ << ", decoded size would be " << samples * vi->channels * 2 << " bytes";
+                OpenALAudioModule::LogDebug(msg.str());
+                
+                ov_clear(&vf);
+                result->streaming_ = true;
+                result->stream_data_ = VorbisDataPtr(new std::vector<u8>());
+                result->stream_data_->swap(request->buffer_);
+                QueueResult<VorbisDecodeResult>(result);
+                return;
+            }
+        }
  
         uint decoded_bytes = 0;
         for (;;)
@@ -178,4 +203,215 @@ namespace OpenALAudio
         ov_clear(&vf);
         QueueResult<VorbisDecodeResult>(result);
     }
-}
\ No newline at end of file
+    
+    VorbisStream::VorbisStream(const std::string& name, VorbisDataPtr data) :
+        name_(name),
+        data_(data),
+        source_(0),
+        file_(0),
+        frequency_(0),
+        stereo_(false),
+        looped_(false),
+        end_of_stream_(false),
+        closed_(false)
+    {
+    }
+    
+    VorbisStream::~VorbisStream()
+    {
+        if (file_)
+        {
+            ov_clear(file_);
+            delete file_;
+        }
+        delete source_;
+    }
+    
+    bool VorbisStream::Open()
+    {
+        if (file_)
+            return true;
+        if ((!data_) || (data_->empty()))
+            return false;
+        
+        source_ = new OggMemDataSource(&(*data_)[0], data_->size());
+        file_ = new OggVorbis_File;
+        
+        ov_callbacks cb;
+        cb.read_func = &OggReadCallback;
+        cb.seek_func = &OggSeekCallback;
+        cb.tell_func = &OggTellCallback;
+        cb.close_func = 0;
+        
+        if (ov_open_callbacks(source_, file_, 0, 0, cb) < 0)
+        {
+            OpenALAudioModule::LogError("Not ogg vorbis format");
+            ov_clear(file_);
+            delete file_;
+            file_ = 0;
+            return false;
+        }
+        
+        vorbis_info* vi = ov_info(file_, -1);
+        if (!vi)
+        {
+            OpenALAudioModule::LogError("No ogg vorbis stream info");
+            ov_clear(file_);
+            delete file_;
+            file_ = 0;
+            return false;
+        }
+        
+        frequency_ = vi->rate;
+        stereo_ = (vi->channels == 2);
+        return true;
+    }
+    
+    bool VorbisStream::DecodeAhead()
+    {
+        std::vector<u8> chunk;
+        bool looped;
+        
+        {
+            MutexLock lock(mutex_);
+            if ((!file_) || (closed_) || (end_of_stream_) || (chunks_.size() >= MAX_STREAM_CHUNKS))
+                return false;
+            looped = looped_;
+            if (!free_chunks_.empty())
+            {
+                chunk.swap(free_chunks_.front());
+                free_chunks_.pop_front();
+            }
+        }
+        
+        chunk.resize(STREAM_CHUNK_SIZE);
+        uint decoded_bytes = 0;
+        bool end = false;
+        bool rewound = false;
+        
+        while (decoded_bytes < STREAM_CHUNK_SIZE)
+        {
+            int bitstream;
+            long ret = ov_read(file_, (char*)&chunk[decoded_bytes], STREAM_CHUNK_SIZE - decoded_bytes, 0, 2, 1, &bitstream);
+            if (ret == OV_HOLE)
+                continue;
+            if (ret > 0)
+            {
+                decoded_bytes += ret;
+                rewound = false;
+                continue;
+            }
+            
+            // End of stream or unrecoverable error. Rewind if looped, unless the stream produces no data at all
+            if ((ret == 0) && (looped) && (!rewound) && (ov_pcm_seek(file_, 0) == 0))
+            {
+                rewound = true;
+                continue;
+            }
+            
+            end = true;
+            break;
+        }
+        
+        chunk.resize(decoded_bytes);
+        
+        MutexLock lock(mutex_);
+        if (decoded_bytes)
+        {
+            chunks_.push_back(std::vector<u8>());
+            chunks_.back().swap(chunk);
+        }
+        if (end)
+            end_of_stream_ = true;
+        return true;
+    }
+    
+    bool VorbisStream::GetChunk(std::vector<u8>& data)
+    {
+        MutexLock lock(mutex_);
+        if (chunks_.empty())
+            return false;
+        
+        data.swap(chunks_.front());
+        // The old storage of data is now in the front chunk; move it to the free list for reuse
+        free_chunks_.splice(free_chunks_.end(), chunks_, chunks_.begin());
+        return true;
+    }
+    
+    void VorbisStream::SetLooped(bool enable)
+    {
+        MutexLock lock(mutex_);
+        looped_ = enable;
+    }
+    
+    void VorbisStream::Close()
+    {
+        MutexLock lock(mutex_);
+        closed_ = true;
+        chunks_.clear();
+        free_chunks_.clear();
+    }
+    
+    bool VorbisStream::IsClosed() const
+    {
+        MutexLock lock(mutex_);
+        return closed_;
+    }
+    
+    bool VorbisStream::IsFinished() const
+    {
+        MutexLock lock(mutex_);
+        return (closed_) || ((end_of_stream_) && (chunks_.empty()));
+    }
+    
+    // Keeps decoding as long as there are streams, so does not fit the task pool
+    VorbisStreamer::VorbisStreamer() :
+        Foundation::ThreadTask("VorbisStreamer", true)
+    {
+    }
+    
+    void VorbisStreamer::Work()
+    {
+        while (ShouldRun())
+        {
+            // Pick up new streams
+            for (;;)
+            {
+                VorbisStreamRequestPtr request = GetNextRequest<VorbisStreamRequest>();
+                if (!request)
+                    break;
+                if (request->stream_)
+                    streams_.push_back(request->stream_);
+            }
+            
+            if (streams_.empty())
+            {
+                WaitForRequests();
+                continue;
+            }
+            
+            bool decoded = false;
+            {
+                PROFILE(VorbisStreamer_Decode);
+                std::list<VorbisStreamPtr>::iterator i = streams_.begin();
+                while (i != streams_.end())
+                {
+                    if ((*i)->IsClosed() || (*i)->IsFinished())
+                    {
+                        i = streams_.erase(i);
+                        continue;
+                    }
+                    if ((*i)->DecodeAhead())
+                        decoded = true;
+                    ++i;
+                }
+            }
+            
+            RESETPROFILER
+            
+            // All streams full, let the channels play some
+            if (!decoded)
+                boost::this_thread::sleep(boost::posix_time::milliseconds(STREAMER_IDLE_WAIT_MS));
+        }
+    }
+}
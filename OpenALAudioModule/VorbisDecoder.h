@@ -5,27 +5,44 @@
 #include "SoundServiceInterface.h"
 #include "ThreadTask.h"
 
+struct OggVorbis_File;
+
 namespace OpenALAudio
 {
+    class OggMemDataSource;
+
+    //! Compressed ogg vorbis data, shared between a sound and the streams playing it
+    typedef boost::shared_ptr<std::vector<u8> > VorbisDataPtr;
+
     //! Ogg vorbis decode request
     class VorbisDecodeRequest : public Foundation::ThreadTaskRequest
     {
     public:
+        VorbisDecodeRequest() : stream_threshold_(0) {}
+
         //! Name/id of sound
         std::string name_;
         //! Vorbis datastream
         std::vector<u8> buffer_;
+        //! Decoded size in bytes above which the sound is not decoded, but returned for streaming. 0 = always decode
+        uint stream_threshold_;
     };
     
     class VorbisDecodeResult : public Foundation::ThreadTaskResult
     {
     public:
+        VorbisDecodeResult() : streaming_(false) {}
+
         //! Name/id of sound
         std::string name_;
         //! Decoded audio data buffer. Will always be 16bit signed
-        /*! If decode failed, will be zero size
+        /*! If decode failed, or the sound is to be streamed, will be zero size
          */
         Foundation::SoundServiceInterface::SoundBuffer buffer_;
+        //! Whether sound was too big to decode at once, and should be streamed instead
+        bool streaming_;
+        //! Vorbis datastream for streaming. Only set if streaming_ is true
+        VorbisDataPtr stream_data_;
     };
     
     typedef boost::shared_ptr<VorbisDecodeRequest> VorbisDecodeRequestPtr;
@@ -49,5 +66,115 @@ namespace OpenALAudio
         
         uint decodes_per_frame_;
     };
+
+    //! An ogg vorbis stream that is decoded ahead of playback in small chunks by VorbisStreamer
+    /*! Chunks are decoded in the streamer thread, and taken for playback by SoundChannel in the main thread.
+     */
+    class VorbisStream
+    {
+    public:
+        //! Constructor
+        /*! \param name Name/id of sound
+            \param data Vorbis datastream
+         */
+        VorbisStream(const std::string& name, VorbisDataPtr data);
+
+        //! Destructor
+        ~VorbisStream();
+
+        //! Opens the stream and reads the stream info. Call before handing the stream to VorbisStreamer
+        /*! \return true if successful
+         */
+        bool Open();
+
+        //! Decodes one chunk ahead, if there is room in the decoded chunk queue. Called from the streamer thread
+        /*! \return true if a chunk was decoded
+         */
+        bool DecodeAhead();
+
+        //! Takes the next decoded chunk
+        /*! \param data Vector that will receive the chunk data. Its old storage is reused for later chunks
+            \return true if a chunk was available
+         */
+        bool GetChunk(std::vector<u8>& data);
+
+        //! Sets looped state. When looped, stream rewinds at the end instead of finishing
+        void SetLooped(bool enable);
+
+        //! Closes the stream. Streamer will drop it on its next round
+        void Close();
+
+        //! Returns whether stream is closed
+        bool IsClosed() const;
+
+        //! Returns whether the whole stream has been decoded and all chunks taken
+        bool IsFinished() const;
+
+        //! Returns sound name
+        const std::string& GetName() const { return name_; }
+
+        //! Returns sound frequency
+        uint GetFrequency() const { return frequency_; }
+
+        //! Returns stereo flag
+        bool IsStereo() const { return stereo_; }
+
+    private:
+        typedef std::list<std::vector<u8> > ChunkList;
+
+        //! Name/id of sound
+        std::string name_;
+        //! Vorbis datastream
+        VorbisDataPtr data_;
+        //! Memory data source for vorbisfile
+        OggMemDataSource* source_;
+        //! Vorbisfile decoding state. Only accessed by the streamer thread after Open()
+        OggVorbis_File* file_;
+        //! Frequency
+        uint frequency_;
+        //! Stereo flag
+        bool stereo_;
+        //! Mutex for the chunk queues & flags
+        mutable Mutex mutex_;
+        //! Decoded chunks waiting for playback
+        ChunkList chunks_;
+        //! Already played chunks, reused for decoding
+        ChunkList free_chunks_;
+        //! Looped flag
+        bool looped_;
+        //! End of stream reached flag
+        bool end_of_stream_;
+        //! Closed flag
+        bool closed_;
+    };
+
+    typedef boost::shared_ptr<VorbisStream> VorbisStreamPtr;
+
+    //! Request to start decoding a stream ahead
+    class VorbisStreamRequest : public Foundation::ThreadTaskRequest
+    {
+    public:
+        //! Opened stream
+        VorbisStreamPtr stream_;
+    };
+
+    typedef boost::shared_ptr<VorbisStreamRequest> VorbisStreamRequestPtr;
+
+    //! Thread that keeps the decoded chunk queues of all playing ogg vorbis streams filled, used by SoundChannel
+    class VorbisStreamer : public Foundation::ThreadTask
+    {
+    public:
+        //! Constructor
+        VorbisStreamer();
+
+        //! Work function
+        virtual void Work();
+
+    private:
+        //! Streams being decoded
+        std::list<VorbisStreamPtr> streams_;
+    };
+
+    typedef boost::shared_ptr<VorbisStreamer> VorbisStreamerPtr;
 }
 #endif
\ No newline at end of file
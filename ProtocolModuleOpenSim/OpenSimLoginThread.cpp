@@ -10,9 +10,7 @@
 
 // ProtocolUtilities includes
 #include "OpenSim/OpenSimAuth.h"
-#include "OpenSim/Grid.h"
-#include "OpenSim/BuddyListParser.h"
-#include "Inventory/InventoryParser.h"
+#include "OpenSim/LoginReplyParser.h"
 #include "Inventory/InventorySkeleton.h"
 #include "Md5.h"
 #include "Framework.h"
@@ -245,9 +243,11 @@ namespace OpenSimProtocol
         //           SEND CALL             //
         /////////////////////////////////////
 
+        // Inventory folders and buddies are read while the reply is still being received.
+        LoginReplyParser reply;
         try
         {
-            call.Send();
+            call.Send(reply);
         }
         catch(XmlRpcException& ex)
         {
@@ -268,19 +268,19 @@ namespace OpenSimProtocol
             if (authentication_ == OPENSIM_AUTHENTICATION && callMethod_ == LOGIN_TO_SIMULATOR)
             {
                 // Grid url, Session ID, Agent ID, Cirtuit Code, Seed Caps
-                threadState_->parameters.sessionID.FromString(call.GetReply<std::string>("session_id"));
-                threadState_->parameters.agentID.FromString(call.GetReply<std::string>("agent_id"));
-                threadState_->parameters.circuitCode = call.GetReply<int>("circuit_code");
-                threadState_->parameters.seedCapabilities = call.GetReply<std::string>("seed_capability");
-                threadState_->parameters.gridUrl = GridParser::ExtractGridAddressFromXMLRPCReply(call);
+                threadState_->parameters.sessionID.FromString(reply.GetReply<std::string>("session_id"));
+                threadState_->parameters.agentID.FromString(reply.GetReply<std::string>("agent_id"));
+                threadState_->parameters.circuitCode = reply.GetReply<int>("circuit_code");
+                threadState_->parameters.seedCapabilities = reply.GetReply<std::string>("seed_capability");
+                threadState_->parameters.gridUrl = reply.GetGridAddress();
 
-                if (call.HasReply("webdav_inventory"))
-                    threadState_->parameters.webdavInventoryUrl = call.GetReply<std::string>("webdav_inventory");
+                if (reply.HasReply("webdav_inventory"))
+                    threadState_->parameters.webdavInventoryUrl = reply.GetReply<std::string>("webdav_inventory");
 
-                if (call.HasReply("region_x") && call.HasReply("region_y"))
+                if (reply.HasReply("region_x") && reply.HasReply("region_y"))
                 {
-                    threadState_->parameters.regionX = static_cast<uint16_t>((call.GetReply<long>("region_x"))/256);
-                    threadState_->parameters.regionY = static_cast<uint16_t>((call.GetReply<long>("region_y"))/256);
+                    threadState_->parameters.regionX = static_cast<uint16_t>((reply.GetReply<long>("region_x"))/256);
+                    threadState_->parameters.regionY = static_cast<uint16_t>((reply.GetReply<long>("region_y"))/256);
                 }
                 
                 if (threadState_->parameters.gridUrl.size() == 0)
@@ -293,7 +293,7 @@ namespace OpenSimProtocol
                 // Inventory
                 try
                 {
-                    threadState_->parameters.inventory = InventoryParser::ExtractInventoryFromXMLRPCReply(call);
+                    threadState_->parameters.inventory = reply.GetInventory();
                 }
                 catch (XmlRpcException &e)
                 {
@@ -303,48 +303,40 @@ namespace OpenSimProtocol
                 }
 
                 // Buddy List
-                try
-                {
-                    threadState_->parameters.buddy_list = BuddyListParser::ExtractBuddyListFromXMLRPCReply(call);
-                }
-                catch (XmlRpcException &e)
-                {
-                    ProtocolModuleOpenSim::LogWarning(QString("Failed to read buddy list: %1").arg(e.what()).toStdString());
-                    threadState_->parameters.buddy_list = BuddyListPtr(new BuddyList());
-                }
+                threadState_->parameters.buddy_list = reply.GetBuddyList();
             }
             else if (authentication_ == REALXTEND_AUTHENTICATION && callMethod_ == CLIENT_AUTHENTICATION) 
             {
                 threadState_->parameters.sessionHash = "";
                 threadState_->parameters.avatarStorageUrl = "";
-                threadState_->parameters.sessionHash = call.GetReply<std::string>("sessionHash");
-                threadState_->parameters.gridUrl = std::string(call.GetReply<std::string>("gridUrl"));
+                threadState_->parameters.sessionHash = reply.GetReply<std::string>("sessionHash");
+                threadState_->parameters.gridUrl = std::string(reply.GetReply<std::string>("gridUrl"));
                 //\bug the grid url provided by authentication server points to tcp port, but the grid url is used in the code to connect to udp port
-                threadState_->parameters.avatarStorageUrl = std::string(call.GetReply<std::string>("avatarStorageUrl"));
+                threadState_->parameters.avatarStorageUrl = std::string(reply.GetReply<std::string>("avatarStorageUrl"));
             }
             else if (authentication_ == REALXTEND_AUTHENTICATION && callMethod_ == LOGIN_TO_SIMULATOR)
             {
                 // Grid url, Session ID, Agent ID, Cirtuit Code, Seed Caps
-                threadState_->parameters.sessionID.FromString(call.GetReply<std::string>("session_id"));
-                threadState_->parameters.agentID.FromString(call.GetReply<std::string>("agent_id"));
-                threadState_->parameters.circuitCode = call.GetReply<int>("circuit_code");
-                threadState_->parameters.seedCapabilities = call.GetReply<std::string>("seed_capability");
-                if (call.HasReply("region_x") && call.HasReply("region_y"))
+                threadState_->parameters.sessionID.FromString(reply.GetReply<std::string>("session_id"));
+                threadState_->parameters.agentID.FromString(reply.GetReply<std::string>("agent_id"));
+                threadState_->parameters.circuitCode = reply.GetReply<int>("circuit_code");
+                threadState_->parameters.seedCapabilities = reply.GetReply<std::string>("seed_capability");
+                if (reply.HasReply("region_x") && reply.HasReply("region_y"))
                 {
-                    threadState_->parameters.regionX = static_cast<uint16_t>((call.GetReply<long>("region_x"))/256);
-                    threadState_->parameters.regionY = static_cast<uint16_t>((call.GetReply<long>("region_y"))/256);
+                    threadState_->parameters.regionX = static_cast<uint16_t>((reply.GetReply<long>("region_x"))/256);
+                    threadState_->parameters.regionY = static_cast<uint16_t>((reply.GetReply<long>("region_y"))/256);
                 }
                 ///\bug related to one 10 lines above. instead of using port defined in authentication server, 
                 /// use the one given by simulator.
                 /// Does this still apply? -jj. Is this a bug in the rex auth server? If so, flag as a workaround or something similar.
-                threadState_->parameters.gridUrl = GridParser::ExtractGridAddressFromXMLRPCReply(call);
+                threadState_->parameters.gridUrl = reply.GetGridAddress();
                 if (threadState_->parameters.gridUrl.size() == 0)
                     throw XmlRpcException("Failed to extract sim_ip and sim_port from login_to_simulator reply!");
 
                 // Inventory
                 try
                 {
-                    threadState_->parameters.inventory = InventoryParser::ExtractInventoryFromXMLRPCReply(call);
+                    threadState_->parameters.inventory = reply.GetInventory();
                 }
                 catch(XmlRpcException &e)
                 {
@@ -354,15 +346,7 @@ namespace OpenSimProtocol
                 }
 
                 // Buddy List
-                try
-                {
-                    threadState_->parameters.buddy_list = BuddyListParser::ExtractBuddyListFromXMLRPCReply(call);
-                }
-                catch(XmlRpcException &e)
-                {
-                    ProtocolModuleOpenSim::LogWarning(QString("Failed to read buddy list: %1").arg(e.what()).toStdString());
-                    threadState_->parameters.buddy_list = BuddyListPtr(new BuddyList());
-                }
+                threadState_->parameters.buddy_list = reply.GetBuddyList();
             }
             else
                 throw XmlRpcException(QString("Undefined login method %1 at parsing call results in PerformXMLRPCLogin()").arg(callMethod_.c_str()).toStdString());
@@ -372,7 +356,7 @@ namespace OpenSimProtocol
             ProtocolModuleOpenSim::LogError(QString("Login procedure threw a XMLRPCException >>> Reason: %1").arg(ex.what()).toStdString());
             try
             {
-                threadState_->errorMessage = call.GetReply<std::string>("message");
+                threadState_->errorMessage = reply.GetReply<std::string>("message");
                 ProtocolModuleOpenSim::LogError(QString(">>> Message: %1").arg(QString(threadState_->errorMessage.c_str())).toStdString());
             }
             catch (XmlRpcException &/*ex*/)
@@ -58,8 +58,6 @@ boost::shared_ptr<ProtocolUtilities::InventorySkeleton> InventoryParser::Extract
     if (!inventoryNode || XMLRPC_GetValueType(inventoryNode) != xmlrpc_vector)
         throw XmlRpcException("Failed to read inventory, inventory-skeleton in the reply was not properly formed!");
 
-    typedef std::pair<RexUUID, ProtocolUtilities::InventoryFolderSkeleton> DetachedInventoryFolder;
-    typedef std::list<DetachedInventoryFolder> DetachedInventoryFolderList;
     DetachedInventoryFolderList folders;
 
     XMLRPC_VALUE item = XMLRPC_VectorRewind(inventoryNode);
@@ -116,50 +114,7 @@ boost::shared_ptr<ProtocolUtilities::InventorySkeleton> InventoryParser::Extract
     if (inventoryRootFolderID.IsNull())
         throw XmlRpcException("Failed to read inventory, inventory-root value folder_id was null or unparseable!");
 
-    // Find the root folder from the list of detached folders, and set it as the root folder to start with.
-    for(DetachedInventoryFolderList::iterator iter = folders.begin(); iter != folders.end(); ++iter)
-    {
-        if (iter->second.id == inventoryRootFolderID)
-        {
-            ProtocolUtilities::InventoryFolderSkeleton *root = inventory->GetRoot();
-            iter->second.editable = false;
-            root->AddChildFolder(iter->second);
-            folders.erase(iter);
-            break;
-        }
-    }
-
-    if (inventory->GetFirstChildFolderByName("My Inventory")->id != inventoryRootFolderID)
-        throw XmlRpcException("Failed to read inventory, inventory-root value folder_id pointed to a nonexisting folder!");
-
-    // Insert the detached folders onto the tree view until all folders have been added or there are orphans left
-    // that cannot be added, and quit.
-    bool progress = true;
-    while(folders.size() > 0 && progress)
-    {
-        progress = false;
-        DetachedInventoryFolderList::iterator iter = folders.begin();
-        while(iter != folders.end())
-        {
-            DetachedInventoryFolderList::iterator next = iter;
-            ++next;
-
-            ProtocolUtilities::InventoryFolderSkeleton *parent = inventory->GetChildFolderById(iter->first);
-            if (parent)
-            {
-                // Mark harcoded OpenSim Library folders non-editable.
-                if (parent->id == inventoryRootFolderID &&
-                    IsHardcodedOpenSimFolder(iter->second.name.c_str()))
-                    iter->second.editable = false;
-
-                parent->AddChildFolder(iter->second);
-                progress = true;
-                folders.erase(iter);
-            }
-
-            iter = next;
-        }
-    }
+    AddMyInventory(*inventory, folders, inventoryRootFolderID);
 
     /********** World Library **********/
 
@@ -265,50 +220,108 @@ boost::shared_ptr<ProtocolUtilities::InventorySkeleton> InventoryParser::Extract
     if (inventoryLibraryRootFolderID.IsNull())
         throw XmlRpcException("Failed to read inventory, inventory-lib-root value folder_id was null or unparseable!");
 
+    AddWorldLibrary(*inventory, library_folders, inventoryLibraryRootFolderID);
+
+    return inventory;
+}
+
+// static
+void InventoryParser::AddMyInventory(ProtocolUtilities::InventorySkeleton &inventory, DetachedInventoryFolderList &folders,
+    const RexUUID &root_id)
+{
     // Find the root folder from the list of detached folders, and set it as the root folder to start with.
-    for(DetachedInventoryFolderList::iterator iter = library_folders.begin(); iter != library_folders.end(); ++iter)
+    for(DetachedInventoryFolderList::iterator iter = folders.begin(); iter != folders.end(); ++iter)
     {
-        if (iter->second.id == inventoryLibraryRootFolderID)
+        if (iter->second.id == root_id)
         {
-            ProtocolUtilities::InventoryFolderSkeleton *root = inventory->GetRoot();
+            ProtocolUtilities::InventoryFolderSkeleton *root = inventory.GetRoot();
             iter->second.editable = false;
-            root->AddChildFolder(iter->second);
-            library_folders.erase(iter);
+            inventory.AddChildFolder(root, iter->second);
+            folders.erase(iter);
             break;
         }
     }
 
-    ProtocolUtilities::InventoryFolderSkeleton *worldLibrary = inventory->GetChildFolderById(inventoryLibraryRootFolderID);
+    ProtocolUtilities::InventoryFolderSkeleton *myInventory = inventory.GetFirstChildFolderByName("My Inventory");
+    if (!myInventory || myInventory->id != root_id)
+        throw XmlRpcException("Failed to read inventory, inventory-root value folder_id pointed to a nonexisting folder!");
+
+    // Insert the detached folders onto the tree view until all folders have been added or there are orphans left
+    // that cannot be added, and quit.
+    bool progress = true;
+    while(folders.size() > 0 && progress)
+    {
+        progress = false;
+        DetachedInventoryFolderList::iterator iter = folders.begin();
+        while(iter != folders.end())
+        {
+            DetachedInventoryFolderList::iterator next = iter;
+            ++next;
+
+            ProtocolUtilities::InventoryFolderSkeleton *parent = inventory.GetChildFolderById(iter->first);
+            if (parent)
+            {
+                // Mark harcoded OpenSim Library folders non-editable.
+                if (parent->id == root_id &&
+                    IsHardcodedOpenSimFolder(iter->second.name.c_str()))
+                    iter->second.editable = false;
+
+                inventory.AddChildFolder(parent, iter->second);
+                progress = true;
+                folders.erase(iter);
+            }
+
+            iter = next;
+        }
+    }
+}
+
+// static
+void InventoryParser::AddWorldLibrary(ProtocolUtilities::InventorySkeleton &inventory, DetachedInventoryFolderList &folders,
+    const RexUUID &root_id)
+{
+    // Find the root folder from the list of detached folders, and set it as the root folder to start with.
+    for(DetachedInventoryFolderList::iterator iter = folders.begin(); iter != folders.end(); ++iter)
+    {
+        if (iter->second.id == root_id)
+        {
+            ProtocolUtilities::InventoryFolderSkeleton *root = inventory.GetRoot();
+            iter->second.editable = false;
+            inventory.AddChildFolder(root, iter->second);
+            folders.erase(iter);
+            break;
+        }
+    }
+
+    ProtocolUtilities::InventoryFolderSkeleton *worldLibrary = inventory.GetChildFolderById(root_id);
     if (!worldLibrary)
         throw XmlRpcException("Failed to read inventory, inventory-lib-root value folder_id pointed to a nonexisting folder!");
 
     // Insert the detached folders onto the tree view until all folders have been added or there are orphans left
     // that cannot be added, and quit.
-    progress = true;
-    while(library_folders.size() > 0 && progress)
+    bool progress = true;
+    while(folders.size() > 0 && progress)
     {
         progress = false;
-        DetachedInventoryFolderList::iterator iter = library_folders.begin();
-        while(iter != library_folders.end())
+        DetachedInventoryFolderList::iterator iter = folders.begin();
+        while(iter != folders.end())
         {
             DetachedInventoryFolderList::iterator next = iter;
             ++next;
 
-            ProtocolUtilities::InventoryFolderSkeleton *parent = inventory->GetChildFolderById(iter->first);
+            ProtocolUtilities::InventoryFolderSkeleton *parent = inventory.GetChildFolderById(iter->first);
             if (parent)
             {
                 // Mark all World Libary folder descendents non-editable.
                 iter->second.editable = false;
-                parent->AddChildFolder(iter->second);
+                inventory.AddChildFolder(parent, iter->second);
                 progress = true;
-                library_folders.erase(iter);
+                folders.erase(iter);
             }
 
             iter = next;
         }
     }
-
-    return inventory;
 }
 
 // STATIC
@@ -8,13 +8,19 @@
 #ifndef incl_Protocol_InventoryParser_h
 #define incl_Protocol_InventoryParser_h
 
+#include "Inventory/InventorySkeleton.h"
+
+#include <list>
+
 namespace ProtocolUtilities
 {
-    class InventoryFolderSkeleton;
-
     class InventoryParser
     {
     public:
+        /// Folder read from the login reply, paired with its parent folder id.
+        typedef std::pair<RexUUID, ProtocolUtilities::InventoryFolderSkeleton> DetachedInventoryFolder;
+        typedef std::list<DetachedInventoryFolder> DetachedInventoryFolderList;
+
         /// This function reads the inventory tree that was stored in the XMLRPC login_to_simulator reply.
         /// @param call Pass in the object to a XMLRPCEPI call that has already been performed. Only the reply part will be read by this function.
         /// @return The inventory object, or null pointer if an error occurred.
@@ -22,6 +28,22 @@ namespace ProtocolUtilities
 
         static void SetErrorFolder(ProtocolUtilities::InventoryFolderSkeleton *root);
 
+        /// Adds the user's own inventory folders to the inventory tree.
+        /// @param inventory Inventory.
+        /// @param folders Folders of inventory-skeleton. Added folders are removed from the list, orphans are left.
+        /// @param root_id Folder id of inventory-root.
+        /// @throw XmlRpcException if the root folder is missing.
+        static void AddMyInventory(ProtocolUtilities::InventorySkeleton &inventory, DetachedInventoryFolderList &folders,
+            const RexUUID &root_id);
+
+        /// Adds the World Library folders to the inventory tree. All of them are non-editable.
+        /// @param inventory Inventory.
+        /// @param folders Folders of inventory-skel-lib. Added folders are removed from the list, orphans are left.
+        /// @param root_id Folder id of inventory-lib-root.
+        /// @throw XmlRpcException if the root folder is missing.
+        static void AddWorldLibrary(ProtocolUtilities::InventorySkeleton &inventory, DetachedInventoryFolderList &folders,
+            const RexUUID &root_id);
+
     private:
         /// Checks if the name of the folder belongs to the harcoded OpenSim folders.
         /// @param name name of the folder.
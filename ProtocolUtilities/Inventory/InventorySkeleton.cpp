@@ -70,6 +70,7 @@ namespace ProtocolUtilities
     {
         root_ = InventoryFolderSkeleton(RexUUID::CreateRandom(), "OpenSim Inventory");
         worldLibraryOwnerId = RexUUID();
+        IndexFolder(&root_);
     }
 
     InventoryFolderSkeleton *InventorySkeleton::GetFirstChildFolderByName(const char *searchName)
@@ -79,7 +80,30 @@ namespace ProtocolUtilities
 
     InventoryFolderSkeleton *InventorySkeleton::GetChildFolderById(const RexUUID &searchId)
     {
-        return root_.GetChildFolderById(searchId);
+        std::map<RexUUID, InventoryFolderSkeleton *>::const_iterator iter = folders_.find(searchId);
+        if (iter != folders_.end())
+            return iter->second;
+
+        return 0;
+    }
+
+    InventoryFolderSkeleton *InventorySkeleton::AddChildFolder(InventoryFolderSkeleton *parent, const InventoryFolderSkeleton &folder)
+    {
+        InventoryFolderSkeleton *newFolder = parent->AddChildFolder(folder);
+        IndexFolder(newFolder);
+        return newFolder;
+    }
+
+    void InventorySkeleton::IndexFolder(InventoryFolderSkeleton *folder)
+    {
+        // Keep the first folder of the id, like a depth first search would find.
+        folders_.insert(std::make_pair(folder->id, folder));
+
+        for(InventoryFolderSkeleton::FolderIter iter = folder->children.begin(); iter != folder->children.end(); ++iter)
+        {
+            iter->parent = folder;
+            IndexFolder(&*iter);
+        }
     }
 
     InventoryFolderSkeleton *InventorySkeleton::GetMyInventoryFolder()
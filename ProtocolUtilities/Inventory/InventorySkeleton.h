@@ -8,6 +8,8 @@
 
 #include "RexUUID.h"
 
+#include <map>
+
 namespace ProtocolUtilities
 {
     class InventoryAssetSkeleton
@@ -112,8 +114,15 @@ namespace ProtocolUtilities
         InventoryFolderSkeleton *GetFirstChildFolderByName(const char *searchName);
 
         /// @return Folder by the requested id or null if the folder isn't found.
+        /// @note Uses the id index, so only finds folders added with InventorySkeleton::AddChildFolder.
         InventoryFolderSkeleton *GetChildFolderById(const RexUUID &searchId);
 
+        /// Adds a copy of a folder and its descendents to a folder of this inventory, and indexes them by id.
+        /// @param parent Parent folder, must belong to this inventory.
+        /// @param folder Folder to be added.
+        /// @return Pointer to the added folder.
+        InventoryFolderSkeleton *AddChildFolder(InventoryFolderSkeleton *parent, const InventoryFolderSkeleton &folder);
+
         /// @return Pointer to "My Inventory" folder or null if not found.
         InventoryFolderSkeleton *GetMyInventoryFolder();
 
@@ -123,9 +132,15 @@ namespace ProtocolUtilities
         /// World Library owner id.
         RexUUID worldLibraryOwnerId;
 
-        private:
+    private:
+        /// Adds a folder and its descendents to the id index.
+        void IndexFolder(InventoryFolderSkeleton *folder);
+
         /// Root folder.
         InventoryFolderSkeleton root_;
+
+        /// Folders by id. Lookups by id are frequent while parsing the inventory.
+        std::map<RexUUID, InventoryFolderSkeleton *> folders_;
     };
 }
 
@@ -255,6 +255,8 @@ namespace ProtocolUtilities
     void NetMessageManager::HandleInboundBytes(std::vector<uint8_t> &data)
     {
         const size_t numBytes = data.size();
+        ++trafficTotals.receivedDatagrams;
+        trafficTotals.receivedDatabytes += numBytes;
 #ifdef PROFILING
         receivedDatagrams.InsertRecord(1.0);
         receivedDatabytes.InsertRecord(numBytes);
@@ -269,12 +271,15 @@ namespace ProtocolUtilities
 
         uint32_t seqNum = ExtractNetworkMessageSequenceNumber(&data[0], numBytes);
 
-#ifdef PROFILING
         if (receivedSequenceNumbers.size() > 0 && seqNum - lastReceivedSequenceNumber < 16)
             for(int i = lastReceivedSequenceNumber+1; i < seqNum; ++i)
                 if (receivedSequenceNumbers.find(i) == receivedSequenceNumbers.end())
+                {
+                    ++trafficTotals.lostPackets;
+#ifdef PROFILING
                     lostPackets.InsertRecord(1.0);
 #endif
+                }
         lastReceivedSequenceNumber = seqNum;
 
         // Send ACK for reliable messages.
@@ -286,6 +291,7 @@ namespace ProtocolUtilities
         pair<set<uint32_t>::iterator, bool> ret = receivedSequenceNumbers.insert(seqNum);
         if (ret.second == false) 
         {
+            ++trafficTotals.duplicatesReceived;
 #ifdef PROFILING
             duplicatesReceived.InsertRecord(1.0);
 #endif
@@ -529,6 +535,8 @@ namespace ProtocolUtilities
         assert(data.size() > 0);
         connection->SendBytes(&data[0], data.size());
 
+        ++trafficTotals.sentDatagrams;
+        trafficTotals.sentDatabytes += data.size();
 #ifdef PROFILING
         sentDatagrams.InsertRecord(1.0);
         sentDatabytes.InsertRecord(data.size());
@@ -706,6 +714,7 @@ namespace ProtocolUtilities
                 it->second->MarkResend();
                 SendProcessedMessage(it->second);
                 //std::cout << "Resending packet " << it->second->GetSequenceNumber() << std::endl;
+                ++trafficTotals.resentPackets;
 #ifdef PROFILING
                 resentPackets.InsertRecord(1.0);
 #endif
@@ -97,6 +97,24 @@ namespace ProtocolUtilities
         /// A history of occurrences of when we have received a duplicate packet and have discarded it.
         EventHistory duplicatesReceived;
 #endif
+        /// Running totals of network traffic since the manager was created. Kept also without PROFILING, for metrics export.
+        struct TrafficTotals
+        {
+            TrafficTotals() : sentDatagrams(0), sentDatabytes(0), receivedDatagrams(0), receivedDatabytes(0),
+                resentPackets(0), lostPackets(0), duplicatesReceived(0) {}
+
+            uint64_t sentDatagrams;
+            uint64_t sentDatabytes;
+            uint64_t receivedDatagrams;
+            uint64_t receivedDatabytes;
+            uint64_t resentPackets;
+            uint64_t lostPackets;
+            uint64_t duplicatesReceived;
+        };
+
+        /// @return Running totals of network traffic.
+        const TrafficTotals &GetTrafficTotals() const { return trafficTotals; }
+
         /// Round-trip time in milliseconds. Calculated using ping messages.
         double lastRoundTripTime;
 
@@ -215,6 +233,9 @@ namespace ProtocolUtilities
 
         /// How much time has elapsed in CPU ticks since we've heard from the server last time.
         Core::tick_t lastHeardSinceTick;
+
+        /// Running totals of network traffic.
+        TrafficTotals trafficTotals;
     };
 }
 
@@ -0,0 +1,132 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+/**
+ *  @file   LoginReplyParser.cpp
+ *  @brief  Reads the login_to_simulator reply while it is being received.
+ */
+
+#include "StableHeaders.h"
+#include "OpenSim/LoginReplyParser.h"
+
+#include <cstdlib>
+
+namespace ProtocolUtilities
+{
+    /// Returns a value of a struct, or empty string if not present.
+    static std::string GetStructValue(const XmlRpcStruct &values, const char *name)
+    {
+        XmlRpcStruct::const_iterator it = values.find(name);
+        if (it != values.end())
+            return it->second;
+        return std::string();
+    }
+
+    /// Reads an inventory folder of inventory-skeleton or inventory-skel-lib.
+    static InventoryParser::DetachedInventoryFolder ReadFolder(const XmlRpcStruct &values)
+    {
+        InventoryParser::DetachedInventoryFolder folder;
+        folder.second.name = GetStructValue(values, "name");
+        folder.first.FromString(GetStructValue(values, "parent_id"));
+        folder.second.version = atoi(GetStructValue(values, "version").c_str());
+        folder.second.type_default = atoi(GetStructValue(values, "type_default").c_str());
+        folder.second.id.FromString(GetStructValue(values, "folder_id"));
+        return folder;
+    }
+
+    LoginReplyParser::LoginReplyParser() :
+        hasInventory_(false),
+        hasLibrary_(false),
+        buddyList_(new ProtocolUtilities::BuddyList())
+    {
+    }
+
+    void LoginReplyParser::OnMember(const std::string &name, const std::string &value)
+    {
+        // In Taiga inventory-lib-owner isn't array, just single value.
+        if (name == "inventory-lib-owner")
+            libraryOwnerId_.FromString(value);
+
+        members_[name] = value;
+    }
+
+    void LoginReplyParser::OnArrayStruct(const std::string &array, const XmlRpcStruct &values)
+    {
+        if (array == "inventory-skeleton")
+        {
+            folders_.push_back(ReadFolder(values));
+            hasInventory_ = true;
+        }
+        else if (array == "inventory-skel-lib")
+        {
+            libraryFolders_.push_back(ReadFolder(values));
+            hasLibrary_ = true;
+        }
+        else if (array == "buddy-list")
+        {
+            RexUUID id(GetStructValue(values, "buddy_id"));
+            int rights_given = atoi(GetStructValue(values, "buddy_rights_given").c_str());
+            int rights_has = atoi(GetStructValue(values, "buddy_rights_has").c_str());
+            buddyList_->AddBuddy(new ProtocolUtilities::Buddy(id, rights_given, rights_has));
+        }
+        // Only the first struct of the single value arrays counts.
+        else if (array == "inventory-root" && inventoryRootId_.IsNull())
+            inventoryRootId_.FromString(GetStructValue(values, "folder_id"));
+        else if (array == "inventory-lib-root" && libraryRootId_.IsNull())
+            libraryRootId_.FromString(GetStructValue(values, "folder_id"));
+        else if (array == "inventory-lib-owner" && libraryOwnerId_.IsNull())
+            libraryOwnerId_.FromString(GetStructValue(values, "agent_id"));
+    }
+
+    void LoginReplyParser::OnFault(int code, const std::string &message)
+    {
+        if (!HasReply("message"))
+            members_["message"] = message;
+    }
+
+    std::string LoginReplyParser::GetGridAddress() const
+    {
+        std::string gridUrl = GetReply<std::string>("sim_ip");
+        if (gridUrl.size() == 0)
+            return "";
+
+        int region_udp_port = GetReply<int>("sim_port");
+        if (region_udp_port <= 0 || region_udp_port >= 65536)
+            return "";
+
+        std::stringstream out;
+        out << gridUrl << ":" << region_udp_port;
+
+        return out.str();
+    }
+
+    boost::shared_ptr<ProtocolUtilities::InventorySkeleton> LoginReplyParser::GetInventory()
+    {
+        boost::shared_ptr<ProtocolUtilities::InventorySkeleton> inventory(new ProtocolUtilities::InventorySkeleton);
+
+        /********** My Inventory **********/
+        if (!hasInventory_)
+            throw XmlRpcException("Failed to read inventory, inventory-skeleton in the reply was not properly formed!");
+
+        if (inventoryRootId_.IsNull())
+            throw XmlRpcException("Failed to read inventory, inventory-root value folder_id was null or unparseable!");
+
+        InventoryParser::AddMyInventory(*inventory, folders_, inventoryRootId_);
+
+        /********** World Library **********/
+        if (libraryOwnerId_.IsNull())
+            throw XmlRpcException("Failed to read inventory, inventory-lib-owner value agent_id was null or unparseable!");
+
+        inventory->worldLibraryOwnerId = libraryOwnerId_;
+
+        // Note: E.g. ScienceSim doens't have have World Library.
+        if (!hasLibrary_)
+            return inventory;
+
+        if (libraryRootId_.IsNull())
+            throw XmlRpcException("Failed to read inventory, inventory-lib-root value folder_id was null or unparseable!");
+
+        InventoryParser::AddWorldLibrary(*inventory, libraryFolders_, libraryRootId_);
+
+        return inventory;
+    }
+}
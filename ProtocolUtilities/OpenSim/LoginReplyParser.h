@@ -0,0 +1,106 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+/**
+ *  @file   LoginReplyParser.h
+ *  @brief  Reads the login_to_simulator reply while it is being received.
+ */
+
+#ifndef incl_Protocol_LoginReplyParser_h
+#define incl_Protocol_LoginReplyParser_h
+
+#include "XmlRpcStreamReader.h"
+#include "XmlRpcException.h"
+#include "OpenSim/BuddyList.h"
+#include "Inventory/InventoryParser.h"
+
+#include <boost/lexical_cast.hpp>
+
+namespace ProtocolUtilities
+{
+    /// Reads the login reply values as they are received with XmlRpcEpi::Send(XmlRpcReplyHandler &).
+    /** Inventory folders and buddies are read when their structs arrive, so nothing is left to parse when the
+        reply ends except linking the folders to the inventory tree.
+    */
+    class LoginReplyParser : public XmlRpcReplyHandler
+    {
+    public:
+        /// Default constructor.
+        LoginReplyParser();
+
+        /// XmlRpcReplyHandler override.
+        virtual void OnMember(const std::string &name, const std::string &value);
+
+        /// XmlRpcReplyHandler override.
+        virtual void OnArrayStruct(const std::string &array, const XmlRpcStruct &values);
+
+        /// XmlRpcReplyHandler override. The fault string is readable as "message".
+        virtual void OnFault(int code, const std::string &message);
+
+        /// @return Does the reply contain a scalar value.
+        bool HasReply(const char *name) const { return members_.find(name) != members_.end(); }
+
+        /// Returns a scalar value of the reply.
+        /// @throw XmlRpcException if there is no such value or it can't be converted.
+        template <typename T> T GetReply(const char *name) const;
+
+        /// @return The ip:port to connect to with the UDP socket, or "" if there was an error.
+        std::string GetGridAddress() const;
+
+        /// Builds the inventory tree from the received folders. Call only once.
+        /// @throw XmlRpcException if the inventory in the reply was not properly formed.
+        boost::shared_ptr<ProtocolUtilities::InventorySkeleton> GetInventory();
+
+        /// @return Buddy list, empty if the reply didn't have one.
+        ProtocolUtilities::BuddyListPtr GetBuddyList() const { return buddyList_; }
+
+    private:
+        /// Scalar values of the reply.
+        std::map<std::string, std::string> members_;
+
+        /// Folders of inventory-skeleton.
+        InventoryParser::DetachedInventoryFolderList folders_;
+
+        /// Folders of inventory-skel-lib.
+        InventoryParser::DetachedInventoryFolderList libraryFolders_;
+
+        /// Was inventory-skeleton present.
+        bool hasInventory_;
+
+        /// Was inventory-skel-lib present.
+        bool hasLibrary_;
+
+        /// Folder id of inventory-root.
+        RexUUID inventoryRootId_;
+
+        /// Folder id of inventory-lib-root.
+        RexUUID libraryRootId_;
+
+        /// Agent id of inventory-lib-owner.
+        RexUUID libraryOwnerId_;
+
+        /// Buddies of buddy-list.
+        ProtocolUtilities::BuddyListPtr buddyList_;
+    };
+
+    template <> inline std::string LoginReplyParser::GetReply<std::string>(const char *name) const
+    {
+        std::map<std::string, std::string>::const_iterator it = members_.find(name);
+        if (it == members_.end())
+            throw XmlRpcException(std::string("Login reply did not contain ") + name);
+        return it->second;
+    }
+
+    template <typename T> T LoginReplyParser::GetReply(const char *name) const
+    {
+        try
+        {
+            return boost::lexical_cast<T>(GetReply<std::string>(name));
+        }
+        catch(boost::bad_lexical_cast &)
+        {
+            throw XmlRpcException(std::string("Login reply value was invalid: ") + name);
+        }
+    }
+}
+
+#endif // incl_Protocol_LoginReplyParser_h
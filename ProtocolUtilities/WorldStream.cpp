@@ -6,6 +6,7 @@
 #include "WorldStream.h"
 #include "RealXtend/RexProtocolMsgIDs.h"
 #include "NetworkMessages/NetOutMessage.h"
+#include "NetworkMessages/NetMessageManager.h"
 
 #include "ProtocolModuleOpenSim.h"
 #include "ProtocolModuleTaiga.h"
@@ -13,6 +14,7 @@
 #include "Framework.h"
 #include "ConfigurationManager.h"
 #include "ModuleManager.h"
+#include "MetricsExporter.h"
 #include "RexTypes.h"
 #include "LoggingFunctions.h"
 #include "EC_OpenSimPrim.h"
@@ -23,6 +25,8 @@ DEFINE_POCO_LOGGING_FUNCTIONS("WorldStream");
 #include <QUrl>
 #include <QStringList>
 
+#include <boost/bind.hpp>
+
 #include "MemoryLeakCheck.h"
 
 namespace ProtocolUtilities
@@ -39,15 +43,21 @@ WorldStream::WorldStream(Foundation::Framework *framework) :
     password_(""),
     username_(""),
     auth_server_address_(""),
-    blockSerialNumber_(0)
+    blockSerialNumber_(0),
+    metricsSource_(0)
 {
     clientParameters_.Reset();
     SetCurrentProtocolType(NotSet);
+    metricsSource_ = framework_->GetMetricsExporter()->RegisterSource("network",
+        boost::bind(&WorldStream::CollectNetworkMetrics, this, _1));
     LogInfo("World Stream created and ready.");
 }
 
 WorldStream::~WorldStream()
 {
+    Foundation::MetricsExporterPtr exporter = framework_->GetMetricsExporter();
+    if (exporter)
+        exporter->UnregisterSource(metricsSource_);
 }
 
 bool WorldStream::CreateUdpConnection()
@@ -1876,4 +1886,29 @@ void WorldStream::WriteFloatToBytes(float value, uint8_t* bytes, int& idx)
     idx += sizeof(float);
 }
 
+void WorldStream::CollectNetworkMetrics(Foundation::MetricValues &values)
+{
+    if (!connected_)
+        return;
+
+    boost::shared_ptr<ProtocolModuleInterface> protocol = GetCurrentProtocolModule();
+    NetMessageManager *netMessageManager = protocol ? protocol->GetNetworkMessageManager() : 0;
+    if (!netMessageManager)
+        return;
+
+    // Totals since the connection was made
+    const NetMessageManager::TrafficTotals &totals = netMessageManager->GetTrafficTotals();
+    values.push_back(std::make_pair("packets_sent", (double)totals.sentDatagrams));
+    values.push_back(std::make_pair("bytes_sent", (double)totals.sentDatabytes));
+    values.push_back(std::make_pair("packets_received", (double)totals.receivedDatagrams));
+    values.push_back(std::make_pair("bytes_received", (double)totals.receivedDatabytes));
+    values.push_back(std::make_pair("packets_resent", (double)totals.resentPackets));
+    values.push_back(std::make_pair("packets_lost", (double)totals.lostPackets));
+    values.push_back(std::make_pair("packets_duplicate", (double)totals.duplicatesReceived));
+
+    values.push_back(std::make_pair("rtt_ms", netMessageManager->smoothenedRoundTripTime));
+    values.push_back(std::make_pair("last_heard_ms", netMessageManager->lastHeardSince));
+    values.push_back(std::make_pair("unacked_packets", (double)netMessageManager->NumUnackedReliablePackets()));
+}
+
 } // namespace ProtocolUtilities
@@ -7,6 +7,7 @@
 #include "Vector3D.h"
 #include "Quaternion.h"
 #include "NetworkEvents.h"
+#include "MetricsExporter.h"
 
 #include <QObject>
 
@@ -567,6 +568,9 @@ namespace ProtocolUtilities
         /// WriteFloatToBytes
         void WriteFloatToBytes(float value, uint8_t* bytes, int& idx);
 
+        /// Adds the network traffic totals and round-trip time of the current connection to a metrics sample.
+        void CollectNetworkMetrics(Foundation::MetricValues &values);
+
         /// The framework we belong to.
         Foundation::Framework *framework_;
 
@@ -617,6 +621,9 @@ namespace ProtocolUtilities
 
         /// Block serial number used for AgentPause and AgentResume messages.
         uint32_t blockSerialNumber_;
+
+        /// Id of the network metrics source.
+        Foundation::metric_source_id_t metricsSource_;
     };
 }
 
@@ -115,6 +115,9 @@ rexlogic_->GetInventory()->GetFirstChildFolderByName("Trash");
 
 #include <propertyeditor.h>
 
+#include <algorithm>
+#include <sstream>
+
 // =========== Note py developers: MemoryLeakCheck must be the last include =========== //
 #include <PlayerService.h>
 #include <WorldBuildingServiceInterface.h>
@@ -129,6 +132,26 @@ rexlogic_->GetInventory()->GetFirstChildFolderByName("Trash");
 
 namespace PythonScript
 {
+    //! Adds the time spent in its scope to the timing of a py module manager method.
+    class HandlerTimer
+    {
+    public:
+        explicit HandlerTimer(HandlerTiming &timing) : timing_(timing), start_(Core::GetCurrentClockTime()) {}
+
+        ~HandlerTimer()
+        {
+            Core::tick_t elapsed = Core::GetCurrentClockTime() - start_;
+            ++timing_.calls;
+            timing_.total += elapsed;
+            if (elapsed > timing_.max)
+                timing_.max = elapsed;
+        }
+
+    private:
+        HandlerTiming &timing_;
+        Core::tick_t start_;
+    };
+
     std::string PythonScriptModule::type_name_static_ = "PythonScript";
 
     PythonScriptModule *PythonScriptModule::pythonScriptModuleInstance_ = 0;
@@ -140,6 +163,7 @@ namespace PythonScript
         inputeventcategoryid = 0;
         networkstate_category_id = 0;
         framework_category_id = 0;
+        batch_scene_events_ = false;
     }
 
     PythonScriptModule::~PythonScriptModule()
@@ -207,6 +231,10 @@ namespace PythonScript
         else
             LogInfo("No registered events in the input category.");
 
+        // Scene event ids in the (event id, entity id) tuples given to SCENE_EVENTS
+        PyModule_AddIntConstant(apiModule, "EntityUpdated", Scene::Events::EVENT_ENTITY_UPDATED);
+        PyModule_AddIntConstant(apiModule, "EntityVisualsModified", Scene::Events::EVENT_ENTITY_VISUALS_MODIFIED);
+
         /*for (Foundation::EventManager::EventMap::const_iterator iter = evmap[inputeventcategoryid].begin();
             iter != evmap[inputeventcategoryid].end(); ++iter)
         {
@@ -230,6 +258,11 @@ namespace PythonScript
         if (PyCallable_Check(pmmClass)) {
             pmmInstance = PyObject_CallObject(pmmClass, NULL); 
             LogInfo("Instanciated Py ModuleManager.");
+
+            // A manager that can take the scene events of a frame in one call opts in by having SCENE_EVENTS
+            batch_scene_events_ = pmmInstance && PyObject_HasAttrString(pmmInstance, "SCENE_EVENTS");
+            if (batch_scene_events_)
+                LogInfo("Py ModuleManager gets scene events batched per frame.");
         } else {
             LogError("Unable to create instance from class ModuleManager");
         }
@@ -248,6 +281,10 @@ namespace PythonScript
         RegisterConsoleCommand(Console::CreateCommand(
             "PyReset", "Resets the Python interpreter - should free all it's memory, and clear all state.", 
             Console::Bind(this, &PythonScriptModule::ConsoleReset))); 
+
+        RegisterConsoleCommand(Console::CreateCommand(
+            "PyHandlerTimes", "Shows the time spent in each Python component handler, and in the calls to the py module manager, slowest first. Usage: PyHandlerTimes(reset) to clear.", 
+            Console::Bind(this, &PythonScriptModule::ConsoleHandlerTimes))); 
     }
 
     bool PythonScriptModule::HandleEvent(event_category_id_t category_id, event_id_t event_id, Foundation::EventDataInterface* data)
@@ -281,7 +318,15 @@ namespace PythonScript
                 //LogInfo("Entity updated.");
                 unsigned int ent_id = edata->localID;
                 if (ent_id != 0)
-                    value = PyObject_CallMethod(pmmInstance, "ENTITY_UPDATED", "I", ent_id);
+                {
+                    if (batch_scene_events_)
+                        QueueSceneEvent(event_id, ent_id);
+                    else
+                    {
+                        HandlerTimer timer(GetHandlerTiming("ENTITY_UPDATED"));
+                        value = PyObject_CallMethod(pmmInstance, "ENTITY_UPDATED", "I", ent_id);
+                    }
+                }
             }
             //todo: add EVENT_ENTITY_DELETED so that e.g. editgui can keep on track in collaborative editing when objs it keeps refs disappear
 
@@ -296,7 +341,13 @@ namespace PythonScript
                 if (!entity)
                     return false;
 
-                value = PyObject_CallMethod(pmmInstance, "ENTITY_VISUALS_MODIFIED", "I", entity->GetId());
+                if (batch_scene_events_)
+                    QueueSceneEvent(event_id, entity->GetId());
+                else
+                {
+                    HandlerTimer timer(GetHandlerTiming("ENTITY_VISUALS_MODIFIED"));
+                    value = PyObject_CallMethod(pmmInstance, "ENTITY_VISUALS_MODIFIED", "I", entity->GetId());
+                }
             }
 
             //how to pass any event data?
@@ -392,6 +443,7 @@ namespace PythonScript
                     Py_DECREF(pys);
                 }
 
+                HandlerTimer timer(GetHandlerTiming("GENERIC_MESSAGE"));
                 value = PyObject_CallMethod(pmmInstance, "GENERIC_MESSAGE", "sO", cxxmsgname.c_str(), stringlist);
             }
             /*else
@@ -505,6 +557,111 @@ namespace PythonScript
         return Console::ResultSuccess();
     }    
 
+    Console::CommandResult PythonScriptModule::ConsoleHandlerTimes(const StringVector &params)
+    {
+        // The component handlers are timed by the py module manager, if it supports it
+        bool component_times = pmmInstance && PyObject_HasAttrString(pmmInstance, "handler_times");
+
+        if (params.size() == 1 && params[0] == "reset")
+        {
+            handler_times_.clear();
+            if (component_times)
+            {
+                PyObject *value = PyObject_CallMethod(pmmInstance, "reset_handler_times", "");
+                if (value)
+                    Py_DECREF(value);
+                else
+                    PyErr_Print();
+            }
+            return Console::ResultSuccess("Python handler times cleared.");
+        }
+
+        std::stringstream ss;
+        if (component_times)
+        {
+            // List of (name, calls, total secs, max secs), slowest in total first
+            PyObject *times = PyObject_CallMethod(pmmInstance, "handler_times", "");
+            if (times && PyList_Check(times))
+            {
+                ss << "Component handler, calls, total ms, average ms, max ms" << std::endl;
+                for(Py_ssize_t i = 0; i < PyList_GET_SIZE(times); ++i)
+                {
+                    const char *name = 0;
+                    uint calls = 0;
+                    double total = 0.0, max = 0.0;
+                    if (!PyArg_ParseTuple(PyList_GET_ITEM(times, i), "sIdd", &name, &calls, &total, &max))
+                    {
+                        PyErr_Print();
+                        break;
+                    }
+                    ss << name << ", " << calls << ", " << total * 1000.0 << ", " << (calls ? total * 1000.0 / calls : 0.0)
+                        << ", " << max * 1000.0 << std::endl;
+                }
+                ss << std::endl;
+            }
+            else
+                PyErr_Print();
+            Py_XDECREF(times);
+        }
+
+        // Slowest in total first
+        std::vector<std::pair<Core::tick_t, std::string> > order;
+        for(std::map<std::string, HandlerTiming>::const_iterator i = handler_times_.begin(); i != handler_times_.end(); ++i)
+            order.push_back(std::make_pair(i->second.total, i->first));
+        std::sort(order.rbegin(), order.rend());
+
+        // Each call to the py module manager fans out to the handlers of all components listening to it
+        const double ms_per_tick = 1000.0 / Core::GetCurrentClockFreq();
+        ss << "Module manager method, calls, total ms, average ms, max ms" << std::endl;
+        for(size_t i = 0; i < order.size(); ++i)
+        {
+            const HandlerTiming &timing = handler_times_[order[i].second];
+            ss << order[i].second << ", " << timing.calls << ", " << timing.total * ms_per_tick << ", "
+                << (timing.calls ? timing.total * ms_per_tick / timing.calls : 0.0) << ", " << timing.max * ms_per_tick << std::endl;
+        }
+
+        return Console::ResultSuccess(ss.str());
+    }
+
+    void PythonScriptModule::QueueSceneEvent(event_id_t event_id, entity_id_t ent_id)
+    {
+        std::pair<event_id_t, entity_id_t> scene_event(event_id, ent_id);
+        if (scene_event_set_.insert(scene_event).second)
+            scene_event_batch_.push_back(scene_event);
+    }
+
+    void PythonScriptModule::FlushSceneEvents()
+    {
+        if (scene_event_batch_.empty())
+            return;
+
+        PyObject *events = PyList_New(scene_event_batch_.size());
+        for(size_t i = 0; events && i < scene_event_batch_.size(); ++i)
+            PyList_SET_ITEM(events, i, Py_BuildValue("(iI)", scene_event_batch_[i].first, scene_event_batch_[i].second));
+
+        // Events caused by the handlers go to next frame's batch
+        scene_event_batch_.clear();
+        scene_event_set_.clear();
+
+        if (!events)
+        {
+            PyErr_Print();
+            return;
+        }
+
+        PyObject *value = 0;
+        {
+            HandlerTimer timer(GetHandlerTiming("SCENE_EVENTS"));
+            value = PyObject_CallMethod(pmmInstance, "SCENE_EVENTS", "O", events);
+        }
+
+        if (value)
+            Py_DECREF(value);
+        else
+            PyErr_Print();
+        Py_DECREF(events);
+    }
+
     // virtual 
     void PythonScriptModule::Uninitialize()
     {        
@@ -532,7 +689,12 @@ namespace PythonScript
 
         // Somehow this causes extreme lag in consoleless mode         
         if (pmmInstance != NULL)
+        {
+            FlushSceneEvents();
+
+            HandlerTimer timer(GetHandlerTiming("run"));
             PyObject_CallMethod(pmmInstance, "run", "f", frametime);
+        }
         
         /*char** args = new char*[2]; //is this 2 'cause the latter terminates?
         std::string methodname = "run";
@@ -836,6 +998,149 @@ PyObject* GetEntity(PyObject *self, PyObject *args)
     }
 }
 
+//! Floats per entity in the buffers of getTransforms and setTransforms: position x, y, z, orientation x, y, z, w.
+static const int TRANSFORM_FLOATS = 7;
+
+//! Reads entity ids from a py sequence. Sets a py exception and returns false on failure.
+static bool ParseEntityIds(PyObject *seq, std::vector<entity_id_t> &ids)
+{
+    PyObject *fast = PySequence_Fast(seq, "Entity ids should be a sequence of integers.");
+    if (!fast)
+        return false;
+
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(fast);
+    PyObject **items = PySequence_Fast_ITEMS(fast);
+    ids.resize(count);
+    for(Py_ssize_t i = 0; i < count; ++i)
+    {
+        ids[i] = (entity_id_t)PyInt_AsUnsignedLongMask(items[i]);
+        if (PyErr_Occurred())
+        {
+            Py_DECREF(fast);
+            return false;
+        }
+    }
+
+    Py_DECREF(fast);
+    return true;
+}
+
+PyObject* GetTransforms(PyObject *self, PyObject *args)
+{
+    PyObject *idseq;
+    PyObject *bufobj = NULL;
+    if (!PyArg_ParseTuple(args, "O|O", &idseq, &bufobj))
+        return NULL;
+
+    std::vector<entity_id_t> ids;
+    if (!ParseEntityIds(idseq, ids))
+        return NULL;
+
+    Scene::ScenePtr scene = PythonScriptModule::GetInstance()->GetScenePtr();
+    if (!scene)
+    {
+        PyErr_SetString(PyExc_ValueError, "Scene is none.");
+        return NULL;
+    }
+
+    // Fill the caller's buffer if given, so that it can be reused every frame
+    const Py_ssize_t size = ids.size() * TRANSFORM_FLOATS * sizeof(float);
+    PyObject *result;
+    void *data;
+    Py_ssize_t len;
+    if (bufobj && bufobj != Py_None)
+    {
+        if (PyObject_AsWriteBuffer(bufobj, &data, &len) != 0)
+            return NULL;
+        if (len < size)
+        {
+            PyErr_SetString(PyExc_ValueError, "Transform buffer is too small, it needs 7 floats per entity.");
+            return NULL;
+        }
+        result = bufobj;
+        Py_INCREF(result);
+    }
+    else
+    {
+        result = PyByteArray_FromStringAndSize(NULL, size);
+        if (!result)
+            return NULL;
+        data = PyByteArray_AS_STRING(result);
+    }
+
+    float *out = static_cast<float *>(data);
+    for(size_t i = 0; i < ids.size(); ++i, out += TRANSFORM_FLOATS)
+    {
+        // Entities without a placeable get zero position & identity orientation, same as in javascript
+        Vector3df pos(0.0f, 0.0f, 0.0f);
+        Quaternion orient(0.0f, 0.0f, 0.0f, 1.0f);
+        Scene::EntityPtr entity = scene->GetEntity(ids[i]);
+        OgreRenderer::EC_OgrePlaceable *placeable = entity ? entity->GetComponent<OgreRenderer::EC_OgrePlaceable>().get() : 0;
+        if (placeable)
+        {
+            pos = placeable->GetPosition();
+            orient = placeable->GetOrientation();
+        }
+
+        out[0] = pos.x;
+        out[1] = pos.y;
+        out[2] = pos.z;
+        out[3] = orient.x;
+        out[4] = orient.y;
+        out[5] = orient.z;
+        out[6] = orient.w;
+    }
+
+    return result;
+}
+
+PyObject* SetTransforms(PyObject *self, PyObject *args)
+{
+    PyObject *idseq;
+    PyObject *bufobj;
+    if (!PyArg_ParseTuple(args, "OO", &idseq, &bufobj))
+        return NULL;
+
+    std::vector<entity_id_t> ids;
+    if (!ParseEntityIds(idseq, ids))
+        return NULL;
+
+    const void *data;
+    Py_ssize_t len;
+    if (PyObject_AsReadBuffer(bufobj, &data, &len) != 0)
+        return NULL;
+    if (len < (Py_ssize_t)(ids.size() * TRANSFORM_FLOATS * sizeof(float)))
+    {
+        PyErr_SetString(PyExc_ValueError, "Transform buffer is too small, it needs 7 floats per entity.");
+        return NULL;
+    }
+
+    Scene::ScenePtr scene = PythonScriptModule::GetInstance()->GetScenePtr();
+    if (!scene)
+    {
+        PyErr_SetString(PyExc_ValueError, "Scene is none.");
+        return NULL;
+    }
+
+    const float *in = static_cast<const float *>(data);
+    unsigned int count = 0;
+    for(size_t i = 0; i < ids.size(); ++i, in += TRANSFORM_FLOATS)
+    {
+        Scene::EntityPtr entity = scene->GetEntity(ids[i]);
+        if (!entity)
+            continue;
+        OgreRenderer::EC_OgrePlaceable *placeable = entity->GetComponent<OgreRenderer::EC_OgrePlaceable>().get();
+        if (!placeable)
+            continue;
+
+        placeable->SetPosition(Vector3df(in[0], in[1], in[2]));
+        placeable->SetOrientation(Quaternion(in[3], in[4], in[5], in[6]));
+        ++count;
+    }
+
+    return Py_BuildValue("I", count);
+}
+
 PyObject* GetEntityByUUID(PyObject *self, PyObject *args)
 {
     char* uuidstr;
@@ -1089,6 +1394,7 @@ void PythonScriptModule::HandleKeyEvent(KeyEvent &key)
     static const event_id_t KEY_PRESSED = 39;
     static const event_id_t KEY_RELEASED = 40;
 
+    HandlerTimer timer(GetHandlerTiming("KEY_INPUT_EVENT"));
     if (key.eventType == KeyEvent::KeyPressed)
         PyObject_CallMethod(pmmInstance, "KEY_INPUT_EVENT", "iii", KEY_PRESSED, key.keyCode, key.modifiers);
 //        if (!PyObject_CallMethod(pmmInstance, "KEY_INPUT_EVENT", "iii", KEY_PRESSED, key.keyCode, key.modifiers))
@@ -1114,6 +1420,7 @@ void PythonScriptModule::HandleMouseEvent(MouseEvent &mouse)
     case MouseEvent::MouseMove:
         if (mouse.IsLeftButtonDown())
         {
+            HandlerTimer timer(GetHandlerTiming("MOUSE_DRAG_INPUT_EVENT"));
             PyObject_CallMethod(pmmInstance, "MOUSE_DRAG_INPUT_EVENT", "iiiii", Input::Events::MOUSEDRAG, mouse.x, mouse.y, mouse.relativeX, mouse.relativeY);
 //            if (!PyObject_CallMethod(pmmInstance, "MOUSE_DRAG_INPUT_EVENT", "iiiii", Input::Events::MOUSEDRAG, mouse.x, mouse.y, mouse.relativeX, mouse.relativeY))
 //                LogWarning("PyObject_CallMethod(MOUSE_DRAG_INPUT_EVENT) failed!");
@@ -1135,7 +1442,10 @@ void PythonScriptModule::HandleMouseEvent(MouseEvent &mouse)
     }
 
     if (eventID != 0)
+    {
+        HandlerTimer timer(GetHandlerTiming("MOUSE_INPUT_EVENT"));
         PyObject_CallMethod(pmmInstance, "MOUSE_INPUT_EVENT", "iiiii", eventID, mouse.x, mouse.y, mouse.relativeX, mouse.relativeY);
+    }
 //        if (!PyObject_CallMethod(pmmInstance, "MOUSE_INPUT_EVENT", "iiiii", eventID, mouse.x, mouse.y, mouse.relativeX, mouse.relativeY))
 //            LogWarning("PyObject_CallMethod(MOUSE_INPUT_EVENT) failed!");
 
@@ -1999,6 +2309,14 @@ static PyMethodDef EmbMethods[] = {
     {"getEntity", (PyCFunction)GetEntity, METH_VARARGS,
     "Gets the entity with the given ID."},
 
+    {"getTransforms", (PyCFunction)GetTransforms, METH_VARARGS,
+    "Gets the positions and orientations of many entities in one call. Parameters: sequence of entity ids, optional writable buffer, e.g. array.array('f'). "
+    "Returns the buffer, or a new bytearray, with 7 floats per entity: position x, y, z, orientation x, y, z, w. Entities without a placeable get position 0, 0, 0 and orientation 0, 0, 0, 1."},
+
+    {"setTransforms", (PyCFunction)SetTransforms, METH_VARARGS,
+    "Sets the positions and orientations of many entities in one call. Parameters: sequence of entity ids, buffer with 7 floats per entity as in getTransforms. "
+    "Returns the number of entities set."},
+
     {"getEntityByUUID", (PyCFunction)GetEntityByUUID, METH_VARARGS,
     "Gets the entity with the given UUID."},
 
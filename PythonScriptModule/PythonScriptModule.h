@@ -7,6 +7,7 @@
 #include "Foundation.h"
 #include "ModuleInterface.h"
 #include "ModuleLoggingFunctions.h"
+#include "HighPerfClock.h"
 
 #include <QObject>
 #include <QList>
@@ -61,6 +62,19 @@ namespace PythonScript
     class PythonEngine;
     typedef boost::shared_ptr<PythonEngine> PythonEnginePtr;
 
+    //! Time spent in calls to one method of the py module manager
+    struct HandlerTiming
+    {
+        HandlerTiming() : calls(0), total(0), max(0) {}
+
+        //! Number of calls
+        uint calls;
+        //! Total time, in clock ticks
+        Core::tick_t total;
+        //! Longest call, in clock ticks
+        Core::tick_t max;
+    };
+
     //! A scripting module using Python
     class MODULE_API PythonScriptModule : public QObject, public Foundation::ModuleInterface
     {
@@ -89,6 +103,7 @@ namespace PythonScript
         Console::CommandResult ConsoleRunString(const StringVector &params);
         Console::CommandResult ConsoleRunFile(const StringVector &params);
         Console::CommandResult ConsoleReset(const StringVector &params);
+        Console::CommandResult ConsoleHandlerTimes(const StringVector &params);
 
         MODULE_LOGGING_FUNCTIONS
 
@@ -140,6 +155,15 @@ namespace PythonScript
         PythonEnginePtr engine_;
         bool pythonqt_inited;
 
+        //! Queues a scene event for the batched SCENE_EVENTS call at the start of next frame.
+        void QueueSceneEvent(event_id_t event_id, entity_id_t ent_id);
+
+        //! Calls SCENE_EVENTS of the py module manager with the scene events queued during last frame.
+        void FlushSceneEvents();
+
+        //! Returns the timing record of a py module manager method.
+        HandlerTiming &GetHandlerTiming(const char *method) { return handler_times_[method]; }
+
         //basic feats
         void RunString(const char* codestr);
         void RunFile(const std::string &modulename);
@@ -172,6 +196,19 @@ namespace PythonScript
         /// The default input context for python code to access. This context operates below
         /// the Qt windowing priority.
         InputContextPtr input;
+
+        //! If true, the py module manager has a SCENE_EVENTS method, and entity updates are delivered to it
+        //! once per frame as a list instead of a call per event.
+        bool batch_scene_events_;
+
+        //! Scene events waiting for the batched call, as (event id, entity id) pairs in arrival order.
+        std::vector<std::pair<event_id_t, entity_id_t> > scene_event_batch_;
+
+        //! Queued scene events, for dropping duplicates within a frame.
+        std::set<std::pair<event_id_t, entity_id_t> > scene_event_set_;
+
+        //! Time spent in each py module manager method. The component handlers the calls fan out to are timed by the py module manager.
+        std::map<std::string, HandlerTiming> handler_times_;
     };
 
     static PythonScriptModule *self() { return PythonScriptModule::GetInstance(); }
@@ -653,6 +653,10 @@ namespace RexLogic
         if (!animctrl || !netpos || !appearance)
             return;
         
+        // Off-screen avatars are not animated, the speeds get adjusted when the avatar becomes visible
+        if (animctrl->GetLod() == EC_OgreAnimationController::LOD_FROZEN)
+            return;
+        
         const AnimationDefinitionMap& anim_defs = appearance->GetAnimations();
         
         const EC_OgreAnimationController::AnimationMap& running_anims = animctrl->GetRunningAnimations();
@@ -698,6 +702,11 @@ namespace RexLogic
         return avatar_appearance_.HandleAssetEvent(event_id, data);
     }
 
+    bool Avatar::HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data)
+    {
+        return avatar_appearance_.HandleTaskEvent(event_id, data);
+    }
+
     Scene::EntityPtr Avatar::GetUserAvatar() const
     {
         return owner_->GetUserAvatarEntity();
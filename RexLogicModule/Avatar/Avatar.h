@@ -80,6 +80,9 @@ namespace RexLogic
         //! Handles asset event
         bool HandleAssetEvent(event_id_t event_id, Foundation::EventDataInterface* data);
 
+        //! Handles thread task event
+        bool HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data);
+
         //! Handles logout
         void HandleLogout();
 
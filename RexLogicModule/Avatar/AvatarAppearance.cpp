@@ -5,6 +5,7 @@
 #include "Avatar/AvatarAppearance.h"
 #include "Avatar/AvatarEditor.h"
 #include "Avatar/AvatarExporter.h"
+#include "Avatar/AvatarAppearanceBaker.h"
 #include "LegacyAvatarSerializer.h"
 #include "RexLogicModule.h"
 #include "EntityComponent/EC_OpenSimAvatar.h"
@@ -34,10 +35,12 @@
 #include "CoreStringUtils.h"
 #include "ServiceManager.h"
 #include "EventManager.h"
+#include "ThreadTaskManager.h"
 #include "WorldStream.h"
 #include "EC_HoveringText.h"
 
 #include <QDomDocument>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QTime>
 
@@ -48,6 +51,8 @@ using namespace RexTypes;
 static const Real FIXED_HEIGHT_OFFSET = -0.87f;
 static const Real OVERLAY_HEIGHT_MULTIPLIER = 1.5f;
 static const uint XMLRPC_ASSET_HASH_LENGTH = 28;
+//! Maximum amount of parsed appearances / filtered index data kept in the bake caches
+static const uint BAKE_CACHE_SIZE = 32;
 
 namespace RexLogic
 { 
@@ -58,15 +63,22 @@ namespace RexLogic
         
     AvatarAppearance::AvatarAppearance(RexLogicModule *rexlogicmodule) :
         rexlogicmodule_(rexlogicmodule),
+        parsed_appearances_(BAKE_CACHE_SIZE),
+        baked_indices_(BAKE_CACHE_SIZE),
         inv_export_state_(Idle)
     {
         std::string default_avatar_path = rexlogicmodule_->GetFramework()->GetDefaultConfig().DeclareSetting("RexAvatar", "default_avatar_file", std::string("./data/default_avatar.xml"));
         
         ReadDefaultAppearance(default_avatar_path);
+        
+        // Create appearance baker thread task and let the framework thread task manager handle it
+        baker_ = AvatarAppearanceBakerPtr(new AvatarAppearanceBaker());
+        rexlogicmodule_->GetFramework()->GetThreadTaskManager()->AddThreadTask(baker_);
     }
 
     AvatarAppearance::~AvatarAppearance()
     {
+        rexlogicmodule_->GetFramework()->GetThreadTaskManager()->RemoveThreadTask(baker_);
     }
 
     void AvatarAppearance::Update(f64 frametime)
@@ -360,9 +372,11 @@ namespace RexLogic
             mesh->SetMeshWithSkeleton(appearance->GetMesh().GetLocalOrResourceName(), appearance->GetSkeleton().GetLocalOrResourceName(), need_mesh_clone);
         else
             mesh->SetMesh(appearance->GetMesh().GetLocalOrResourceName(), need_mesh_clone);
-            
+        
+        // Any earlier vertex hiding in progress is for the mesh just replaced
+        pending_vertex_hides_.erase(entity->GetId());
         if (need_mesh_clone)
-            HideVertices(mesh->GetEntity(), vertices_to_hide);
+            HideVertices(entity, vertices_to_hide);
         
         AvatarMaterialVector materials = appearance->GetMaterials();
         for (uint i = 0; i < materials.size(); ++i)
@@ -674,64 +688,78 @@ namespace RexLogic
         return skeleton->getBone(bone_name);
     }
     
-    void AvatarAppearance::HideVertices(Ogre::Entity* entity, std::set<uint> vertices_to_hide)
+    void AvatarAppearance::HideVertices(Scene::EntityPtr entity, const std::set<uint>& vertices_to_hide)
+    {
+        EC_AvatarAppearance* appearance = entity->GetComponent<EC_AvatarAppearance>().get();
+        OgreRenderer::EC_OgreMesh* mesh = entity->GetComponent<OgreRenderer::EC_OgreMesh>().get();
+        if (!appearance || !mesh)
+            return;
+        Ogre::Entity* ogre_entity = mesh->GetEntity();
+        if (!ogre_entity)
+            return;
+        Ogre::MeshPtr ogre_mesh = ogre_entity->getMesh();
+        if (ogre_mesh.isNull() || !ogre_mesh->getNumSubMeshes())
+            return;
+        
+        // Under current system, it seems vertices should only be hidden from first submesh
+        Ogre::IndexData *data = ogre_mesh->getSubMesh(0)->indexData;
+        Ogre::HardwareIndexBufferSharedPtr ibuf = data->indexBuffer;
+        if (ibuf.isNull() || !data->indexCount)
+            return;
+        
+        // Same base mesh with same hidden vertices always gives the same result
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(appearance->GetMesh().GetLocalOrResourceName().c_str());
+        for (std::set<uint>::const_iterator i = vertices_to_hide.begin(); i != vertices_to_hide.end(); ++i)
+        {
+            u32 index = *i;
+            hash.addData((const char*)&index, sizeof(index));
+        }
+        std::string key = QString(hash.result().toHex()).toStdString();
+        
+        BakedIndexDataPtr indices = baked_indices_.Find(key);
+        if (indices)
+        {
+            ApplyHiddenVertices(ogre_entity, *indices);
+            return;
+        }
+        
+        // Copy the indices for the baker. Meshes keep a shadow copy of their index buffers, so this does not read back from the GPU
+        VertexHideRequestPtr request(new VertexHideRequest());
+        request->entity_id_ = entity->GetId();
+        request->key_ = key;
+        request->mesh_name_ = ogre_mesh->getName();
+        request->use32bitindexes_ = (ibuf->getType() == Ogre::HardwareIndexBuffer::IT_32BIT);
+        request->vertices_to_hide_ = vertices_to_hide;
+        request->index_data_.resize(data->indexCount * ibuf->getIndexSize());
+        ibuf->readData(data->indexStart * ibuf->getIndexSize(), request->index_data_.size(), &request->index_data_[0]);
+        
+        request_tag_t tag = rexlogicmodule_->GetFramework()->GetThreadTaskManager()->AddRequest<VertexHideRequest>(baker_->GetTaskDescription(), request);
+        if (tag)
+            pending_vertex_hides_[entity->GetId()] = tag;
+    }
+    
+    void AvatarAppearance::ApplyHiddenVertices(Ogre::Entity* entity, const BakedIndexData& indices)
     {
         if (!entity)
             return;
         Ogre::MeshPtr mesh = entity->getMesh();
-        if (mesh.isNull())
+        if (mesh.isNull() || !mesh->getNumSubMeshes())
             return;
         
-        for (uint m = 0; m < 1; ++m)
+        Ogre::IndexData *data = mesh->getSubMesh(0)->indexData;
+        Ogre::HardwareIndexBufferSharedPtr ibuf = data->indexBuffer;
+        if (ibuf.isNull())
+            return;
+        if ((indices.index_count_ > data->indexCount) || (indices.data_.size() != indices.index_count_ * ibuf->getIndexSize()))
         {
-            // Under current system, it seems vertices should only be hidden from first submesh
-            Ogre::SubMesh *submesh = mesh->getSubMesh(m);
-            Ogre::IndexData *data = submesh->indexData;
-            Ogre::HardwareIndexBufferSharedPtr ibuf = data->indexBuffer;
-
-            unsigned long* lIdx = static_cast<unsigned long*>(ibuf->lock(Ogre::HardwareBuffer::HBL_NORMAL));
-            unsigned short* pIdx = reinterpret_cast<unsigned short*>(lIdx);
-            bool use32bitindexes = (ibuf->getType() == Ogre::HardwareIndexBuffer::IT_32BIT);
-
-            for (uint n = 0; n < data->indexCount; n += 3)
-            {
-                if (!use32bitindexes)
-                {
-                    if (vertices_to_hide.find(pIdx[n]) != vertices_to_hide.end() ||
-                        vertices_to_hide.find(pIdx[n+1]) != vertices_to_hide.end() ||
-                        vertices_to_hide.find(pIdx[n+2]) != vertices_to_hide.end())
-                    {
-                        if (n + 3 < data->indexCount)
-                        {
-                            for (size_t i = n ; i<data->indexCount-3 ; ++i)
-                            {
-                                pIdx[i] = pIdx[i+3];
-                            }
-                        }
-                        data->indexCount -= 3;
-                        n -= 3;
-                    }
-                }
-                else
-                {
-                    if (vertices_to_hide.find(lIdx[n]) != vertices_to_hide.end() ||
-                        vertices_to_hide.find(lIdx[n+1]) != vertices_to_hide.end() ||
-                        vertices_to_hide.find(lIdx[n+2]) != vertices_to_hide.end())
-                    {
-                        if (n + 3 < data->indexCount)
-                        {
-                            for (size_t i = n ; i<data->indexCount-3 ; ++i)
-                            {
-                                lIdx[i] = lIdx[i+3];
-                            }
-                        }
-                        data->indexCount -= 3;
-                        n -= 3;
-                    }
-                }
-            }
-            ibuf->unlock();
+            RexLogicModule::LogWarning("Filtered index data does not match avatar mesh " + mesh->getName() + ", not hiding vertices");
+            return;
         }
+        
+        if (indices.data_.size())
+            ibuf->writeData(data->indexStart * ibuf->getIndexSize(), indices.data_.size(), &indices.data_[0]);
+        data->indexCount = indices.index_count_;
     }
     
     void AvatarAppearance::ProcessAppearanceDownloads()
@@ -771,17 +799,63 @@ namespace RexLogic
     {       
         if (!entity)
             return;
+        
+        RequestAppearanceParse(entity, data, size, false, std::string(), base_url);
+    }
+    
+    void AvatarAppearance::RequestAppearanceParse(Scene::EntityPtr entity, const u8* data, uint size, bool legacy_storage, const std::string& host, const QString& base_url)
+    {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        // Storage host is a part of the asset urls, so it is a part of the key as well
+        hash.addData(host.c_str());
+        hash.addData((const char*)data, size);
+        std::string key = (legacy_storage ? "storage:" : "inventory:") + QString(hash.result().toHex()).toStdString();
+        
+        AppearanceParseResultPtr parsed = parsed_appearances_.Find(key);
+        if (parsed)
+        {
+            pending_appearance_parses_.erase(entity->GetId());
+            ApplyParsedAppearance(entity, parsed, base_url);
+            return;
+        }
+        
+        AppearanceParseRequestPtr request(new AppearanceParseRequest());
+        request->entity_id_ = entity->GetId();
+        request->key_ = key;
+        request->legacy_storage_ = legacy_storage;
+        request->host_ = host;
+        request->data_.resize(size);
+        if (size)
+            memcpy(&request->data_[0], data, size);
+        
+        request_tag_t tag = rexlogicmodule_->GetFramework()->GetThreadTaskManager()->AddRequest<AppearanceParseRequest>(baker_->GetTaskDescription(), request);
+        if (tag)
+        {
+            PendingAppearanceParse pending;
+            pending.tag_ = tag;
+            pending.base_url_ = base_url;
+            pending_appearance_parses_[entity->GetId()] = pending;
+        }
+    }
+    
+    void AvatarAppearance::ApplyParsedAppearance(Scene::EntityPtr entity, AppearanceParseResultPtr result, const QString& base_url)
+    {
         EC_AvatarAppearance* appearance = entity->GetComponent<EC_AvatarAppearance>().get();
         if (!appearance)
             return;
         
-        std::string data_str((const char*)data, size);
-
-        QDomDocument avatar_doc("Avatar");
-        avatar_doc.setContent(QString::fromStdString(data_str));
-
+        if (!result->success_)
+        {
+            // If not found, use default appearance
+            // (at this point, it's nice to just have *some* appearance change, for example
+            // changing back to default human from fish in the fishworld, if no avatar stored)
+            RexLogicModule::LogInfo("Got empty avatar description from storage, setting default appearance");
+            SetupDefaultAppearance(entity);
+            return;
+        }
+        
         // Deserialize appearance from the document into the EC
-        if (!LegacyAvatarSerializer::ReadAvatarAppearance(*appearance, avatar_doc))
+        if (!LegacyAvatarSerializer::ReadAvatarAppearance(*appearance, *result->document_))
         {
             // If fails badly, setup default instead
             RexLogicModule::LogInfo("Failed to parse avatar description, setting default appearance");
@@ -789,30 +863,38 @@ namespace RexLogic
             return;
         }
         
-        const AvatarAssetMap& assets = appearance->GetAssetMap(); 
-        
         uint pending_requests;
-        if (base_url.isEmpty())
-            pending_requests = RequestAvatarResources(entity, assets, true);
+        if (result->legacy_storage_)
+        {
+            appearance->SetAssetMap(result->assets_);
+            pending_requests = RequestAvatarResources(entity, result->assets_);
+        }
         else
         {
-            // If base url exists, this is webdav inventory avatar
-            // Lets clear the cache as the id == url doesnt chance so
-            // we can be sure the asset is fetched again from the web
-            boost::shared_ptr<Foundation::AssetServiceInterface> asset_service = 
-                rexlogicmodule_->GetFramework()->GetServiceManager()->GetService<Foundation::AssetServiceInterface>(Foundation::Service::ST_Asset).lock();
-            if (asset_service)
+            const AvatarAssetMap& assets = appearance->GetAssetMap(); 
+            
+            if (base_url.isEmpty())
+                pending_requests = RequestAvatarResources(entity, assets, true);
+            else
             {
-                AvatarAssetMap::const_iterator iter = assets.begin();
-                AvatarAssetMap::const_iterator end = assets.end();
-                while (iter != end)
+                // If base url exists, this is webdav inventory avatar
+                // Lets clear the cache as the id == url doesnt chance so
+                // we can be sure the asset is fetched again from the web
+                boost::shared_ptr<Foundation::AssetServiceInterface> asset_service = 
+                    rexlogicmodule_->GetFramework()->GetServiceManager()->GetService<Foundation::AssetServiceInterface>(Foundation::Service::ST_Asset).lock();
+                if (asset_service)
                 {
-                    std::string asset_id = iter->second;
-                    asset_service->RemoveAssetFromCache(asset_id);
-                    ++iter;
+                    AvatarAssetMap::const_iterator iter = assets.begin();
+                    AvatarAssetMap::const_iterator end = assets.end();
+                    while (iter != end)
+                    {
+                        std::string asset_id = iter->second;
+                        asset_service->RemoveAssetFromCache(asset_id);
+                        ++iter;
+                    }
                 }
+                pending_requests = RequestAvatarResources(entity, assets, false, base_url);
             }
-            pending_requests = RequestAvatarResources(entity, assets, false, base_url);
         }
         
         // In the unlikely case of no requests at all, rebuild avatar now
@@ -871,65 +953,11 @@ namespace RexLogic
     {        
         if (!entity)
             return;
-        EC_AvatarAppearance* appearance = entity->GetComponent<EC_AvatarAppearance>().get();
         EC_OpenSimAvatar* avatar = entity->GetComponent<EC_OpenSimAvatar>().get();
-        if (!appearance || !avatar)
-            return;
-        
-        std::string data_str((const char*)data, size);
-        std::map<std::string, std::string> contents = RexTypes::ParseLLSDMap(data_str);
-        
-        // Get the avatar appearance description ("generic xml")
-        std::map<std::string, std::string>::iterator i = contents.find("generic xml");
-        if (i == contents.end())
-        {
-            // If not found, use default appearance
-            // (at this point, it's nice to just have *some* appearance change, for example
-            // changing back to default human from fish in the fishworld, if no avatar stored)
-            RexLogicModule::LogInfo("Got empty avatar description from storage, setting default appearance");
-            SetupDefaultAppearance(entity);
-            return;
-        }
-        
-        std::string& appearance_str = i->second;
-
-        // Return to original format by substituting to < >
-        ReplaceSubstringInplace(appearance_str, "&lt;", "<");
-        ReplaceSubstringInplace(appearance_str, "&gt;", ">");
-        
-        QDomDocument avatar_doc("Avatar");
-        avatar_doc.setContent(QString::fromStdString(appearance_str));
-        
-        std::map<std::string, std::string>::iterator j = contents.begin();
-        // Build mapping of human-readable asset names to id's
-        std::string host = HttpUtilities::GetHostFromUrl(avatar->GetAppearanceAddress());
-        AvatarAssetMap assets;
-        while (j != contents.end())
-        {
-            // Don't add the name field or the avatar description
-            if ((j->first != "generic xml") && (j->first != "name"))
-            {
-                assets[j->first] = host + "/item/" + j->second;
-            }
-            ++j;
-        }
-        
-        // Deserialize appearance from the document into the EC
-        if (!LegacyAvatarSerializer::ReadAvatarAppearance(*appearance, avatar_doc))
-        {
-            // If fails badly, setup default instead
-            RexLogicModule::LogInfo("Failed to parse avatar description, setting default appearance");
-            SetupDefaultAppearance(entity);
+        if (!avatar)
             return;
-        }
-        
-        appearance->SetAssetMap(assets);
-
-        uint pending_requests = RequestAvatarResources(entity, assets);
         
-        // In the unlikely case of no requests at all, rebuild avatar now
-        if (!pending_requests)
-            SetupAppearance(entity);
+        RequestAppearanceParse(entity, data, size, true, HttpUtilities::GetHostFromUrl(avatar->GetAppearanceAddress()));
     }
     
     bool AvatarAppearance::HandleResourceEvent(event_id_t event_id, Foundation::EventDataInterface* data)
@@ -1007,6 +1035,58 @@ namespace RexLogic
         return true;
     }
     
+    bool AvatarAppearance::HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data)
+    {
+        if (event_id != Task::Events::REQUEST_COMPLETED)
+            return false;
+        Foundation::ThreadTaskResult* task_result = checked_static_cast<Foundation::ThreadTaskResult*>(data);
+        if (!task_result || task_result->task_description_ != baker_->GetTaskDescription())
+            return false;
+        
+        AppearanceParseResult* parse_result = dynamic_cast<AppearanceParseResult*>(data);
+        if (parse_result)
+        {
+            // Keep a copy for avatars with the same appearance. The document is shared, and only read from now on
+            AppearanceParseResultPtr result(new AppearanceParseResult(*parse_result));
+            parsed_appearances_.Insert(result->key_, result);
+            
+            std::map<entity_id_t, PendingAppearanceParse>::iterator i = pending_appearance_parses_.find(result->entity_id_);
+            if ((i == pending_appearance_parses_.end()) || (i->second.tag_ != result->tag_))
+                return true;
+            QString base_url = i->second.base_url_;
+            pending_appearance_parses_.erase(i);
+            
+            Scene::EntityPtr entity = rexlogicmodule_->GetAvatarEntity(result->entity_id_);
+            if (entity)
+                ApplyParsedAppearance(entity, result, base_url);
+            return true;
+        }
+        
+        VertexHideResult* hide_result = dynamic_cast<VertexHideResult*>(data);
+        if (hide_result)
+        {
+            baked_indices_.Insert(hide_result->key_, hide_result->indices_);
+            
+            std::map<entity_id_t, request_tag_t>::iterator i = pending_vertex_hides_.find(hide_result->entity_id_);
+            if ((i == pending_vertex_hides_.end()) || (i->second != hide_result->tag_))
+                return true;
+            pending_vertex_hides_.erase(i);
+            
+            // Make sure the avatar still uses the mesh the indices were read from
+            Scene::EntityPtr entity = rexlogicmodule_->GetAvatarEntity(hide_result->entity_id_);
+            if (!entity)
+                return true;
+            OgreRenderer::EC_OgreMesh* mesh = entity->GetComponent<OgreRenderer::EC_OgreMesh>().get();
+            if (!mesh || !mesh->GetEntity() || (mesh->GetEntity()->getMesh()->getName() != hide_result->mesh_name_))
+                return true;
+            
+            ApplyHiddenVertices(mesh->GetEntity(), *hide_result->indices_);
+            return true;
+        }
+        
+        return false;
+    }
+    
     bool AvatarAppearance::HandleInventoryEvent(event_id_t event_id, Foundation::EventDataInterface* data)
     {
         if (event_id == Inventory::Events::EVENT_INVENTORY_DESCENDENT)
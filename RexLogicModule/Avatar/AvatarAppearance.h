@@ -29,9 +29,19 @@ namespace RexLogic
     class AvatarExporterRequest;
     typedef boost::shared_ptr<AvatarExporter> AvatarExporterPtr;
     typedef boost::shared_ptr<AvatarExporterRequest> AvatarExporterRequestPtr;
+    class AvatarAppearanceBaker;
+    class AppearanceParseResult;
+    class BakedIndexData;
+    typedef boost::shared_ptr<AvatarAppearanceBaker> AvatarAppearanceBakerPtr;
+    typedef boost::shared_ptr<AppearanceParseResult> AppearanceParseResultPtr;
+    typedef boost::shared_ptr<BakedIndexData> BakedIndexDataPtr;
     class EC_AvatarAppearance;
 
     //! Handles setting up and updating avatars' appearance. Owned by RexLogicModule::Avatar.
+    /*! Parsing of downloaded appearance descriptions and hiding of mesh vertices under attachments are done
+        by an AvatarAppearanceBaker thread task. Their results are cached by a hash of the input data, so that
+        avatars sharing the same appearance get set up without going through the baker again.
+     */
     class AvatarAppearance
     {
         //! States of inventory-based export. Must go input-first
@@ -87,6 +97,8 @@ namespace RexLogic
         bool HandleAssetEvent(event_id_t event_id, Foundation::EventDataInterface* data);
         //! Handles inventory event
         bool HandleInventoryEvent(event_id_t event_id, Foundation::EventDataInterface* data);        
+        //! Handles thread task event
+        bool HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data);
         
         //! Exports avatar to an authentication/avatar storage server account
         void ExportAvatar(Scene::EntityPtr entity, const std::string& account, const std::string& authserver, const std::string& password);
@@ -134,8 +146,14 @@ namespace RexLogic
         //! Applies a bone modifier
         void ApplyBoneModifier(Scene::EntityPtr entity, const BoneModifier& modifier, Real value);
         
-        //! Hides vertices from an entity's mesh. Mesh should be cloned from the base mesh and this must not be called more than once for the entity.
-        void HideVertices(Ogre::Entity*, std::set<uint> vertices_to_hide);
+        //! Hides vertices from an avatar entity's mesh. Mesh should be cloned from the base mesh and this must not be called more than once for the entity.
+        /*! Uses a cached result if the same vertices have been hidden from the same base mesh before, otherwise
+            queues the work to the appearance baker and applies the result once it arrives.
+         */
+        void HideVertices(Scene::EntityPtr entity, const std::set<uint>& vertices_to_hide);
+        
+        //! Writes filtered index data to the first submesh of an entity's mesh
+        void ApplyHiddenVertices(Ogre::Entity* entity, const BakedIndexData& indices);
         
         //! Processes appearance downloads
         void ProcessAppearanceDownloads();
@@ -149,6 +167,19 @@ namespace RexLogic
         //! Processes an avatar appearance asset (inventory based avatar)
         void ProcessInventoryAppearance(Scene::EntityPtr entity, const u8* data, uint size, QString base_url = QString());
         
+        //! Parses avatar appearance data, using a cached result if the same data has been parsed before
+        /*! \param entity Avatar entity
+            \param data Appearance data
+            \param size Size of data
+            \param legacy_storage Whether data is from legacy avatar storage (true), or inventory/webdav (false)
+            \param host Avatar storage host (legacy storage only)
+            \param base_url Webdav base url (webdav only)
+         */
+        void RequestAppearanceParse(Scene::EntityPtr entity, const u8* data, uint size, bool legacy_storage, const std::string& host, const QString& base_url = QString());
+        
+        //! Deserializes a parsed appearance into the appearance EC and requests the avatar resources
+        void ApplyParsedAppearance(Scene::EntityPtr entity, AppearanceParseResultPtr result, const QString& base_url);
+        
         //! Requests needed avatar resouces
         uint RequestAvatarResources(Scene::EntityPtr entity, const AvatarAssetMap& assets, bool inventorymode = false, QString base_url = QString());
             
@@ -211,6 +242,83 @@ namespace RexLogic
         //! Amount of pending avatar resource requests. When hits 0, should be able to build avatar
         std::map<entity_id_t, uint> avatar_pending_requests_;
         
+        //! Pending appearance parse of an avatar
+        struct PendingAppearanceParse
+        {
+            //! Baker request tag
+            request_tag_t tag_;
+            //! Webdav base url, if any
+            QString base_url_;
+        };
+        
+        //! Appearance baker task
+        AvatarAppearanceBakerPtr baker_;
+        
+        //! Pending appearance parses, only the latest request of each avatar is applied
+        std::map<entity_id_t, PendingAppearanceParse> pending_appearance_parses_;
+        
+        //! Pending vertex hide request tags, only the latest request of each avatar is applied
+        std::map<entity_id_t, request_tag_t> pending_vertex_hides_;
+        
+        //! Bake results keyed by hash. When full, the least recently used result is evicted
+        template <typename T> class BakeCache
+        {
+        public:
+            //! Constructor
+            /*! \param max_size maximum amount of results kept
+             */
+            explicit BakeCache(uint max_size) : max_size_(max_size) {}
+            
+            //! Returns a result & marks it most recently used
+            /*! \param key hash
+                \return result, or null if not cached
+             */
+            T Find(const std::string& key)
+            {
+                typename std::map<std::string, typename EntryList::iterator>::iterator i = index_.find(key);
+                if (i == index_.end())
+                    return T();
+                entries_.splice(entries_.begin(), entries_, i->second);
+                return i->second->second;
+            }
+            
+            //! Adds or replaces a result as the most recently used, evicting the least recently used if full
+            /*! \param key hash
+                \param value result
+             */
+            void Insert(const std::string& key, T value)
+            {
+                typename std::map<std::string, typename EntryList::iterator>::iterator i = index_.find(key);
+                if (i != index_.end())
+                {
+                    entries_.erase(i->second);
+                    index_.erase(i);
+                }
+                else if ((index_.size() >= max_size_) && (!entries_.empty()))
+                {
+                    index_.erase(entries_.back().first);
+                    entries_.pop_back();
+                }
+                entries_.push_front(std::make_pair(key, value));
+                index_[key] = entries_.begin();
+            }
+            
+        private:
+            //! Results from the most to the least recently used
+            typedef std::list<std::pair<std::string, T> > EntryList;
+            EntryList entries_;
+            //! Positions of the results in the use order by key
+            std::map<std::string, typename EntryList::iterator> index_;
+            //! Maximum amount of results
+            uint max_size_;
+        };
+        
+        //! Parsed appearances keyed by appearance data hash
+        BakeCache<AppearanceParseResultPtr> parsed_appearances_;
+        
+        //! Filtered index data keyed by hash of base mesh & hidden vertices
+        BakeCache<BakedIndexDataPtr> baked_indices_;
+        
         //! Legacy storage avatar exporter task
         AvatarExporterPtr avatar_exporter_;
         
@@ -0,0 +1,157 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "Avatar/AvatarAppearanceBaker.h"
+#include "LLSDUtilities.h"
+#include "CoreStringUtils.h"
+
+#include <QDomDocument>
+
+using namespace RexTypes;
+
+namespace RexLogic
+{
+    template <class T> void FilterTriangles(const T* source, uint count, const std::vector<bool>& hidden, T* dest, uint& dest_count)
+    {
+        dest_count = 0;
+        uint num_hidden = hidden.size();
+        for (uint n = 0; n + 2 < count; n += 3)
+        {
+            if ((source[n] < num_hidden && hidden[source[n]]) ||
+                (source[n+1] < num_hidden && hidden[source[n+1]]) ||
+                (source[n+2] < num_hidden && hidden[source[n+2]]))
+                continue;
+
+            dest[dest_count++] = source[n];
+            dest[dest_count++] = source[n+1];
+            dest[dest_count++] = source[n+2];
+        }
+    }
+
+    AvatarAppearanceBaker::AvatarAppearanceBaker() : ThreadTask("AvatarAppearanceBaker")
+    {
+    }
+
+    void AvatarAppearanceBaker::Work()
+    {
+        while (ShouldRun())
+        {
+            WaitForRequests();
+
+            Foundation::ThreadTaskRequestPtr request = GetNextRequest();
+            if (!request)
+                continue;
+
+            AppearanceParseRequestPtr parse_request = boost::dynamic_pointer_cast<AppearanceParseRequest>(request);
+            if (parse_request)
+            {
+                PROFILE(AvatarAppearanceBaker_ParseAppearance);
+                ParseAppearance(parse_request);
+            }
+
+            VertexHideRequestPtr hide_request = boost::dynamic_pointer_cast<VertexHideRequest>(request);
+            if (hide_request)
+            {
+                PROFILE(AvatarAppearanceBaker_HideVertices);
+                HideVertices(hide_request);
+            }
+
+            RESETPROFILER
+        }
+    }
+
+    void AvatarAppearanceBaker::ParseAppearance(AppearanceParseRequestPtr request)
+    {
+        AppearanceParseResultPtr result(new AppearanceParseResult());
+        result->tag_ = request->tag_;
+        result->task_description_ = GetTaskDescription();
+        result->entity_id_ = request->entity_id_;
+        result->key_ = request->key_;
+        result->legacy_storage_ = request->legacy_storage_;
+        result->document_ = boost::shared_ptr<QDomDocument>(new QDomDocument("Avatar"));
+
+        std::string data_str;
+        if (request->data_.size())
+            data_str = std::string((const char*)&request->data_[0], request->data_.size());
+
+        if (request->legacy_storage_)
+        {
+            std::map<std::string, std::string> contents = RexTypes::ParseLLSDMap(data_str);
+
+            // Get the avatar appearance description ("generic xml")
+            std::map<std::string, std::string>::iterator i = contents.find("generic xml");
+            if (i != contents.end())
+            {
+                std::string& appearance_str = i->second;
+
+                // Return to original format by substituting to < >
+                ReplaceSubstringInplace(appearance_str, "&lt;", "<");
+                ReplaceSubstringInplace(appearance_str, "&gt;", ">");
+
+                result->document_->setContent(QString::fromStdString(appearance_str));
+
+                // Build mapping of human-readable asset names to id's
+                std::map<std::string, std::string>::iterator j = contents.begin();
+                while (j != contents.end())
+                {
+                    // Don't add the name field or the avatar description
+                    if ((j->first != "generic xml") && (j->first != "name"))
+                        result->assets_[j->first] = request->host_ + "/item/" + j->second;
+                    ++j;
+                }
+
+                result->success_ = true;
+            }
+        }
+        else
+        {
+            result->document_->setContent(QString::fromStdString(data_str));
+            result->success_ = true;
+        }
+
+        QueueResult<AppearanceParseResult>(result);
+    }
+
+    void AvatarAppearanceBaker::HideVertices(VertexHideRequestPtr request)
+    {
+        VertexHideResultPtr result(new VertexHideResult());
+        result->tag_ = request->tag_;
+        result->task_description_ = GetTaskDescription();
+        result->entity_id_ = request->entity_id_;
+        result->key_ = request->key_;
+        result->mesh_name_ = request->mesh_name_;
+        result->indices_ = BakedIndexDataPtr(new BakedIndexData());
+
+        FilterHiddenTriangles(request->index_data_, request->use32bitindexes_, request->vertices_to_hide_, *result->indices_);
+
+        QueueResult<VertexHideResult>(result);
+    }
+
+    void AvatarAppearanceBaker::FilterHiddenTriangles(const std::vector<u8>& source, bool use32bitindexes, const std::set<uint>& vertices_to_hide, BakedIndexData& dest)
+    {
+        dest.data_.resize(source.size());
+        dest.index_count_ = 0;
+        if (source.empty())
+            return;
+
+        // Lookup table instead of set searches, as every index of the submesh is checked
+        std::vector<bool> hidden;
+        if (vertices_to_hide.size())
+        {
+            hidden.resize(*vertices_to_hide.rbegin() + 1, false);
+            for (std::set<uint>::const_iterator i = vertices_to_hide.begin(); i != vertices_to_hide.end(); ++i)
+                hidden[*i] = true;
+        }
+
+        if (use32bitindexes)
+        {
+            FilterTriangles<u32>((const u32*)&source[0], source.size() / sizeof(u32), hidden, (u32*)&dest.data_[0], dest.index_count_);
+            dest.data_.resize(dest.index_count_ * sizeof(u32));
+        }
+        else
+        {
+            FilterTriangles<u16>((const u16*)&source[0], source.size() / sizeof(u16), hidden, (u16*)&dest.data_[0], dest.index_count_);
+            dest.data_.resize(dest.index_count_ * sizeof(u16));
+        }
+    }
+}
@@ -0,0 +1,137 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_RexLogic_AvatarAppearanceBaker_h
+#define incl_RexLogic_AvatarAppearanceBaker_h
+
+#include "ThreadTask.h"
+#include "EntityComponent/EC_AvatarAppearance.h"
+
+class QDomDocument;
+
+namespace RexLogic
+{
+    //! Request to parse an avatar appearance description
+    class AppearanceParseRequest : public Foundation::ThreadTaskRequest
+    {
+    public:
+        AppearanceParseRequest() : entity_id_(0), legacy_storage_(false) {}
+
+        //! Avatar entity
+        entity_id_t entity_id_;
+        //! Cache key of the appearance data
+        std::string key_;
+        //! Raw appearance data
+        std::vector<u8> data_;
+        //! Whether data is a legacy avatar storage LLSD map (true), or an inventory/webdav appearance xml (false)
+        bool legacy_storage_;
+        //! Avatar storage host, used to build asset urls of a legacy storage appearance
+        std::string host_;
+    };
+
+    //! Parsed avatar appearance description
+    class AppearanceParseResult : public Foundation::ThreadTaskResult
+    {
+    public:
+        AppearanceParseResult() : entity_id_(0), legacy_storage_(false), success_(false) {}
+
+        //! Avatar entity
+        entity_id_t entity_id_;
+        //! Cache key of the appearance data
+        std::string key_;
+        //! Whether data was a legacy avatar storage LLSD map
+        bool legacy_storage_;
+        //! Whether an appearance description was found. If not, default appearance should be used
+        bool success_;
+        //! Appearance description document. Only to be accessed by the main thread once the result has been received
+        boost::shared_ptr<QDomDocument> document_;
+        //! Human-readable asset names mapped to asset urls (legacy storage only)
+        AvatarAssetMap assets_;
+    };
+
+    //! Request to remove triangles using hidden vertices from the index data of an avatar submesh
+    class VertexHideRequest : public Foundation::ThreadTaskRequest
+    {
+    public:
+        VertexHideRequest() : entity_id_(0), use32bitindexes_(false) {}
+
+        //! Avatar entity
+        entity_id_t entity_id_;
+        //! Cache key of the bake (base mesh & hidden vertices)
+        std::string key_;
+        //! Name of the cloned mesh the indices were read from
+        std::string mesh_name_;
+        //! Copy of the original index data
+        std::vector<u8> index_data_;
+        //! Whether indices are 32bit (true) or 16bit (false)
+        bool use32bitindexes_;
+        //! Vertices to hide
+        std::set<uint> vertices_to_hide_;
+    };
+
+    //! Filtered index data, ready to be written to the index buffer as is
+    class BakedIndexData
+    {
+    public:
+        BakedIndexData() : index_count_(0) {}
+
+        //! Index data in the index buffer format
+        std::vector<u8> data_;
+        //! Number of indices
+        uint index_count_;
+    };
+
+    typedef boost::shared_ptr<BakedIndexData> BakedIndexDataPtr;
+
+    //! Result of vertex hiding
+    class VertexHideResult : public Foundation::ThreadTaskResult
+    {
+    public:
+        VertexHideResult() : entity_id_(0) {}
+
+        //! Avatar entity
+        entity_id_t entity_id_;
+        //! Cache key of the bake
+        std::string key_;
+        //! Name of the cloned mesh the indices were read from
+        std::string mesh_name_;
+        //! Filtered indices
+        BakedIndexDataPtr indices_;
+    };
+
+    typedef boost::shared_ptr<AppearanceParseRequest> AppearanceParseRequestPtr;
+    typedef boost::shared_ptr<AppearanceParseResult> AppearanceParseResultPtr;
+    typedef boost::shared_ptr<VertexHideRequest> VertexHideRequestPtr;
+    typedef boost::shared_ptr<VertexHideResult> VertexHideResultPtr;
+
+    //! Threadtask that performs the CPU-heavy parts of avatar appearance setup, used by AvatarAppearance
+    /*! Parses appearance descriptions into xml documents, and filters the triangles of hidden vertices from
+        a copy of the avatar mesh index data. Results are queued to the framework's ThreadTaskManager; the main thread
+        deserializes the document into the appearance EC and uploads the filtered indices.
+     */
+    class AvatarAppearanceBaker : public Foundation::ThreadTask
+    {
+    public:
+        AvatarAppearanceBaker();
+
+        virtual void Work();
+
+        //! Filters out triangles that use any of the given vertices
+        /*! \param source Index data
+            \param use32bitindexes Whether indices are 32bit (true) or 16bit (false)
+            \param vertices_to_hide Vertices to hide
+            \param dest Result index data, in the same format as the source
+         */
+        static void FilterHiddenTriangles(const std::vector<u8>& source, bool use32bitindexes, const std::set<uint>& vertices_to_hide, BakedIndexData& dest);
+
+    private:
+        //! Parses an appearance description
+        void ParseAppearance(AppearanceParseRequestPtr request);
+
+        //! Hides vertices
+        void HideVertices(VertexHideRequestPtr request);
+    };
+
+    typedef boost::shared_ptr<AvatarAppearanceBaker> AvatarAppearanceBakerPtr;
+}
+
+#endif
@@ -19,7 +19,8 @@ static const Real REAUTHENTICATION_TIME = 60.0f;
 
 namespace RexLogic
 {
-    AvatarExporter::AvatarExporter() : ThreadTask("AvatarExport")
+    // Export waits for the authentication & upload calls, so it gets a thread of its own
+    AvatarExporter::AvatarExporter() : ThreadTask("AvatarExport", true)
     {
     }
     
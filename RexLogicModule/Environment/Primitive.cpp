@@ -38,9 +38,12 @@
 #include "WorldStream.h"
 #include "EC_HoveringText.h"
 #include "EC_OpenSimPrim.h"
+#include "FrameScheduler.h"
 
 #include <OgreSceneNode.h>
 
+#include <boost/bind.hpp>
+
 #include <QUrl>
 #include <QColor>
 #include <QDomDocument>
@@ -48,12 +51,15 @@
 namespace RexLogic
 {
 
-Primitive::Primitive(RexLogicModule *rexlogicmodule) : rexlogicmodule_(rexlogicmodule)
+Primitive::Primitive(RexLogicModule *rexlogicmodule) :
+    rexlogicmodule_(rexlogicmodule),
+    prim_geometry_job_(0)
 {
 }
 
 Primitive::~Primitive()
 {
+    rexlogicmodule_->GetFramework()->GetFrameScheduler()->Cancel(prim_geometry_job_);
 }
 
 void Primitive::Update(f64 frametime)
@@ -943,17 +949,9 @@ void Primitive::HandleDrawType(entity_id_t entityid)
         // Request prim textures
         HandlePrimTexturesAndMaterial(entityid);
 
-        // Create/update geometry
+        // Create/update geometry. Deferred to the prim geometry frame job, as entering a region can bring lots of prims at once
         if (prim.HasPrimShapeData)
-        {
-            Ogre::ManualObject* manual = CreatePrimGeometry(rexlogicmodule_->GetFramework(), prim);
-            custom.CommitChanges(manual);
-            
-            Scene::Events::EntityEventData event_data;
-            event_data.entity = entity;
-            Foundation::EventManagerPtr event_manager = rexlogicmodule_->GetFramework()->GetEventManager();
-            event_manager->SendEvent("Scene", Scene::Events::EVENT_ENTITY_VISUALS_MODIFIED, &event_data);
-        }
+            QueuePrimGeometry(entityid);
     }
 
     if (!RexTypes::IsNull(prim.ParticleScriptID))
@@ -1483,15 +1481,7 @@ void Primitive::HandleMaterialResourceReady(entity_id_t entityid, Foundation::Re
         {
             // Update geometry now that the material exists
             if (prim->HasPrimShapeData)
-            {
-                Ogre::ManualObject* manual = CreatePrimGeometry(rexlogicmodule_->GetFramework(), *prim);
-                custom->CommitChanges(manual);
-
-                Scene::Events::EntityEventData event_data;
-                event_data.entity = entity;
-                Foundation::EventManagerPtr event_manager = rexlogicmodule_->GetFramework()->GetEventManager();
-                event_manager->SendEvent("Scene", Scene::Events::EVENT_ENTITY_VISUALS_MODIFIED, &event_data);
-            }
+                QueuePrimGeometry(entityid);
         }
     }
     
@@ -1908,6 +1898,60 @@ void Primitive::HandleLogout()
     pending_rexfreedata_.clear();
     local_dirty_entities_.clear();
     network_dirty_entities_.clear();
+    prim_geometry_queue_.clear();
+    queued_prim_geometries_.clear();
+}
+
+void Primitive::QueuePrimGeometry(entity_id_t entityid)
+{
+    if (queued_prim_geometries_.insert(entityid).second)
+        prim_geometry_queue_.push_back(entityid);
+
+    Foundation::FrameSchedulerPtr scheduler = rexlogicmodule_->GetFramework()->GetFrameScheduler();
+    if (!scheduler->IsScheduled(prim_geometry_job_))
+    {
+        prim_geometry_job_ = scheduler->Schedule("Primitive_CreatePrimGeometries",
+            boost::bind(&Primitive::CreateQueuedPrimGeometries, this, _1));
+    }
+}
+
+bool Primitive::CreateQueuedPrimGeometries(const Foundation::FrameBudget& budget)
+{
+    PROFILE(Primitive_CreatePrimGeometries);
+
+    // Always create at least one geometry per slice, so that a small budget can not stall loading
+    while (!prim_geometry_queue_.empty())
+    {
+        entity_id_t entityid = prim_geometry_queue_.front();
+        prim_geometry_queue_.pop_front();
+        queued_prim_geometries_.erase(entityid);
+        CreatePrimGeometryNow(entityid);
+
+        if (budget.IsExceeded())
+            break;
+    }
+
+    return !prim_geometry_queue_.empty();
+}
+
+void Primitive::CreatePrimGeometryNow(entity_id_t entityid)
+{
+    // The prim may have been removed or changed to a mesh while queued
+    Scene::EntityPtr entity = rexlogicmodule_->GetPrimEntity(entityid);
+    if (!entity)
+        return;
+    EC_OpenSimPrim *prim = entity->GetComponent<EC_OpenSimPrim>().get();
+    OgreRenderer::EC_OgreCustomObject* custom = entity->GetComponent<OgreRenderer::EC_OgreCustomObject>().get();
+    if (!prim || !custom || prim->DrawType != RexTypes::DRAWTYPE_PRIM || !prim->HasPrimShapeData)
+        return;
+
+    Ogre::ManualObject* manual = CreatePrimGeometry(rexlogicmodule_->GetFramework(), *prim);
+    custom->CommitChanges(manual);
+
+    Scene::Events::EntityEventData event_data;
+    event_data.entity = entity;
+    Foundation::EventManagerPtr event_manager = rexlogicmodule_->GetFramework()->GetEventManager();
+    event_manager->SendEvent("Scene", Scene::Events::EVENT_ENTITY_VISUALS_MODIFIED, &event_data);
 }
 
 
@@ -14,6 +14,7 @@
 #include "ComponentInterface.h"
 #include "SceneManager.h"
 #include "Color.h"
+#include "FrameScheduler.h"
 
 #include <QObject>
 
@@ -181,6 +182,18 @@ namespace RexLogic
         //! handles prim size and visibility
         void HandlePrimScaleAndVisibility(entity_id_t entityid);
 
+        //! queues the geometry of a prim to be (re)created in the prim geometry frame job
+        //! @param entityid Entity id.
+        void QueuePrimGeometry(entity_id_t entityid);
+
+        //! creates queued prim geometries until the frame budget is used. Frame job
+        //! @return true if prims are left for the next frame
+        bool CreateQueuedPrimGeometries(const Foundation::FrameBudget& budget);
+
+        //! creates the geometry of a prim and notifies of the changed visuals
+        //! @param entityid Entity id.
+        void CreatePrimGeometryNow(entity_id_t entityid);
+
         //! discards request tags for certain entity
         void DiscardRequestTags(entity_id_t, EntityResourceRequestMap& map);
 
@@ -215,6 +228,13 @@ namespace RexLogic
         EntityIdSet local_dirty_entities_;
         //! entities with EC changes from the network
         EntityIdSet network_dirty_entities_;
+
+        //! prims whose geometry waits to be created, in order
+        std::list<entity_id_t> prim_geometry_queue_;
+        //! prims in prim_geometry_queue_, so that each prim is queued once
+        EntityIdSet queued_prim_geometries_;
+        //! frame job that creates the queued prim geometries, 0 if none
+        Foundation::frame_job_id_t prim_geometry_job_;
     };
 }
 #endif
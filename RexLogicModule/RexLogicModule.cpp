@@ -90,6 +90,7 @@
 #include <OgreEntity.h>
 #include <OgreBillboard.h>
 #include <OgreBillboardSet.h>
+#include <OgreCamera.h>
 
 #include <boost/make_shared.hpp>
 
@@ -229,6 +230,11 @@ void RexLogicModule::PostInitialize()
     eventcategoryid = framework_->GetEventManager()->QueryEventCategory("Asset");
     event_handlers_[eventcategoryid].push_back(
         boost::bind(&RexLogicModule::HandleAssetEvent, this, _1, _2));
+
+    // Thread task events
+    eventcategoryid = framework_->GetEventManager()->QueryEventCategory("Task");
+    event_handlers_[eventcategoryid].push_back(
+        boost::bind(&RexLogicModule::HandleTaskEvent, this, _1, _2));
     
     // Framework events
     eventcategoryid = framework_->GetEventManager()->QueryEventCategory("Framework");
@@ -966,6 +972,12 @@ bool RexLogicModule::HandleAssetEvent(event_id_t event_id, Foundation::EventData
     return avatar_->HandleAssetEvent(event_id, data);
 }
 
+bool RexLogicModule::HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data)
+{
+    // Pass the event to the avatar manager
+    return avatar_->HandleTaskEvent(event_id, data);
+}
+
 void RexLogicModule::AboutToDeleteWorld()
 {
     // Lets take some screenshots before deleting the scene
@@ -1035,8 +1047,6 @@ void RexLogicModule::UpdateAvatarNameTags(Scene::EntityPtr users_avatar)
     if (!current_scene.get() || !users_avatar.get())
         return;
 
-    Scene::EntityList all_avatars = current_scene->GetEntitiesWithComponent("EC_OpenSimPresence");
-
     // Get users position
     boost::shared_ptr<EC_HoveringWidget> widget;
     boost::shared_ptr<EC_ChatBubble> chat_bubble;
@@ -1044,19 +1054,51 @@ void RexLogicModule::UpdateAvatarNameTags(Scene::EntityPtr users_avatar)
     if (!placeable)
         return;
 
-    foreach (Scene::EntityPtr avatar, all_avatars)
+    OgreRenderer::RendererPtr renderer = GetOgreRendererPtr();
+    Scene::EntityPtr camera_entity = GetCameraEntity();
+    if (!renderer || !renderer->GetCurrentCamera() || !camera_entity)
+        return;
+    boost::shared_ptr<OgreRenderer::EC_OgrePlaceable> camera_placeable = camera_entity->GetComponent<OgreRenderer::EC_OgrePlaceable>();
+    if (!camera_placeable)
+        return;
+
+    // We need to update the positions so that the distance is right, otherwise were always one frame behind.
+    camera_placeable->GetSceneNode()->_update(false, true);
+    Vector3Df camera_position = this->GetCameraPosition();
+
+    // Only the avatars in view need their widgets updated. The rest are updated when they come into view.
+    // The widgets stand above the avatars, so the frustum is widened by a margin.
+    const f32 cWidgetMargin = 2.0f;
+    Ogre::Camera *camera = renderer->GetCurrentCamera();
+    std::vector<Scene::SpatialIndex::Plane> planes;
+    for(int i = 0; i < 6; ++i)
+    {
+        if (i == Ogre::FRUSTUM_PLANE_FAR && camera->getFarClipDistance() == 0)
+            continue;
+        const Ogre::Plane &frustum_plane = camera->getFrustumPlane(i);
+        Scene::SpatialIndex::Plane plane;
+        plane.normal_ = Vector3df(frustum_plane.normal.x, frustum_plane.normal.y, frustum_plane.normal.z);
+        plane.d_ = frustum_plane.d + cWidgetMargin;
+        planes.push_back(plane);
+    }
+
+    std::vector<entity_id_t> visible_ids;
+    current_scene->GetSpatialIndex().QueryFrustum(planes, visible_ids);
+
+    foreach (entity_id_t id, visible_ids)
     {
+        Scene::EntityPtr avatar = current_scene->GetEntity(id);
+        if (!avatar || !avatar->HasComponent("EC_OpenSimPresence"))
+            continue;
+
         // Update avatar name tag/hovering widget
         placeable = avatar->GetComponent<OgreRenderer::EC_OgrePlaceable>();
         widget = avatar->GetComponent<EC_HoveringWidget>();
         if (!placeable || !widget)
             continue;
 
-        // We need to update the positions so that the distance is right, otherwise were always one frame behind.
-        GetCameraEntity()->GetComponent<OgreRenderer::EC_OgrePlaceable>()->GetSceneNode()->_update(false, true);
         placeable->GetSceneNode()->_update(false, true);
 
-        Vector3Df camera_position = this->GetCameraPosition();
         f32 distance = camera_position.getDistanceFrom(placeable->GetPosition());
         widget->SetCameraDistance(distance);
 
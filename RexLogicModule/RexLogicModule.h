@@ -290,6 +290,9 @@ namespace RexLogic
         //! Handle an asset event.
         bool HandleAssetEvent(event_id_t event_id, Foundation::EventDataInterface* data);
 
+        //! Handle a thread task event.
+        bool HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data);
+
         //! Does preparations before logout/delete of scene
         //! For example: Takes ui screenshots of world/avatar with rendering service.
         //! Add functionality if you need something done before logout.
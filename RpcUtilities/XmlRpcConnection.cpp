@@ -3,11 +3,19 @@
 #include "StableHeaders.h"
 #include "XmlRpcException.h"
 #include "XmlRpcConnection.h"
+#include "XmlRpcStreamReader.h"
 #include "Poco/URI.h"
 #include "boost/lexical_cast.hpp"
 
 #include "HttpRequest.h"
 
+#include <boost/bind.hpp>
+
+static bool FeedStreamReader(XmlRpcStreamReader *reader, const u8 *data, uint size)
+{
+    return reader->AddData((const char *)data, (int)size);
+}
+
 XmlRpcConnection::XmlRpcConnection(const std::string& url)
 {
     SetServer(url);
@@ -49,3 +57,23 @@ XMLRPC_REQUEST XmlRpcConnection::Send(const char* data)
     // Convert the XML string to a XMLRPC reply structure.
     return XMLRPC_REQUEST_FromXML((const char*)&response_data[0], (int)(response_data.size()), 0);
 }
+
+void XmlRpcConnection::Send(const char* data, XmlRpcStreamReader& reader)
+{
+    HttpUtilities::HttpRequest request;
+    request.SetUrl(strUrl_);
+    request.SetRequestData("text/xml", data);
+    request.SetMethod(HttpUtilities::HttpRequest::Post);
+    request.SetResponseHandler(boost::bind(&FeedStreamReader, &reader, _1, _2));
+    request.Perform();
+
+    // The reader stops the transfer if it finds an error, so check it first for a better error message.
+    if (!reader.GetError().empty())
+        throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcConnection::Send() " + reader.GetError()));
+
+    if (!request.GetSuccess())
+        throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcConnection::Send() " + request.GetReason()));
+
+    if (!reader.IsFinished())
+        throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcConnection::Send() response data was incomplete"));
+}
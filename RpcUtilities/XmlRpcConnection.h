@@ -4,6 +4,8 @@
 
 #include <xmlrpc.h>
 
+class XmlRpcStreamReader;
+
 /**
  * Represents a XMLRPC connection. You can do multiple XMLRPC requests/replies using the same connection.
  * @note use class throught XMLRPCEPI-class. 
@@ -43,6 +45,14 @@ public:
 	 **/
 	XMLRPC_REQUEST Send(const char* data);  
 
+	/**
+	 * Sends the XMLRPC request data (pure xml) over to the server, and parses the reply while it is received.
+	 * @param data is pure xml which is constructed in @p XMLRPCCall -class
+	 * @param reader is reader which gets the reply data as it arrives.
+	 * @throw XMLRPCException is send failed, or the reply was incomplete or not well-formed.
+	 **/
+	void Send(const char* data, XmlRpcStreamReader& reader);
+
 private:
 	std::string strUrl_;
 };
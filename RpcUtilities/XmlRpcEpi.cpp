@@ -6,6 +6,7 @@
 #include "XmlRpcEpi.h"
 #include "XmlRpcConnection.h"
 #include "XmlRpcCall.h"
+#include "XmlRpcStreamReader.h"
 
 #include <xmlrpc.h>
 
@@ -113,6 +114,42 @@ void XmlRpcEpi::Send()
     pXmlData = 0;
 }
 
+void XmlRpcEpi::Send(XmlRpcReplyHandler &handler)
+{
+    if (call_ == 0)
+       throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcEpi::Send() Call object was zero pointer"));
+    else if (connection_ == 0)
+       throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcEpi::Send() Connection object was zero pointer"));
+
+    // We now own xmlData, remember to deallocate using free();
+    char *pXmlData = XMLRPC_REQUEST_ToXML(call_->GetRequest(), 0);
+    if (pXmlData == 0)
+        throw XmlRpcException(std::string("XmlRpcEpi exception in XmlRpcEpi::Send() xml data was zero pointer"));
+
+    // Old reply would not match the new one.
+    if (call_->GetReply() != 0)
+    {
+        XMLRPC_RequestFree(call_->GetReply(),1);
+        call_->SetReply(0);
+    }
+
+    try
+    {
+        XmlRpcStreamReader reader(&handler);
+        connection_->Send(pXmlData, reader);
+    }
+    catch(XmlRpcException& ex)
+    {
+        // Free xmlData
+        XMLRPC_Free(pXmlData);
+        pXmlData = 0;
+        throw ex;
+    }
+    // Free xmlData
+    XMLRPC_Free(pXmlData);
+    pXmlData = 0;
+}
+
 void XmlRpcEpi::AddStringToArray(const std::string& name, const char *sstr)
 {
     if (call_ != 0)
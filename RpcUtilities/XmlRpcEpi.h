@@ -7,6 +7,7 @@
 
 class XmlRpcConnection;
 class XmlRpcCall;
+class XmlRpcReplyHandler;
 
 	/**
 	 * This class purpose is to be easy interface for XMLRPC-epi function calls. You only need to include this 
@@ -80,6 +81,12 @@ class XmlRpcCall;
 			@throw XMLRPCException if message cannot be send or problem occures. */
 		void Send();
 
+		/** Sends the built xmlrpc-call through connection, and passes the reply values to a handler while the reply
+			is being received. The reply is not stored, so @p GetReply() and @p HasReply() can't be used afterwards.
+			@param handler Handler which receives the reply values.
+			@throw XMLRPCException if message cannot be send, or the reply was incomplete or not well-formed. */
+		void Send(XmlRpcReplyHandler &handler);
+
 		/**
 		 * Sets a new call method name. 
 		 * @param method is new xmlrpc request method name. 
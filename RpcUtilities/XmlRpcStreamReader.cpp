@@ -0,0 +1,156 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "XmlRpcStreamReader.h"
+
+#include <cstdlib>
+
+static std::string ToStdString(const QString &str)
+{
+    QByteArray utf8 = str.toUtf8();
+    return std::string(utf8.constData(), utf8.size());
+}
+
+XmlRpcStreamReader::XmlRpcStreamReader(XmlRpcReplyHandler *handler) :
+    handler_(handler),
+    collect_(false),
+    scalar_(false),
+    fault_(false),
+    faultCode_(0),
+    finished_(false)
+{
+}
+
+bool XmlRpcStreamReader::AddData(const char *data, int size)
+{
+    if (!error_.empty())
+        return false;
+
+    xml_.addData(QByteArray(data, size));
+
+    while(!xml_.atEnd())
+    {
+        switch(xml_.readNext())
+        {
+        case QXmlStreamReader::StartElement:
+            StartElement(xml_.name());
+            break;
+        case QXmlStreamReader::EndElement:
+            EndElement(xml_.name());
+            break;
+        case QXmlStreamReader::Characters:
+            if (collect_)
+                text_ += xml_.text();
+            break;
+        case QXmlStreamReader::EndDocument:
+            finished_ = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // The reader stops at the end of the data it has, and continues where it left off when more is added.
+    if (xml_.hasError() && xml_.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+    {
+        error_ = "XmlRpcStreamReader: " + ToStdString(xml_.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+void XmlRpcStreamReader::StartElement(const QStringRef &name)
+{
+    if (name == "value")
+    {
+        scalar_ = true;
+        collect_ = true;
+        text_.clear();
+    }
+    else if (name == "struct" || name == "array")
+    {
+        scalar_ = false;
+        collect_ = false;
+        Container container;
+        container.isStruct = (name == "struct");
+        containers_.push_back(container);
+    }
+    else if (name == "name")
+    {
+        collect_ = true;
+        text_.clear();
+    }
+    else if (name == "fault")
+    {
+        fault_ = true;
+        faultCode_ = 0;
+        faultString_.clear();
+    }
+    else if (scalar_)
+    {
+        // Typed scalar, e.g. <string> or <i4>. Drop the whitespace before it.
+        collect_ = true;
+        text_.clear();
+    }
+}
+
+void XmlRpcStreamReader::EndElement(const QStringRef &name)
+{
+    if (name == "value")
+    {
+        if (scalar_)
+            EndScalar();
+        scalar_ = false;
+        collect_ = false;
+    }
+    else if (name == "struct" || name == "array")
+    {
+        if (!containers_.empty())
+            containers_.pop_back();
+
+        // Struct inside an array member of the reply struct is complete.
+        if (name == "struct" && containers_.size() == 2 && containers_[0].isStruct && !containers_[1].isStruct)
+        {
+            if (!fault_)
+                handler_->OnArrayStruct(containers_[0].member, struct_);
+            struct_.clear();
+        }
+    }
+    else if (name == "name")
+    {
+        if (!containers_.empty())
+            containers_.back().member = ToStdString(text_.trimmed());
+        collect_ = false;
+    }
+    else if (name == "fault")
+    {
+        fault_ = false;
+        handler_->OnFault(faultCode_, faultString_);
+    }
+    else if (scalar_)
+    {
+        // End of a typed scalar, ignore the whitespace after it.
+        collect_ = false;
+    }
+}
+
+void XmlRpcStreamReader::EndScalar()
+{
+    std::string value = ToStdString(text_);
+
+    if (containers_.size() == 1 && containers_[0].isStruct)
+    {
+        const std::string &member = containers_[0].member;
+        if (!fault_)
+            handler_->OnMember(member, value);
+        else if (member == "faultCode")
+            faultCode_ = atoi(value.c_str());
+        else if (member == "faultString")
+            faultString_ = value;
+    }
+    else if (containers_.size() == 3 && containers_[0].isStruct && !containers_[1].isStruct && containers_[2].isStruct)
+    {
+        struct_[containers_[2].member] = value;
+    }
+}
@@ -0,0 +1,129 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+#ifndef incl_RpcUtilities_XmlRpcStreamReader_h
+#define incl_RpcUtilities_XmlRpcStreamReader_h
+
+#include <QXmlStreamReader>
+
+#include <string>
+#include <map>
+#include <vector>
+
+/**
+ * Struct of scalar values inside a XMLRPC reply, member name -> value as text.
+ */
+typedef std::map<std::string, std::string> XmlRpcStruct;
+
+/**
+ * Receives the values of a XMLRPC reply from @p XmlRpcStreamReader while the reply is being read.
+ * Only the shapes used by login replies are reported: scalar members of the reply struct and
+ * structs of scalars inside arrays of the reply struct. Other values are skipped.
+ */
+class XmlRpcReplyHandler
+{
+public:
+	virtual ~XmlRpcReplyHandler() {}
+
+	/**
+	 * Called for each scalar member of the reply struct.
+	 * @param name is member name.
+	 * @param value is member value as text, booleans are "0" or "1".
+	 */
+	virtual void OnMember(const std::string& name, const std::string& value) = 0;
+
+	/**
+	 * Called for each struct inside an array member of the reply struct, e.g. an inventory folder.
+	 * @param array is name of the array member.
+	 * @param values are the scalar members of the struct.
+	 */
+	virtual void OnArrayStruct(const std::string& array, const XmlRpcStruct& values) = 0;
+
+	/**
+	 * Called if the server replied with a fault instead of a reply struct.
+	 * @param code is fault code.
+	 * @param message is fault string.
+	 */
+	virtual void OnFault(int code, const std::string& message) {}
+};
+
+/**
+ * Reads a XMLRPC reply in pieces as it arrives and passes the values on to a @p XmlRpcReplyHandler,
+ * without building the reply tree in memory.
+ *
+ * @code
+ *  XmlRpcStreamReader reader(&handler);
+ *  while(more data)
+ *      if (!reader.AddData(data, size))
+ *          throw XmlRpcException(reader.GetError());
+ *  if (!reader.IsFinished())
+ *      throw XmlRpcException("Incomplete reply");
+ * @endcode
+ */
+class XmlRpcStreamReader
+{
+public:
+	/**
+	 * Constructor.
+	 * @param handler receives the reply values. Not owned.
+	 */
+	explicit XmlRpcStreamReader(XmlRpcReplyHandler *handler);
+
+	/**
+	 * Parses the next piece of reply data. Handler is called for every value completed by the data.
+	 * @param data is reply data.
+	 * @param size is data size in bytes.
+	 * @return false if the data is not well-formed XML.
+	 */
+	bool AddData(const char *data, int size);
+
+	/**
+	 * Returns true when the whole reply document has been read.
+	 */
+	bool IsFinished() const { return finished_; }
+
+	/**
+	 * Returns description of the parse error, or empty string if no error occurred.
+	 */
+	std::string GetError() const { return error_; }
+
+private:
+	/// Open struct or array of the reply.
+	struct Container
+	{
+		/// Is this a struct or an array.
+		bool isStruct;
+		/// Name of the current member of a struct.
+		std::string member;
+	};
+
+	void StartElement(const QStringRef &name);
+	void EndElement(const QStringRef &name);
+	void EndScalar();
+
+	XmlRpcReplyHandler *handler_;
+	QXmlStreamReader xml_;
+
+	/// Open structs and arrays, the reply struct first.
+	std::vector<Container> containers_;
+
+	/// Values of the struct being read inside an array of the reply struct.
+	XmlRpcStruct struct_;
+
+	/// Character data of the current member name or scalar value.
+	QString text_;
+
+	/// Is character data being collected to text_.
+	bool collect_;
+
+	/// Is the current value a scalar.
+	bool scalar_;
+
+	/// Is a fault being read.
+	bool fault_;
+	int faultCode_;
+	std::string faultString_;
+
+	bool finished_;
+	std::string error_;
+};
+
+#endif
@@ -12,6 +12,8 @@
 #include "ComponentInterface.h"
 #include "ForwardDefines.h"
 
+#include <QVector4D>
+
 #include "MemoryLeakCheck.h"
 
 namespace Scene
@@ -95,6 +97,7 @@ namespace Scene
             framework_->GetEventManager()->SendEvent(cat_id, Events::EVENT_ENTITY_DELETED, &event_data);
 
             entities_.erase(it);
+            spatial_index_.Remove(id);
             // If entity somehow manages to live, at least it doesn't belong to the scene anymore
             del_entity->SetScene(0);
             del_entity.reset();
@@ -129,6 +132,8 @@ namespace Scene
     void SceneManager::EmitComponentRemoved(Scene::Entity* entity, Foundation::ComponentInterface* comp, AttributeChange::Type change)
     {
         emit ComponentRemoved(entity, comp, change);
+        // Drop the bounds if they were set by this component
+        spatial_index_.Remove(entity->GetId(), comp);
     }
 
     void SceneManager::EmitAttributeChanged(Foundation::ComponentInterface* comp, Foundation::AttributeInterface* attribute, AttributeChange::Type change)
@@ -167,5 +172,55 @@ namespace Scene
         }
         return ids;
     }
-}
 
+    static QVariantList ToVariantList(const std::vector<entity_id_t> &ids)
+    {
+        QVariantList list;
+        for(size_t i = 0; i < ids.size(); ++i)
+            list.append(QVariant(ids[i]));
+        return list;
+    }
+
+    QVariantList SceneManager::GetEntityIdsInRadius(const QVector3D &center, float radius)
+    {
+        std::vector<entity_id_t> ids;
+        spatial_index_.QueryRadius(Vector3df(center.x(), center.y(), center.z()), radius, ids);
+        return ToVariantList(ids);
+    }
+
+    QVariantList SceneManager::GetEntityIdsInBox(const QVector3D &min, const QVector3D &max)
+    {
+        std::vector<entity_id_t> ids;
+        spatial_index_.QueryBox(Vector3df(min.x(), min.y(), min.z()), Vector3df(max.x(), max.y(), max.z()), ids);
+        return ToVariantList(ids);
+    }
+
+    QVariantList SceneManager::GetEntityIdsInFrustum(const QVariantList &planes)
+    {
+        std::vector<SpatialIndex::Plane> index_planes;
+        for(int i = 0; i < planes.size(); ++i)
+        {
+            QVector4D plane = planes[i].value<QVector4D>();
+            SpatialIndex::Plane index_plane;
+            index_plane.normal_ = Vector3df(plane.x(), plane.y(), plane.z());
+            index_plane.d_ = plane.w();
+            index_planes.push_back(index_plane);
+        }
+
+        std::vector<entity_id_t> ids;
+        spatial_index_.QueryFrustum(index_planes, ids);
+        return ToVariantList(ids);
+    }
+
+    QVariantList SceneManager::GetEntityIdsOnRay(const QVector3D &origin, const QVector3D &direction, float max_distance)
+    {
+        std::vector<SpatialIndex::RayHit> hits;
+        spatial_index_.QueryRay(Vector3df(origin.x(), origin.y(), origin.z()),
+            Vector3df(direction.x(), direction.y(), direction.z()), max_distance, hits);
+
+        QVariantList ids;
+        for(size_t i = 0; i < hits.size(); ++i)
+            ids.append(QVariant(hits[i].second));
+        return ids;
+    }
+}
@@ -7,8 +7,10 @@
 #include "CoreAnyIterator.h"
 #include "Entity.h"
 #include "ComponentInterface.h"
+#include "SpatialIndex.h"
 #include <QObject>
 #include <qvariant.h>
+#include <QtGui/qvector3d.h>
 
 namespace Foundation
 {
@@ -55,6 +57,21 @@ namespace Scene
     public slots:
         QVariantList GetEntityIdsWithComponent(const QString &type_name);
 
+        //! Returns ids of entities whose bounds are within a distance from a point
+        QVariantList GetEntityIdsInRadius(const QVector3D &center, float radius);
+
+        //! Returns ids of entities whose bounds intersect a box
+        QVariantList GetEntityIdsInBox(const QVector3D &min, const QVector3D &max);
+
+        //! Returns ids of entities whose bounds are at least partly inside all planes
+        /*! \param planes list of QVector4D, with the plane normal in xyz and distance in w.
+                   The inside is where normal.dotProduct(point) + distance >= 0
+         */
+        QVariantList GetEntityIdsInFrustum(const QVariantList &planes);
+
+        //! Returns ids of entities whose bounds a ray hits, sorted by distance
+        QVariantList GetEntityIdsOnRay(const QVector3D &origin, const QVector3D &direction, float max_distance);
+
     public:
         //! destructor
         ~SceneManager();
@@ -131,6 +148,10 @@ namespace Scene
         //! \param type_name Type name of the component
         EntityList GetEntitiesWithComponent(const std::string &type_name);
 
+        //! Returns spatial index of the entities. Placeable components keep it up to date
+        SpatialIndex &GetSpatialIndex() { return spatial_index_; }
+        const SpatialIndex &GetSpatialIndex() const { return spatial_index_; }
+
         //! Emit a notification of a component's attributes changing. Called by the components themselves
         /*! \param comp Component pointer
             \param change Type of change (local, from network...)
@@ -187,6 +208,9 @@ namespace Scene
         //! Name of the scene
         const std::string name_;
 
+        //! Bounds of the entities
+        SpatialIndex spatial_index_;
+
     signals:
         //! Signal when a component is changed and should possibly be replicated (if the change originates from local)
         /*! Network synchronization managers should connect to this
@@ -0,0 +1,605 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#include "StableHeaders.h"
+#include "DebugOperatorNew.h"
+
+#include "SpatialIndex.h"
+
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+
+#include "MemoryLeakCheck.h"
+
+namespace Scene
+{
+    //! Max. depth of a query stack. The tree is kept balanced, so this is never reached in practice
+    const int cMaxStackSize = 256;
+
+    SpatialIndex::Bounds SpatialIndex::Bounds::Union(const Bounds &a, const Bounds &b)
+    {
+        Bounds result;
+        result.min_ = Vector3df(std::min(a.min_.x, b.min_.x), std::min(a.min_.y, b.min_.y), std::min(a.min_.z, b.min_.z));
+        result.max_ = Vector3df(std::max(a.max_.x, b.max_.x), std::max(a.max_.y, b.max_.y), std::max(a.max_.z, b.max_.z));
+        return result;
+    }
+
+    SpatialIndex::SpatialIndex(f32 margin) :
+        root_(-1),
+        free_list_(-1),
+        margin_(margin)
+    {
+    }
+
+    int SpatialIndex::AllocateNode()
+    {
+        int node;
+        if (free_list_ >= 0)
+        {
+            node = free_list_;
+            free_list_ = nodes_[node].parent_;
+        }
+        else
+        {
+            node = nodes_.size();
+            nodes_.push_back(Node());
+        }
+
+        Node &n = nodes_[node];
+        n.parent_ = -1;
+        n.child1_ = -1;
+        n.child2_ = -1;
+        n.height_ = 0;
+        n.id_ = 0;
+        n.source_ = 0;
+        return node;
+    }
+
+    void SpatialIndex::FreeNode(int node)
+    {
+        nodes_[node].parent_ = free_list_;
+        nodes_[node].height_ = -1;
+        free_list_ = node;
+    }
+
+    void SpatialIndex::Update(entity_id_t id, const Vector3df &min, const Vector3df &max, const void *source)
+    {
+        Bounds bounds;
+        bounds.min_ = min;
+        bounds.max_ = max;
+
+        std::map<entity_id_t, int>::iterator it = leaves_.find(id);
+        int leaf;
+        if (it != leaves_.end())
+        {
+            leaf = it->second;
+            nodes_[leaf].entity_bounds_ = bounds;
+            nodes_[leaf].source_ = source;
+
+            // Small moves stay inside the enlarged bounds
+            if (nodes_[leaf].bounds_.Contains(bounds))
+                return;
+
+            RemoveLeaf(leaf);
+        }
+        else
+        {
+            leaf = AllocateNode();
+            nodes_[leaf].id_ = id;
+            nodes_[leaf].entity_bounds_ = bounds;
+            nodes_[leaf].source_ = source;
+            leaves_[id] = leaf;
+        }
+
+        nodes_[leaf].bounds_.min_ = min - margin_;
+        nodes_[leaf].bounds_.max_ = max + margin_;
+        InsertLeaf(leaf);
+    }
+
+    void SpatialIndex::Remove(entity_id_t id, const void *source)
+    {
+        std::map<entity_id_t, int>::iterator it = leaves_.find(id);
+        if (it == leaves_.end())
+            return;
+
+        int leaf = it->second;
+        if (source && nodes_[leaf].source_ != source)
+            return;
+
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+        leaves_.erase(it);
+    }
+
+    void SpatialIndex::Clear()
+    {
+        nodes_.clear();
+        leaves_.clear();
+        root_ = -1;
+        free_list_ = -1;
+    }
+
+    void SpatialIndex::InsertLeaf(int leaf)
+    {
+        if (root_ < 0)
+        {
+            root_ = leaf;
+            nodes_[leaf].parent_ = -1;
+            return;
+        }
+
+        // Find the best sibling by the surface area heuristic
+        Bounds leaf_bounds = nodes_[leaf].bounds_;
+        int index = root_;
+        while(!nodes_[index].IsLeaf())
+        {
+            int child1 = nodes_[index].child1_;
+            int child2 = nodes_[index].child2_;
+
+            f32 area = nodes_[index].bounds_.HalfArea();
+            f32 combined_area = Bounds::Union(nodes_[index].bounds_, leaf_bounds).HalfArea();
+
+            // Cost of making a new parent for this node and the new leaf
+            f32 cost = 2.0f * combined_area;
+            // Minimum cost of pushing the leaf further down the tree
+            f32 inheritance_cost = 2.0f * (combined_area - area);
+
+            f32 cost1 = Bounds::Union(leaf_bounds, nodes_[child1].bounds_).HalfArea() + inheritance_cost;
+            if (!nodes_[child1].IsLeaf())
+                cost1 -= nodes_[child1].bounds_.HalfArea();
+            f32 cost2 = Bounds::Union(leaf_bounds, nodes_[child2].bounds_).HalfArea() + inheritance_cost;
+            if (!nodes_[child2].IsLeaf())
+                cost2 -= nodes_[child2].bounds_.HalfArea();
+
+            if (cost < cost1 && cost < cost2)
+                break;
+
+            index = cost1 < cost2 ? child1 : child2;
+        }
+
+        int sibling = index;
+
+        // Create a new parent for the sibling and the leaf
+        int old_parent = nodes_[sibling].parent_;
+        int new_parent = AllocateNode();
+        nodes_[new_parent].parent_ = old_parent;
+        nodes_[new_parent].bounds_ = Bounds::Union(leaf_bounds, nodes_[sibling].bounds_);
+        nodes_[new_parent].height_ = nodes_[sibling].height_ + 1;
+        nodes_[new_parent].child1_ = sibling;
+        nodes_[new_parent].child2_ = leaf;
+        nodes_[sibling].parent_ = new_parent;
+        nodes_[leaf].parent_ = new_parent;
+
+        if (old_parent >= 0)
+        {
+            if (nodes_[old_parent].child1_ == sibling)
+                nodes_[old_parent].child1_ = new_parent;
+            else
+                nodes_[old_parent].child2_ = new_parent;
+        }
+        else
+            root_ = new_parent;
+
+        // Refit the ancestors
+        index = nodes_[leaf].parent_;
+        while(index >= 0)
+        {
+            index = Balance(index);
+
+            int child1 = nodes_[index].child1_;
+            int child2 = nodes_[index].child2_;
+            nodes_[index].height_ = 1 + std::max(nodes_[child1].height_, nodes_[child2].height_);
+            nodes_[index].bounds_ = Bounds::Union(nodes_[child1].bounds_, nodes_[child2].bounds_);
+
+            index = nodes_[index].parent_;
+        }
+    }
+
+    void SpatialIndex::RemoveLeaf(int leaf)
+    {
+        if (leaf == root_)
+        {
+            root_ = -1;
+            return;
+        }
+
+        int parent = nodes_[leaf].parent_;
+        int grand_parent = nodes_[parent].parent_;
+        int sibling = nodes_[parent].child1_ == leaf ? nodes_[parent].child2_ : nodes_[parent].child1_;
+
+        if (grand_parent >= 0)
+        {
+            // Replace the parent by the sibling
+            if (nodes_[grand_parent].child1_ == parent)
+                nodes_[grand_parent].child1_ = sibling;
+            else
+                nodes_[grand_parent].child2_ = sibling;
+            nodes_[sibling].parent_ = grand_parent;
+            FreeNode(parent);
+
+            int index = grand_parent;
+            while(index >= 0)
+            {
+                index = Balance(index);
+
+                int child1 = nodes_[index].child1_;
+                int child2 = nodes_[index].child2_;
+                nodes_[index].bounds_ = Bounds::Union(nodes_[child1].bounds_, nodes_[child2].bounds_);
+                nodes_[index].height_ = 1 + std::max(nodes_[child1].height_, nodes_[child2].height_);
+
+                index = nodes_[index].parent_;
+            }
+        }
+        else
+        {
+            root_ = sibling;
+            nodes_[sibling].parent_ = -1;
+            FreeNode(parent);
+        }
+    }
+
+    int SpatialIndex::Balance(int a)
+    {
+        Node &A = nodes_[a];
+        if (A.IsLeaf() || A.height_ < 2)
+            return a;
+
+        int b = A.child1_;
+        int c = A.child2_;
+        int balance = nodes_[c].height_ - nodes_[b].height_;
+
+        // Rotate the taller child up
+        if (balance > 1 || balance < -1)
+        {
+            int f = balance > 1 ? c : b;
+            int other = balance > 1 ? b : c;
+            Node &F = nodes_[f];
+            int g = F.child1_;
+            int h = F.child2_;
+
+            // F becomes the parent of A
+            F.child1_ = a;
+            F.parent_ = A.parent_;
+            A.parent_ = f;
+
+            if (F.parent_ >= 0)
+            {
+                if (nodes_[F.parent_].child1_ == a)
+                    nodes_[F.parent_].child1_ = f;
+                else
+                    nodes_[F.parent_].child2_ = f;
+            }
+            else
+                root_ = f;
+
+            // The taller grandchild stays under F, the other one takes F's place under A
+            int keep = nodes_[g].height_ > nodes_[h].height_ ? g : h;
+            int move = keep == g ? h : g;
+            F.child2_ = keep;
+            if (balance > 1)
+                A.child2_ = move;
+            else
+                A.child1_ = move;
+            nodes_[move].parent_ = a;
+
+            A.bounds_ = Bounds::Union(nodes_[other].bounds_, nodes_[move].bounds_);
+            A.height_ = 1 + std::max(nodes_[other].height_, nodes_[move].height_);
+            F.bounds_ = Bounds::Union(A.bounds_, nodes_[keep].bounds_);
+            F.height_ = 1 + std::max(A.height_, nodes_[keep].height_);
+
+            return f;
+        }
+
+        return a;
+    }
+
+    void SpatialIndex::QueryRadius(const Vector3df &center, f32 radius, std::vector<entity_id_t> &result) const
+    {
+        if (root_ < 0)
+            return;
+
+        f32 radius_sq = radius * radius;
+        Bounds query;
+        query.min_ = center - radius;
+        query.max_ = center + radius;
+
+        int stack[cMaxStackSize];
+        int stack_size = 0;
+        stack[stack_size++] = root_;
+        while(stack_size)
+        {
+            const Node &node = nodes_[stack[--stack_size]];
+            if (!node.bounds_.Overlaps(query))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                // Distance from the center to the closest point of the bounds
+                const Bounds &b = node.entity_bounds_;
+                Vector3df closest(std::max(b.min_.x, std::min(center.x, b.max_.x)),
+                    std::max(b.min_.y, std::min(center.y, b.max_.y)), std::max(b.min_.z, std::min(center.z, b.max_.z)));
+                if ((closest - center).getLengthSQ() <= radius_sq)
+                    result.push_back(node.id_);
+            }
+            else if (stack_size + 2 <= cMaxStackSize)
+            {
+                stack[stack_size++] = node.child1_;
+                stack[stack_size++] = node.child2_;
+            }
+        }
+    }
+
+    void SpatialIndex::QueryBox(const Vector3df &min, const Vector3df &max, std::vector<entity_id_t> &result) const
+    {
+        if (root_ < 0)
+            return;
+
+        Bounds query;
+        query.min_ = min;
+        query.max_ = max;
+
+        int stack[cMaxStackSize];
+        int stack_size = 0;
+        stack[stack_size++] = root_;
+        while(stack_size)
+        {
+            const Node &node = nodes_[stack[--stack_size]];
+            if (!node.bounds_.Overlaps(query))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                if (node.entity_bounds_.Overlaps(query))
+                    result.push_back(node.id_);
+            }
+            else if (stack_size + 2 <= cMaxStackSize)
+            {
+                stack[stack_size++] = node.child1_;
+                stack[stack_size++] = node.child2_;
+            }
+        }
+    }
+
+    //! Returns true if bounds are at least partly on the inside of a plane
+    static bool InsidePlane(const SpatialIndex::Plane &plane, const Vector3df &min, const Vector3df &max)
+    {
+        // Test the corner farthest along the plane normal
+        Vector3df corner(plane.normal_.x >= 0.0f ? max.x : min.x, plane.normal_.y >= 0.0f ? max.y : min.y,
+            plane.normal_.z >= 0.0f ? max.z : min.z);
+        return plane.normal_.dotProduct(corner) + plane.d_ >= 0.0f;
+    }
+
+    void SpatialIndex::QueryFrustum(const std::vector<Plane> &planes, std::vector<entity_id_t> &result) const
+    {
+        if (root_ < 0)
+            return;
+
+        int stack[cMaxStackSize];
+        int stack_size = 0;
+        stack[stack_size++] = root_;
+        while(stack_size)
+        {
+            const Node &node = nodes_[stack[--stack_size]];
+            const Bounds &b = node.IsLeaf() ? node.entity_bounds_ : node.bounds_;
+
+            bool inside = true;
+            for(size_t i = 0; i < planes.size() && inside; ++i)
+                inside = InsidePlane(planes[i], b.min_, b.max_);
+            if (!inside)
+                continue;
+
+            if (node.IsLeaf())
+                result.push_back(node.id_);
+            else if (stack_size + 2 <= cMaxStackSize)
+            {
+                stack[stack_size++] = node.child1_;
+                stack[stack_size++] = node.child2_;
+            }
+        }
+    }
+
+    f32 SpatialIndex::IntersectRay(const Bounds &bounds, const Vector3df &origin, const Vector3df &inv_direction, f32 max_distance)
+    {
+        // Slab test. Zero direction components give infinite inverses, which the comparisons handle.
+        f32 tmin = 0.0f;
+        f32 tmax = max_distance;
+        const f32 *min = &bounds.min_.x;
+        const f32 *max = &bounds.max_.x;
+        const f32 *o = &origin.x;
+        const f32 *inv = &inv_direction.x;
+        for(int i = 0; i < 3; ++i)
+        {
+            f32 t1 = (min[i] - o[i]) * inv[i];
+            f32 t2 = (max[i] - o[i]) * inv[i];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            if (t1 > tmin)
+                tmin = t1;
+            if (t2 < tmax)
+                tmax = t2;
+            if (tmin > tmax)
+                return -1.0f;
+        }
+        return tmin;
+    }
+
+    void SpatialIndex::QueryRay(const Vector3df &origin, const Vector3df &direction, f32 max_distance, std::vector<RayHit> &result) const
+    {
+        if (root_ < 0)
+            return;
+
+        Vector3df inv_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        size_t first = result.size();
+
+        int stack[cMaxStackSize];
+        int stack_size = 0;
+        stack[stack_size++] = root_;
+        while(stack_size)
+        {
+            const Node &node = nodes_[stack[--stack_size]];
+            if (IntersectRay(node.bounds_, origin, inv_direction, max_distance) < 0.0f)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                f32 distance = IntersectRay(node.entity_bounds_, origin, inv_direction, max_distance);
+                if (distance >= 0.0f)
+                    result.push_back(RayHit(distance, node.id_));
+            }
+            else if (stack_size + 2 <= cMaxStackSize)
+            {
+                stack[stack_size++] = node.child1_;
+                stack[stack_size++] = node.child2_;
+            }
+        }
+
+        std::sort(result.begin() + first, result.end());
+    }
+
+    static f32 RandomFloat(f32 min, f32 max)
+    {
+        return min + (max - min) * (f32)rand() / (f32)RAND_MAX;
+    }
+
+    std::string BenchmarkSpatialIndex(uint num_entities, uint num_queries)
+    {
+        // Entities spread over a 16x16 grid of 256 m regions, mostly small prims and some large ones
+        const f32 world_size = 4096.0f;
+
+        srand(1);
+
+        std::vector<Vector3df> mins(num_entities);
+        std::vector<Vector3df> maxs(num_entities);
+        for(uint i = 0; i < num_entities; ++i)
+        {
+            Vector3df pos(RandomFloat(0.0f, world_size), RandomFloat(0.0f, world_size), RandomFloat(0.0f, 100.0f));
+            f32 radius = (i % 20 == 0) ? RandomFloat(5.0f, 30.0f) : RandomFloat(0.2f, 2.0f);
+            mins[i] = pos - radius;
+            maxs[i] = pos + radius;
+        }
+
+        SpatialIndex index;
+        Poco::Timestamp insert_start;
+        for(uint i = 0; i < num_entities; ++i)
+            index.Update(i, mins[i], maxs[i]);
+        double insert_time = insert_start.elapsed() / 1000000.0;
+
+        // Move every entity by a small step, as moving avatars and physics objects do each frame
+        Poco::Timestamp move_start;
+        for(uint i = 0; i < num_entities; ++i)
+        {
+            Vector3df step(RandomFloat(-0.3f, 0.3f), RandomFloat(-0.3f, 0.3f), 0.0f);
+            mins[i] += step;
+            maxs[i] += step;
+            index.Update(i, mins[i], maxs[i]);
+        }
+        double move_time = move_start.elapsed() / 1000000.0;
+
+        std::vector<Vector3df> centers(num_queries);
+        for(uint i = 0; i < num_queries; ++i)
+            centers[i] = Vector3df(RandomFloat(0.0f, world_size), RandomFloat(0.0f, world_size), RandomFloat(0.0f, 100.0f));
+        const f32 radius = 50.0f;
+
+        // Radius queries, e.g. for name tags or sound sources near the listener
+        uint index_found = 0;
+        std::vector<entity_id_t> found;
+        Poco::Timestamp radius_start;
+        for(uint i = 0; i < num_queries; ++i)
+        {
+            found.clear();
+            index.QueryRadius(centers[i], radius, found);
+            index_found += found.size();
+        }
+        double radius_time = radius_start.elapsed() / 1000000.0;
+
+        uint all_found = 0;
+        Poco::Timestamp all_start;
+        for(uint i = 0; i < num_queries; ++i)
+            for(uint j = 0; j < num_entities; ++j)
+            {
+                Vector3df closest(std::max(mins[j].x, std::min(centers[i].x, maxs[j].x)),
+                    std::max(mins[j].y, std::min(centers[i].y, maxs[j].y)), std::max(mins[j].z, std::min(centers[i].z, maxs[j].z)));
+                if ((closest - centers[i]).getLengthSQ() <= radius * radius)
+                    ++all_found;
+            }
+        double all_time = all_start.elapsed() / 1000000.0;
+
+        // Box queries of the same extent, e.g. for the objects of a region
+        uint box_found = 0;
+        const Vector3df box_extent(radius, radius, radius);
+        Poco::Timestamp box_start;
+        for(uint i = 0; i < num_queries; ++i)
+        {
+            found.clear();
+            index.QueryBox(centers[i] - box_extent, centers[i] + box_extent, found);
+            box_found += found.size();
+        }
+        double box_time = box_start.elapsed() / 1000000.0;
+
+        // View frustums of a camera looking horizontally in a random direction, with a 60 degree field of view
+        const f32 near_distance = 0.1f;
+        const f32 far_distance = 200.0f;
+        const f32 half_fov_sin = 0.5f;
+        const f32 half_fov_cos = 0.8660254f;
+        std::vector<std::vector<SpatialIndex::Plane> > frustums(num_queries);
+        for(uint i = 0; i < num_queries; ++i)
+        {
+            f32 angle = RandomFloat(0.0f, 6.2831853f);
+            Vector3df forward(cos(angle), sin(angle), 0.0f);
+            Vector3df up(0.0f, 0.0f, 1.0f);
+            Vector3df right = forward.crossProduct(up);
+            Vector3df normals[6] = { forward, -forward, forward * half_fov_sin - right * half_fov_cos, forward * half_fov_sin + right * half_fov_cos,
+                forward * half_fov_sin - up * half_fov_cos, forward * half_fov_sin + up * half_fov_cos };
+            Vector3df points[6] = { centers[i] + forward * near_distance, centers[i] + forward * far_distance, centers[i], centers[i], centers[i], centers[i] };
+            for(int j = 0; j < 6; ++j)
+            {
+                SpatialIndex::Plane plane;
+                plane.normal_ = normals[j];
+                plane.d_ = -normals[j].dotProduct(points[j]);
+                frustums[i].push_back(plane);
+            }
+        }
+
+        uint frustum_found = 0;
+        Poco::Timestamp frustum_start;
+        for(uint i = 0; i < num_queries; ++i)
+        {
+            found.clear();
+            index.QueryFrustum(frustums[i], found);
+            frustum_found += found.size();
+        }
+        double frustum_time = frustum_start.elapsed() / 1000000.0;
+
+        // Rays from above, like picks
+        uint ray_hits = 0;
+        std::vector<SpatialIndex::RayHit> hits;
+        Poco::Timestamp ray_start;
+        for(uint i = 0; i < num_queries; ++i)
+        {
+            Vector3df origin(centers[i].x, centers[i].y, 150.0f);
+            Vector3df target(centers[i].x + RandomFloat(-100.0f, 100.0f), centers[i].y + RandomFloat(-100.0f, 100.0f), 0.0f);
+            Vector3df direction = target - origin;
+            direction.normalize();
+            hits.clear();
+            index.QueryRay(origin, direction, 500.0f, hits);
+            ray_hits += hits.size();
+        }
+        double ray_time = ray_start.elapsed() / 1000000.0;
+
+        uint queries = std::max(num_queries, 1u);
+        std::ostringstream report;
+        report << "Entities: " << num_entities << ", tree height: " << index.GetHeight() << std::endl;
+        report << "Insert all: " << insert_time * 1000.0 << " ms, move all: " << move_time * 1000.0 << " ms" << std::endl;
+        report << "Radius " << radius << " queries: " << radius_time * 1000000.0 / queries << " us each, testing all entities: "
+            << all_time * 1000000.0 / queries << " us each" << std::endl;
+        report << "Box " << radius * 2.0f << " queries: " << box_time * 1000000.0 / queries << " us each, " << box_found << " found" << std::endl;
+        report << "Frustum " << far_distance << " queries: " << frustum_time * 1000000.0 / queries << " us each, " << frustum_found << " found" << std::endl;
+        report << "Ray queries: " << ray_time * 1000000.0 / queries << " us each, " << ray_hits << " hits" << std::endl;
+        report << "Entities found: " << index_found << ", by testing all: " << all_found;
+        return report.str();
+    }
+}
@@ -0,0 +1,153 @@
+// For conditions of distribution and use, see copyright notice in license.txt
+
+#ifndef incl_SceneManager_SpatialIndex_h
+#define incl_SceneManager_SpatialIndex_h
+
+#include "CoreTypes.h"
+#include "Vector3D.h"
+
+#include <vector>
+#include <map>
+#include <string>
+
+namespace Scene
+{
+    //! Dynamic bounding volume tree of entity bounds, for finding the entities near a point, in a box, frustum or on a ray
+    /*! Independent of the renderer: the bounds are set by the component that places the entity, e.g. the Ogre placeable,
+        whenever its transform changes. Each entity has one bounding box.
+
+        Leaves are stored with their bounds enlarged by a margin, so that an entity moving by small steps needs no tree
+        update on most moves. Queries test the exact bounds of the entities.
+
+        \ingroup Scene_group
+    */
+    class SpatialIndex
+    {
+    public:
+        //! Plane of a frustum. The inside is where normal_.dotProduct(point) + d_ >= 0
+        struct Plane
+        {
+            Vector3df normal_;
+            f32 d_;
+        };
+
+        //! Entity hit by a ray, and the distance along the ray where it enters the entity bounds
+        typedef std::pair<f32, entity_id_t> RayHit;
+
+        //! constructor
+        /*! \param margin distance the leaf bounds are enlarged by
+         */
+        explicit SpatialIndex(f32 margin = 0.5f);
+
+        //! Sets bounds of an entity, inserting it if needed
+        /*! \param id entity id
+            \param min minimum corner of the bounds in world space
+            \param max maximum corner of the bounds in world space
+            \param source the component setting the bounds, see Remove
+         */
+        void Update(entity_id_t id, const Vector3df &min, const Vector3df &max, const void *source = 0);
+
+        //! Removes an entity
+        /*! \param id entity id
+            \param source if not null, the entity is removed only if its bounds were set by this component
+         */
+        void Remove(entity_id_t id, const void *source = 0);
+
+        //! Removes all entities
+        void Clear();
+
+        //! Returns true if the entity has bounds in the index
+        bool Contains(entity_id_t id) const { return leaves_.find(id) != leaves_.end(); }
+
+        //! Returns number of entities in the index
+        size_t GetNumEntities() const { return leaves_.size(); }
+
+        //! Finds entities whose bounds are within a distance from a point
+        /*! \param result ids are appended to this
+         */
+        void QueryRadius(const Vector3df &center, f32 radius, std::vector<entity_id_t> &result) const;
+
+        //! Finds entities whose bounds intersect a box
+        /*! \param result ids are appended to this
+         */
+        void QueryBox(const Vector3df &min, const Vector3df &max, std::vector<entity_id_t> &result) const;
+
+        //! Finds entities whose bounds are at least partly inside all planes, e.g. the six planes of a camera frustum
+        /*! \param result ids are appended to this
+         */
+        void QueryFrustum(const std::vector<Plane> &planes, std::vector<entity_id_t> &result) const;
+
+        //! Finds entities whose bounds a ray hits
+        /*! \param origin ray origin
+            \param direction ray direction, distances are measured in its lengths
+            \param max_distance max. distance along the ray
+            \param result hits are appended to this, sorted by distance
+         */
+        void QueryRay(const Vector3df &origin, const Vector3df &direction, f32 max_distance, std::vector<RayHit> &result) const;
+
+        //! Returns height of the tree, for diagnostics
+        int GetHeight() const { return root_ >= 0 ? nodes_[root_].height_ : 0; }
+
+    private:
+        struct Bounds
+        {
+            Vector3df min_;
+            Vector3df max_;
+
+            bool Contains(const Bounds &other) const { return min_ <= other.min_ && other.max_ <= max_; }
+            bool Overlaps(const Bounds &other) const { return min_ <= other.max_ && other.min_ <= max_; }
+            f32 HalfArea() const
+            {
+                Vector3df d = max_ - min_;
+                return d.x * d.y + d.y * d.z + d.z * d.x;
+            }
+            static Bounds Union(const Bounds &a, const Bounds &b);
+        };
+
+        struct Node
+        {
+            //! Bounds of the subtree. For leaves, the entity bounds enlarged by the margin
+            Bounds bounds_;
+            //! Parent node, or next free node in the free list
+            int parent_;
+            int child1_;
+            int child2_;
+            //! Height of the subtree, 0 for leaves, -1 for free nodes
+            int height_;
+
+            //! Leaf data: exact bounds of the entity, its id and the component that set the bounds
+            Bounds entity_bounds_;
+            entity_id_t id_;
+            const void *source_;
+
+            bool IsLeaf() const { return child1_ < 0; }
+        };
+
+        int AllocateNode();
+        void FreeNode(int node);
+        void InsertLeaf(int leaf);
+        void RemoveLeaf(int leaf);
+        //! Rotates the subtree at a to reduce its height if it is unbalanced, returns the new subtree root
+        int Balance(int a);
+
+        //! Returns entry distance of a ray into bounds, or a negative value on a miss
+        static f32 IntersectRay(const Bounds &bounds, const Vector3df &origin, const Vector3df &inv_direction, f32 max_distance);
+
+        std::vector<Node> nodes_;
+        int root_;
+        int free_list_;
+        f32 margin_;
+
+        //! Leaf node of each entity
+        std::map<entity_id_t, int> leaves_;
+    };
+
+    //! Times updates and radius, box, frustum and ray queries of a synthetic scene. Radius queries are also timed against testing all entities
+    /*! \param num_entities number of entities in the scene
+        \param num_queries number of queries of each kind
+        \return report of the timings
+     */
+    std::string BenchmarkSpatialIndex(uint num_entities, uint num_queries);
+}
+
+#endif
@@ -64,31 +64,22 @@ namespace TextureDecoder
     {
         while (ShouldRun())
         {
-            WaitForRequests();
+            if (!WaitForRequests())
+                continue;
+            
+            // Wait if "too many" results already produced, to prevent slowing down the main thread with 
+            // too many texture creations per frame
+            if ((GetThreadTaskManager()) && (GetNumQueuedResults() >= decodes_per_frame_))
+            {
+                WaitForResultsCollected();
+                continue;
+            }
             
             DecodeRequestPtr request = GetNextRequest<DecodeRequest>();
             if (request)
             {
-                // Wait if "too many" results already produced, to prevent slowing down the main thread with 
-                // too many texture creations per frame
-                Foundation::ThreadTaskManager* manager = GetThreadTaskManager();
-                if (manager)
-                {
-                    for (;;)
-                    {
-                        uint results = manager->GetNumResults(GetTaskDescription());
-                        if (results < decodes_per_frame_)
-                            break;
-                        if (!ShouldRun())
-                            return;
-                        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
-                    }
-                }
-                
-                {
-                    PROFILE(OpenJpegDecoder_Decode);
-                    PerformDecode(request);
-                }
+                PROFILE(OpenJpegDecoder_Decode);
+                PerformDecode(request);
             }
 
             RESETPROFILER
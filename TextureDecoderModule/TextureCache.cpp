@@ -11,6 +11,7 @@
 #include <QDataStream>
 #include <QCryptographicHash>
 #include <QSettings>
+#include <QCoreApplication>
 
 #include <QMessageBox>
 
@@ -49,6 +50,10 @@ namespace TextureDecoder
         QFileInfoList file_info_list = cache_dir_.entryInfoList(QDir::Files);
         foreach(QFileInfo info, file_info_list)
             current_cache_size_ += info.size();
+
+        // The module may be initialized in a worker thread, but the ui signals must be handled in the main thread
+        if (QCoreApplication::instance() && thread() != QCoreApplication::instance()->thread())
+            moveToThread(QCoreApplication::instance()->thread());
     }
 
     TextureCache::~TextureCache()
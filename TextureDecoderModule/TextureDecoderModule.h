@@ -44,9 +44,6 @@ namespace TextureDecoder
 
         //! Asset event category
         event_category_id_t asset_event_category_;
-
-        //! Task event category
-        event_category_id_t task_event_category_;
     };
 }
 
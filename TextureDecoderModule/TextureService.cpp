@@ -17,7 +17,7 @@
 #include "ConfigurationManager.h"
 #include "TextureCache.h"
 
-#include <QStringList>
+#include <boost/bind.hpp>
 
 namespace TextureDecoder
 {
@@ -25,7 +25,8 @@ namespace TextureDecoder
     
     TextureService::TextureService(Foundation::Framework* framework) : 
         framework_(framework),
-        cache_(new TextureCache(framework))
+        cache_(new TextureCache(framework)),
+        decoder_task_id_(0)
     {
         Foundation::EventManagerPtr event_manager = framework_->GetEventManager();
 
@@ -39,28 +40,34 @@ namespace TextureDecoder
         OpenJpegDecoder* decoder = new OpenJpegDecoder();
         decoder->SetDecodesPerFrame(max_decodes_per_frame_);
 
-        framework_->GetThreadTaskManager()->AddThreadTask(Foundation::ThreadTaskPtr(decoder));
+        Foundation::ThreadTaskManagerPtr manager = framework_->GetThreadTaskManager();
+        decoder_task_id_ = manager->AddThreadTask(Foundation::ThreadTaskPtr(decoder));
+        manager->RegisterResultHandler<DecodeResult>(decoder_task_id_, boost::bind(&TextureService::HandleDecodeResults, this, _1));
     }
     
     TextureService::~TextureService()
     {
+        framework_->GetThreadTaskManager()->UnregisterResultHandler(decoder_task_id_);
     }
 
     request_tag_t TextureService::RequestTexture(const std::string& asset_id)
     {
         request_tag_t tag = framework_->GetEventManager()->GetNextRequestTag();
+        Foundation::AssetKey key(asset_id);
     
-        if (requests_.find(asset_id) != requests_.end())
+        TextureRequestMap::iterator i = requests_.find(key);
+        if (i != requests_.end())
         {
             // Already requested, just add request tag
-            requests_.find(asset_id)->second.InsertTag(tag);
+            i->second.InsertTag(tag);
             return tag; 
         }
 
-        if (cache_replys_.find(asset_id) != cache_replys_.end())
+        CacheReplys::iterator j = cache_replys_.find(key);
+        if (j != cache_replys_.end())
         {
             // Already requested and found from cache, just add request tag
-            cache_replys_.find(asset_id)->second.tags.push_back(tag);
+            j->second.tags.push_back(tag);
             return tag;
         }
 
@@ -71,14 +78,14 @@ namespace TextureDecoder
             CacheReply reply;
             reply.tags.push_back(tag);
             reply.resource = Foundation::ResourcePtr(texture);
-            cache_replys_[asset_id] = reply;
+            cache_replys_[key] = reply;
             return tag;
         }
 
         // Make new decoding thread later in update
         TextureRequest new_request(asset_id); 
         new_request.InsertTag(tag);
-        requests_[asset_id] = new_request;
+        requests_[key] = new_request;
 
         return tag;
     }
@@ -109,28 +116,24 @@ namespace TextureDecoder
         if (!asset_service || !event_manager)
             return;
 
-        // Check if we want to send cached replies
-        CacheReplys::iterator cache_iter = cache_replys_.begin();
-        QStringList sent_replys;
-        while (cache_iter != cache_replys_.end())
+        // Send cached replies. Take them out first, as the event handlers may request more textures
+        CacheReplys sent_replys;
+        sent_replys.swap(cache_replys_);
+        CacheReplys::iterator cache_iter = sent_replys.begin();
+        while (cache_iter != sent_replys.end())
         {
-            std::string id = cache_iter->first;
-            CacheReply reply_data = cache_iter->second;
-            sent_replys.append(id.c_str());
-
-            if (!reply_data.resource.get())
-                break;
-
-            const RequestTagVector& tags = reply_data.tags;
-            for (uint j = 0; j < tags.size(); ++j)
-            { 
-                Resource::Events::ResourceReady event_data(id, reply_data.resource, tags[j]);
-                event_manager->SendEvent(resource_event_category_, Resource::Events::RESOURCE_READY, &event_data);    
+            const CacheReply& reply_data = cache_iter->second;
+            if (reply_data.resource.get())
+            {
+                const RequestTagVector& tags = reply_data.tags;
+                for (uint j = 0; j < tags.size(); ++j)
+                { 
+                    Resource::Events::ResourceReady event_data(reply_data.resource->GetId(), reply_data.resource, tags[j]);
+                    event_manager->SendEvent(resource_event_category_, Resource::Events::RESOURCE_READY, &event_data);    
+                }
             }
-            cache_iter++;
+            ++cache_iter;
         }
-        foreach(QString sent, sent_replys)
-            cache_replys_.erase(sent.toStdString());
 
         // Check if assets have enough data to queue decode requests
         TextureRequestMap::iterator i = requests_.begin();
@@ -173,22 +176,23 @@ namespace TextureDecoder
                 new_decode_request->id_ = request.GetId();
                 new_decode_request->level_ = request.GetNextLevel();
                 new_decode_request->source_ = asset;
-                framework_->GetThreadTaskManager()->AddRequest<DecodeRequest>("TextureDecoder", new_decode_request);
+                framework_->GetThreadTaskManager()->AddRequest<DecodeRequest>(decoder_task_id_, new_decode_request);
                 
                 request.SetDecodeRequested(true);
             }
         }
     }  
     
-    bool TextureService::HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data)
+    void TextureService::HandleDecodeResults(const std::vector<DecodeResultPtr>& results)
     {
-        if (event_id != Task::Events::REQUEST_COMPLETED)
-            return false;
-        DecodeResult* result = dynamic_cast<DecodeResult*>(data);
-        if (!result || result->task_description_ != "TextureDecoder")
-            return false;
-        
-        TextureRequestMap::iterator i = requests_.find(result->id_);
+        PROFILE(TextureService_HandleDecodeResults);
+        for (uint i = 0; i < results.size(); ++i)
+            HandleDecodeResult(results[i].get());
+    }
+
+    void TextureService::HandleDecodeResult(DecodeResult* result)
+    {
+        TextureRequestMap::iterator i = requests_.find(Foundation::AssetKey(result->id_));
         if (i != requests_.end())
         {
             bool done = i->second.UpdateWithDecodeResult(result);
@@ -222,8 +226,6 @@ namespace TextureDecoder
             if (done)
                 requests_.erase(i);
         }
-        
-        return true;
     }
     
     bool TextureService::HandleAssetEvent(event_id_t event_id, Foundation::EventDataInterface* data)
@@ -231,7 +233,7 @@ namespace TextureDecoder
         if (event_id == Asset::Events::ASSET_CANCELED)
         {
             Asset::Events::AssetCanceled* event_data = checked_static_cast<Asset::Events::AssetCanceled*>(data);
-            TextureRequestMap::iterator i = requests_.find(event_data->asset_id_);
+            TextureRequestMap::iterator i = requests_.find(Foundation::AssetKey(event_data->asset_id_));
             if (i != requests_.end())
             {
                 TextureDecoderModule::LogDebug("Texture decode request " + i->second.GetId() + " canceled");
@@ -6,6 +6,10 @@
 #include "TextureRequest.h"
 #include "TextureServiceInterface.h"
 #include "TextureCache.h"
+#include "AssetKey.h"
+#include "ThreadTask.h"
+
+#include <boost/unordered_map.hpp>
 
 namespace Foundation
 {
@@ -43,10 +47,13 @@ namespace TextureDecoder
         //! Handles an asset event. Called by TextureDecoderModule
         bool HandleAssetEvent(event_id_t event_id, Foundation::EventDataInterface* data);
         
-        //! Handles a thread task event. Called by TextureDecoderModule
-        bool HandleTaskEvent(event_id_t event_id, Foundation::EventDataInterface* data);
-        
     private:
+        //! Handles the decode results of a frame. Called by the thread task manager
+        void HandleDecodeResults(const std::vector<DecodeResultPtr>& results);
+
+        //! Handles a decode result
+        void HandleDecodeResult(DecodeResult* result);
+
         //! Updates a texture request
         /*! Polls the asset service & queues decode requests to the decode thread as necessary
          */
@@ -72,6 +79,9 @@ namespace TextureDecoder
 
         //! Max decodes per frame
         int max_decodes_per_frame_;
+
+        //! Task id of the decoder thread task
+        Foundation::thread_task_id_t decoder_task_id_;
     };
 }
 
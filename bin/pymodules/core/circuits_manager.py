@@ -9,6 +9,7 @@ try:
 except ImportError: #not running under rex
     import mockviewer as r
 from circuits import handler, Event, Component, Manager, Debugger
+from timeit import default_timer
 from core.logger import NaaliLogger
 #is not identical to the c++ side, where x and y have abs and rel
 #XXX consider making identical and possible wrapping of the c++ type
@@ -27,12 +28,42 @@ class MouseMove(Event): pass
 class MouseClick(Event): pass
 class SceneAdded(Event): pass
 class EntityUpdate(Event): pass
+class SceneEvents(Event): pass
 class Exit(Event): pass
 class LoginInfo(Event): pass
 class InboundNetwork(Event): pass
 class GenericMessage(Event): pass
 class Logout(Event): pass
 class WorldStreamReady(Event): pass
+
+class TimedManager(Manager):
+    """A circuits Manager that times each handler call, per component class and channel,
+    so that slow scripts can be found. The c++ side shows the times with the
+    PyHandlerTimes console command."""
+    
+    def __init__(self, *args, **kwargs):
+        Manager.__init__(self, *args, **kwargs)
+        self.handler_times = {} #(component class name, channel) -> [calls, total secs, max secs]
+        
+    def _getHandlers(self, _channel):
+        #the manager calls each handler between two steps of this generator,
+        #so the time a step is suspended is the time spent in the handler
+        channel = _channel[1]
+        for h in Manager._getHandlers(self, _channel):
+            start = default_timer()
+            try:
+                yield h
+            finally: #also when the manager stops at a filtering handler
+                elapsed = default_timer() - start
+                owner = getattr(h, 'im_self', None)
+                name = owner.__class__.__name__ if owner is not None else getattr(h, '__name__', str(h))
+                timing = self.handler_times.get((name, channel))
+                if timing is None:
+                    timing = self.handler_times[(name, channel)] = [0, 0.0, 0.0]
+                timing[0] += 1
+                timing[1] += elapsed
+                if elapsed > timing[2]:
+                    timing[2] = elapsed
     
 class ComponentRunner:
     instance = None
@@ -53,7 +84,7 @@ class ComponentRunner:
     def start(self):
         # Create a new circuits Manager
         #ignevents = [Update, MouseMove]
-        ignchannames = ['update', 'on_mousemove', 'on_mousedrag', 'on_keydown', 'on_input', 'on_mouseclick', 'on_entityupdated', 'on_exit', 'on_keyup', 'on_login', 'on_inboundnetwork', 'on_genericmessage', 'on_scene', 'on_entity_visuals_modified', 'on_logout', 'on_worldstreamready']
+        ignchannames = ['update', 'on_mousemove', 'on_mousedrag', 'on_keydown', 'on_input', 'on_mouseclick', 'on_entityupdated', 'on_exit', 'on_keyup', 'on_login', 'on_inboundnetwork', 'on_genericmessage', 'on_scene', 'on_entity_visuals_modified', 'on_logout', 'on_worldstreamready', 'on_sceneevents']
         ignchannels = [('*', n) for n in ignchannames]
         
         # Note: instantiating Manager with debugger causes severe lag when running as a true windowed app (no console), so instantiate without debugger
@@ -62,7 +93,7 @@ class ComponentRunner:
         # to something that shows e.g. in console, so prints from scripts show
         # (people commonly use those for debugging so they should show somewhere)
         d = Debugger(IgnoreChannels = ignchannels, logger=NaaliLogger()) #IgnoreEvents = ignored)
-        self.m = Manager() + d
+        self.m = TimedManager() + d
         #self.m = Manager()
 
         #or __all__ in pymodules __init__ ? (i.e. import pymodules would do that)
@@ -153,6 +184,36 @@ class ComponentRunner:
     def ENTITY_VISUALS_MODIFIED(self, entid):
         return self.send_event(EntityUpdate(entid), "on_entity_visuals_modified")
 
+    def SCENE_EVENTS(self, events):
+        """Scene changes of the last frame, as a list of (event id, entity id) tuples.
+        Having this method makes the c++ side call it once per frame instead of
+        ENTITY_UPDATED and ENTITY_VISUALS_MODIFIED for each change.
+        Components should take the whole list on the on_sceneevents channel.
+        For older components, each event is also pushed on its per entity channel
+        if a component listens to it, so those still cost a dispatch per event,
+        and can't stop the propagation of the event on the c++ side."""
+        m = self.m
+        m.push(SceneEvents(events), "on_sceneevents")
+        updated = "on_entityupdated" in m._cmap
+        visuals = "on_entity_visuals_modified" in m._cmap
+        if updated or visuals:
+            for evid, entid in events:
+                if updated and evid == r.EntityUpdated:
+                    m.push(EntityUpdate(entid), "on_entityupdated")
+                elif visuals and evid == r.EntityVisualsModified:
+                    m.push(EntityUpdate(entid), "on_entity_visuals_modified")
+        while m: m.flush()
+
+    def handler_times(self):
+        """Times of the component handlers as (name, calls, total secs, max secs) tuples,
+        slowest in total first. The name is the component class and the channel."""
+        times = [("%s %s" % key, t[0], t[1], t[2]) for key, t in self.m.handler_times.iteritems()]
+        times.sort(key=lambda t: t[2], reverse=True)
+        return times
+
+    def reset_handler_times(self):
+        self.m.handler_times.clear()
+
     def LOGIN_INFO(self, id): 
         #print "Login Info", id
         #return self.send_event(LoginInfo(id), "on_login") #XXX so wasn't needed or?
@@ -1,6 +1,8 @@
 MoveForwardPressed = 1
 MoveForwardReleased = 2
 KeyPressed = 3
+EntityUpdated = 5
+EntityVisualsModified = 15
 
 forwardevent = False
 